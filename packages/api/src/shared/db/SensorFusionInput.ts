@@ -0,0 +1,23 @@
+import { attribute } from "@aws/dynamodb-data-mapper-annotations";
+
+//
+// See https://github.com/awslabs/dynamodb-data-mapper-js
+//
+// Note that we need to write full constructors for mapped objects
+// so that field types don't get erased during lint:fix.
+//
+
+export default class SensorFusionInput {
+  // External sensor ID [OneWire 64-bit hex ID] (`undefined` for the onboard sensor)
+  @attribute()
+  public sensorId?: string;
+
+  // Relative weight within the fused temperature (zero monitors the sensor without using it)
+  @attribute()
+  public weight: number;
+
+  public constructor() {
+    this.sensorId = undefined;
+    this.weight = NaN;
+  }
+}
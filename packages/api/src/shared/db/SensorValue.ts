@@ -27,6 +27,16 @@ export default class SensorValue extends DeviceWithTenantAndId {
   @attribute()
   public temperature: number;
 
+  // Min/max/mean over the publish window (`undefined` if there was only one sample) [Celsius]
+  @attribute()
+  public temperatureMin?: number;
+
+  @attribute()
+  public temperatureMax?: number;
+
+  @attribute()
+  public temperatureMean?: number;
+
   public constructor() {
     super();
 
@@ -34,5 +44,8 @@ export default class SensorValue extends DeviceWithTenantAndId {
     this.deviceTime = new Date();
     this.deviceLocalSerial = 0;
     this.temperature = 0.0;
+    this.temperatureMin = undefined;
+    this.temperatureMax = undefined;
+    this.temperatureMean = undefined;
   }
 }
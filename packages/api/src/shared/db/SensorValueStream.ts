@@ -29,6 +29,16 @@ export default class SensorValueStream {
   @attribute()
   public temperature: number;
 
+  // Min/max/mean over the publish window (`undefined` if there was only one sample) [Celsius]
+  @attribute()
+  public temperatureMin?: number;
+
+  @attribute()
+  public temperatureMax?: number;
+
+  @attribute()
+  public temperatureMean?: number;
+
   public constructor() {
     this.stream = "";
     this.ts = 0;
@@ -36,6 +46,9 @@ export default class SensorValueStream {
     this.publishedTime = new Date();
     this.deviceLocalSerial = 0;
     this.temperature = 0.0;
+    this.temperatureMin = undefined;
+    this.temperatureMax = undefined;
+    this.temperatureMean = undefined;
   }
 
   public static getStreamKey(tenant: string, streamName: string): string {
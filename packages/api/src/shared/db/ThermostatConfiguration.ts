@@ -3,6 +3,9 @@ import * as GraphQL from "../../../generated/graphqlTypes";
 import { attribute, table } from "@aws/dynamodb-data-mapper-annotations";
 
 import DeviceWithTenantAndId from "./DeviceWithTenantAndId";
+import SensorFusionInput from "./SensorFusionInput";
+import ZoneConfiguration from "./ZoneConfiguration";
+import { embed } from "@aws/dynamodb-data-mapper";
 
 //
 // See https://github.com/awslabs/dynamodb-data-mapper-js
@@ -33,6 +36,10 @@ export default class ThermostatConfiguration extends DeviceWithTenantAndId {
   @attribute()
   public cadence: number;
 
+  // Status publish cadence [sec], aggregating measurements in between (zero/absent: every cadence)
+  @attribute()
+  public publishCadence?: number;
+
   // Available actions: GraphQL.ThermostatAction (may be `undefined` if no actions are available)
   @attribute({ memberType: "String" })
   public availableActions?: Set<GraphQL.ThermostatAction>;
@@ -41,6 +48,72 @@ export default class ThermostatConfiguration extends DeviceWithTenantAndId {
   @attribute()
   public timezone?: string;
 
+  // Heating/cooling control mode: GraphQL.ControlMode (firmware default if absent)
+  @attribute()
+  public controlMode?: GraphQL.ControlMode;
+
+  // Time-proportional control gains [duty fraction per C, per C*hour] and window [sec]
+  @attribute()
+  public proportionalGain?: number;
+
+  @attribute()
+  public integralGain?: number;
+
+  @attribute()
+  public controlCycleWindow?: number;
+
+  // Short-cycle protection [sec]: minimum run and off times for heat/cool,
+  // and the dead time between switching from one to the other
+  @attribute()
+  public minimumRunTime?: number;
+
+  @attribute()
+  public minimumOffTime?: number;
+
+  @attribute()
+  public changeoverDeadTime?: number;
+
+  // Early start: minutes ahead of a scheduled setting that recovery towards it may start
+  // (based on heating/cooling rates learned by the device; zero or absent disables)
+  @attribute()
+  public maximumEarlyStart?: number;
+
+  // Sensor fusion inputs (if present, the operable temperature is fused from these sensors
+  // rather than picked by externalSensorId) and method: GraphQL.SensorFusionMethod
+  @attribute({ memberType: embed(SensorFusionInput) })
+  public sensorFusionInputs?: SensorFusionInput[];
+
+  @attribute()
+  public sensorFusionMethod?: GraphQL.SensorFusionMethod;
+
+  // Sensor noise filtering: GraphQL.SensorFilterType with its parameters, i.e.
+  // smoothing [fraction of each new reading] for exponential moving averages
+  // and process/measurement noise variances [C^2] for Kalman filters
+  @attribute()
+  public sensorFilterType?: GraphQL.SensorFilterType;
+
+  @attribute()
+  public sensorFilterSmoothing?: number;
+
+  @attribute()
+  public sensorFilterProcessNoise?: number;
+
+  @attribute()
+  public sensorFilterMeasurementNoise?: number;
+
+  // Independently controlled zones sharing this device's sensors
+  // (if absent, a single zone on the default relay pins uses all thermostat settings)
+  @attribute({ memberType: embed(ZoneConfiguration) })
+  public zones?: ZoneConfiguration[];
+
+  // Dew point above which to cool to dehumidify [Celsius] (`undefined` or zero to disable)
+  @attribute()
+  public dehumidifyAboveDewPoint?: number;
+
+  // Sleep in between tasks on battery-powered devices rather than idling (`undefined` for no)
+  @attribute()
+  public lowPowerSleep?: boolean;
+
   public constructor() {
     super();
 
@@ -49,7 +122,25 @@ export default class ThermostatConfiguration extends DeviceWithTenantAndId {
     this.externalSensorId = undefined;
     this.threshold = NaN;
     this.cadence = NaN;
+    this.publishCadence = undefined;
     this.availableActions = undefined;
     this.timezone = undefined;
+    this.controlMode = undefined;
+    this.proportionalGain = undefined;
+    this.integralGain = undefined;
+    this.controlCycleWindow = undefined;
+    this.minimumRunTime = undefined;
+    this.minimumOffTime = undefined;
+    this.changeoverDeadTime = undefined;
+    this.maximumEarlyStart = undefined;
+    this.sensorFusionInputs = undefined;
+    this.sensorFusionMethod = undefined;
+    this.sensorFilterType = undefined;
+    this.sensorFilterSmoothing = undefined;
+    this.sensorFilterProcessNoise = undefined;
+    this.sensorFilterMeasurementNoise = undefined;
+    this.zones = undefined;
+    this.dehumidifyAboveDewPoint = undefined;
+    this.lowPowerSleep = undefined;
   }
 }
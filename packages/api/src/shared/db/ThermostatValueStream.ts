@@ -43,6 +43,44 @@ export default class ThermostatValueStream {
   @attribute()
   public humidity: number;
 
+  // Min/max/mean over the publish window (`undefined` if there was only one sample) [Celsius]
+  @attribute()
+  public temperatureMin?: number;
+
+  @attribute()
+  public temperatureMax?: number;
+
+  @attribute()
+  public temperatureMean?: number;
+
+  // Min/max/mean over the publish window (`undefined` if there was only one sample) [%RH]
+  @attribute()
+  public humidityMin?: number;
+
+  @attribute()
+  public humidityMax?: number;
+
+  @attribute()
+  public humidityMean?: number;
+
+  // Samples aggregated over the publish window
+  @attribute()
+  public sampleCount?: number;
+
+  // Duration of the publish window [sec]
+  @attribute()
+  public aggregationWindow?: number;
+
+  // Time spent in each action over the publish window [sec]
+  @attribute()
+  public heatOnTime?: number;
+
+  @attribute()
+  public coolOnTime?: number;
+
+  @attribute()
+  public circulateOnTime?: number;
+
   // Target temperature for heating [Celsius]
   @attribute()
   public setPointHeat: number;
@@ -81,6 +119,17 @@ export default class ThermostatValueStream {
     this.temperature = 0.0;
     this.secondaryTemperature = undefined;
     this.humidity = 0.0;
+    this.temperatureMin = undefined;
+    this.temperatureMax = undefined;
+    this.temperatureMean = undefined;
+    this.humidityMin = undefined;
+    this.humidityMax = undefined;
+    this.humidityMean = undefined;
+    this.sampleCount = undefined;
+    this.aggregationWindow = undefined;
+    this.heatOnTime = undefined;
+    this.coolOnTime = undefined;
+    this.circulateOnTime = undefined;
     this.setPointHeat = NaN;
     this.setPointCool = NaN;
     this.setPointCirculateAbove = NaN;
@@ -0,0 +1,58 @@
+import * as GraphQL from "../../../generated/graphqlTypes";
+
+import { attribute } from "@aws/dynamodb-data-mapper-annotations";
+
+//
+// See https://github.com/awslabs/dynamodb-data-mapper-js
+//
+// Note that we need to write full constructors for mapped objects
+// so that field types don't get erased during lint:fix.
+//
+
+export default class ZoneConfiguration {
+  // External sensor ID [OneWire 64-bit hex ID] (`undefined` for the device's operable temperature)
+  @attribute()
+  public sensorId?: string;
+
+  // Indexes into the device's ThermostatSettings.settings applying to this zone
+  // (`undefined` or empty for all settings)
+  @attribute()
+  public thermostatSettingIndexes?: number[];
+
+  // Relay pins [Particle pin number] (`undefined` if not connected)
+  @attribute()
+  public relayPinHeat?: number;
+
+  @attribute()
+  public relayPinSwitchOver?: number;
+
+  @attribute()
+  public relayPinCirculate?: number;
+
+  // Heating/cooling control mode: GraphQL.ControlMode (`undefined` to follow the configuration's)
+  @attribute()
+  public controlMode?: GraphQL.ControlMode;
+
+  // Time-proportional control gains [duty fraction per C, per C*hour] and window [sec]
+  // (`undefined` for the configuration's)
+  @attribute()
+  public proportionalGain?: number;
+
+  @attribute()
+  public integralGain?: number;
+
+  @attribute()
+  public controlCycleWindow?: number;
+
+  public constructor() {
+    this.sensorId = undefined;
+    this.thermostatSettingIndexes = undefined;
+    this.relayPinHeat = undefined;
+    this.relayPinSwitchOver = undefined;
+    this.relayPinCirculate = undefined;
+    this.controlMode = undefined;
+    this.proportionalGain = undefined;
+    this.integralGain = undefined;
+    this.controlCycleWindow = undefined;
+  }
+}
@@ -3,6 +3,7 @@ export * from "./DbMapper";
 import DeviceTenancy from "./DeviceTenancy";
 import DeviceWithTenantAndId from "./DeviceWithTenantAndId";
 import SensorConfiguration from "./SensorConfiguration";
+import SensorFusionInput from "./SensorFusionInput";
 import SensorValue from "./SensorValue";
 import SensorValueStream from "./SensorValueStream";
 import ThermostatConfiguration from "./ThermostatConfiguration";
@@ -11,11 +12,13 @@ import ThermostatSettings from "./ThermostatSettings";
 import ThermostatValue from "./ThermostatValue";
 import ThermostatValueStream from "./ThermostatValueStream";
 import UserPreferences from "./UserPreferences";
+import ZoneConfiguration from "./ZoneConfiguration";
 
 export {
   DeviceTenancy,
   DeviceWithTenantAndId,
   SensorConfiguration,
+  SensorFusionInput,
   SensorValue,
   SensorValueStream,
   ThermostatConfiguration,
@@ -24,4 +27,5 @@ export {
   ThermostatValue,
   ThermostatValueStream,
   UserPreferences,
+  ZoneConfiguration,
 };
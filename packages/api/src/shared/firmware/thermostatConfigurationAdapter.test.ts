@@ -0,0 +1,340 @@
+import * as GraphQL from "../../../generated/graphqlTypes";
+import * as OneWireIdAdapter from "./oneWireIdAdapter";
+import * as ThermostatConfigurationAdapter from "./thermostatConfigurationAdapter";
+
+import { Flatbuffers, flatbuffers } from "@grumpycorp/warm-and-fuzzy-shared";
+import {
+  SensorFusionInput,
+  ThermostatConfiguration,
+  ThermostatSetting,
+  ThermostatSettings,
+  ZoneConfiguration,
+} from "../db";
+
+function buildThermostatConfiguration(timezone?: string): ThermostatConfiguration {
+  const thermostatConfiguration = new ThermostatConfiguration();
+
+  thermostatConfiguration.id = "0123456789abcdef01234567";
+  thermostatConfiguration.threshold = 0.5;
+  thermostatConfiguration.cadence = 60;
+  thermostatConfiguration.timezone = timezone;
+
+  return thermostatConfiguration;
+}
+
+function buildThermostatSettings(cSettings: number): ThermostatSettings {
+  const thermostatSettings = new ThermostatSettings();
+
+  for (let idxSetting = 0; idxSetting < cSettings; ++idxSetting) {
+    const thermostatSetting = new ThermostatSetting();
+
+    thermostatSetting.type = GraphQL.ThermostatSettingType.Scheduled;
+    thermostatSetting.daysOfWeek = new Set([GraphQL.DayOfWeek.Monday]);
+    thermostatSetting.atMinutesSinceMidnight = idxSetting * 30;
+    thermostatSetting.setPointHeat = 20;
+    thermostatSetting.setPointCool = 25;
+    thermostatSetting.allowedActions = new Set([GraphQL.ThermostatAction.Heat]);
+
+    thermostatSettings.settings?.push(thermostatSetting);
+  }
+
+  return thermostatSettings;
+}
+
+function decodeFirmwareBytes(
+  firmwareConfigBytes: Uint8Array
+): Flatbuffers.Firmware.ThermostatConfiguration {
+  return Flatbuffers.Firmware.ThermostatConfiguration.getRootAsThermostatConfiguration(
+    new flatbuffers.ByteBuffer(firmwareConfigBytes)
+  );
+}
+
+function timezoneTransitionsLength(firmwareConfigBytes: Uint8Array): number {
+  return decodeFirmwareBytes(firmwareConfigBytes).timezoneTransitionsLength();
+}
+
+function decodedFirmwareFromModel(
+  thermostatConfiguration: ThermostatConfiguration
+): Flatbuffers.Firmware.ThermostatConfiguration {
+  return decodeFirmwareBytes(
+    ThermostatConfigurationAdapter.firmwareBytesFromModel(
+      thermostatConfiguration,
+      buildThermostatSettings(1)
+    )
+  );
+}
+
+function canBuildFirmwareBytes(
+  thermostatConfiguration: ThermostatConfiguration,
+  cSettings: number
+): boolean {
+  try {
+    ThermostatConfigurationAdapter.firmwareBytesFromModel(
+      thermostatConfiguration,
+      buildThermostatSettings(cSettings)
+    );
+    return true;
+  } catch (e) {
+    return false;
+  }
+}
+
+// Largest number of settings for which a configuration can be built
+function largestSettingsCount(thermostatConfiguration: ThermostatConfiguration): number {
+  let cSettings = 0;
+
+  while (canBuildFirmwareBytes(thermostatConfiguration, cSettings + 1)) {
+    ++cSettings;
+  }
+
+  return cSettings;
+}
+
+describe("firmwareBytesFromModel", () => {
+  it("builds configurations within the firmware's limit", () => {
+    const firmwareConfigBytes = ThermostatConfigurationAdapter.firmwareBytesFromModel(
+      buildThermostatConfiguration("America/Los_Angeles"),
+      buildThermostatSettings(6)
+    );
+
+    expect(firmwareConfigBytes.length).toBeLessThanOrEqual(
+      ThermostatConfigurationAdapter.firmwareConfigBytesMax
+    );
+    expect(timezoneTransitionsLength(firmwareConfigBytes)).toBe(
+      ThermostatConfigurationAdapter.timezoneTransitionsMax
+    );
+  });
+
+  it("rejects configurations exceeding the firmware's limit", () => {
+    expect(() =>
+      ThermostatConfigurationAdapter.firmwareBytesFromModel(
+        buildThermostatConfiguration(),
+        buildThermostatSettings(32)
+      )
+    ).toThrow(/exceeds the firmware's limit/);
+  });
+
+  it("drops timezone transitions to make room for settings", () => {
+    const thermostatConfiguration = buildThermostatConfiguration("America/Los_Angeles");
+    const cSettings = largestSettingsCount(thermostatConfiguration);
+
+    // (As many settings fit as without a timezone, give or take the other timezone fields)
+    expect(cSettings).toBeGreaterThan(0);
+    expect(cSettings).toBeGreaterThanOrEqual(
+      largestSettingsCount(buildThermostatConfiguration()) - 1
+    );
+
+    const firmwareConfigBytes = ThermostatConfigurationAdapter.firmwareBytesFromModel(
+      thermostatConfiguration,
+      buildThermostatSettings(cSettings)
+    );
+
+    expect(firmwareConfigBytes.length).toBeLessThanOrEqual(
+      ThermostatConfigurationAdapter.firmwareConfigBytesMax
+    );
+    expect(timezoneTransitionsLength(firmwareConfigBytes)).toBeLessThan(
+      ThermostatConfigurationAdapter.timezoneTransitionsMax
+    );
+  });
+});
+
+describe("firmwareBytesFromModel fields", () => {
+  it("carries the publish cadence", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+    expect(decodedFirmwareFromModel(thermostatConfiguration).publishCadence()).toBe(0);
+
+    thermostatConfiguration.publishCadence = 600;
+    expect(decodedFirmwareFromModel(thermostatConfiguration).publishCadence()).toBe(600);
+  });
+
+  it("carries time-proportional control", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+    const defaults = decodedFirmwareFromModel(thermostatConfiguration);
+
+    expect(defaults.controlMode()).toBe(Flatbuffers.Firmware.ControlMode.Hysteresis);
+    expect(defaults.proportionalGainX100()).toBe(20);
+
+    thermostatConfiguration.controlMode = GraphQL.ControlMode.TimeProportional;
+    thermostatConfiguration.proportionalGain = 0.35;
+    thermostatConfiguration.integralGain = 0.1;
+    thermostatConfiguration.controlCycleWindow = 600;
+
+    const firmwareConfig = decodedFirmwareFromModel(thermostatConfiguration);
+
+    expect(firmwareConfig.controlMode()).toBe(Flatbuffers.Firmware.ControlMode.TimeProportional);
+    expect(firmwareConfig.proportionalGainX100()).toBe(35);
+    expect(firmwareConfig.integralGainX100()).toBe(10);
+    expect(firmwareConfig.controlCycleWindow()).toBe(600);
+  });
+
+  it("carries short-cycle protection", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    thermostatConfiguration.minimumRunTime = 300;
+    thermostatConfiguration.minimumOffTime = 600;
+    thermostatConfiguration.changeoverDeadTime = 120;
+
+    const firmwareConfig = decodedFirmwareFromModel(thermostatConfiguration);
+
+    expect(firmwareConfig.minimumRunTime()).toBe(300);
+    expect(firmwareConfig.minimumOffTime()).toBe(600);
+    expect(firmwareConfig.changeoverDeadTime()).toBe(120);
+  });
+
+  it("carries the maximum early start", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+    expect(decodedFirmwareFromModel(thermostatConfiguration).maximumEarlyStart()).toBe(0);
+
+    thermostatConfiguration.maximumEarlyStart = 120;
+    expect(decodedFirmwareFromModel(thermostatConfiguration).maximumEarlyStart()).toBe(120);
+  });
+
+  it("carries sensor fusion inputs in order", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+    const sensorIds = [undefined, "28ff0102030405a1", "28ff0102030405b2"];
+
+    thermostatConfiguration.sensorFusionMethod = GraphQL.SensorFusionMethod.TrimmedMean;
+    thermostatConfiguration.sensorFusionInputs = sensorIds.map((sensorId, idxInput) =>
+      Object.assign(new SensorFusionInput(), { sensorId, weight: idxInput + 1 })
+    );
+
+    const firmwareConfig = decodedFirmwareFromModel(thermostatConfiguration);
+
+    expect(firmwareConfig.sensorFusionMethod()).toBe(
+      Flatbuffers.Firmware.SensorFusionMethod.TrimmedMean
+    );
+    expect(firmwareConfig.sensorFusionInputsLength()).toBe(sensorIds.length);
+
+    sensorIds.forEach((sensorId, idxInput) => {
+      const sensorFusionInput = firmwareConfig.sensorFusionInputs(idxInput);
+
+      expect(sensorFusionInput?.sensorId().toFloat64()).toBe(
+        sensorId ? OneWireIdAdapter.firmwareFromModel(sensorId).toFloat64() : 0
+      );
+      expect(sensorFusionInput?.weight()).toBe(idxInput + 1);
+    });
+  });
+
+  it("carries sensor filter settings", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    thermostatConfiguration.sensorFilterType = GraphQL.SensorFilterType.Kalman;
+    thermostatConfiguration.sensorFilterSmoothing = 0.25;
+    thermostatConfiguration.sensorFilterProcessNoise = 0.0015;
+    thermostatConfiguration.sensorFilterMeasurementNoise = 0.09;
+
+    const firmwareConfig = decodedFirmwareFromModel(thermostatConfiguration);
+
+    expect(firmwareConfig.sensorFilterType()).toBe(Flatbuffers.Firmware.SensorFilterType.Kalman);
+    expect(firmwareConfig.sensorFilterSmoothingX100()).toBe(25);
+    expect(firmwareConfig.sensorFilterProcessNoiseX10000()).toBe(15);
+    expect(firmwareConfig.sensorFilterMeasurementNoiseX10000()).toBe(900);
+  });
+
+  it("carries zones in order, selecting settings by model index", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    thermostatConfiguration.zones = [
+      Object.assign(new ZoneConfiguration(), {
+        thermostatSettingIndexes: [0, 2],
+        relayPinHeat: 10,
+        relayPinSwitchOver: 11,
+      }),
+      Object.assign(new ZoneConfiguration(), {
+        sensorId: "28ff0102030405a1",
+        relayPinHeat: 13,
+      }),
+    ];
+
+    const firmwareConfig = decodeFirmwareBytes(
+      ThermostatConfigurationAdapter.firmwareBytesFromModel(
+        thermostatConfiguration,
+        buildThermostatSettings(3)
+      )
+    );
+
+    expect(firmwareConfig.zonesLength()).toBe(2);
+
+    const firstZone = firmwareConfig.zones(0);
+    const secondZone = firmwareConfig.zones(1);
+
+    expect(firstZone?.sensorId().toFloat64()).toBe(0);
+    expect(firstZone?.relayPinHeat()).toBe(10);
+    expect(firstZone?.relayPinSwitchOver()).toBe(11);
+    expect(firstZone?.relayPinCirculate()).toBe(255);
+
+    // Selected settings are those the model lists, wherever they land in the firmware's vector
+    const selectedSettingTimes: number[] = [];
+
+    const cFirmwareSettings = firmwareConfig.thermostatSettingsLength();
+
+    for (let idxFirmware = 0; idxFirmware < cFirmwareSettings; ++idxFirmware) {
+      if ((firstZone?.thermostatSettingsMask() ?? 0) & (1 << idxFirmware)) {
+        selectedSettingTimes.push(
+          firmwareConfig.thermostatSettings(idxFirmware)?.atMinutesSinceMidnight() ?? -1
+        );
+      }
+    }
+
+    expect(selectedSettingTimes.sort((lhs, rhs) => lhs - rhs)).toEqual([0, 60]);
+
+    expect(secondZone?.sensorId().toFloat64()).toBe(
+      OneWireIdAdapter.firmwareFromModel("28ff0102030405a1").toFloat64()
+    );
+    expect(secondZone?.thermostatSettingsMask()).toBe(0);
+    expect(secondZone?.relayPinHeat()).toBe(13);
+  });
+
+  it("carries zone control settings, defaulting to the configuration's", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    thermostatConfiguration.controlMode = GraphQL.ControlMode.Hysteresis;
+    thermostatConfiguration.integralGain = 0.1;
+
+    thermostatConfiguration.zones = [
+      Object.assign(new ZoneConfiguration(), { relayPinHeat: 10 }),
+      Object.assign(new ZoneConfiguration(), {
+        relayPinHeat: 13,
+        controlMode: GraphQL.ControlMode.TimeProportional,
+        proportionalGain: 0.5,
+      }),
+    ];
+
+    const firmwareConfig = decodeFirmwareBytes(
+      ThermostatConfigurationAdapter.firmwareBytesFromModel(
+        thermostatConfiguration,
+        buildThermostatSettings(1)
+      )
+    );
+
+    const firstZone = firmwareConfig.zones(0);
+    const secondZone = firmwareConfig.zones(1);
+
+    expect(firstZone?.controlMode()).toBe(Flatbuffers.Firmware.ZoneControlMode.Default);
+
+    expect(secondZone?.controlMode()).toBe(Flatbuffers.Firmware.ZoneControlMode.TimeProportional);
+    expect(secondZone?.proportionalGainX100()).toBe(50);
+    expect(secondZone?.integralGainX100()).toBe(10); // From the configuration
+    expect(secondZone?.controlCycleWindow()).toBe(900); // Firmware default
+  });
+
+  it("carries the dehumidification dew point", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    expect(decodedFirmwareFromModel(thermostatConfiguration).dehumidifyAboveDewPointX100()).toBe(0);
+
+    thermostatConfiguration.dehumidifyAboveDewPoint = 15.5;
+    expect(decodedFirmwareFromModel(thermostatConfiguration).dehumidifyAboveDewPointX100()).toBe(
+      1550
+    );
+  });
+
+  it("carries low-power sleep", () => {
+    const thermostatConfiguration = buildThermostatConfiguration();
+
+    expect(decodedFirmwareFromModel(thermostatConfiguration).lowPowerSleep()).toBe(false);
+
+    thermostatConfiguration.lowPowerSleep = true;
+    expect(decodedFirmwareFromModel(thermostatConfiguration).lowPowerSleep()).toBe(true);
+  });
+});
@@ -1,3 +1,4 @@
+import * as GraphQL from "../../../generated/graphqlTypes";
 import * as OneWireIdAdapter from "./oneWireIdAdapter";
 import * as ThermostatSettingAdapter from "./thermostatSettingAdapter";
 
@@ -7,10 +8,183 @@ import { ThermostatConfiguration, ThermostatSettings } from "../db";
 import { Z85Encode } from "../Z85";
 import moment from "moment-timezone";
 
+// c.f. //packages/firmware/thermostat/Main.cpp#handleUpdatedConfig
+const versionMagic = "3Z85";
+
+// Sent in lieu of the configuration when the device's configuration hash matches
+// c.f. //packages/firmware/thermostat/Main.cpp#onStatusResponse
+export const firmwareNotModified = "304";
+
+// Upcoming UTC offset changes are sent along so the device can keep local time while offline
+// c.f. //packages/firmware/thermostat/inc/LocalTime.h
+const timezoneTransitionsHorizon = 366 * 24 * 60 * 60 * 1000; // ms, i.e. about a year
+export const timezoneTransitionsMax = 4; // c.f. Configuration.h#sc_cTimezoneTransitions_Max
+
+// Largest configuration the device accepts: what fits into Particle's 622 chars of event data
+// behind quotes and versionMagic, i.e. (622 - 2 - 4) / 5 whole Z85 frames of 4 bytes each
+// c.f. //packages/firmware/thermostat/inc/Configuration.h#sc_cbFlatbufferData_Max
+export const firmwareConfigBytesMax = 492;
+
 export function firmwareFromModel(
   thermostatConfiguration: ThermostatConfiguration,
   thermostatSettings: ThermostatSettings
 ): string {
+  return firmwareFromBytes(firmwareBytesFromModel(thermostatConfiguration, thermostatSettings));
+}
+
+export function firmwareFromBytes(firmwareConfigBytes: Uint8Array): string {
+  return versionMagic.concat(Z85Encode(firmwareConfigBytes));
+}
+
+// 32-bit FNV-1a over the bytes as the device decodes them (i.e. zero-padded by Z85)
+// c.f. //packages/firmware/thermostat/inc/Configuration.h#ComputeHash
+export function firmwareHashFromBytes(firmwareConfigBytes: Uint8Array): string {
+  let hash = 0x811c9dc5;
+
+  const accumulateByte = (currentValue: number): void => {
+    hash = Math.imul(hash ^ currentValue, 0x01000193) >>> 0; // >>> -> coerce as uint32
+  };
+
+  firmwareConfigBytes.forEach(currentValue => accumulateByte(currentValue));
+
+  for (let cbPadding = (4 - (firmwareConfigBytes.length % 4)) % 4; cbPadding > 0; --cbPadding) {
+    accumulateByte(0);
+  }
+
+  return ("0000000" + hash.toString(16)).slice(-8);
+}
+
+// Optional fields may be absent from the model or explicitly null (e.g. from GraphQL inputs);
+// either way the firmware's default applies
+function isSet<T>(value: T | null | undefined): value is T {
+  return value !== undefined && value !== null;
+}
+
+function controlModeFromModel(
+  controlMode: GraphQL.ControlMode
+): Flatbuffers.Firmware.ControlMode {
+  if (controlMode === GraphQL.ControlMode.Hysteresis) {
+    return Flatbuffers.Firmware.ControlMode.Hysteresis;
+  }
+
+  if (controlMode === GraphQL.ControlMode.TimeProportional) {
+    return Flatbuffers.Firmware.ControlMode.TimeProportional;
+  }
+
+  throw new Error(`Unrecognized control mode '${controlMode}'`);
+}
+
+// Zones without a control mode of their own follow the configuration's
+// (c.f. firmware.fbs#ZoneControlMode)
+function zoneControlModeFromModel(
+  controlMode: GraphQL.ControlMode | null | undefined
+): Flatbuffers.Firmware.ZoneControlMode {
+  if (!isSet(controlMode)) {
+    return Flatbuffers.Firmware.ZoneControlMode.Default;
+  }
+
+  if (controlMode === GraphQL.ControlMode.Hysteresis) {
+    return Flatbuffers.Firmware.ZoneControlMode.Hysteresis;
+  }
+
+  if (controlMode === GraphQL.ControlMode.TimeProportional) {
+    return Flatbuffers.Firmware.ZoneControlMode.TimeProportional;
+  }
+
+  throw new Error(`Unrecognized control mode '${controlMode}'`);
+}
+
+function sensorFusionMethodFromModel(
+  sensorFusionMethod: GraphQL.SensorFusionMethod
+): Flatbuffers.Firmware.SensorFusionMethod {
+  if (sensorFusionMethod === GraphQL.SensorFusionMethod.WeightedMedian) {
+    return Flatbuffers.Firmware.SensorFusionMethod.WeightedMedian;
+  }
+
+  if (sensorFusionMethod === GraphQL.SensorFusionMethod.TrimmedMean) {
+    return Flatbuffers.Firmware.SensorFusionMethod.TrimmedMean;
+  }
+
+  throw new Error(`Unrecognized sensor fusion method '${sensorFusionMethod}'`);
+}
+
+function sensorFilterTypeFromModel(
+  sensorFilterType: GraphQL.SensorFilterType
+): Flatbuffers.Firmware.SensorFilterType {
+  if (sensorFilterType === GraphQL.SensorFilterType.None) {
+    return Flatbuffers.Firmware.SensorFilterType.None;
+  }
+
+  if (sensorFilterType === GraphQL.SensorFilterType.ExponentialMovingAverage) {
+    return Flatbuffers.Firmware.SensorFilterType.ExponentialMovingAverage;
+  }
+
+  if (sensorFilterType === GraphQL.SensorFilterType.Kalman) {
+    return Flatbuffers.Firmware.SensorFilterType.Kalman;
+  }
+
+  throw new Error(`Unrecognized sensor filter type '${sensorFilterType}'`);
+}
+
+// Settings go into the firmware's thermostatSettings vector in reverse (c.f. buildFirmwareBytes())
+// so model setting N lands at firmware index (cSettings - 1 - N), which is the mask bit to set.
+// Indexes past the end of the settings are ignored (if none are left, the zone uses all settings).
+function zoneSettingsMaskFromModel(
+  thermostatSettingIndexes: number[] | undefined,
+  cSettings: number
+): number {
+  let thermostatSettingsMask = 0;
+
+  thermostatSettingIndexes?.forEach(idxSetting => {
+    const idxFirmware = cSettings - 1 - idxSetting;
+
+    if (idxSetting >= 0 && idxFirmware >= 0 && idxFirmware < 32) {
+      thermostatSettingsMask = (thermostatSettingsMask | (1 << idxFirmware)) >>> 0;
+    }
+  });
+
+  return thermostatSettingsMask;
+}
+
+function relayPinFromModel(relayPin: number | undefined): number {
+  const relayPinNotConnected = 255; // c.f. firmware Configuration.h#sc_RelayPin_NotConnected
+
+  return isSet(relayPin) ? relayPin : relayPinNotConnected;
+}
+
+// Throws if the configuration won't fit on the device even without timezone transitions
+export function firmwareBytesFromModel(
+  thermostatConfiguration: ThermostatConfiguration,
+  thermostatSettings: ThermostatSettings
+): Uint8Array {
+  // Timezone transitions only keep local time going while offline (the next change is sent anyway),
+  // so give up the latest ones first to make room for everything else
+  for (
+    let timezoneTransitionsLimit = timezoneTransitionsMax;
+    timezoneTransitionsLimit >= 0;
+    --timezoneTransitionsLimit
+  ) {
+    const firmwareConfigBytes = buildFirmwareBytes(
+      thermostatConfiguration,
+      thermostatSettings,
+      timezoneTransitionsLimit
+    );
+
+    if (firmwareConfigBytes.length <= firmwareConfigBytesMax) {
+      return firmwareConfigBytes;
+    }
+  }
+
+  throw new Error(
+    `Configuration for device ${thermostatConfiguration.id} exceeds the firmware's limit of ${firmwareConfigBytesMax} bytes`
+  );
+}
+
+function buildFirmwareBytes(
+  thermostatConfiguration: ThermostatConfiguration,
+  thermostatSettings: ThermostatSettings,
+  timezoneTransitionsLimit: number
+): Uint8Array {
   // Create buffer
   const firmwareConfigBuilder: flatbuffers.Builder = new flatbuffers.Builder(128); // ...initial guess at size
 
@@ -26,6 +200,128 @@ export function firmwareFromModel(
 
   const thermostatSettingsVector = firmwareConfigBuilder.endVector();
 
+  // Determine timezone periods (we rely on the timezoneInfo data being in sorted order)
+  const timezoneInfo = thermostatConfiguration.timezone
+    ? moment.tz.zone(thermostatConfiguration.timezone)
+    : null;
+
+  const currentTime = Date.now(); // ms since UTC epoch, just like timezoneInfo.untils[]
+  const idxCurrent = timezoneInfo?.untils.findIndex(untilTime => untilTime > currentTime) ?? -1;
+
+  // Create timezone transitions array: the offsets taking over at the end of upcoming periods
+  let timezoneTransitionsVector: number | undefined;
+
+  if (timezoneInfo && idxCurrent > 0 && timezoneTransitionsLimit > 0) {
+    const timezoneTransitions: { at: number; utcOffset: number }[] = [];
+
+    for (
+      let idxUntil = idxCurrent;
+      idxUntil < timezoneInfo.untils.length - 1 &&
+      timezoneInfo.untils[idxUntil] <= currentTime + timezoneTransitionsHorizon &&
+      timezoneTransitions.length < timezoneTransitionsLimit;
+      ++idxUntil
+    ) {
+      timezoneTransitions.push({
+        at: timezoneInfo.untils[idxUntil] / 1000, // -> sec since UTC epoch
+        utcOffset: timezoneInfo.offsets[idxUntil + 1],
+      });
+    }
+
+    Flatbuffers.Firmware.ThermostatConfiguration.startTimezoneTransitionsVector(
+      firmwareConfigBuilder,
+      timezoneTransitions.length
+    );
+
+    // (Vectors are built back to front, so add in reverse to keep them in ascending order)
+    for (let idxTransition = timezoneTransitions.length - 1; idxTransition >= 0; --idxTransition) {
+      Flatbuffers.Firmware.TimezoneTransition.createTimezoneTransition(
+        firmwareConfigBuilder,
+        timezoneTransitions[idxTransition].at,
+        timezoneTransitions[idxTransition].utcOffset,
+        0
+      );
+    }
+
+    timezoneTransitionsVector = firmwareConfigBuilder.endVector();
+  }
+
+  // Create sensor fusion inputs array
+  const sensorFusionInputs = thermostatConfiguration.sensorFusionInputs ?? [];
+  let sensorFusionInputsVector: number | undefined;
+
+  if (sensorFusionInputs.length > 0) {
+    Flatbuffers.Firmware.ThermostatConfiguration.startSensorFusionInputsVector(
+      firmwareConfigBuilder,
+      sensorFusionInputs.length
+    );
+
+    // (Vectors are built back to front, so add in reverse to keep them in order)
+    for (let idxInput = sensorFusionInputs.length - 1; idxInput >= 0; --idxInput) {
+      const { sensorId, weight } = sensorFusionInputs[idxInput];
+
+      Flatbuffers.Firmware.SensorFusionInput.createSensorFusionInput(
+        firmwareConfigBuilder,
+        sensorId ? OneWireIdAdapter.firmwareFromModel(sensorId) : flatbuffers.Long.ZERO,
+        weight,
+        0,
+        0,
+        0
+      );
+    }
+
+    sensorFusionInputsVector = firmwareConfigBuilder.endVector();
+  }
+
+  // Create zones array
+  const zones = thermostatConfiguration.zones ?? [];
+  let zonesVector: number | undefined;
+
+  if (zones.length > 0) {
+    Flatbuffers.Firmware.ThermostatConfiguration.startZonesVector(
+      firmwareConfigBuilder,
+      zones.length
+    );
+
+    // Zones with a control mode of their own carry all of their control settings
+    // (the firmware doesn't mix and match), so fill in what they leave out from the configuration
+    // or, failing that, from the firmware's defaults (c.f. firmware.fbs#ThermostatConfiguration)
+    const proportionalGainDefault = thermostatConfiguration.proportionalGain ?? 0.2;
+    const integralGainDefault = thermostatConfiguration.integralGain ?? 0.05;
+    const controlCycleWindowDefault = thermostatConfiguration.controlCycleWindow ?? 900;
+
+    // (Vectors are built back to front, so add in reverse to keep them in order)
+    for (let idxZone = zones.length - 1; idxZone >= 0; --idxZone) {
+      const { sensorId, relayPinHeat, relayPinSwitchOver, relayPinCirculate } = zones[idxZone];
+      const { controlMode, proportionalGain, integralGain, controlCycleWindow } = zones[idxZone];
+
+      const zoneControlMode = zoneControlModeFromModel(controlMode);
+      const hasOwnControl = zoneControlMode !== Flatbuffers.Firmware.ZoneControlMode.Default;
+
+      const zoneProportionalGain = proportionalGain ?? proportionalGainDefault;
+      const zoneIntegralGain = integralGain ?? integralGainDefault;
+      const zoneControlCycleWindow = controlCycleWindow ?? controlCycleWindowDefault;
+
+      Flatbuffers.Firmware.ZoneConfiguration.createZoneConfiguration(
+        firmwareConfigBuilder,
+        sensorId ? OneWireIdAdapter.firmwareFromModel(sensorId) : flatbuffers.Long.ZERO,
+        zoneSettingsMaskFromModel(
+          zones[idxZone].thermostatSettingIndexes,
+          thermostatSettings.settings?.length ?? 0
+        ),
+        relayPinFromModel(relayPinHeat),
+        relayPinFromModel(relayPinSwitchOver),
+        relayPinFromModel(relayPinCirculate),
+        zoneControlMode,
+        hasOwnControl ? Math.round(zoneProportionalGain * 100) : 0,
+        hasOwnControl ? Math.round(zoneIntegralGain * 100) : 0,
+        hasOwnControl ? zoneControlCycleWindow : 0,
+        0
+      );
+    }
+
+    zonesVector = firmwareConfigBuilder.endVector();
+  }
+
   // Start top-level table
   Flatbuffers.Firmware.ThermostatConfiguration.startThermostatConfiguration(firmwareConfigBuilder);
 
@@ -40,6 +336,13 @@ export function firmwareFromModel(
     thermostatConfiguration.cadence
   );
 
+  if (thermostatConfiguration.publishCadence) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addPublishCadence(
+      firmwareConfigBuilder,
+      thermostatConfiguration.publishCadence
+    );
+  }
+
   if (thermostatConfiguration.externalSensorId) {
     Flatbuffers.Firmware.ThermostatConfiguration.addExternalSensorId(
       firmwareConfigBuilder,
@@ -47,36 +350,147 @@ export function firmwareFromModel(
     );
   }
 
-  if (thermostatConfiguration.timezone) {
-    const timezoneInfo = moment.tz.zone(thermostatConfiguration.timezone);
+  if (timezoneInfo && idxCurrent > 0) {
+    const currentOffset = timezoneInfo.offsets[idxCurrent];
+    const nextOffset = timezoneInfo.offsets[idxCurrent + 1];
 
-    if (timezoneInfo) {
-      // We rely on the timezoneInfo data being in sorted order
-      const currentTime = Date.now(); // ms since UTC epoch, just like timezoneInfo.untils[]
-      const idxCurrent = timezoneInfo.untils.findIndex(untilTime => untilTime > currentTime);
+    const nextTimezoneChange = timezoneInfo.untils[idxCurrent] / 1000; // -> sec since UTC epoch
 
-      if (idxCurrent > 0) {
-        const currentOffset = timezoneInfo.offsets[idxCurrent];
-        const nextOffset = timezoneInfo.offsets[idxCurrent + 1];
+    Flatbuffers.Firmware.ThermostatConfiguration.addCurrentTimezoneUTCOffset(
+      firmwareConfigBuilder,
+      currentOffset
+    );
 
-        const nextTimezoneChange = timezoneInfo.untils[idxCurrent] / 1000; // -> sec since UTC epoch
+    // (Superseded by timezoneTransitions; still sent for older firmware)
+    Flatbuffers.Firmware.ThermostatConfiguration.addNextTimezoneUTCOffset(
+      firmwareConfigBuilder,
+      nextOffset
+    );
 
-        Flatbuffers.Firmware.ThermostatConfiguration.addCurrentTimezoneUTCOffset(
-          firmwareConfigBuilder,
-          currentOffset
-        );
+    Flatbuffers.Firmware.ThermostatConfiguration.addNextTimezoneChange(
+      firmwareConfigBuilder,
+      nextTimezoneChange
+    );
+  }
 
-        Flatbuffers.Firmware.ThermostatConfiguration.addNextTimezoneUTCOffset(
-          firmwareConfigBuilder,
-          nextOffset
-        );
+  if (isSet(thermostatConfiguration.controlMode)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addControlMode(
+      firmwareConfigBuilder,
+      controlModeFromModel(thermostatConfiguration.controlMode)
+    );
+  }
 
-        Flatbuffers.Firmware.ThermostatConfiguration.addNextTimezoneChange(
-          firmwareConfigBuilder,
-          nextTimezoneChange
-        );
-      }
-    }
+  if (isSet(thermostatConfiguration.proportionalGain)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addProportionalGainX100(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.proportionalGain * 100)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.integralGain)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addIntegralGainX100(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.integralGain * 100)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.controlCycleWindow)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addControlCycleWindow(
+      firmwareConfigBuilder,
+      thermostatConfiguration.controlCycleWindow
+    );
+  }
+
+  if (thermostatConfiguration.minimumRunTime) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addMinimumRunTime(
+      firmwareConfigBuilder,
+      thermostatConfiguration.minimumRunTime
+    );
+  }
+
+  if (thermostatConfiguration.minimumOffTime) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addMinimumOffTime(
+      firmwareConfigBuilder,
+      thermostatConfiguration.minimumOffTime
+    );
+  }
+
+  if (thermostatConfiguration.changeoverDeadTime) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addChangeoverDeadTime(
+      firmwareConfigBuilder,
+      thermostatConfiguration.changeoverDeadTime
+    );
+  }
+
+  if (thermostatConfiguration.maximumEarlyStart) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addMaximumEarlyStart(
+      firmwareConfigBuilder,
+      thermostatConfiguration.maximumEarlyStart
+    );
+  }
+
+  if (sensorFusionInputsVector !== undefined) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFusionInputs(
+      firmwareConfigBuilder,
+      sensorFusionInputsVector
+    );
+  }
+
+  if (isSet(thermostatConfiguration.sensorFusionMethod)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFusionMethod(
+      firmwareConfigBuilder,
+      sensorFusionMethodFromModel(thermostatConfiguration.sensorFusionMethod)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.sensorFilterType)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFilterType(
+      firmwareConfigBuilder,
+      sensorFilterTypeFromModel(thermostatConfiguration.sensorFilterType)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.sensorFilterSmoothing)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFilterSmoothingX100(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.sensorFilterSmoothing * 100)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.sensorFilterProcessNoise)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFilterProcessNoiseX10000(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.sensorFilterProcessNoise * 10000)
+    );
+  }
+
+  if (isSet(thermostatConfiguration.sensorFilterMeasurementNoise)) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addSensorFilterMeasurementNoiseX10000(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.sensorFilterMeasurementNoise * 10000)
+    );
+  }
+
+  if (zonesVector !== undefined) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addZones(firmwareConfigBuilder, zonesVector);
+  }
+
+  if (thermostatConfiguration.dehumidifyAboveDewPoint) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addDehumidifyAboveDewPointX100(
+      firmwareConfigBuilder,
+      Math.round(thermostatConfiguration.dehumidifyAboveDewPoint * 100)
+    );
+  }
+
+  if (thermostatConfiguration.lowPowerSleep) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addLowPowerSleep(firmwareConfigBuilder, true);
+  }
+
+  if (timezoneTransitionsVector !== undefined) {
+    Flatbuffers.Firmware.ThermostatConfiguration.addTimezoneTransitions(
+      firmwareConfigBuilder,
+      timezoneTransitionsVector
+    );
   }
 
   Flatbuffers.Firmware.ThermostatConfiguration.addThermostatSettings(
@@ -94,13 +508,6 @@ export function firmwareFromModel(
     firmwareConfigOffset
   );
 
-  // Extract and encode
-  const firmwareConfigBytes = firmwareConfigBuilder.asUint8Array();
-
-  const stringEncodedFirmwareConfig = Z85Encode(firmwareConfigBytes);
-
-  // c.f. //packages/firmware/thermostat/Main.cpp#handleUpdatedConfig
-  const versionMagic = "3Z85";
-
-  return versionMagic.concat(stringEncodedFirmwareConfig);
+  // Extract
+  return firmwareConfigBuilder.asUint8Array();
 }
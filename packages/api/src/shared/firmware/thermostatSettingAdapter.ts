@@ -9,7 +9,7 @@ import {
   flatbuffers,
 } from "@grumpycorp/warm-and-fuzzy-shared";
 
-import { ThermostatSetting } from "../db";
+import { ThermostatSetting, ThermostatSettings } from "../db";
 
 function thermostatSettingType(
   thermostatSetting: ThermostatSetting
@@ -54,3 +54,46 @@ export function createThermostatSetting(
     thermostatSetting.atMinutesSinceMidnight ?? 0
   );
 }
+
+// Text form of the active hold (if any) for the device's `hold` function, which applies it ahead of the full
+// configuration (that carries the same hold) so holds take effect right away; empty to clear any prior hold.
+// c.f. //packages/firmware/thermostat/inc/HoldOverride.h
+export function firmwareHoldFromModel(thermostatSettings: ThermostatSettings): string {
+  const now = Date.now();
+
+  // Earliest-expiring hold still in effect, just like the firmware's scheduler picks it
+  const activeHold = thermostatSettings.settings
+    ?.filter(
+      thermostatSetting =>
+        thermostatSetting.type === GraphQL.ThermostatSettingType.Hold &&
+        (thermostatSetting.holdUntil?.valueOf() ?? 0) >= now
+    )
+    .reduce<ThermostatSetting | undefined>(
+      (earliestHold, thermostatSetting) =>
+        earliestHold &&
+        (earliestHold.holdUntil?.valueOf() ?? 0) <= (thermostatSetting.holdUntil?.valueOf() ?? 0)
+          ? earliestHold
+          : thermostatSetting,
+      undefined
+    );
+
+  if (!activeHold) {
+    return "";
+  }
+
+  const fields = [
+    ActionsAdapter.firmwareFromModel(activeHold.allowedActions),
+    TemperatureAdapter.firmwareFromModel(activeHold.setPointHeat),
+    TemperatureAdapter.firmwareFromModel(activeHold.setPointCool),
+    // TEMPORARY: Fallbacks for backwards compatibility
+    TemperatureAdapter.firmwareFromModel(
+      activeHold.setPointCirculateAbove ?? ThermostatSettingSchema.SetPointRange.max
+    ),
+    TemperatureAdapter.firmwareFromModel(
+      activeHold.setPointCirculateBelow ?? ThermostatSettingSchema.SetPointRange.min
+    ),
+    Math.floor((activeHold.holdUntil?.valueOf() ?? 0) / 1000),
+  ];
+
+  return ["H1", ...fields].join(",");
+}
@@ -1,6 +1,7 @@
 import "source-map-support/register";
 
 import * as ThermostatConfigurationAdapter from "../../shared/firmware/thermostatConfigurationAdapter";
+import * as ThermostatSettingAdapter from "../../shared/firmware/thermostatSettingAdapter";
 
 import {
   DbMapper,
@@ -91,11 +92,31 @@ export const dynamoStream: DynamoDBStreamHandler = async (
         continue;
       }
 
+      // Deliver the active hold (if any) first: the device applies it right away
+      // whereas the full configuration below takes a while to land
+      const firmwareHold = ThermostatSettingAdapter.firmwareHoldFromModel(thermostatSettings);
+
+      try {
+        // see /firmware/thermostat/Main.cpp#setup() > Particle.function()
+        await invokeParticleFunction(particleAPIKey, "hold", deviceIdentifier.id, firmwareHold);
+      } catch (error) {
+        console.log(`Error delivering hold (see below), ignoring.`);
+        console.log(error);
+      }
+
       // Build firmware configuration
-      const firmwareConfiguration = ThermostatConfigurationAdapter.firmwareFromModel(
-        thermostatConfiguration,
-        thermostatSettings
-      );
+      let firmwareConfiguration: string;
+
+      try {
+        firmwareConfiguration = ThermostatConfigurationAdapter.firmwareFromModel(
+          thermostatConfiguration,
+          thermostatSettings
+        );
+      } catch (error) {
+        console.log(`Error building configuration for device ${deviceIdentifier.id}, skipping.`);
+        console.log(error);
+        continue;
+      }
 
       console.log(
         `Delivering updated configuration to device ${deviceIdentifier.id}: ${firmwareConfiguration}`
@@ -17,6 +17,7 @@ import {
   ThermostatValueStream,
 } from "../../../shared/db";
 import { StatusEvent, StatusEventSchema } from "./statusEvent";
+import { sensorAggregatesFromStatus, thermostatAggregatesFromStatus } from "./statusAggregates";
 
 import Responses from "../../../shared/Responses";
 import moment from "moment";
@@ -63,6 +64,18 @@ export const post: APIGatewayProxyHandler = async (event): Promise<APIGatewayPro
     return Responses.badRequest({ error: e.errors, body: parsedRequestBody });
   }
 
+  // Surface deadline overruns (c.f. firmware DeadlineMonitor.h) in the logs
+  if (statusEvent.data.ov) {
+    console.log(`Device ${statusEvent.deviceId} was reset after a deadline overrun:`);
+    console.log(statusEvent.data.ov);
+  }
+
+  if (statusEvent.data.vx) {
+    console.log(
+      `Device ${statusEvent.deviceId} omitted ${statusEvent.data.vx} measurement(s) from its status`
+    );
+  }
+
   // Locate tenant name for device
   let tenant = "";
 
@@ -115,6 +128,8 @@ export const post: APIGatewayProxyHandler = async (event): Promise<APIGatewayPro
       setPointCirculateBelow: statusEvent.data.cc.sb,
       threshold: statusEvent.data.cc.th,
       currentTimezoneUTCOffset: statusEvent.data.cc.tz,
+
+      ...thermostatAggregatesFromStatus(statusEvent.data),
     };
 
     {
@@ -160,6 +175,7 @@ export const post: APIGatewayProxyHandler = async (event): Promise<APIGatewayPro
         deviceLocalSerial,
 
         temperature: value.t,
+        ...sensorAggregatesFromStatus(value),
       };
 
       entitiesToStore.push(Object.assign(new SensorValue(), sensorData));
@@ -179,6 +195,7 @@ export const post: APIGatewayProxyHandler = async (event): Promise<APIGatewayPro
         deviceLocalSerial,
 
         temperature: value.t,
+        ...sensorAggregatesFromStatus(value),
       };
 
       entitiesToStore.push(Object.assign(new SensorValueStream(), sensorStreamData));
@@ -189,8 +206,25 @@ export const post: APIGatewayProxyHandler = async (event): Promise<APIGatewayPro
   for await (const {} of DbMapper.batchPut(entitiesToStore)) {
   }
 
-  // Return current configuration to device
-  return Responses.success(
-    ThermostatConfigurationAdapter.firmwareFromModel(thermostatConfiguration, thermostatSettings)
-  );
+  // Return current configuration to device (unless it already has it)
+  let firmwareConfigBytes: Uint8Array;
+
+  try {
+    firmwareConfigBytes = ThermostatConfigurationAdapter.firmwareBytesFromModel(
+      thermostatConfiguration,
+      thermostatSettings
+    );
+  } catch (e) {
+    // (The device keeps running off its current configuration)
+    console.log(e);
+    return Responses.internalError({ error: e.message });
+  }
+
+  if (
+    statusEvent.data.ch === ThermostatConfigurationAdapter.firmwareHashFromBytes(firmwareConfigBytes)
+  ) {
+    return Responses.success(ThermostatConfigurationAdapter.firmwareNotModified);
+  }
+
+  return Responses.success(ThermostatConfigurationAdapter.firmwareFromBytes(firmwareConfigBytes));
 };
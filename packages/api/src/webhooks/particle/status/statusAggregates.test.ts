@@ -0,0 +1,74 @@
+import { sensorAggregatesFromStatus, thermostatAggregatesFromStatus } from "./statusAggregates";
+
+import { StatusEventSchema } from "./statusEvent";
+
+function buildStatusEvent(data: object): object {
+  return {
+    event: "status",
+    deviceId: "17002c001247363333343437",
+    publishedAt: "2020-01-06T09:00:00.000Z",
+    firmwareVersion: 1,
+    data: {
+      ts: 1578301200,
+      ser: 1,
+      t: 20.5,
+      h: 41.0,
+      ca: "H",
+      cc: { sh: 20.0, sc: 25.0, sa: 18.0, sb: 26.0, th: 0.5, tz: 0, aa: "HC" },
+      v: [{ id: "2851861f0b000033", t: 19.5 }],
+      ...data,
+    },
+  };
+}
+
+describe("Status event aggregates", () => {
+  it("keeps the publish window's aggregates through validation", async () => {
+    const statusEvent = await StatusEventSchema.validate(
+      buildStatusEvent({
+        tn: 19.8,
+        tx: 20.9,
+        ta: 20.41,
+        hn: 40.2,
+        hx: 42.5,
+        ha: 41.37,
+        n: 10,
+        w: 600,
+        ao: [420, 0, 60],
+        v: [{ id: "2851861f0b000033", t: 19.5, tn: 19.1, tx: 19.9, ta: 19.52 }],
+      }),
+      { stripUnknown: true }
+    );
+
+    expect(thermostatAggregatesFromStatus(statusEvent.data)).toEqual({
+      temperatureMin: 19.8,
+      temperatureMax: 20.9,
+      temperatureMean: 20.41,
+      humidityMin: 40.2,
+      humidityMax: 42.5,
+      humidityMean: 41.37,
+      sampleCount: 10,
+      aggregationWindow: 600,
+      heatOnTime: 420,
+      coolOnTime: 0,
+      circulateOnTime: 60,
+    });
+
+    expect(sensorAggregatesFromStatus(statusEvent.data.v[0])).toEqual({
+      temperatureMin: 19.1,
+      temperatureMax: 19.9,
+      temperatureMean: 19.52,
+    });
+  });
+
+  it("leaves aggregates unset for single-sample windows", async () => {
+    const statusEvent = await StatusEventSchema.validate(buildStatusEvent({}), {
+      stripUnknown: true,
+    });
+
+    const thermostatAggregates = thermostatAggregatesFromStatus(statusEvent.data);
+
+    expect(thermostatAggregates.temperatureMin).toBeUndefined();
+    expect(thermostatAggregates.heatOnTime).toBeUndefined();
+    expect(sensorAggregatesFromStatus(statusEvent.data.v[0]).temperatureMean).toBeUndefined();
+  });
+});
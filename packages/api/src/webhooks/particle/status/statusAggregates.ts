@@ -0,0 +1,56 @@
+import { SensorValue, ThermostatValue } from "../../../shared/db";
+
+import { StatusEvent } from "./statusEvent";
+
+//
+// Aggregates the firmware reports over its publish window (c.f. firmware StatusAggregator.h),
+// which can span several measurement cadences: without them, dashboards would only see
+// each window's last reading.
+//
+
+type StatusEventData = StatusEvent["data"];
+type StatusEventMeasurement = StatusEventData["v"][number];
+
+export type ThermostatAggregates = Pick<
+  ThermostatValue,
+  | "temperatureMin"
+  | "temperatureMax"
+  | "temperatureMean"
+  | "humidityMin"
+  | "humidityMax"
+  | "humidityMean"
+  | "sampleCount"
+  | "aggregationWindow"
+  | "heatOnTime"
+  | "coolOnTime"
+  | "circulateOnTime"
+>;
+
+export type SensorAggregates = Pick<
+  SensorValue,
+  "temperatureMin" | "temperatureMax" | "temperatureMean"
+>;
+
+export function thermostatAggregatesFromStatus(data: StatusEventData): ThermostatAggregates {
+  return {
+    temperatureMin: data.tn,
+    temperatureMax: data.tx,
+    temperatureMean: data.ta,
+    humidityMin: data.hn,
+    humidityMax: data.hx,
+    humidityMean: data.ha,
+    sampleCount: data.n,
+    aggregationWindow: data.w,
+    heatOnTime: data.ao?.[0],
+    coolOnTime: data.ao?.[1],
+    circulateOnTime: data.ao?.[2],
+  };
+}
+
+export function sensorAggregatesFromStatus(measurement: StatusEventMeasurement): SensorAggregates {
+  return {
+    temperatureMin: measurement.tn,
+    temperatureMax: measurement.tx,
+    temperatureMean: measurement.ta,
+  };
+}
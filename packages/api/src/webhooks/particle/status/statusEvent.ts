@@ -36,11 +36,63 @@ export const StatusEventSchema = yup.object().shape({
       t: yup.number().required(),
       t2: yup.number().notRequired(), // temperature value from onboard sensor if external sensor override was used
       h: yup.number().required(),
+      // Aggregates over the publish window (only present if there was more than one sample)
+      tn: yup.number().notRequired(), // temperature min
+      tx: yup.number().notRequired(), // temperature max
+      ta: yup.number().notRequired(), // temperature mean
+      hn: yup.number().notRequired(), // humidity min
+      hx: yup.number().notRequired(), // humidity max
+      ha: yup.number().notRequired(), // humidity mean
+      dp: yup.number().notRequired(), // dew point from onboard sensor (absent without humidity)
+      ah: yup.number().notRequired(), // absolute humidity [g/m^3] from onboard sensor
+      fq: yup
+        .string()
+        .notRequired()
+        .matches(/^[FHSB]*$/), // sensor fusion input status, one per configured input (c.f. firmware SensorFusion.h)
       ca: yup
         .string()
         .min(0) // string needs to be present but can be empty
         .matches(/^H?C?R?$/), // firmware should upload in H-C-R order
+      // Aggregation window (c.f. firmware StatusAggregator.h)
+      n: yup
+        .number()
+        .integer()
+        .min(0)
+        .notRequired(), // sample count
+      w: yup
+        .number()
+        .integer()
+        .min(0)
+        .notRequired(), // window duration [sec]
+      ao: yup
+        .array()
+        .notRequired()
+        .of(
+          yup
+            .number()
+            .integer()
+            .min(0)
+        ), // time spent heating, cooling, and circulating within the window [sec]
+      // Zones (only present for devices with more than one zone; c.f. firmware Zone.h)
+      z: yup
+        .array()
+        .notRequired()
+        .of(
+          yup.object().shape({
+            t: yup.number().required(),
+            sh: yup.number().required(), // setPointHeat
+            sc: yup.number().required(), // setPointCool
+            ca: yup
+              .string()
+              .min(0) // string needs to be present but can be empty
+              .matches(/^H?C?R?$/), // firmware should upload in H-C-R order
+          })
+        ),
       // Configuration
+      ch: yup
+        .string()
+        .notRequired()
+        .matches(/^[0-9a-f]{8}$/), // hash of device's active configuration (c.f. firmware Configuration.h)
       cc: yup
         .object()
         .required()
@@ -59,6 +111,33 @@ export const StatusEventSchema = yup.object().shape({
             .min(0) // string needs to be present but can be empty
             .matches(/^H?C?R?$/), // firmware should upload in H-C-R order
         }),
+      // Deadline overrun that led to the device's previous reset, reported once (c.f. firmware DeadlineMonitor.h)
+      ov: yup
+        .object()
+        .notRequired()
+        .default(undefined)
+        .shape({
+          s: yup.string().required(), // stage
+          d: yup
+            .number()
+            .integer()
+            .min(0)
+            .required(), // duration [msec] (as of detection if incomplete, zero if it hung)
+          dl: yup
+            .number()
+            .integer()
+            .min(0)
+            .required(), // deadline [msec]
+          i: yup
+            .number()
+            .integer()
+            .min(0)
+            .max(1), // stage was incomplete
+          ts: yup
+            .number()
+            .integer()
+            .min(0), // detection time (UTC epoch seconds, zero if it hung)
+        }),
       // Measurements
       v: yup
         .array()
@@ -71,8 +150,16 @@ export const StatusEventSchema = yup.object().shape({
               .lowercase()
               .matches(/^([a-f0-9]{16})$/, { excludeEmptyString: true }),
             t: yup.number().required(),
+            tn: yup.number().notRequired(), // min, max, and mean over the publish window (as above)
+            tx: yup.number().notRequired(),
+            ta: yup.number().notRequired(),
           })
         ),
+      vx: yup
+        .number()
+        .integer()
+        .min(0)
+        .notRequired(), // measurements omitted to fit Particle's event size limit (c.f. firmware StatusPublisher.h)
     }),
 });
 
@@ -0,0 +1,139 @@
+const { Command, flags } = require("@oclif/command");
+const { execSync } = require("child_process");
+const fs = require("fs");
+const glob = require("glob");
+const path = require("path");
+
+class BenchCommand extends Command {
+  async run() {
+    // Check parameters
+    const { flags } = this.parse(BenchCommand);
+
+    if (!flags.project) {
+      this.error("No project directory specified (-p). Exiting.");
+      return;
+    }
+
+    // Set up paths
+    const packageRoot = process.cwd();
+    const projectRoot = path.join(packageRoot, flags.project);
+    const testsRoot = path.join(projectRoot, "tests");
+    const benchRoot = path.join(testsRoot, "bench");
+
+    const outputRoot = path.join(testsRoot, "generated");
+
+    if (!fs.existsSync(outputRoot)) {
+      fs.mkdirSync(outputRoot);
+    }
+
+    // Identify what we're measuring so results can be compared across commits
+    const commit = this.getCommit(projectRoot);
+
+    const resultsFile = flags.output
+      ? path.resolve(flags.output)
+      : path.join(outputRoot, `bench-${commit}.json`);
+
+    // Build (always optimized, with the same flags, so results are comparable)
+    this.log(`Building benchmarks...`);
+
+    const sourceFiles = glob.sync(`${benchRoot}/*.cpp`);
+    const benchExecutable = path.join(outputRoot, "bench");
+
+    execSync(
+      `g++ -O2 -DNDEBUG -I${projectRoot} -I${testsRoot} -I${benchRoot} ${sourceFiles.join(
+        " "
+      )} -lstdc++ -lm -lpthread -o ${benchExecutable}`,
+      {
+        cwd: benchRoot,
+        stdio: "inherit",
+      }
+    );
+
+    // Run
+    this.log(`Running benchmarks...`);
+
+    const benchArguments = [
+      `--json ${resultsFile}`,
+      `--commit ${commit}`,
+      flags.samples ? `--samples ${flags.samples}` : "",
+      flags.filter ? `"${flags.filter}"` : "",
+    ];
+
+    execSync(`${benchExecutable} ${benchArguments.join(" ")}`, {
+      cwd: benchRoot,
+      stdio: "inherit",
+    });
+
+    // Compare
+    if (flags.baseline) {
+      const baselineResults = JSON.parse(fs.readFileSync(flags.baseline));
+      const currentResults = JSON.parse(fs.readFileSync(resultsFile));
+
+      this.compareResults(baselineResults, currentResults);
+    }
+  }
+
+  getCommit(projectRoot) {
+    try {
+      const git = command =>
+        execSync(`git ${command}`, { cwd: projectRoot })
+          .toString()
+          .trim();
+
+      const commit = git("rev-parse --short HEAD");
+      const isDirty = git("status --porcelain --untracked-files=no .").length > 0;
+
+      return isDirty ? `${commit}-dirty` : commit;
+    } catch (error) {
+      return "unknown";
+    }
+  }
+
+  compareResults(baseline, current) {
+    this.log(`\nComparing ${current.commit} against baseline ${baseline.commit} (median ns/iter):`);
+
+    if (baseline.compiler !== current.compiler) {
+      this.warn(
+        `Compiler differs (${baseline.compiler} vs. ${current.compiler}), results may not be comparable.`
+      );
+    }
+
+    current.benchmarks.forEach(benchmark => {
+      const baselineBenchmark = baseline.benchmarks.find(
+        baselineBenchmark => baselineBenchmark.name === benchmark.name
+      );
+
+      if (!baselineBenchmark) {
+        this.log(`  ${benchmark.name}: ${benchmark.median_ns.toFixed(1)} (new)`);
+        return;
+      }
+
+      const baselineMedian = baselineBenchmark.median_ns.toFixed(1);
+      const currentMedian = benchmark.median_ns.toFixed(1);
+
+      const change = (benchmark.median_ns / baselineBenchmark.median_ns - 1) * 100;
+      const changeSign = change >= 0 ? "+" : "";
+
+      this.log(
+        `  ${benchmark.name}: ${baselineMedian} -> ${currentMedian} (${changeSign}${change.toFixed(1)}%)`
+      );
+    });
+  }
+}
+
+BenchCommand.description = `Benchmark firmware project's host-compilable components
+...
+Provide name of project directory with -p.
+Results are written as JSON to tests/generated/bench-<commit>.json unless overridden with -o;
+compare against a previous run's results with -b.
+`;
+
+BenchCommand.flags = {
+  project: flags.string({ char: "p", description: "Project to benchmark" }),
+  output: flags.string({ char: "o", description: "JSON results file" }),
+  baseline: flags.string({ char: "b", description: "JSON results file to compare against" }),
+  samples: flags.integer({ char: "n", description: "Samples per benchmark" }),
+  filter: flags.string({ char: "f", description: "Benchmarks to run (Catch test spec)" }),
+};
+
+module.exports = BenchCommand;
@@ -0,0 +1,90 @@
+const { Command, flags } = require("@oclif/command");
+const { execSync } = require("child_process");
+const fs = require("fs");
+const glob = require("glob");
+const path = require("path");
+
+class FuzzCommand extends Command {
+  async run() {
+    // Check parameters
+    const { flags } = this.parse(FuzzCommand);
+
+    if (!flags.project) {
+      this.error("No project directory specified (-p). Exiting.");
+      return;
+    }
+
+    // Set up paths
+    const packageRoot = process.cwd();
+    const projectRoot = path.join(packageRoot, flags.project);
+    const testsRoot = path.join(projectRoot, "tests");
+    const fuzzRoot = path.join(testsRoot, "fuzz");
+
+    const outputRoot = path.join(testsRoot, "generated");
+    const corpusRoot = path.join(outputRoot, "fuzz-corpus");
+
+    [outputRoot, corpusRoot].forEach(directory => {
+      if (!fs.existsSync(directory)) {
+        fs.mkdirSync(directory);
+      }
+    });
+
+    // Build (libFuzzer requires clang; --replay builds a plain corpus replay driver instead)
+    this.log(`Building fuzzer...`);
+
+    const sourceFiles = glob.sync(`${fuzzRoot}/*.cpp`);
+    const fuzzExecutable = path.join(outputRoot, "fuzz");
+
+    const compiler = flags.replay
+      ? "g++ -DFUZZ_REPLAY_MAIN -fsanitize=address,undefined"
+      : "clang++ -fsanitize=fuzzer,address,undefined";
+
+    execSync(
+      `${compiler} -g -O1 -I${projectRoot} -I${testsRoot} ${sourceFiles.join(
+        " "
+      )} -lstdc++ -lm -o ${fuzzExecutable}`,
+      {
+        cwd: fuzzRoot,
+        stdio: "inherit",
+      }
+    );
+
+    // Run
+    if (flags.replay) {
+      const corpusFiles = glob.sync(`${corpusRoot}/*`);
+
+      this.log(`Replaying ${corpusFiles.length} inputs...`);
+
+      if (corpusFiles.length > 0) {
+        execSync(`${fuzzExecutable} ${corpusFiles.join(" ")}`, {
+          cwd: fuzzRoot,
+          stdio: "inherit",
+        });
+      }
+
+      return;
+    }
+
+    this.log(`Fuzzing for ${flags.time} seconds...`);
+
+    execSync(`${fuzzExecutable} -max_total_time=${flags.time} ${corpusRoot}`, {
+      cwd: fuzzRoot,
+      stdio: "inherit",
+    });
+  }
+}
+
+FuzzCommand.description = `Fuzz firmware project's configuration ingestion
+...
+Provide name of project directory with -p.
+Requires clang (libFuzzer); the corpus is kept in tests/generated/fuzz-corpus.
+Use --replay to re-run the corpus without libFuzzer (e.g. with g++ only).
+`;
+
+FuzzCommand.flags = {
+  project: flags.string({ char: "p", description: "Project to fuzz" }),
+  time: flags.integer({ char: "t", description: "Seconds to fuzz for", default: 60 }),
+  replay: flags.boolean({ description: "Replay corpus instead of fuzzing" }),
+};
+
+module.exports = FuzzCommand;
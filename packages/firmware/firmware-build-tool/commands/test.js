@@ -34,7 +34,7 @@ class TestCommand extends Command {
     execSync(
       `g++ -I${projectRoot} -I${testsRoot} ${sourceFiles.join(
         " "
-      )} -lstdc++ -lm -o ${testExecutable}`,
+      )} -lstdc++ -lm -lpthread -o ${testExecutable}`,
       {
         cwd: testsRoot,
         stdio: "inherit",
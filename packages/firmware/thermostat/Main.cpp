@@ -2,8 +2,6 @@
 
 #include "inc/stdinc.h"
 
-#include "PietteTech_DHT.h"
-
 //
 // Particle configuration
 //
@@ -11,6 +9,8 @@
 PRODUCT_ID(8773);
 PRODUCT_VERSION(18);  // Increment for each release
 
+STARTUP(System.enableFeature(FEATURE_RETAINED_MEMORY));  // c.f. g_RetainedState, g_DeadlineRecord
+
 
 //
 // Globals
@@ -21,10 +21,13 @@ PRODUCT_VERSION(18);  // Increment for each release
 // Connect pin 4 (on the right) of the sensor to GROUND
 // Connect a 10K resistor from pin 2 (data) to pin 1 (power) of the sensor
 
+// (Pins used here are off limits to zones' relays, c.f. Configuration::IsReservedPin())
 pin_t constexpr c_dht22Pin = D2;
 pin_t constexpr c_LedPin = D7;
+pin_t constexpr c_WakeUpPin = D6;  // Unused: pulled down while asleep, so sleep only ends on time (c.f. LowPowerSleep)
 
 PietteTech_DHT g_OnboardSensor(c_dht22Pin, DHT22);
+OnboardSensorReader<PietteTech_DHT> g_OnboardSensorReader(g_OnboardSensor);
 
 //
 uint8_t constexpr c_cOneWireDevices_Max = 16;
@@ -32,21 +35,85 @@ OneWireGateway2484 g_OneWireGateway;
 
 // Configuration
 Configuration g_Configuration;
+HoldOverride g_HoldOverride;  // Local hold ahead of the configuration's settings, c.f. onHold()
+
+// Control state carried across resets
+retained RetainedState g_RetainedState;
+
+// Stage deadlines (generous: the first overrun stops the watchdog from being kicked, c.f. DeadlineMonitor)
+DeadlineMonitor g_DeadlineMonitor;
+retained DeadlineMonitor::RetainedRecord g_DeadlineRecord;  // First overrun, carried across the watchdog's reset
+
+struct StageDeadline
+{
+    DeadlineMonitor::Stage Stage;
+    unsigned long Deadline_msec;
+};
+
+StageDeadline constexpr c_rgStageDeadlines[] = {
+    {DeadlineMonitor::Stage::Ingest, 2 * 1000},
+    {DeadlineMonitor::Stage::Acquire, 10 * 1000},  // Enumeration, conversion (up to 750 msec), and readout
+    {DeadlineMonitor::Stage::Process, 500},
+    {DeadlineMonitor::Stage::Control, 1000},
+    {DeadlineMonitor::Stage::Publish, 25 * 1000},  // Publishes WITH_ACK (including any backlog, c.f. QueuedPublisher)
+    {DeadlineMonitor::Stage::Maintenance, 3 * 1000},
+};
+
+// (The watchdog isn't kicked within a stage, so it has to outlast the longest deadline)
+unsigned long constexpr c_WatchdogTimeout_msec = 30 * 1000;
+
+// Low-power sleep in between tasks (opt-in for battery-powered devices, c.f. ThermostatConfiguration::lowPowerSleep)
+// (The watchdog keeps counting in stop mode, so sleep ends well before it would reset the device)
+LowPowerSleep g_LowPowerSleep(c_WakeUpPin);
+unsigned long constexpr c_MaximumSleep_msec = c_WatchdogTimeout_msec - 5 * 1000;
 
 // Services
-ThermostatSetpointScheduler g_ThermostatSetpointScheduler;
-Thermostat g_Thermostat;
+LoopScheduler g_LoopScheduler;
+MaintenanceScheduler g_MaintenanceScheduler;
+Zone g_rgZones[Zone::sc_cZones_Max];
+size_t g_cZones = 0;
+
+// Sensor processing
+SensorRegistry<c_cOneWireDevices_Max> g_SensorRegistry;
+SensorFilterBank<c_cOneWireDevices_Max> g_SensorFilterBank;
+SensorFusion<c_cOneWireDevices_Max> g_SensorFusion;
+
+// Acquisition (all sensor I/O runs on the acquisition thread once setup() has made its first control decision)
+struct AcquisitionRequest
+{
+    unsigned long MaximumOnboardAge_msec;  // Oldest onboard reading to fall back on
+};
+
+typedef SensorSnapshot<c_cOneWireDevices_Max> Readings;
+
+AcquisitionChannel<AcquisitionRequest, Readings> g_AcquisitionChannel;
+Thread* g_pAcquisitionThread = nullptr;
+
+unsigned long constexpr c_AcquisitionPollingInterval_msec = 50;  // Latency of picking up requests
+
+// Readings from the latest acquisition, retained so zones can re-evaluate control in between acquisitions
+Readings g_LatestReadings;
 
 // Publishers
+StatusAggregator<c_cOneWireDevices_Max> g_StatusAggregator;
 StatusPublisher<c_cOneWireDevices_Max> g_StatusPublisher;
 
 //
 // Declarations
 //
 
-void applyTimezoneConfiguration();
+void startWatchdog();
+void serviceWatchdog();
+bool runMaintenance(unsigned long const timeUntilNextTask_msec);
+void acquisitionThread(void* pParam);
+void acquireReadings(AcquisitionRequest const& request, Readings& readings);
+void processReadings(Readings& readings);
+AcquisitionRequest getAcquisitionRequest();
+void controlZones(Readings const& readings, unsigned long const currentTime_msec);
+void applyZoneConfiguration();
 void onStatusResponse(char const* szEvent, char const* szData);
 int onConfigPush(String configString);
+int onHold(String holdString);
 
 //
 // Setup
@@ -61,20 +128,23 @@ void setup()
 {
     // Configure debugging output
     Serial.begin();
-    Serial.println("Thermostat started.");
+    WAF_LOG_INFO("Thermostat started.");
 
-    {
-        Activity testActivity("StartupTestDelay");
-        delay(10 * 1000);
-    }
+    //
+    // Fast boot: get the relays going before anything that can wait (e.g. connecting to the cloud)
+    //
 
-    // Set up configuration
-    g_Configuration.Initialize();
+    // Set up configuration (skipping verification if we've verified it before the reset)
+    bool const fHasRetainedState = g_RetainedState.IsValid();
+    g_Configuration.Initialize(fHasRetainedState ? g_RetainedState.ConfigurationHash : 0);
 
-    Serial.print("Current configuration: ");
-    g_Configuration.PrintConfiguration();
+    // Pick up any deadline overrun that led to this reset (published with the first status)
+    for (StageDeadline const& stageDeadline : c_rgStageDeadlines)
+    {
+        g_DeadlineMonitor.SetDeadline(stageDeadline.Stage, stageDeadline.Deadline_msec);
+    }
 
-    applyTimezoneConfiguration();
+    g_DeadlineMonitor.Initialize(&g_DeadlineRecord);
 
     // Configure I/O
     g_OnboardSensor.begin();
@@ -83,18 +153,95 @@ void setup()
     pinMode(c_LedPin, OUTPUT);
 
     // Configure services
-    g_Thermostat.Initialize();
+    applyZoneConfiguration();
+
+    // Resume relays as they were before the reset, provided they were driven off the same configuration
+    bool const fResumedControlState =
+        fHasRetainedState && (g_RetainedState.ConfigurationHash == g_Configuration.Hash());
+
+    if (fResumedControlState)
+    {
+        size_t const cZones = std::min(g_cZones, static_cast<size_t>(g_RetainedState.cZones));
+
+        for (size_t idxZone = 0; idxZone < cZones; ++idxZone)
+        {
+            g_rgZones[idxZone].Resume(
+                g_Configuration, static_cast<ThermostatAction>(g_RetainedState.rgZoneActions[idxZone]), millis());
+        }
+    }
+
+    unsigned long const resumedTime_msec = millis();
+
+    // Make a first control decision off the sensors as soon as they can be read
+    {
+        Activity firstControlActivity("FirstControl");
+
+        unsigned long const currentTime_msec = millis();
+        unsigned long const powerUpDelay_msec = OnboardSensorReader<PietteTech_DHT>::sc_PowerUpDelay_msec;
+
+        if (currentTime_msec < powerUpDelay_msec)
+        {
+            delay(powerUpDelay_msec - currentTime_msec);
+        }
+
+        // (Acquired right here since the acquisition thread isn't running yet)
+        acquireReadings(getAcquisitionRequest(), g_LatestReadings);
+        processReadings(g_LatestReadings);
+
+        controlZones(g_LatestReadings, millis());
+    }
+
+    // Hand sensor I/O off to its own thread from here on
+    g_pAcquisitionThread = new Thread("Acquisition", acquisitionThread);
+
+    // Report time since boot (millis() starts at boot)
+    if (fResumedControlState)
+    {
+        WAF_LOG_INFO("Fast boot: resumed relays after %lu msec, first control decision after %lu msec.",
+                     resumedTime_msec,
+                     millis());
+    }
+    else
+    {
+        WAF_LOG_INFO("Fast boot: no control state to resume, first control decision after %lu msec.", millis());
+    }
+
+    if (!Time.isValid())
+    {
+        WAF_LOG_INFO("Time not yet known, heating to lowest heat setpoints until synchronized with the cloud.");
+    }
+
+    //
+    // Everything else
+    //
+
+    WAF_LOG_INFO("Current configuration:");
+    g_Configuration.PrintConfiguration();
+    DeferredLog::Instance().Drain();
+
+    if (DeadlineMonitor::Overrun const* const pPreviousOverrun = g_DeadlineMonitor.PreviousOverrun())
+    {
+        WAF_LOG_WARNING("!! Reset after %s overran its deadline (%lu msec%s, deadline: %lu msec).",
+                        DeadlineMonitor::GetStageName(pPreviousOverrun->Stage),
+                        static_cast<unsigned long>(pPreviousOverrun->Duration_msec),
+                        pPreviousOverrun->fIsIncomplete ? " or more" : "",
+                        static_cast<unsigned long>(pPreviousOverrun->Deadline_msec));
+    }
 
     // Configure cloud interactions
     // (async since we're not yet connected to the cloud, courtesy of SYSTEM_MODE = SEMI_AUTOMATIC)
     Particle.subscribe(System.deviceID() + "/hook-response/status", onStatusResponse, MY_DEVICES);
     Particle.function("configPush", onConfigPush);
+    Particle.function("hold", onHold);
 
     // Request connection to cloud (not blocking)
     {
         Activity connectActivity("Connect");
         Particle.connect();
     }
+
+    // Stages are monitored from here on
+    startWatchdog();
 }
 
 
@@ -104,174 +251,192 @@ void setup()
 
 void loop()
 {
-    //
-    // Set up loop time tracking
-    //
-
-    static unsigned long s_LastLoopEnterTime_msec = 0;
-
     unsigned long const loopStartTime_msec = millis();
 
-    if (s_LastLoopEnterTime_msec != 0)
-    {
-        unsigned long const timeSinceLastLoopStart_msec = loopStartTime_msec - s_LastLoopEnterTime_msec;
-        Serial.printlnf("-- Time since last loop start: %lu msec", timeSinceLastLoopStart_msec);
-    }
-
-    s_LastLoopEnterTime_msec = loopStartTime_msec;
+    serviceWatchdog();
 
     //
-    // Ingest any configuration updates submitted by events
+    // Ingest any hold and configuration updates submitted by events
+    // (in the order the cloud sends them, c.f. //packages/api/src/streams/thermostatConfigurationAndSettings)
     //
 
-    {
-        bool const fUpdatedConfiguration = g_Configuration.AcceptPendingUpdates();
+    g_DeadlineMonitor.Begin(DeadlineMonitor::Stage::Ingest, loopStartTime_msec);
 
-        if (fUpdatedConfiguration)
+    bool const fUpdatedHold = g_HoldOverride.AcceptPendingUpdates();
+
+    if (fUpdatedHold)
+    {
+        if (g_HoldOverride.IsActive(Time.now()))
+        {
+            WAF_LOG_INFO("Accepted local hold until %lu.", static_cast<unsigned long>(g_HoldOverride.HoldUntil()));
+        }
+        else
         {
-            Serial.print("Accepted updated configuration: ");
-            g_Configuration.PrintConfiguration();
+            WAF_LOG_INFO("Cleared local hold.");
         }
     }
 
-    applyTimezoneConfiguration();  // Apply whether configuration has changed or not (e.g. we may have changed DST)
+    bool const fUpdatedConfiguration = g_Configuration.AcceptPendingUpdates();
 
+    if (fUpdatedConfiguration)
     {
-        char const* rgDaysOfWeek[] = {"n/a", "Sun", "Mon", "Tues", "Wednes", "Thurs", "Fri", "Satur"};
+        WAF_LOG_INFO("Accepted updated configuration:");
+        g_Configuration.PrintConfiguration();
+
+        // The configuration carries any hold the cloud knows about
+        g_HoldOverride.Clear();
 
-        uint32_t const timeNow = Time.now();
-        int const idxDayOfWeek = Time.weekday(timeNow);
+        applyZoneConfiguration();
 
-        Serial.printlnf("-- It is currently %02d:%02d on a %sday (%u Unix time)",
-                        Time.hour(timeNow),
-                        Time.minute(timeNow),
-                        idxDayOfWeek < countof(rgDaysOfWeek) ? rgDaysOfWeek[idxDayOfWeek] : "<unexpected>",
-                        timeNow);
+        // (Configuration updates are rare; write out their dump before it crowds out the loop's records)
+        DeferredLog::Instance().Drain();
     }
 
+    g_DeadlineMonitor.End(DeadlineMonitor::Stage::Ingest, millis());
+
     //
-    // Acquire data
+    // Determine due tasks
     //
 
-    float onboardTemperature = NAN;
-    float onboardHumidity = NAN;
+    unsigned long const acquisitionInterval_msec = g_Configuration.rootConfiguration().cadence() * 1000UL;
 
-    OneWireAddress rgAddresses[c_cOneWireDevices_Max];
-    size_t cAddressesFound = 0;
+    LoopScheduler::DueTasks const dueTasks = g_LoopScheduler.GetDueTasks(
+        loopStartTime_msec, acquisitionInterval_msec, fUpdatedConfiguration || fUpdatedHold);
 
-    float rgExternalTemperatures[c_cOneWireDevices_Max] = {NAN};
+    //
+    // Acquire data (requesting it from the acquisition thread; readings come in on a later pass)
+    //
 
+    if (dueTasks.fAcquire)
     {
-        Activity acquireDataActivity("AcquireData");
+#if WAF_LOG_LEVEL <= WAF_LOG_LEVEL_TRACE
+        // (Trace-only; compiled out along with the trace records themselves at higher log levels)
+        static unsigned long s_LastAcquisitionTime_msec = 0;
 
-        // Onboard devices
-        int const sensorStatus = g_OnboardSensor.acquireAndWait(5000);  // 5 sec timeout should suffice
-
-        if (sensorStatus == DHTLIB_OK)
+        if (s_LastAcquisitionTime_msec != 0)
         {
-            onboardTemperature = g_OnboardSensor.getCelsius();
-            onboardHumidity = g_OnboardSensor.getHumidity();
+            unsigned long const timeSinceLastAcquisition_msec = loopStartTime_msec - s_LastAcquisitionTime_msec;
+            WAF_LOG_TRACE("-- Time since last acquisition: %lu msec", timeSinceLastAcquisition_msec);
         }
-        else
+
+        s_LastAcquisitionTime_msec = loopStartTime_msec;
+
         {
-            Serial.printlnf("Error '%d' acquiring DHT22 data. Skipping internal sensor.\n", sensorStatus);
-        }
+            char const* rgDaysOfWeek[] = {"Sun", "Mon", "Tues", "Wednes", "Thurs", "Fri", "Satur"};
 
-        // Enumerate external devices
-        g_OneWireGateway.EnumerateDevices([&](OneWireAddress const& Address) {
-            if (cAddressesFound < countof(rgAddresses))
-            {
-                if (Address.GetDeviceFamily() == 0x28)  // Ensure device is a DS18B20 sensor
-                {
-                    rgAddresses[cAddressesFound] = Address;
-                    ++cAddressesFound;
-                }
-            }
-        });
+            uint32_t const timeNow = Time.now();
+            uint16_t const minutesSinceStartOfWeek = LocalTime::GetMinutesSinceStartOfWeek(g_Configuration, timeNow);
+            uint16_t const minutesSinceMidnight = minutesSinceStartOfWeek % LocalTime::sc_MinutesPerDay;
 
-        // Request temperature measurement from all sensors
-        if (OneWireTemperatureSensor::RequestMeasurement(g_OneWireGateway))
+            WAF_LOG_TRACE("-- It is currently %02u:%02u on a %sday (%u Unix time)",
+                          minutesSinceMidnight / 60,
+                          minutesSinceMidnight % 60,
+                          rgDaysOfWeek[minutesSinceStartOfWeek / LocalTime::sc_MinutesPerDay],
+                          timeNow);
+        }
+#endif
+
+        if (!g_AcquisitionChannel.Request(getAcquisitionRequest()))
         {
-            // Retrieve measurements
-            for (size_t idxAddress = 0; idxAddress < cAddressesFound; ++idxAddress)
-            {
-                OneWireTemperatureSensor::RetrieveMeasurement(
-                    rgExternalTemperatures[idxAddress], rgAddresses[idxAddress], g_OneWireGateway);
-            }
+            WAF_LOG_WARNING("!! Warning: acquisition thread is falling behind, skipping acquisition.");
+        }
+        else if (!g_DeadlineMonitor.IsInProgress(DeadlineMonitor::Stage::Acquire))
+        {
+            g_DeadlineMonitor.Begin(DeadlineMonitor::Stage::Acquire, loopStartTime_msec);
         }
     }
 
-    // Override onboard temperature if requested and available
-    OneWireAddress const externalSensorId(g_Configuration.rootConfiguration().externalSensorId());
-    float operableTemperature = onboardTemperature;
-    bool fUsedExternalSensor = false;
+    bool const fReceivedReadings = g_AcquisitionChannel.Receive(g_LatestReadings);
 
-    if (!externalSensorId.IsEmpty())
+    if (fReceivedReadings)
     {
-        for (size_t idxAddress = 0; idxAddress < cAddressesFound; ++idxAddress)
-        {
-            // Find sensor by address
-            if (rgAddresses[idxAddress] != externalSensorId)
-            {
-                continue;
-            }
+        unsigned long const receivedTime_msec = millis();
 
-            // Make sure it has a reported value
-            if (std::isnan(rgExternalTemperatures[idxAddress]))
-            {
-                continue;
-            }
+        g_DeadlineMonitor.End(DeadlineMonitor::Stage::Acquire, receivedTime_msec);
 
-            // Apply override
-            operableTemperature = rgExternalTemperatures[idxAddress];
-            fUsedExternalSensor = true;
-
-            // Punch out sensor from reported sensors list (no point in double-reporting)
-            rgExternalTemperatures[idxAddress] = nan("");
-        }
-
-        if (!fUsedExternalSensor)
+        if (g_AcquisitionChannel.IsAcquiring())
         {
-            Serial.println("!! Warning: couldn't locate requested external sensor.");
+            // Next outstanding request is picked up right away
+            g_DeadlineMonitor.Begin(DeadlineMonitor::Stage::Acquire, receivedTime_msec);
         }
+
+        DeadlineMonitor::Scope processScope(g_DeadlineMonitor, DeadlineMonitor::Stage::Process);
+        processReadings(g_LatestReadings);
     }
 
     //
     // Apply data
     //
 
-    ThermostatSetpoint const thermostatSetpoint =
-        g_ThermostatSetpointScheduler.getCurrentThermostatSetpoint(g_Configuration);
-    g_Thermostat.Apply(g_Configuration, thermostatSetpoint, operableTemperature);
+    if (fReceivedReadings || dueTasks.fControl)
+    {
+        DeadlineMonitor::Scope controlScope(g_DeadlineMonitor, DeadlineMonitor::Stage::Control);
+        controlZones(g_LatestReadings, loopStartTime_msec);
+    }
+
+    // The first zone is reported as the device's primary status
+    Zone const& primaryZone = g_rgZones[0];
 
     //
-    // Publish data
+    // Aggregate data
     //
 
+    if (fReceivedReadings)
+    {
+        g_StatusAggregator.AddSample(
+            loopStartTime_msec, primaryZone.CurrentActions(), g_LatestReadings, g_SensorRegistry);
+    }
+    else if (dueTasks.fControl)
     {
-        Activity publishActivity("PublishStatus");
-        g_StatusPublisher.Publish(g_Configuration,
-                                  thermostatSetpoint,
-                                  g_Thermostat.CurrentActions(),
-                                  fUsedExternalSensor,
-                                  operableTemperature,
-                                  onboardTemperature,
-                                  onboardHumidity,
-                                  rgAddresses,
-                                  cAddressesFound,
-                                  rgExternalTemperatures);
+        // Account for actions changed in between acquisitions without adding measurement samples
+        g_StatusAggregator.AddActions(loopStartTime_msec, primaryZone.CurrentActions());
     }
 
     //
-    // Perform deferred maintainance
+    // Publish data
     //
 
+    if (fReceivedReadings)
     {
-        EEPROM.performPendingErase();
+        static bool s_fHasPublished = false;
+        static unsigned long s_LastPublishTime_msec = 0;
+
+        // publishCadence of zero means "publish every acquisition"
+        uint16_t const publishCadence = g_Configuration.rootConfiguration().publishCadence();
+        unsigned long const publishCadence_msec =
+            (publishCadence ? publishCadence : g_Configuration.rootConfiguration().cadence()) * 1000UL;
+
+        // (Carefully phrased to deal with rollovers)
+        bool const fIsPublishDue =
+            !s_fHasPublished || ((loopStartTime_msec - s_LastPublishTime_msec) >= publishCadence_msec);
+
+        if (fIsPublishDue)
+        {
+            // (Gets a full watchdog timeout to itself)
+            serviceWatchdog();
+
+            Activity publishActivity("PublishStatus");
+            DeadlineMonitor::Scope publishScope(g_DeadlineMonitor, DeadlineMonitor::Stage::Publish);
+
+            g_StatusPublisher.Publish(g_Configuration,
+                                      primaryZone.CurrentSetpoint(),
+                                      primaryZone.CurrentActions(),
+                                      g_StatusAggregator,
+                                      g_SensorFusion,
+                                      g_rgZones,
+                                      g_cZones,
+                                      g_DeadlineMonitor.PreviousOverrun());
+
+            g_StatusAggregator.Reset();
+            g_DeadlineMonitor.ClearPreviousOverrun();
+
+            s_fHasPublished = true;
+            s_LastPublishTime_msec = loopStartTime_msec;
+        }
     }
 
     //
-    // Delay until next iteration
+    // Delay until next task is due (performing deferred maintenance while idle)
     //
 
     {
@@ -279,26 +444,46 @@ void loop()
 
         while (true)
         {
-            // (Carefully phrased to deal with rollovers)
-            unsigned long const currentTime_msec = millis();
-            unsigned long const timeSinceLastLoopStart_msec = currentTime_msec - loopStartTime_msec;
+            serviceWatchdog();
 
-            unsigned long const loopDesiredCadence_msec = g_Configuration.rootConfiguration().cadence() * 1000;
+            unsigned long const remainingTotalDelay_msec =
+                g_LoopScheduler.TimeUntilNextTask_msec(millis(), acquisitionInterval_msec);
 
-            if (timeSinceLastLoopStart_msec > loopDesiredCadence_msec)
+            if (remainingTotalDelay_msec == 0)
             {
                 // No further delay required
                 break;
             }
 
-            if (g_Configuration.HasPendingUpdates())
+            if (g_Configuration.HasPendingUpdates() || g_HoldOverride.HasPendingUpdates() ||
+                g_AcquisitionChannel.HasReadings())
             {
-                // Skip remaining delay so we can act on the latest configuration changes right away
+                // Skip remaining delay so we can act on the latest changes right away
                 break;
             }
 
-            unsigned long const remainingTotalDelay_msec = loopDesiredCadence_msec - timeSinceLastLoopStart_msec;
-            unsigned long const maxPollingDelay_msec = 2 * 1000;  // maximum time between config update checks
+            // Erase flash and write out configurations only if it'll be done well before the next task is due
+            // (and never while sensor I/O may be underway: erases stall the CPU, clobbering sensor timing)
+            if (!g_AcquisitionChannel.IsAcquiring() && runMaintenance(remainingTotalDelay_msec))
+            {
+                // (Re-evaluate remaining delay)
+                continue;
+            }
+
+            // Write out deferred logs while idle (formatting and serial output stay off the control path)
+            DeferredLog::Instance().Drain();
+
+            // Sleep through the rest of the delay on battery-powered devices (relays hold their state in stop mode;
+            // sensor I/O doesn't survive it, so only sleep once any acquisition is done)
+            if (g_Configuration.rootConfiguration().lowPowerSleep() && !g_AcquisitionChannel.IsAcquiring() &&
+                g_LowPowerSleep.Sleep(remainingTotalDelay_msec, c_MaximumSleep_msec, Particle.connected()))
+            {
+                // (Re-evaluate remaining delay)
+                continue;
+            }
+
+            // Maximum time between update checks (bounds the latency of holds and readings in particular)
+            unsigned long const maxPollingDelay_msec = 250;
 
             delay(std::min(remainingTotalDelay_msec, maxPollingDelay_msec));
         }
@@ -310,6 +495,10 @@ void loop()
 // Subscriptions
 //
 
+// Status response in lieu of a configuration that matches the active one, including quotes
+// (c.f. //packages/api/src/shared/firmware/thermostatConfigurationAdapter.ts#firmwareNotModified)
+char constexpr c_szConfigurationNotModified[] = "\"304\"";
+
 Configuration::ConfigUpdateResult handleUpdatedConfig(char const* const szData,
                                                       bool const fTrimQuotes,
                                                       char const* const szSource)
@@ -332,19 +521,19 @@ Configuration::ConfigUpdateResult handleUpdatedConfig(char const* const szData,
 
     if (cchData < cchData_Min)
     {
-        Serial.printlnf("-- Configuration invalid: too short: \"%s\"", szData);
+        WAF_LOG_WARNING("-- Configuration invalid: too short: \"%s\"", szData);
         return Configuration::ConfigUpdateResult::Invalid;
     }
 
     if (cchData > static_cast<uint16_t>(-1))
     {
-        Serial.println("-- Configuration invalid: too long");
+        WAF_LOG_WARNING("-- Configuration invalid: too long");
         return Configuration::ConfigUpdateResult::Invalid;
     }
 
     if (strncmp(szData + cchQuote, rgMagic, cchMagic) != 0)
     {
-        Serial.printlnf("-- Configuration invalid: wrong magic: \"%s\"", szData);
+        WAF_LOG_WARNING("-- Configuration invalid: wrong magic: \"%s\"", szData);
         return Configuration::ConfigUpdateResult::Invalid;
     }
 
@@ -359,16 +548,18 @@ Configuration::ConfigUpdateResult handleUpdatedConfig(char const* const szData,
     switch (configUpdateResult)
     {
         case Configuration::ConfigUpdateResult::Invalid:
-            Serial.printlnf(
-                "!! Configuration from %s \"%.*s\" invalid, ignoring.", szSource, cchConfigData, rgConfigData);
+            // (The encoded data itself is too long to be worth logging, c.f. DeferredLog::sc_cchStringArgument_Max)
+            WAF_LOG_WARNING("!! Configuration from %s invalid (%u chars of encoded data), ignoring.",
+                            szSource,
+                            static_cast<unsigned int>(cchConfigData));
             break;
 
         case Configuration::ConfigUpdateResult::Retained:
-            Serial.printlnf("Retained existing configuration after %s.", szSource);
+            WAF_LOG_INFO("Retained existing configuration after %s.", szSource);
             break;
 
         case Configuration::ConfigUpdateResult::Accepted:
-            Serial.printlnf("Updating existing configuration from %s.", szSource);
+            WAF_LOG_INFO("Updating existing configuration from %s.", szSource);
             break;
     }
 
@@ -381,7 +572,14 @@ void onStatusResponse(char const* szEvent, char const* szData)
 
     if (strstr(szEvent, "/hook-response/status/0") == nullptr)  // [deviceID]/hook-response/status/0
     {
-        Serial.printlnf("Unexpected event %s with data %s", szEvent, szData);
+        WAF_LOG_WARNING("Unexpected event %s with data %s", szEvent, szData);
+        return;
+    }
+
+    // The cloud abbreviates its response if our configuration's hash matches its own (c.f. Configuration::Hash())
+    if (strcmp(szData, c_szConfigurationNotModified) == 0)
+    {
+        WAF_LOG_TRACE("Retained existing configuration after statusResponse (not modified).");
         return;
     }
 
@@ -394,30 +592,235 @@ int onConfigPush(String configString)
     return static_cast<int>(handleUpdatedConfig(configString.c_str(), false /* no quotes */, "push"));
 }
 
+int onHold(String holdString)
+{
+    Activity holdActivity("Hold");
+
+    HoldOverride::HoldUpdateResult const holdUpdateResult = g_HoldOverride.SubmitUpdate(holdString.c_str());
+
+    if (holdUpdateResult == HoldOverride::HoldUpdateResult::Invalid)
+    {
+        WAF_LOG_WARNING("!! Hold \"%s\" invalid, ignoring.", holdString.c_str());
+    }
+
+    return static_cast<int>(holdUpdateResult);
+}
+
 
 //
 // Helpers
 //
 
-void applyTimezoneConfiguration()
+// Hardware watchdog: the STM32's independent watchdog (IWDG), clocked off the ~32 kHz LSI oscillator
+// and, once started, only stopped by a reset
+void startWatchdog()
 {
-    //
-    // We don't bother telling Particle about DST, we'll just change zones (e.g. PST to PDT)
-    // so the above is sufficient. We just need the math to work, we don't need nice formatting.
-    //
-    // Our configuration tells us the current timezone's offset as well as
-    // the next one and when to switch over, in case we don't update frequently.
-    //
+    // 32 kHz / 256 = 125 Hz, so the 12-bit reload value allows for timeouts of up to ~32 sec
+    uint32_t constexpr c_WatchdogReload = c_WatchdogTimeout_msec * 125 / 1000;
+    static_assert(c_WatchdogReload <= 0xFFF, "Watchdog timeout too long");
+
+    IWDG->KR = 0x5555;  // Unlock prescaler and reload registers
+    IWDG->PR = 0x6;     // Divide by 256
+    IWDG->RLR = c_WatchdogReload;
+    IWDG->KR = 0xAAAA;  // Reload
+    IWDG->KR = 0xCCCC;  // Start
+
+    WAF_LOG_INFO("Watchdog started (%lu msec).", c_WatchdogTimeout_msec);
+}
+
+// Kicks the watchdog unless a stage has overrun its deadline (in which case the watchdog resets us shortly)
+void serviceWatchdog()
+{
+    if (g_DeadlineMonitor.Check(millis()))
+    {
+        IWDG->KR = 0xAAAA;  // Reload
+    }
+}
+
+bool runMaintenance(unsigned long const timeUntilNextTask_msec)
+{
+    DeadlineMonitor::Scope maintenanceScope(g_DeadlineMonitor, DeadlineMonitor::Stage::Maintenance);
+    return g_MaintenanceScheduler.RunIdleTasks(g_Configuration, g_rgZones, g_cZones, timeUntilNextTask_msec);
+}
+
+void acquisitionThread(void* /* pParam */)
+{
+    while (true)
+    {
+        if (!g_AcquisitionChannel.Service(acquireReadings))
+        {
+            delay(c_AcquisitionPollingInterval_msec);
+        }
+    }
+}
+
+// (Acquisition thread, or setup() before it's started)
+void acquireReadings(AcquisitionRequest const& request, Readings& readings)
+{
+    readings.Reset();
+    readings.AcquisitionTime_msec = millis();
+
+    {
+        Activity acquireDataActivity("AcquireData");
+
+        // Start onboard acquisition (completes in the background while we deal with external devices)
+        g_OnboardSensorReader.Start(millis());
+
+        // Enumerate external devices
+        g_OneWireGateway.EnumerateDevices([&](OneWireAddress const& Address) {
+            if (Address.GetDeviceFamily() == 0x28)  // Ensure device is a DS18B20 sensor
+            {
+                readings.AddSensor(Address);
+            }
+        });
+
+        // Request temperature measurement from all sensors
+        if (OneWireTemperatureSensor::RequestMeasurement(g_OneWireGateway))
+        {
+            // Retrieve measurements
+            for (size_t idxSensor = 0; idxSensor < readings.cSensors; ++idxSensor)
+            {
+                float temperature = NAN;
+                uint8_t resolutionBits = 0;
+                OneWireTemperatureSensor::RetrieveMeasurement(
+                    temperature, readings.rgIds[idxSensor], g_OneWireGateway, &resolutionBits);
+
+                readings.SetReading(idxSensor, temperature, millis(), resolutionBits);
+            }
+        }
+
+        // Harvest onboard acquisition, falling back on recent readings if it failed
+        bool const fHarvestedOnboardReading = g_OnboardSensorReader.Harvest();
 
-    bool const inNextTimezone = g_Configuration.rootConfiguration().nextTimezoneChange() <= Time.now();
+        OnboardSensorReader<PietteTech_DHT>::Reading const onboardReading =
+            g_OnboardSensorReader.GetReading(millis(), request.MaximumOnboardAge_msec);
 
-    // {current,next}TimezoneUTCOffset: signed IANA UTC offset, e.g. PST = 480
-    int16_t const timezoneUTCOffset = inNextTimezone ? g_Configuration.rootConfiguration().nextTimezoneUTCOffset()
-                                                     : g_Configuration.rootConfiguration().currentTimezoneUTCOffset();
+        readings.OnboardTemperature = onboardReading.Temperature;
+        readings.OnboardHumidity = onboardReading.Humidity;
+        readings.OnboardDewPoint = Psychrometrics::DewPoint(onboardReading.Temperature, onboardReading.Humidity);
 
-    // particleTimezone: signed fractional hours, e.g. PST = -8.0
-    float const particleTimezone = -1.0f * (timezoneUTCOffset / 60.0f);
+        if (std::isnan(onboardReading.Temperature))
+        {
+            WAF_LOG_WARNING("No recent DHT22 data (status '%d'). Skipping internal sensor.",
+                            g_OnboardSensorReader.LastStatus());
+        }
+        else if (!fHarvestedOnboardReading)
+        {
+            WAF_LOG_INFO("Using DHT22 data from %lu msec ago.", onboardReading.Age_msec);
+        }
+    }
+}
+
+// (Control thread)
+void processReadings(Readings& readings)
+{
+    // Filter temperatures for control (raw values are retained for publishing)
+    readings.FilteredOnboardTemperature =
+        g_SensorFilterBank.FilterOnboard(g_Configuration, readings.OnboardTemperature);
+
+    for (size_t idxSensor = 0; idxSensor < readings.cSensors; ++idxSensor)
+    {
+        readings.rgFilteredValues[idxSensor] = g_SensorFilterBank.FilterExternal(
+            g_Configuration, readings.rgIds[idxSensor], readings.rgValues[idxSensor]);
+    }
+
+    // Register sensors and their readings for lookup by control, sensor fusion, and aggregation
+    g_SensorRegistry.Update(readings);
+
+    // Fuse operable temperature from configured sensors if requested,
+    // otherwise override onboard temperature if requested and available
+    OneWireAddress const externalSensorId(g_Configuration.rootConfiguration().externalSensorId());
+
+    readings.OperableTemperature = readings.FilteredOnboardTemperature;
+    readings.fUsedExternalSensor = false;
+
+    if (SensorFusion<c_cOneWireDevices_Max>::IsConfigured(g_Configuration))
+    {
+        readings.OperableTemperature = g_SensorFusion.Fuse(
+            g_Configuration, readings.FilteredOnboardTemperature, g_SensorRegistry, readings.AcquisitionTime_msec);
+        readings.fUsedExternalSensor = g_SensorFusion.UsedExternalSensor();
+
+        if (std::isnan(readings.OperableTemperature))
+        {
+            WAF_LOG_WARNING("!! Warning: no usable readings from sensor fusion inputs.");
+        }
+    }
+    else if (!externalSensorId.IsEmpty())
+    {
+        float const externalTemperature = g_SensorRegistry.GetCurrentTemperature(externalSensorId.Value());
+
+        if (!std::isnan(externalTemperature))
+        {
+            // Apply override (the sensor is then reported as the operable temperature rather than on its own)
+            readings.OperableTemperature = externalTemperature;
+            readings.fUsedExternalSensor = true;
+
+            g_SensorRegistry.SetRoles(externalSensorId.Value(), g_SensorRegistry.sc_RoleOperable);
+        }
+        else
+        {
+            WAF_LOG_WARNING("!! Warning: couldn't locate requested external sensor.");
+        }
+    }
+}
+
+AcquisitionRequest getAcquisitionRequest()
+{
+    AcquisitionRequest request;
+    request.MaximumOnboardAge_msec = 3 * g_Configuration.rootConfiguration().cadence() * 1000UL;
+
+    return request;
+}
+
+void controlZones(Readings const& readings, unsigned long const currentTime_msec)
+{
+    // Schedules and holds need the time of day, which we only get once connected to the cloud
+    // (RTC time survives resets but not power loss) - until then, rather than following whatever setting
+    // the unset clock happens to land on, zones only heat to their lowest heat setpoint
+    bool const fIsTimeValid = Time.isValid();
+
+    ThermostatAction rgActions[Zone::sc_cZones_Max];
+
+    // (Re-)evaluate all zones off the given readings
+    for (size_t idxZone = 0; idxZone < g_cZones; ++idxZone)
+    {
+        Zone& zone = g_rgZones[idxZone];
+
+        float const zoneTemperature = zone.SelectTemperature(readings.OperableTemperature, g_SensorRegistry);
+
+        if (fIsTimeValid)
+        {
+            zone.Apply(g_Configuration, zoneTemperature, currentTime_msec, readings.OnboardDewPoint);
+        }
+        else
+        {
+            zone.ApplyWithoutTime(g_Configuration, zoneTemperature, currentTime_msec);
+        }
+
+        rgActions[idxZone] = zone.CurrentActions();
+    }
+
+    // Retain outcome so we can pick up from here after a reset
+    g_RetainedState.Update(g_Configuration.Hash(), rgActions, g_cZones);
+}
+
+void applyZoneConfiguration()
+{
+    unsigned long const currentTime_msec = millis();
+
+    size_t const cZones = Zone::GetZoneCount(g_Configuration);
+
+    // Release zones that are no longer configured
+    for (size_t idxZone = cZones; idxZone < g_cZones; ++idxZone)
+    {
+        g_rgZones[idxZone].Shutdown(currentTime_msec);
+    }
+
+    for (size_t idxZone = 0; idxZone < cZones; ++idxZone)
+    {
+        g_rgZones[idxZone].Initialize(
+            g_Configuration, static_cast<uint8_t>(idxZone), currentTime_msec, &g_HoldOverride);
+    }
 
-    // Apply
-    Time.zone(particleTimezone);
+    g_cZones = cZones;
 }
\ No newline at end of file
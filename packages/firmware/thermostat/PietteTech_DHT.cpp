@@ -90,7 +90,7 @@ void PietteTech_DHT::begin()
     _lastreadtime = 0;
     _state = STOPPED;
     _status = DHTLIB_ERROR_NOTSTARTED;
-    _detachISR = false;
+    _cEdges = 0;
     pinMode(_sigPin, OUTPUT);
     digitalWrite(_sigPin, HIGH);
 }
@@ -119,24 +119,14 @@ int PietteTech_DHT::acquire()
          */
         _firstreading = false;
         _lastreadtime = currenttime;
-        _state = RESPONSE;
-
-#if defined(DHT_DEBUG_TIMING)
-        /*
-         * Clear the debug timings array
-         */
-        for (int i = 0; i < 41; i++)
-            _edges[i] = 0;
-        _e = &_edges[0];
-#endif
+        _state = ACQUIRING;
 
         /*
          * Set the initial values in the buffer and variables
          */
         for (int i = 0; i < 5; i++)
             _bits[i] = 0;
-        _cnt = 7;
-        _idx = 0;
+        _cEdges = 0;
         _hum = 0;
         _temp = 0;
 
@@ -156,8 +146,7 @@ int PietteTech_DHT::acquire()
          * Attach the interrupt handler to receive the data once the DHT
          * starts to send us data
          */
-        _us = micros();
-        _detachISR = false;
+        _startUs = micros();
         attachInterrupt(_sigPin, &PietteTech_DHT::_isrCallback, this, FALLING);
 
         return DHTLIB_ACQUIRING;
@@ -172,10 +161,7 @@ int PietteTech_DHT::acquireAndWait(uint32_t timeout)
     uint32_t start = millis();
     while (acquiring() && (timeout == 0 || ((millis() - start) < timeout)))
         Particle.process();
-    if (acquiring())
-    {
-        _status = DHTLIB_ERROR_RESPONSE_TIMEOUT;
-    }
+    abort();
     return getStatus();
 }
 
@@ -187,110 +173,18 @@ void PietteTech_DHT::isrCallback()
 {
 }
 
+/*
+ * Only records the falling edge's timestamp; the pulses are classified in bulk
+ * on the main thread (c.f. decodeIfComplete()) so the ISR takes a few instructions
+ * and decoding doesn't depend on how promptly the ISR runs relative to other work.
+ */
 void PietteTech_DHT::_isrCallback()
 {
-    if (_detachISR)
-    {
-        /*
-         * NOTE:  We can't call detachInterrupt() inside the ISR (c.f.
-         * https://github.com/particle-iot/device-os/issues/1835) so we'll set _detachISR inside the ISR when we're done
-         *        and count on code on the main thread to detach it via detachISRIfRequested().
-         *        Getting another interrupt after we've already requested a detach is benign
-         *        so we'll just ignore this interrupt and return.
-         */
-        return;
-    }
-
-    unsigned long newUs = micros();
-    unsigned long delta = (newUs - _us);
-    _us = newUs;
-
-    if (delta > 6000)
-    {
-        _status = DHTLIB_ERROR_ISR_TIMEOUT;
-        _state = STOPPED;
-        _detachISR = true;
-        return;
-    }
-    switch (_state)
+    uint8_t cEdges = _cEdges;
+    if (cEdges < DHT_EDGES_MAX)
     {
-        case RESPONSE:  // Spec: 80us LOW followed by 80us HIGH
-            if (delta < 65)
-            {  // Spec: 20-200us to first falling edge of response
-                _us -= delta;
-                break;  // do nothing, it started the response signal
-
-                // --------------- issue: https://github.com/particle-iot/device-os/issues/1654 -----------------
-                //    } if (125 < delta && delta < 200) { // originally
-            }
-            if (125 < delta && delta < 220)
-            {  // account for timing offset with Particle Mesh devices
-               // ----------------------------------------------------------------------------------------------
-
-#if defined(DHT_DEBUG_TIMING)
-                *_e++ = delta;  // record the edge -> edge time
-#endif
-                _state = DATA;
-            }
-            else
-            {
-                _detachISR = true;
-                _status = DHTLIB_ERROR_RESPONSE_TIMEOUT;
-                _state = STOPPED;
-#if defined(DHT_DEBUG_TIMING)
-                *_e++ = delta;  // record the edge -> edge time
-#endif
-            }
-            break;
-        case DATA:  // Spec: 50us low followed by high of 26-28us = 0, 70us = 1
-            if (60 < delta && delta < 155)
-            {                       // valid in timing
-                _bits[_idx] <<= 1;  // shift the data
-                if (delta > 110)    // is a one
-                    _bits[_idx] |= 1;
-#if defined(DHT_DEBUG_TIMING)
-                *_e++ = delta;  // record the edge -> edge time
-#endif
-                if (_cnt == 0)
-                {              // we have completed the byte, go to next
-                    _cnt = 7;  // restart at MSB
-                    if (++_idx == 5)
-                    {  // go to next byte, if we have got 5 bytes stop.
-                        _detachISR = true;
-                        // Verify checksum
-                        uint8_t sum = _bits[0] + _bits[1] + _bits[2] + _bits[3];
-                        if (_bits[4] != sum)
-                        {
-                            _status = DHTLIB_ERROR_CHECKSUM;
-                            _state = STOPPED;
-                        }
-                        else
-                        {
-                            _status = DHTLIB_OK;
-                            _state = ACQUIRED;
-                            _convert = true;
-                        }
-                        break;
-                    }
-                }
-                else
-                    _cnt--;
-            }
-            else if (delta < 10)
-            {
-                _detachISR = true;
-                _status = DHTLIB_ERROR_DELTA;
-                _state = STOPPED;
-            }
-            else
-            {
-                _detachISR = true;
-                _status = DHTLIB_ERROR_DATA_TIMEOUT;
-                _state = STOPPED;
-            }
-            break;
-        default:
-            break;
+        _edges[cEdges] = micros();
+        _cEdges = cEdges + 1;
     }
 }
 
@@ -312,25 +206,67 @@ void PietteTech_DHT::convert()
     _convert = false;
 }
 
-void PietteTech_DHT::detachISRIfRequested()
+void PietteTech_DHT::decodeIfComplete()
 {
-    if (_detachISR)
+    if (_state != ACQUIRING)
+        return;
+
+    /*
+     * Transmission is complete once all edges have been captured or the line has gone quiet
+     * (Read the time first; the ISR may record an edge after it, hence the signed comparison)
+     */
+    uint32_t nowUs = micros();
+    uint8_t cEdges = _cEdges;
+    uint32_t lastUs = (cEdges > 0) ? _edges[cEdges - 1] : _startUs;
+
+    if (cEdges < DHT_EDGES_MAX && static_cast<int32_t>(nowUs - lastUs) < static_cast<int32_t>(DHT_IDLE_US))
+        return;
+
+    /*
+     * NOTE:  We can't call detachInterrupt() inside the ISR (c.f.
+     *        https://github.com/particle-iot/device-os/issues/1835) so we detach it here on the main thread.
+     */
+    detachInterrupt(_sigPin);
+
+    uint32_t edges[DHT_EDGES_MAX];
+    for (uint8_t i = 0; i < cEdges; i++)
+        edges[i] = _edges[i];
+
+    _status = decodeEdges(edges, cEdges, _startUs, _bits);
+    if (_status == DHTLIB_OK)
     {
-        detachInterrupt(_sigPin);
-        _detachISR = false;
+        _state = ACQUIRED;
+        _convert = true;
     }
+    else
+        _state = STOPPED;
 }
 
 bool PietteTech_DHT::acquiring()
 {
+    decodeIfComplete();
     if (_state != ACQUIRED && _state != STOPPED)
         return true;
     return false;
 }
 
+/*
+ * Abandons an acquisition in progress (e.g. a sensor that never responded, which would
+ * otherwise leave the state machine waiting for a response indefinitely)
+ */
+void PietteTech_DHT::abort()
+{
+    if (acquiring())
+    {
+        detachInterrupt(_sigPin);
+        _state = STOPPED;
+        _status = DHTLIB_ERROR_RESPONSE_TIMEOUT;
+    }
+}
+
 int PietteTech_DHT::getStatus()
 {
-    detachISRIfRequested();
+    decodeIfComplete();
     return _status;
 }
 
@@ -386,18 +322,8 @@ double PietteTech_DHT::getDewPoint()
     return Td;
 }
 
-// dewPoint function NOAA
-// reference: http://wahiduddin.net/calc/density_algorithms.htm
 double PietteTech_DHT::getDewPointSlow()
 {
     DHT_CHECK_STATE;
-    double a0 = (double)373.15 / (273.15 + (double)_temp);
-    double SUM = (double)-7.90298 * (a0 - 1.0);
-    SUM += 5.02808 * log10(a0);
-    SUM += -1.3816e-7 * (pow(10, (11.344 * (1 - 1 / a0))) - 1);
-    SUM += 8.1328e-3 * (pow(10, (-3.49149 * (a0 - 1))) - 1);
-    SUM += log10(1013.246);
-    double VP = pow(10, SUM - 3) * (double)_hum;
-    double T = log(VP / 0.61078);  // temp var
-    return (241.88 * T) / (17.558 - T);
+    return dewPointSlow(_temp, _hum);
 }
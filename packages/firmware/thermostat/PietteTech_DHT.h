@@ -33,9 +33,6 @@
 #ifndef __PIETTETECH_DHT_H__
 #define __PIETTETECH_DHT_H__
 
-// There appears to be a overrun in memory on this class.  For now please leave DHT_DEBUG_TIMING enabled
-#define DHT_DEBUG_TIMING  // Enable this for edge->edge timing collection
-
 #include <Particle.h>
 #include <math.h>
 
@@ -63,8 +60,14 @@ const int DHTLIB_ERROR_ACQUIRING = -5;
 const int DHTLIB_ERROR_DELTA = -6;
 const int DHTLIB_ERROR_NOTSTARTED = -7;
 
+// edge capture
+const uint8_t DHT_DATA_BITS = 40;
+const uint8_t DHT_EDGES_MAX = DHT_DATA_BITS + 2;  // sensor's initial falling edge, end of response, data bits
+const uint8_t DHT_EDGES_MIN = DHT_DATA_BITS + 1;  // initial falling edge may precede the ISR being attached
+const uint32_t DHT_IDLE_US = 1000;                // transmission is over once the line's been quiet this long
+
 #define DHT_CHECK_STATE                \
-    detachISRIfRequested();            \
+    decodeIfComplete();                \
     if (_state == STOPPED)             \
         return _status;                \
     else if (_state != ACQUIRED)       \
@@ -96,37 +99,40 @@ public:
     double getDewPointSlow();
     float getHumidity();
     bool acquiring();
+    void abort();
     int getStatus();
     float readTemperature();
     float readHumidity();
-#if defined(DHT_DEBUG_TIMING)
-    volatile uint8_t _edges[41];
-#endif
+
+    /*
+     * Decodes falling edge timestamps captured by the ISR into the sensor's five data bytes,
+     * returning DHTLIB_OK or one of the DHTLIB_ERROR_* codes
+     */
+    static int decodeEdges(uint32_t const *edges, uint8_t cEdges, uint32_t startUs, uint8_t *bits);
+
+    /*
+     * NOAA dew point (c.f. getDewPointSlow()), exposed as a reference for faster approximations
+     */
+    static double dewPointSlow(double celsius, double humidity);
 
 private:
     void _isrCallback();
     void convert();
-    void detachISRIfRequested();
+    void decodeIfComplete();
 
     enum states
     {
-        RESPONSE = 0,
-        DATA = 1,
         ACQUIRED = 2,
         STOPPED = 3,
         ACQUIRING = 4
     };
-    volatile states _state;
-    volatile int _status;
-    volatile uint8_t _bits[5];
-    volatile uint8_t _cnt;
-    volatile uint8_t _idx;
-    volatile unsigned long _us;
-    volatile bool _convert;
-    volatile bool _detachISR;
-#if defined(DHT_DEBUG_TIMING)
-    volatile uint8_t *_e;
-#endif
+    states _state;
+    int _status;
+    uint8_t _bits[5];
+    bool _convert;
+    uint32_t _startUs;
+    volatile uint32_t _edges[DHT_EDGES_MAX];  // written by the ISR
+    volatile uint8_t _cEdges;                 // written by the ISR
     int _sigPin;
     int _type;
     unsigned long _lastreadtime;
@@ -134,4 +140,97 @@ private:
     float _hum;
     float _temp;
 };
+
+/*
+ * Edges are timed relative to startUs (when the line was released to the sensor):
+ *
+ *   [initial falling edge], end of response, end of data bit 1, ..., end of data bit 40
+ *
+ * Rather than comparing each bit against a fixed threshold, the bits' durations are split
+ * into short ('0') and long ('1') clusters using the midpoint of the observed range refined
+ * by one pass of the clusters' means, so uniformly skewed timings (e.g. ISR latency, the
+ * Mesh timing offset) still decode.
+ */
+inline int PietteTech_DHT::decodeEdges(uint32_t const *edges, uint8_t cEdges, uint32_t startUs, uint8_t *bits)
+{
+    if (cEdges < DHT_EDGES_MIN)
+        return (cEdges == 0) ? DHTLIB_ERROR_RESPONSE_TIMEOUT : DHTLIB_ERROR_DATA_TIMEOUT;
+
+    /*
+     * Response, timed from releasing the line to the start of the first data bit
+     *   Spec: 20-200us + 160us, 125-220us accounts for timing offset with Particle Mesh devices
+     */
+    uint8_t idxFirst = cEdges - DHT_DATA_BITS;
+    uint32_t response = edges[idxFirst - 1] - startUs;
+
+    if (response <= 125 || response >= 220)
+        return DHTLIB_ERROR_RESPONSE_TIMEOUT;
+
+    /*
+     * Data bits, falling edge to falling edge
+     *   Spec: '0' 70us - 85us, '1' 116us - 130us
+     */
+    uint32_t durations[DHT_DATA_BITS];
+    uint32_t minDuration = UINT32_MAX;
+    uint32_t maxDuration = 0;
+
+    for (uint8_t i = 0; i < DHT_DATA_BITS; i++)
+    {
+        uint32_t duration = edges[idxFirst + i] - edges[idxFirst + i - 1];
+
+        if (duration < 10)
+            return DHTLIB_ERROR_DELTA;
+        if (duration < 40 || duration > 200)
+            return DHTLIB_ERROR_DATA_TIMEOUT;
+
+        durations[i] = duration;
+        minDuration = (duration < minDuration) ? duration : minDuration;
+        maxDuration = (duration > maxDuration) ? duration : maxDuration;
+    }
+
+    // All bits of one kind (no usable spread): fall back on the fixed threshold
+    uint32_t threshold = 110;
+
+    if (maxDuration - minDuration >= 20)
+    {
+        threshold = (minDuration + maxDuration) / 2;
+
+        uint32_t sums[2] = {0, 0};
+        uint8_t counts[2] = {0, 0};
+
+        for (uint8_t i = 0; i < DHT_DATA_BITS; i++)
+        {
+            int isOne = (durations[i] > threshold) ? 1 : 0;
+            sums[isOne] += durations[i];
+            counts[isOne]++;
+        }
+
+        threshold = (sums[0] / counts[0] + sums[1] / counts[1]) / 2;
+    }
+
+    for (uint8_t i = 0; i < 5; i++)
+        bits[i] = 0;
+
+    for (uint8_t i = 0; i < DHT_DATA_BITS; i++)
+        bits[i / 8] = (bits[i / 8] << 1) | ((durations[i] > threshold) ? 1 : 0);
+
+    // Verify checksum
+    uint8_t sum = bits[0] + bits[1] + bits[2] + bits[3];
+    return (bits[4] == sum) ? DHTLIB_OK : DHTLIB_ERROR_CHECKSUM;
+}
+
+// dewPoint function NOAA
+// reference: http://wahiduddin.net/calc/density_algorithms.htm
+inline double PietteTech_DHT::dewPointSlow(double celsius, double humidity)
+{
+    double a0 = (double)373.15 / (273.15 + celsius);
+    double SUM = (double)-7.90298 * (a0 - 1.0);
+    SUM += 5.02808 * log10(a0);
+    SUM += -1.3816e-7 * (pow(10, (11.344 * (1 - 1 / a0))) - 1);
+    SUM += 8.1328e-3 * (pow(10, (-3.49149 * (a0 - 1))) - 1);
+    SUM += log10(1013.246);
+    double VP = pow(10, SUM - 3) * humidity;
+    double T = log(VP / 0.61078);  // temp var
+    return (241.88 * T) / (17.558 - T);
+}
 #endif
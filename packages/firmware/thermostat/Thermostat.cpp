@@ -3,7 +3,13 @@
 #include "inc/stdinc.h"
 
 Thermostat::Thermostat()
-    : m_CurrentActions(ThermostatAction::NONE)
+    : m_RelayPins(DefaultRelayPins())
+    , m_idxZone()
+    , m_CurrentActions(ThermostatAction::NONE)
+    , m_HeatController()
+    , m_CoolController()
+    , m_ShortCycleProtection()
+    , m_fIsDehumidifying()
 {
 }
 
@@ -13,17 +19,59 @@ Thermostat::~Thermostat()
 
 void Thermostat::Initialize()
 {
+    Initialize(DefaultRelayPins());
+}
+
+void Thermostat::Initialize(RelayPins const& relayPins, uint8_t const idxZone)
+{
+    m_RelayPins = relayPins;
+    m_idxZone = idxZone;
+
     // See ApplyActions() for explanation
-    pinMode(sc_RelayPin_Heat, OUTPUT);
-    pinMode(sc_RelayPin_SwitchOver, OUTPUT);
-    pinMode(sc_RelayPin_Circulate, OUTPUT);
+    for (pin_t const pin : {m_RelayPins.Heat, m_RelayPins.SwitchOver, m_RelayPins.Circulate})
+    {
+        if (pin != sc_RelayPin_None)
+        {
+            pinMode(pin, OUTPUT);
+        }
+    }
 
     ApplyActions(m_CurrentActions);
 }
 
+void Thermostat::Shutdown(unsigned long const CurrentTime_msec)
+{
+    m_ShortCycleProtection.Override(m_CurrentActions, ThermostatAction::NONE, CurrentTime_msec);
+
+    m_CurrentActions = ThermostatAction::NONE;
+    ApplyActions(m_CurrentActions);
+}
+
+void Thermostat::Resume(Configuration const& Configuration,
+                        ThermostatAction const Actions,
+                        unsigned long const CurrentTime_msec)
+{
+    // Relays were off while we were down, so heat/cool that was running stopped at the reset
+    // and may only resume once short-cycle protection allows it
+    m_ShortCycleProtection.RecordReset(Actions, CurrentTime_msec);
+
+    ThermostatAction const permittedActions = m_ShortCycleProtection.Apply(
+        m_CurrentActions, Actions, GetShortCycleProtectionTimings(Configuration), CurrentTime_msec);
+
+    if (permittedActions != Actions)
+    {
+        WAF_LOG_INFO("Thermostat: short-cycle protection holding back resumed heat/cool.");
+    }
+
+    m_CurrentActions = permittedActions;
+    ApplyActions(m_CurrentActions);
+}
+
 void Thermostat::Apply(Configuration const& Configuration,
                        ThermostatSetpoint const& ThermostatSetpoint,
-                       float CurrentTemperature)
+                       float CurrentTemperature,
+                       unsigned long CurrentTime_msec,
+                       float CurrentDewPoint)
 {
     // Compute proposed action, defaulting to continuing the current course of action
     ThermostatAction proposedActions = m_CurrentActions;
@@ -36,28 +84,102 @@ void Thermostat::Apply(Configuration const& Configuration,
         std::min(ThermostatSetpoint.SetPointCirculateAbove, ThermostatSetpoint.SetPointCirculateBelow);
     float const threshold = Configuration::getTemperature(Configuration.rootConfiguration().threshold_x100());
 
-    // Heat
-    if (!!(m_CurrentActions & ThermostatAction::Heat) && CurrentTemperature > (setPointHeat + threshold))
+    ControlSettings const controlSettings = GetControlSettings(Configuration, m_idxZone);
+
+    if (controlSettings.Mode == ControlMode::TimeProportional)
     {
-        // Turn off heat
-        proposedActions &= ~ThermostatAction::Heat;
+        // Heat and cool by time-proportioned PI control
+        if (!std::isnan(CurrentTemperature))
+        {
+            auto applyController = [&](TimeProportionalController& controller,
+                                       ThermostatAction const action,
+                                       float const error) {
+                if (!(ThermostatSetpoint.AllowedActions & action))
+                {
+                    // Don't accumulate error for actions we can't take
+                    controller.Reset();
+                    proposedActions &= ~action;
+                    return;
+                }
+
+                if (controller.Update(error,
+                                      controlSettings.ProportionalGain,
+                                      controlSettings.IntegralGain_PerHour,
+                                      controlSettings.Window_msec,
+                                      CurrentTime_msec))
+                {
+                    proposedActions |= action;
+                }
+                else
+                {
+                    proposedActions &= ~action;
+                }
+            };
+
+            applyController(m_HeatController, ThermostatAction::Heat, setPointHeat - CurrentTemperature);
+            applyController(m_CoolController, ThermostatAction::Cool, CurrentTemperature - setPointCool);
+        }
     }
-    else if (!(m_CurrentActions & ThermostatAction::Heat) && CurrentTemperature < (setPointHeat - threshold))
+    else
     {
-        // Turn on heat
-        proposedActions |= ThermostatAction::Heat;
-    }
+        m_HeatController.Reset();
+        m_CoolController.Reset();
 
-    // Cool
-    if (!!(m_CurrentActions & ThermostatAction::Cool) && CurrentTemperature < (setPointCool - threshold))
-    {
-        // Turn off cooling
-        proposedActions &= ~ThermostatAction::Cool;
+        // Heat
+        if (!!(m_CurrentActions & ThermostatAction::Heat) && CurrentTemperature > (setPointHeat + threshold))
+        {
+            // Turn off heat
+            proposedActions &= ~ThermostatAction::Heat;
+        }
+        else if (!(m_CurrentActions & ThermostatAction::Heat) && CurrentTemperature < (setPointHeat - threshold))
+        {
+            // Turn on heat
+            proposedActions |= ThermostatAction::Heat;
+        }
+
+        // Cool
+        if (!!(m_CurrentActions & ThermostatAction::Cool) && CurrentTemperature < (setPointCool - threshold))
+        {
+            // Turn off cooling
+            proposedActions &= ~ThermostatAction::Cool;
+        }
+        else if (!(m_CurrentActions & ThermostatAction::Cool) && CurrentTemperature > (setPointCool + threshold))
+        {
+            // Turn on cooling
+            proposedActions |= ThermostatAction::Cool;
+        }
     }
-    else if (!(m_CurrentActions & ThermostatAction::Cool) && CurrentTemperature > (setPointCool + threshold))
+
+    // Dehumidify by cooling
+    // (hysteresis around the configured dew point, but never cooling below the heat setpoint)
     {
-        // Turn on cooling
-        proposedActions |= ThermostatAction::Cool;
+        uint16_t const dehumidifyAboveDewPoint_x100 = Configuration.rootConfiguration().dehumidifyAboveDewPoint_x100();
+
+        bool fShouldDehumidify = false;
+
+        if (dehumidifyAboveDewPoint_x100 && !!(ThermostatSetpoint.AllowedActions & ThermostatAction::Cool) &&
+            !(proposedActions & ThermostatAction::Heat) && !std::isnan(CurrentDewPoint) &&
+            CurrentTemperature > (setPointHeat + threshold))
+        {
+            float const dehumidifyAboveDewPoint = Configuration::getTemperature(dehumidifyAboveDewPoint_x100);
+
+            fShouldDehumidify = m_fIsDehumidifying ? CurrentDewPoint > (dehumidifyAboveDewPoint - threshold)
+                                                   : CurrentDewPoint > (dehumidifyAboveDewPoint + threshold);
+        }
+
+        if (fShouldDehumidify != m_fIsDehumidifying)
+        {
+            WAF_LOG_INFO("Thermostat: %s dehumidifying (dew point %.1f C).",
+                         fShouldDehumidify ? "started" : "stopped",
+                         CurrentDewPoint);
+        }
+
+        m_fIsDehumidifying = fShouldDehumidify;
+
+        if (m_fIsDehumidifying)
+        {
+            proposedActions |= ThermostatAction::Cool;
+        }
     }
 
     // Circulate
@@ -90,35 +212,102 @@ void Thermostat::Apply(Configuration const& Configuration,
     if (!!(proposedActions & ThermostatAction::Heat) && !!(proposedActions & ThermostatAction::Cool))
     {
         // This shouldn't ever happen - bail on heat/cool actions to be safe (allow circulation).
-        Serial.println("Thermostat: simultaneous heat and cool proposed, dropping both.");
+        WAF_LOG_WARNING("Thermostat: simultaneous heat and cool proposed, dropping both.");
 
         proposedActions &= ~(ThermostatAction::Heat | ThermostatAction::Cool);
     }
 
+    // Protect compressor from short-cycling
+    {
+        ThermostatAction const permittedActions = m_ShortCycleProtection.Apply(
+            m_CurrentActions, proposedActions, GetShortCycleProtectionTimings(Configuration), CurrentTime_msec);
+
+        if (permittedActions != proposedActions)
+        {
+            WAF_LOG_INFO("Thermostat: short-cycle protection holding back heat/cool transition.");
+        }
+
+        proposedActions = permittedActions;
+    }
+
     // Commit
     m_CurrentActions = proposedActions;
     ApplyActions(m_CurrentActions);
 }
 
+Thermostat::ControlSettings Thermostat::GetControlSettings(Configuration const& Configuration, uint8_t const idxZone)
+{
+    auto const& rootConfiguration = Configuration.rootConfiguration();
+    auto const pvZones = rootConfiguration.zones();
+
+    if (pvZones && idxZone < pvZones->size())
+    {
+        auto const& zoneConfiguration = *pvZones->Get(idxZone);
+
+        if (zoneConfiguration.controlMode() != ZoneControlMode::Default)
+        {
+            ControlSettings const controlSettings = {
+                (zoneConfiguration.controlMode() == ZoneControlMode::TimeProportional) ? ControlMode::TimeProportional
+                                                                                        : ControlMode::Hysteresis,
+                zoneConfiguration.proportionalGain_x100() / 100.0f,
+                zoneConfiguration.integralGain_x100() / 100.0f,
+                zoneConfiguration.controlCycleWindow() * 1000UL,
+            };
+
+            return controlSettings;
+        }
+    }
+
+    ControlSettings const controlSettings = {
+        rootConfiguration.controlMode(),
+        rootConfiguration.proportionalGain_x100() / 100.0f,
+        rootConfiguration.integralGain_x100() / 100.0f,
+        rootConfiguration.controlCycleWindow() * 1000UL,
+    };
+
+    return controlSettings;
+}
+
+ShortCycleProtection::Timings Thermostat::GetShortCycleProtectionTimings(Configuration const& Configuration)
+{
+    auto const& rootConfiguration = Configuration.rootConfiguration();
+
+    ShortCycleProtection::Timings const timings = {
+        rootConfiguration.minimumRunTime() * 1000UL,
+        rootConfiguration.minimumOffTime() * 1000UL,
+        rootConfiguration.changeoverDeadTime() * 1000UL,
+    };
+
+    return timings;
+}
+
 void Thermostat::ApplyActions(ThermostatAction const& Actions)
 {
     //
     // Relays are used in the following configuration:
     //
     // - Radiant heat
-    //   - sc_RelayPin_Heat = call for heat
+    //   - RelayPins.Heat = call for heat
     //
     // - Heat pump
-    //   - sc_RelayPin_Heat = call for work (heat [default] or cool)
-    //   - sc_RelayPin_SwitchOver = switch over call for heat into call for cool
-    //   - sc_RelayPin_Circulate = turn on circulator fan
+    //   - RelayPins.Heat = call for work (heat [default] or cool)
+    //   - RelayPins.SwitchOver = switch over call for heat into call for cool
+    //   - RelayPins.Circulate = turn on circulator fan
     //
     // There are many heat pumps and not all are like mine,
     // but there's no value in adding the complexity to make this configurable for other setups until needed...
     //
 
-    digitalWrite(sc_RelayPin_Heat, !!(Actions & (ThermostatAction::Heat | ThermostatAction::Cool)));
-    digitalWrite(sc_RelayPin_SwitchOver, !!(Actions & ThermostatAction::Cool));
-    digitalWrite(sc_RelayPin_Circulate,
-                 !!(Actions & (ThermostatAction::Heat | ThermostatAction::Cool | ThermostatAction::Circulate)));
+    WriteRelay(m_RelayPins.Heat, !!(Actions & (ThermostatAction::Heat | ThermostatAction::Cool)));
+    WriteRelay(m_RelayPins.SwitchOver, !!(Actions & ThermostatAction::Cool));
+    WriteRelay(m_RelayPins.Circulate,
+               !!(Actions & (ThermostatAction::Heat | ThermostatAction::Cool | ThermostatAction::Circulate)));
+}
+
+void Thermostat::WriteRelay(pin_t const pin, bool const fIsOn)
+{
+    if (pin != sc_RelayPin_None)
+    {
+        digitalWrite(pin, fIsOn);
+    }
 }
@@ -3,6 +3,10 @@
 #include "inc/stdinc.h"
 
 ThermostatSetpointScheduler::ThermostatSetpointScheduler()
+    : m_ThermostatSettingsMask()
+    , m_pHoldOverride()
+    , m_idxEarlyStartSetting(sc_idxNotSet)
+    , m_EarlyStartScheduledTime()
 {
 }
 
@@ -12,6 +16,17 @@ ThermostatSetpointScheduler::~ThermostatSetpointScheduler()
 
 ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Configuration const& Configuration) const
 {
+    uint32_t const timeNow = Time.now();  // seconds since UTC epoch
+
+    //
+    // See if there's a local hold (which trumps everything in the configuration)
+    //
+
+    if (isHoldOverrideActive(timeNow))
+    {
+        return m_pHoldOverride->Setpoint();
+    }
+
     auto const pvThermostatSettings = Configuration.rootConfiguration().thermostatSettings();
 
     if (!pvThermostatSettings || pvThermostatSettings->size() == 0)
@@ -24,47 +39,13 @@ ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Con
     // See if there's an applicable Hold
     //
 
-    uint32_t constexpr c_idxNotSet = static_cast<uint32_t>(-1);
-
-    uint32_t const timeNow = Time.now();  // seconds since UTC epoch
-
     {
-        uint32_t idxEarliestHoldUntil = c_idxNotSet;
-
-        for (uint32_t idxSetting = 0; idxSetting < pvThermostatSettings->size(); ++idxSetting)
-        {
-            auto const& thermostatSetting = *pvThermostatSettings->Get(idxSetting);
-
-            if (thermostatSetting.type() != ThermostatSettingType::Hold)
-            {
-                // Not a hold
-                continue;
-            }
-
-            if (thermostatSetting.holdUntil() < timeNow)
-            {
-                // No longer valid
-                continue;
-            }
-
-            if (idxEarliestHoldUntil == c_idxNotSet)
-            {
-                // There's no better (earlier) setting yet, adopt this one
-                idxEarliestHoldUntil = idxSetting;
-                continue;
-            }
+        uint32_t const idxActiveHold = getActiveHoldIndex(Configuration, timeNow);
 
-            if (thermostatSetting.holdUntil() < pvThermostatSettings->Get(idxEarliestHoldUntil)->holdUntil())
-            {
-                // This setting is earlier, adopt it
-                idxEarliestHoldUntil = idxSetting;
-            }
-        }
-
-        if (idxEarliestHoldUntil != c_idxNotSet)
+        if (idxActiveHold != sc_idxNotSet)
         {
             // We found a suitable setting - return it
-            return ThermostatSetpoint(*pvThermostatSettings->Get(idxEarliestHoldUntil));
+            return ThermostatSetpoint(*pvThermostatSettings->Get(idxActiveHold));
         }
     }
 
@@ -73,24 +54,24 @@ ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Con
     //
 
     {
-        // c.f. https://docs.particle.io/reference/device-os/firmware/photon/#hour-
-        uint16_t const currentMinutesSinceMidnight = Time.hour(timeNow) * 60 + Time.minute(timeNow);
-        uint8_t const currentScalarDayOfWeek =
-            static_cast<uint8_t>(Time.weekday(timeNow));  // Sunday = 1, ...; c.f. getScalarDayOfWeek
-
-        uint16_t const currentMinutesSinceStartOfWeek =
-            currentMinutesSinceMidnight + (currentScalarDayOfWeek - 1) * (24 * 60);
+        uint16_t const currentMinutesSinceStartOfWeek = LocalTime::GetMinutesSinceStartOfWeek(Configuration, timeNow);
 
-        uint32_t idxClosestScheduled = c_idxNotSet;
+        uint32_t idxClosestScheduled = sc_idxNotSet;
         uint16_t closestScheduledMinutesSinceStartOfWeek = 0;
 
-        uint32_t idxLatestScheduled = c_idxNotSet;
+        uint32_t idxLatestScheduled = sc_idxNotSet;
         uint16_t latestScheduledMinutesSinceStartOfWeek = 0;
 
         for (uint32_t idxSetting = 0; idxSetting < pvThermostatSettings->size(); ++idxSetting)
         {
             auto const& thermostatSetting = *pvThermostatSettings->Get(idxSetting);
 
+            if (!isSettingSelected(idxSetting))
+            {
+                // Not for this zone
+                continue;
+            }
+
             if (thermostatSetting.type() != ThermostatSettingType::Scheduled)
             {
                 // Not a scheduled setting
@@ -115,7 +96,7 @@ ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Con
                 // Check if this could be the closest (at or before) scheduled setting
                 if (settingAtMinutesSinceStartOfWeek <= currentMinutesSinceStartOfWeek)
                 {
-                    if ((idxClosestScheduled == c_idxNotSet)  // ...there is no closest setting
+                    if ((idxClosestScheduled == sc_idxNotSet)  // ...there is no closest setting
                         || (settingAtMinutesSinceStartOfWeek >
                             closestScheduledMinutesSinceStartOfWeek))  // ...this setting is closer
                     {
@@ -137,13 +118,13 @@ ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Con
         }
 
         // If we found a suitable setting, return it
-        if (idxClosestScheduled != c_idxNotSet)
+        if (idxClosestScheduled != sc_idxNotSet)
         {
             return ThermostatSetpoint(*pvThermostatSettings->Get(idxClosestScheduled));
         }
 
         // We may be at the beginning of the week - use the latest setting in the week if available
-        if (idxLatestScheduled != c_idxNotSet)
+        if (idxLatestScheduled != sc_idxNotSet)
         {
             return ThermostatSetpoint(*pvThermostatSettings->Get(idxLatestScheduled));
         }
@@ -153,6 +134,260 @@ ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(Con
     return ThermostatSetpoint();
 }
 
+ThermostatSetpoint ThermostatSetpointScheduler::getCurrentThermostatSetpoint(
+    Configuration const& Configuration,
+    RecoveryRateEstimator const& RecoveryRateEstimator,
+    float CurrentTemperature)
+{
+    ThermostatSetpoint const currentThermostatSetpoint = getCurrentThermostatSetpoint(Configuration);
+
+    uint16_t const maximumEarlyStart = Configuration.rootConfiguration().maximumEarlyStart();  // minutes
+
+    if (!maximumEarlyStart)
+    {
+        // Early start disabled
+        m_idxEarlyStartSetting = sc_idxNotSet;
+        return currentThermostatSetpoint;
+    }
+
+    uint32_t const timeNow = Time.now();  // seconds since UTC epoch
+
+    if (isHoldOverrideActive(timeNow) || (getActiveHoldIndex(Configuration, timeNow) != sc_idxNotSet))
+    {
+        // Holds trump schedules
+        m_idxEarlyStartSetting = sc_idxNotSet;
+        return currentThermostatSetpoint;
+    }
+
+    uint16_t minutesUntilNextScheduled = 0;
+    uint32_t const idxNextScheduled = getNextScheduledIndex(Configuration, timeNow, minutesUntilNextScheduled);
+
+    if (idxNextScheduled == sc_idxNotSet)
+    {
+        // Nothing coming up
+        m_idxEarlyStartSetting = sc_idxNotSet;
+        return currentThermostatSetpoint;
+    }
+
+    ThermostatSetpoint const nextThermostatSetpoint(
+        *Configuration.rootConfiguration().thermostatSettings()->Get(idxNextScheduled));
+
+    // (Stable across calls for the same upcoming setting, given minute granularity of schedules)
+    uint32_t const nextScheduledTime = (timeNow - timeNow % 60) + minutesUntilNextScheduled * 60;
+
+    if ((m_idxEarlyStartSetting == idxNextScheduled) && (m_EarlyStartScheduledTime == nextScheduledTime))
+    {
+        // Early start already underway, stick with it until the schedule catches up
+        // (at which point the next setting becomes the current one and the latch lapses by itself)
+        return nextThermostatSetpoint;
+    }
+
+    m_idxEarlyStartSetting = sc_idxNotSet;
+
+    if (minutesUntilNextScheduled > maximumEarlyStart)
+    {
+        // Nothing coming up soon enough to consider
+        return currentThermostatSetpoint;
+    }
+
+    float const requiredRecoveryTime_minutes =
+        RecoveryRateEstimator.RequiredRecoveryTime_minutes(nextThermostatSetpoint, CurrentTemperature);
+
+    if (requiredRecoveryTime_minutes < minutesUntilNextScheduled)
+    {
+        // Still time to get there on schedule
+        return currentThermostatSetpoint;
+    }
+
+    WAF_LOG_INFO("Starting recovery to next setpoint %u minutes early (estimated %.0f minutes required)",
+                 minutesUntilNextScheduled,
+                 requiredRecoveryTime_minutes);
+
+    m_idxEarlyStartSetting = idxNextScheduled;
+    m_EarlyStartScheduledTime = nextScheduledTime;
+
+    return nextThermostatSetpoint;
+}
+
+ThermostatSetpoint ThermostatSetpointScheduler::getTimeIndependentThermostatSetpoint(
+    Configuration const& Configuration) const
+{
+    auto const pvThermostatSettings = Configuration.rootConfiguration().thermostatSettings();
+
+    if (!pvThermostatSettings)
+    {
+        // Return empty (inactive) setpoint
+        return ThermostatSetpoint();
+    }
+
+    uint32_t idxLowestHeat = sc_idxNotSet;
+    float lowestSetPointHeat = 0.0f;
+
+    for (uint32_t idxSetting = 0; idxSetting < pvThermostatSettings->size(); ++idxSetting)
+    {
+        auto const& thermostatSetting = *pvThermostatSettings->Get(idxSetting);
+
+        if (!isSettingSelected(idxSetting) || !(thermostatSetting.allowedActions() & ThermostatAction::Heat))
+        {
+            continue;
+        }
+
+        float const setPointHeat = Configuration::getTemperature(thermostatSetting.setPointHeat_x100());
+
+        if (idxLowestHeat == sc_idxNotSet || setPointHeat < lowestSetPointHeat)
+        {
+            idxLowestHeat = idxSetting;
+            lowestSetPointHeat = setPointHeat;
+        }
+    }
+
+    if (idxLowestHeat == sc_idxNotSet)
+    {
+        // Return empty (inactive) setpoint
+        return ThermostatSetpoint();
+    }
+
+    ThermostatSetpoint thermostatSetpoint(*pvThermostatSettings->Get(idxLowestHeat));
+    thermostatSetpoint.AllowedActions = ThermostatAction::Heat;
+
+    return thermostatSetpoint;
+}
+
+uint32_t ThermostatSetpointScheduler::getActiveHoldIndex(Configuration const& Configuration,
+                                                         uint32_t const timeNow) const
+{
+    auto const pvThermostatSettings = Configuration.rootConfiguration().thermostatSettings();
+
+    uint32_t idxEarliestHoldUntil = sc_idxNotSet;
+
+    if (!pvThermostatSettings)
+    {
+        return idxEarliestHoldUntil;
+    }
+
+    for (uint32_t idxSetting = 0; idxSetting < pvThermostatSettings->size(); ++idxSetting)
+    {
+        auto const& thermostatSetting = *pvThermostatSettings->Get(idxSetting);
+
+        if (!isSettingSelected(idxSetting))
+        {
+            // Not for this zone
+            continue;
+        }
+
+        if (thermostatSetting.type() != ThermostatSettingType::Hold)
+        {
+            // Not a hold
+            continue;
+        }
+
+        if (thermostatSetting.holdUntil() < timeNow)
+        {
+            // No longer valid
+            continue;
+        }
+
+        if (idxEarliestHoldUntil == sc_idxNotSet)
+        {
+            // There's no better (earlier) setting yet, adopt this one
+            idxEarliestHoldUntil = idxSetting;
+            continue;
+        }
+
+        if (thermostatSetting.holdUntil() < pvThermostatSettings->Get(idxEarliestHoldUntil)->holdUntil())
+        {
+            // This setting is earlier, adopt it
+            idxEarliestHoldUntil = idxSetting;
+        }
+    }
+
+    return idxEarliestHoldUntil;
+}
+
+uint32_t ThermostatSetpointScheduler::getNextScheduledIndex(Configuration const& Configuration,
+                                                            uint32_t const timeNow,
+                                                            uint16_t& minutesUntilNextScheduled) const
+{
+    auto const pvThermostatSettings = Configuration.rootConfiguration().thermostatSettings();
+
+    uint32_t idxNextScheduled = sc_idxNotSet;
+    minutesUntilNextScheduled = 0;
+
+    if (!pvThermostatSettings)
+    {
+        return idxNextScheduled;
+    }
+
+    uint16_t constexpr c_MinutesPerWeek = 7 * 24 * 60;
+    uint16_t const currentMinutesSinceStartOfWeek = LocalTime::GetMinutesSinceStartOfWeek(Configuration, timeNow);
+
+    for (uint32_t idxSetting = 0; idxSetting < pvThermostatSettings->size(); ++idxSetting)
+    {
+        auto const& thermostatSetting = *pvThermostatSettings->Get(idxSetting);
+
+        if (!isSettingSelected(idxSetting))
+        {
+            // Not for this zone
+            continue;
+        }
+
+        if (thermostatSetting.type() != ThermostatSettingType::Scheduled)
+        {
+            // Not a scheduled setting
+            continue;
+        }
+
+        for (uint8_t idxDayOfWeekEnum = 0; idxDayOfWeekEnum < 7; ++idxDayOfWeekEnum)
+        {
+            DaysOfWeek const settingDayOfWeek = Flatbuffers::Firmware::EnumValuesDaysOfWeek()[idxDayOfWeekEnum];
+
+            if (!(settingDayOfWeek & thermostatSetting.daysOfWeek()))
+            {
+                continue;
+            }
+
+            uint16_t const settingAtMinutesSinceStartOfWeek =
+                thermostatSetting.atMinutesSinceMidnight() + (getScalarDayOfWeek(settingDayOfWeek) - 1) * (24 * 60);
+
+            // Strictly after now, wrapping around the end of the week
+            uint16_t const minutesUntilSetting =
+                (settingAtMinutesSinceStartOfWeek + c_MinutesPerWeek - currentMinutesSinceStartOfWeek) %
+                c_MinutesPerWeek;
+
+            if (minutesUntilSetting == 0)
+            {
+                // That's the current setting
+                continue;
+            }
+
+            if ((idxNextScheduled == sc_idxNotSet) || (minutesUntilSetting < minutesUntilNextScheduled))
+            {
+                // Adopt this one
+                idxNextScheduled = idxSetting;
+                minutesUntilNextScheduled = minutesUntilSetting;
+            }
+        }
+    }
+
+    return idxNextScheduled;
+}
+
+bool ThermostatSetpointScheduler::isHoldOverrideActive(uint32_t const timeNow) const
+{
+    return m_pHoldOverride && m_pHoldOverride->IsActive(timeNow);
+}
+
+bool ThermostatSetpointScheduler::isSettingSelected(uint32_t const idxSetting) const
+{
+    if (!m_ThermostatSettingsMask)
+    {
+        // All settings selected
+        return true;
+    }
+
+    return (idxSetting < 32) && !!(m_ThermostatSettingsMask & (1UL << idxSetting));
+}
+
 uint8_t ThermostatSetpointScheduler::getScalarDayOfWeek(DaysOfWeek const dayOfWeek) const
 {
     switch (dayOfWeek)
@@ -172,7 +407,7 @@ uint8_t ThermostatSetpointScheduler::getScalarDayOfWeek(DaysOfWeek const dayOfWe
         case DaysOfWeek::Saturday:
             return 7;
         default:
-            Serial.printlnf("!! Unrecognized day of week %u", static_cast<int>(dayOfWeek));
+            WAF_LOG_WARNING("!! Unrecognized day of week %u", static_cast<int>(dayOfWeek));
             return 1;
     }
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+//
+// Hands acquisitions off between the control thread (i.e. the app thread running loop()) and a dedicated
+// acquisition thread that owns all sensor I/O (c.f. Main.cpp#acquisitionThread()), so the control thread
+// never blocks on a sensor:
+//
+// - The control thread requests acquisitions when LoopScheduler says they're due and receives completed readings
+//   (timestamped by the acquisition thread) on a later pass.
+// - The acquisition thread services requests one at a time, filling readings in place in the outbound queue.
+//
+// Both directions are lock-free single-producer/single-consumer queues (c.f. SPSCQueue). A request is only
+// retired once its readings have been handed off, so IsAcquiring() tells the control thread whether sensor I/O
+// may be underway (which flash maintenance must stay clear of, c.f. MaintenanceScheduler).
+//
+
+template <typename TRequest, typename TReadings, uint8_t c_cReadings_Max = 2>
+class AcquisitionChannel
+{
+public:
+    static uint8_t constexpr sc_cRequests_Max = 2;
+
+public:
+    AcquisitionChannel()
+        : m_Requests()
+        , m_Readings()
+    {
+    }
+
+    AcquisitionChannel(AcquisitionChannel const&) = delete;
+    AcquisitionChannel& operator=(AcquisitionChannel const&) = delete;
+
+public:
+    //
+    // Control thread
+    //
+
+    // @returns false if too many requests are outstanding already (i.e. the acquisition thread is falling behind)
+    bool Request(TRequest const& request)
+    {
+        return m_Requests.push(request);
+    }
+
+    // @returns false if no readings have come in since the last call
+    bool Receive(TReadings& readings)
+    {
+        return m_Readings.pop(readings);
+    }
+
+    bool HasReadings() const
+    {
+        return !m_Readings.empty();
+    }
+
+    bool IsAcquiring() const
+    {
+        return !m_Requests.empty();
+    }
+
+    //
+    // Acquisition thread
+    //
+
+    // Services the oldest outstanding request (if any) through acquire(TRequest const&, TReadings&)
+    // @returns whether a request was serviced
+    template <typename TAcquire>
+    bool Service(TAcquire&& acquire)
+    {
+        TRequest const* const pRequest = m_Requests.front();
+
+        if (!pRequest)
+        {
+            return false;
+        }
+
+        TReadings* const pReadings = m_Readings.prepare_push();
+
+        if (!pReadings)
+        {
+            // Control thread hasn't caught up with previous readings yet; leave the request outstanding
+            return false;
+        }
+
+        acquire(*pRequest, *pReadings);
+
+        m_Readings.commit_push();
+        m_Requests.pop();
+
+        return true;
+    }
+
+private:
+    SPSCQueue<TRequest, sc_cRequests_Max> m_Requests;  // Control thread -> acquisition thread
+    SPSCQueue<TReadings, c_cReadings_Max> m_Readings;  // Acquisition thread -> control thread
+};
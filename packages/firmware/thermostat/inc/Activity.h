@@ -7,21 +7,13 @@ public:
         : m_szName(szName)
         , m_StartTime_msec(millis())
     {
-        WITH_LOCK(Serial)
-        {
-            Serial.printlnf(">> %s (SSID: %s)", m_szName, getSSID());
-        }
+        WAF_LOG_TRACE(">> %s (SSID: %s)", m_szName, getSSID());
     }
 
     ~Activity()
     {
-        unsigned long const endTime_msec = millis();
-        unsigned long const duration_msec = endTime_msec - m_StartTime_msec;
-
-        WITH_LOCK(Serial)
-        {
-            Serial.printlnf("<< %s (%lu msec) (SSID: %s)", m_szName, duration_msec, getSSID());
-        }
+        // (Carefully phrased to deal with rollovers)
+        WAF_LOG_TRACE("<< %s (%lu msec) (SSID: %s)", m_szName, millis() - m_StartTime_msec, getSSID());
     }
 
 private:
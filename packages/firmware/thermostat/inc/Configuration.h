@@ -34,6 +34,8 @@ public:
     Configuration()
         : m_Data()
         , m_pConfiguration()
+        , m_Hash()
+        , m_fHasUnsavedData()
         , m_cbPendingData()
         , m_rgPendingData()
         , m_UpdateMutex()
@@ -57,6 +59,13 @@ public:
         return *m_pConfiguration;
     }
 
+    // Identifies the active configuration to the cloud so unchanged configurations needn't be sent back
+    // (c.f. //packages/api/src/webhooks/particle/status/index.ts)
+    uint32_t Hash() const
+    {
+        return m_Hash;
+    }
+
     static float getTemperature(uint16_t const temperature_x100)
     {
         return temperature_x100 / 100.0f;
@@ -71,7 +80,9 @@ public:
     // Operations
     //
 
-    void Initialize()
+    // @param verifiedHash: hash of a configuration that has passed verification before (c.f. RetainedState),
+    //                      letting a matching stored configuration skip verification at boot; zero if none
+    void Initialize(uint32_t const verifiedHash = 0)
     {
         // Load header from EEPROM
         EEPROM.get(sc_EEPROMAddress, m_Data);
@@ -90,13 +101,15 @@ public:
             LoadDefaults();
         }
 
-        // Payload checks
+        // Payload checks (unless we've verified this very data before)
+        m_Hash = ComputeHash(m_Data.rgFlatbufferData, m_Data.cbFlatbufferData);
+
+        bool const fIsVerified = verifiedHash && (m_Hash == verifiedHash);
+
+        if (!fIsVerified && !IsValidFlatbuffer(m_Data.rgFlatbufferData, m_Data.cbFlatbufferData))
         {
-            flatbuffers::Verifier verifier(m_Data.rgFlatbufferData, m_Data.cbFlatbufferData);
-            if (!Flatbuffers::Firmware::VerifyThermostatConfigurationBuffer(verifier))
-            {
-                LoadDefaults();
-            }
+            LoadDefaults();
+            m_Hash = ComputeHash(m_Data.rgFlatbufferData, m_Data.cbFlatbufferData);
         }
 
         // Mount Flatbuffer data for reading
@@ -123,15 +136,14 @@ public:
 
         if (!cbPendingData)
         {
-            Serial.println("!! Z85::Decode rejected configuration text");
+            WAF_LOG_WARNING("!! Z85::Decode rejected configuration text");
             return ConfigUpdateResult::Invalid;
         }
 
         // Validate flatbuffer
-        flatbuffers::Verifier verifier(m_rgPendingData, cbPendingData);
-        if (!Flatbuffers::Firmware::VerifyThermostatConfigurationBuffer(verifier))
+        if (!IsValidFlatbuffer(m_rgPendingData, cbPendingData))
         {
-            Serial.println("!! Couldn't verify new configuration flatbuffer");
+            WAF_LOG_WARNING("!! Couldn't verify new configuration flatbuffer");
             return ConfigUpdateResult::Invalid;
         }
 
@@ -162,11 +174,12 @@ public:
         memcpy(m_Data.rgFlatbufferData, m_rgPendingData, m_cbPendingData);
         m_Data.cbFlatbufferData = m_cbPendingData;
 
-        // Persist data
-        EEPROM.put(sc_EEPROMAddress, m_Data);
+        // Persist data later (c.f. SaveData())
+        m_fHasUnsavedData = true;
 
         // Re-mount Flatbuffer data for reading
         m_pConfiguration = Flatbuffers::Firmware::GetThermostatConfiguration(m_Data.rgFlatbufferData);
+        m_Hash = ComputeHash(m_Data.rgFlatbufferData, m_Data.cbFlatbufferData);
 
         // Clear pending data
         m_cbPendingData = 0;
@@ -181,10 +194,121 @@ public:
         return !!m_cbPendingData;
     }
 
+    // Accepted configurations take effect right away but are only written out by SaveData(), which callers defer
+    // to when the write can't hold up control (c.f. MaintenanceScheduler) since writes can stall on flash page erases.
+    // (Should we reset before then, we'll boot with the previous configuration and be sent the latest one again.)
+    bool HasUnsavedData() const
+    {
+        return m_fHasUnsavedData;
+    }
+
+    void SaveData()
+    {
+        EEPROM.put(sc_EEPROMAddress, m_Data);
+        m_fHasUnsavedData = false;
+    }
+
+    //
+    // Validation
+    //
+    // Configuration updates are ingested on the system thread for every status response and config push,
+    // so the cost of rejecting adversarial input is bounded by the decode buffer's size (sc_cbFlatbufferData_Max)
+    // and by verifier limits tuned to our schema rather than flatbuffers' generous defaults:
+    // - ThermostatConfiguration is our only table (everything else is structs), so there's no nesting.
+    //   (The verifier doesn't visit fields it doesn't know, so newer schemas with nested tables still verify.)
+    // - Vectors can't have more elements than the firmware can make use of.
+    // - Zones can't drive relays off pins the device uses for something else, nor share relay pins.
+    //
+
+    // Sized to what the cloud can deliver in one go (a status response or config push, c.f. handleUpdatedConfig()):
+    // of Particle's 622 chars of event data, quotes and magic ("3Z85") take 2 + 4, leaving 616 chars,
+    // i.e. 123 whole Z85 frames of 5 chars each, which decode to 4 bytes apiece: 492 bytes.
+    static constexpr uint16_t sc_cchConfigEventData_Max = 622;
+    static constexpr uint16_t sc_cbFlatbufferData_Max = (sc_cchConfigEventData_Max - 2 - 4) / 5 * 4;
+
+    static constexpr uint32_t sc_VerifierDepth_Max = 1;
+    static constexpr uint32_t sc_VerifierTables_Max = 1;
+
+    // Smallest overhead around a vector's elements: root offset, empty vtable, table offset, offset to the vector,
+    // and the vector's length (i.e. limits past what fits in the buffer with just that overhead are unreachable)
+    static constexpr uint32_t sc_cbVectorOverhead_Min = 5 * sizeof(uint32_t);
+    static constexpr uint32_t sc_cbVectorElements_Max = sc_cbFlatbufferData_Max - sc_cbVectorOverhead_Min;
+
+    static constexpr uint32_t sc_cThermostatSettings_Max =
+        // c.f. ZoneConfiguration::thermostatSettingsMask
+        (sc_cbVectorElements_Max / sizeof(Flatbuffers::Firmware::ThermostatSetting) < 32)
+            ? sc_cbVectorElements_Max / sizeof(Flatbuffers::Firmware::ThermostatSetting)
+            : 32;
+    static constexpr uint32_t sc_cSensorFusionInputs_Max = 17;  // Onboard sensor + 16 OneWire devices
+    static constexpr uint32_t sc_cZones_Max = 4;
+    static constexpr uint32_t sc_cTimezoneTransitions_Max = 4;  // About a year's worth of DST changes
+
+    static_assert(sc_cSensorFusionInputs_Max * sizeof(Flatbuffers::Firmware::SensorFusionInput) <=
+                      sc_cbVectorElements_Max,
+                  "Sensor fusion input limit unreachable within configuration buffer");
+    static_assert(sc_cZones_Max * sizeof(Flatbuffers::Firmware::ZoneConfiguration) <= sc_cbVectorElements_Max,
+                  "Zone limit unreachable within configuration buffer");
+    static_assert(sc_cTimezoneTransitions_Max * sizeof(Flatbuffers::Firmware::TimezoneTransition) <=
+                      sc_cbVectorElements_Max,
+                  "Timezone transition limit unreachable within configuration buffer");
+
+    static bool IsValidFlatbuffer(uint8_t const* const rgData, uint16_t const cbData)
+    {
+        flatbuffers::Verifier verifier(rgData, cbData, sc_VerifierDepth_Max, sc_VerifierTables_Max);
+
+        if (!Flatbuffers::Firmware::VerifyThermostatConfigurationBuffer(verifier))
+        {
+            return false;
+        }
+
+        auto const& rootConfiguration = *Flatbuffers::Firmware::GetThermostatConfiguration(rgData);
+
+        return isWithinLimit(rootConfiguration.thermostatSettings(), sc_cThermostatSettings_Max) &&
+               isWithinLimit(rootConfiguration.sensorFusionInputs(), sc_cSensorFusionInputs_Max) &&
+               isWithinLimit(rootConfiguration.zones(), sc_cZones_Max) &&
+               isWithinLimit(rootConfiguration.timezoneTransitions(), sc_cTimezoneTransitions_Max) &&
+               hasValidRelayPins(rootConfiguration.zones());
+    }
+
+    // Pins the device uses itself (c.f. Main.cpp), which relays can't be assigned to
+    static bool IsReservedPin(uint8_t const pin)
+    {
+        switch (pin)
+        {
+            case D0:  // I2C SDA to the OneWire gateway
+            case D1:  // I2C SCL to the OneWire gateway
+            case D2:  // Onboard DHT22 sensor
+            case D6:  // Wake-up pin (c.f. LowPowerSleep)
+            case D7:  // Onboard LED
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    // Configured pin number for relays that aren't connected (c.f. ZoneConfiguration)
+    static constexpr uint8_t sc_RelayPin_NotConnected = 255;
+
+    // 32-bit FNV-1a over flatbuffer data as decoded from Z85 (i.e. zero-padded to a multiple of four bytes)
+    // (c.f. //packages/api/src/shared/firmware/thermostatConfigurationAdapter.ts#firmwareHashFromBytes)
+    static uint32_t ComputeHash(uint8_t const* const rgData, uint16_t const cbData)
+    {
+        uint32_t hash = 0x811C9DC5;
+
+        for (uint16_t idxData = 0; idxData < cbData; ++idxData)
+        {
+            hash = (hash ^ rgData[idxData]) * 0x01000193;
+        }
+
+        return hash;
+    }
+
     //
     // Debugging
     //
 
+    // (Writes the log out as it goes: a full configuration's dump exceeds DeferredLog's buffer)
     void PrintConfiguration() const
     {
         char szExternalSensorId[OneWireAddress::sc_cchAsHexString_WithTerminator];
@@ -192,31 +316,147 @@ public:
 
         externalSensorId.ToString(szExternalSensorId);
 
-        Serial.printlnf(
-            "Threshold = +/-%.1f C, Cadence = %u sec, ExternalSensorId = %s, Timezone UTC offset %d/%d pre/post %u",
+        WAF_LOG_INFO(
+            "Threshold = +/-%.1f C, Cadence = %u sec, PublishCadence = %u sec, ExternalSensorId = %s, Timezone UTC "
+            "offset %d/%d pre/post %u",
             Configuration::getTemperature(rootConfiguration().threshold_x100()),
             rootConfiguration().cadence(),
+            rootConfiguration().publishCadence(),
             szExternalSensorId,
             rootConfiguration().currentTimezoneUTCOffset(),
             rootConfiguration().nextTimezoneUTCOffset(),
             rootConfiguration().nextTimezoneChange());
 
+        auto const pvTimezoneTransitions = rootConfiguration().timezoneTransitions();
+
+        if (pvTimezoneTransitions)
+        {
+            for (auto const pTimezoneTransition : *pvTimezoneTransitions)
+            {
+                WAF_LOG_INFO("  Timezone UTC offset %d from %lu",
+                             pTimezoneTransition->utcOffset(),
+                             static_cast<unsigned long>(pTimezoneTransition->at()));
+                DeferredLog::Instance().Drain();
+            }
+        }
+
+        if (rootConfiguration().controlMode() == ControlMode::TimeProportional)
+        {
+            WAF_LOG_INFO("Time-proportional control: Kp = %.2f /C, Ki = %.2f /C/h, window = %u sec",
+                         rootConfiguration().proportionalGain_x100() / 100.0f,
+                         rootConfiguration().integralGain_x100() / 100.0f,
+                         rootConfiguration().controlCycleWindow());
+        }
+
+        auto const pvZones = rootConfiguration().zones();
+
+        if (pvZones)
+        {
+            for (uint32_t idxZone = 0; idxZone < pvZones->size(); ++idxZone)
+            {
+                auto const& zoneConfiguration = *pvZones->Get(idxZone);
+
+                switch (zoneConfiguration.controlMode())
+                {
+                    case ZoneControlMode::Hysteresis:
+                        WAF_LOG_INFO("Zone %u: hysteresis control", static_cast<unsigned int>(idxZone));
+                        break;
+
+                    case ZoneControlMode::TimeProportional:
+                        WAF_LOG_INFO(
+                            "Zone %u: time-proportional control, Kp = %.2f /C, Ki = %.2f /C/h, window = %u sec",
+                            static_cast<unsigned int>(idxZone),
+                            zoneConfiguration.proportionalGain_x100() / 100.0f,
+                            zoneConfiguration.integralGain_x100() / 100.0f,
+                            zoneConfiguration.controlCycleWindow());
+                        break;
+
+                    default:
+                        break;
+                }
+
+                DeferredLog::Instance().Drain();
+            }
+        }
+
+        WAF_LOG_INFO("Short-cycle protection: minimum run %u sec, minimum off %u sec, changeover dead time %u sec",
+                     rootConfiguration().minimumRunTime(),
+                     rootConfiguration().minimumOffTime(),
+                     rootConfiguration().changeoverDeadTime());
+
+        WAF_LOG_INFO("Early start: up to %u min", rootConfiguration().maximumEarlyStart());
+
+        if (rootConfiguration().lowPowerSleep())
+        {
+            WAF_LOG_INFO("Low-power sleep in between tasks");
+        }
+
+        if (rootConfiguration().dehumidifyAboveDewPoint_x100())
+        {
+            WAF_LOG_INFO("Dehumidify by cooling above dew point %.1f C",
+                         Configuration::getTemperature(rootConfiguration().dehumidifyAboveDewPoint_x100()));
+        }
+
+        switch (rootConfiguration().sensorFilterType())
+        {
+            case SensorFilterType::ExponentialMovingAverage:
+                WAF_LOG_INFO("Sensor filter: EMA, smoothing %.2f",
+                             rootConfiguration().sensorFilterSmoothing_x100() / 100.0f);
+                break;
+
+            case SensorFilterType::Kalman:
+                WAF_LOG_INFO("Sensor filter: Kalman, process noise %.4f C^2, measurement noise %.4f C^2",
+                             rootConfiguration().sensorFilterProcessNoise_x10000() / 10000.0f,
+                             rootConfiguration().sensorFilterMeasurementNoise_x10000() / 10000.0f);
+                break;
+
+            default:
+                break;
+        }
+
+        auto const pvSensorFusionInputs = rootConfiguration().sensorFusionInputs();
+
+        if (pvSensorFusionInputs && pvSensorFusionInputs->size() > 0)
+        {
+            WAF_LOG_INFO("Sensor fusion (%s):",
+                         rootConfiguration().sensorFusionMethod() == SensorFusionMethod::TrimmedMean
+                             ? "trimmed mean"
+                             : "weighted median");
+
+            for (auto const pSensorFusionInput : *pvSensorFusionInputs)
+            {
+                char szSensorId[OneWireAddress::sc_cchAsHexString_WithTerminator];
+                OneWireAddress(pSensorFusionInput->sensorId()).ToString(szSensorId);
+
+                WAF_LOG_INFO("  %s: weight %u",
+                             pSensorFusionInput->sensorId() ? szSensorId : "onboard",
+                             pSensorFusionInput->weight());
+                DeferredLog::Instance().Drain();
+            }
+        }
+
         auto const pvThermostatSettings = rootConfiguration().thermostatSettings();
 
         if (pvThermostatSettings)
         {
             for (auto const pThermostatSetting : *pvThermostatSettings)
             {
+                // Describe when the setting applies
+                char szApplicability[48];
+
                 switch (pThermostatSetting->type())
                 {
                     case ThermostatSettingType::Hold: {
-                        Serial.print("  Hold: ");
-                        Serial.printf("until %lu", pThermostatSetting->holdUntil());
+                        snprintf(szApplicability,
+                                 sizeof(szApplicability),
+                                 "Hold: until %lu",
+                                 static_cast<unsigned long>(pThermostatSetting->holdUntil()));
                         break;
                     }
 
                     case ThermostatSettingType::Scheduled: {
-                        Serial.print("  Scheduled: ");
+                        // (Bounded: "Scheduled: " + seven three-letter days + " at hh:mm" fits the buffer)
+                        size_t cchApplicability = snprintf(szApplicability, sizeof(szApplicability), "Scheduled: ");
 
                         DaysOfWeek const daysOfWeek = pThermostatSetting->daysOfWeek();
 
@@ -225,26 +465,37 @@ public:
                             DaysOfWeek const dayOfWeek = Flatbuffers::Firmware::EnumValuesDaysOfWeek()[idxEnumBit];
                             if (!!(daysOfWeek & dayOfWeek))
                             {
-                                Serial.printf("%.3s", Flatbuffers::Firmware::EnumNameDaysOfWeek(dayOfWeek));
+                                cchApplicability += snprintf(szApplicability + cchApplicability,
+                                                             sizeof(szApplicability) - cchApplicability,
+                                                             "%.3s",
+                                                             Flatbuffers::Firmware::EnumNameDaysOfWeek(dayOfWeek));
                             }
                         }
 
                         uint16_t const atMinutesSinceMidnight = pThermostatSetting->atMinutesSinceMidnight();
-                        Serial.printf(" at %02u:%02u", atMinutesSinceMidnight / 60, atMinutesSinceMidnight % 60);
+                        snprintf(szApplicability + cchApplicability,
+                                 sizeof(szApplicability) - cchApplicability,
+                                 " at %02u:%02u",
+                                 atMinutesSinceMidnight / 60,
+                                 atMinutesSinceMidnight % 60);
                         break;
                     }
 
                     default: {
-                        Serial.printf("  UnknownSettingType(%u)", pThermostatSetting->type());
+                        snprintf(szApplicability,
+                                 sizeof(szApplicability),
+                                 "UnknownSettingType(%u)",
+                                 static_cast<unsigned int>(pThermostatSetting->type()));
                         break;
                     }
                 }
 
                 ThermostatAction const allowedActions = pThermostatSetting->allowedActions();
 
-                Serial.printlnf(
-                    ": %.1f C (heat), %.1f C (cool), %.1f C / %.1f C (circulate above/below), AllowedActions = "
+                WAF_LOG_INFO(
+                    "  %s: %.1f C (heat), %.1f C (cool), %.1f C / %.1f C (circulate above/below), AllowedActions = "
                     "[%c%c%c]",
+                    szApplicability,
                     Configuration::getTemperature(pThermostatSetting->setPointHeat_x100()),
                     Configuration::getTemperature(pThermostatSetting->setPointCool_x100()),
                     Configuration::getTemperature(pThermostatSetting->setPointCirculateAbove_x100()),
@@ -252,6 +503,7 @@ public:
                     !!(allowedActions & Flatbuffers::Firmware::ThermostatAction::Heat) ? 'H' : '_',
                     !!(allowedActions & Flatbuffers::Firmware::ThermostatAction::Cool) ? 'C' : '_',
                     !!(allowedActions & Flatbuffers::Firmware::ThermostatAction::Circulate) ? 'R' : '_');
+                DeferredLog::Instance().Drain();
             }
         }
     }
@@ -272,11 +524,9 @@ private:
         }
 
         static constexpr uint16_t sc_Signature = 0x8233;
-        static constexpr uint16_t sc_CurrentVersion = 4;
+        static constexpr uint16_t sc_CurrentVersion = 7;
     };
 
-    static constexpr uint16_t sc_cbFlatbufferData_Max = 256;
-
     struct ConfigurationData
     {
         ConfigurationHeader Header;
@@ -303,41 +553,91 @@ private:
     // Readable state
     ConfigurationData m_Data;
     Flatbuffers::Firmware::ThermostatConfiguration const* m_pConfiguration;
+    uint32_t m_Hash;
+    bool m_fHasUnsavedData;
 
     // Pending (to be ingested and written out) state
     uint16_t m_cbPendingData;
-    uint8_t m_rgPendingData[sc_cbFlatbufferData_Max];
+    alignas(alignof(uint64_t)) uint8_t m_rgPendingData[sc_cbFlatbufferData_Max];  // c.f. rgFlatbufferData
 
     // Protects pending state (readable state is always good to read)
     mutable Mutex m_UpdateMutex;
 
 private:
-    void LoadDefaults()
+    template <typename TVector>
+    static bool isWithinLimit(TVector const* const pVector, uint32_t const cElements_Max)
     {
-        Serial.println("-- Resetting configuration to defaults");
+        return !pVector || pVector->size() <= cElements_Max;
+    }
 
-        // Build flatbuffer with default values
-        flatbuffers::FlatBufferBuilder flatbufferBuilder(sizeof(m_Data.rgFlatbufferData));
+    // (Expects zones to be within sc_cZones_Max)
+    template <typename TVector>
+    static bool hasValidRelayPins(TVector const* const pvZones)
+    {
+        if (!pvZones)
         {
-            auto const rootConfiguration = Flatbuffers::Firmware::CreateThermostatConfiguration(flatbufferBuilder);
-            Flatbuffers::Firmware::FinishThermostatConfigurationBuffer(flatbufferBuilder, rootConfiguration);
+            return true;
         }
 
-        // Verify size and casting limits
-        if (flatbufferBuilder.GetSize() > sizeof(m_Data.rgFlatbufferData))
+        uint8_t rgRelayPins[sc_cZones_Max * 3];
+        size_t cRelayPins = 0;
+
+        for (uint32_t idxZone = 0; idxZone < pvZones->size(); ++idxZone)
         {
-            Serial.printlnf("Default configuration size of %u exceeds limits. Bailing.", flatbufferBuilder.GetSize());
+            auto const& zoneConfiguration = *pvZones->Get(idxZone);
+
+            for (uint8_t const relayPin : {zoneConfiguration.relayPinHeat(),
+                                           zoneConfiguration.relayPinSwitchOver(),
+                                           zoneConfiguration.relayPinCirculate()})
+            {
+                if (relayPin == sc_RelayPin_NotConnected)
+                {
+                    continue;
+                }
+
+                if (IsReservedPin(relayPin))
+                {
+                    WAF_LOG_WARNING("!! Zone %u relay assigned to reserved pin %u", idxZone, relayPin);
+                    return false;
+                }
 
-            delay(60 * 1000);
-            System.reset();
+                for (size_t idxRelayPin = 0; idxRelayPin < cRelayPins; ++idxRelayPin)
+                {
+                    if (rgRelayPins[idxRelayPin] == relayPin)
+                    {
+                        WAF_LOG_WARNING("!! Zone %u relay pin %u already in use", idxZone, relayPin);
+                        return false;
+                    }
+                }
+
+                rgRelayPins[cRelayPins++] = relayPin;
+            }
         }
 
+        return true;
+    }
+
+    void LoadDefaults()
+    {
+        WAF_LOG_INFO("-- Resetting configuration to defaults");
+
+        // Prebuilt flatbuffer with default values, i.e. an empty root table, as FlatBufferBuilder would lay it out
+        // (saves building it, and the builder's heap allocations, on the boot path)
+        static constexpr uint8_t rgDefaultFlatbufferData[] = {
+            0x0C, 0x00, 0x00, 0x00,  // Offset to root table
+            'W',  'A',  'F',  '3',   // File identifier (c.f. firmware.fbs)
+            0x04, 0x00, 0x04, 0x00,  // vtable: vtable size, table size (no fields)
+            0x04, 0x00, 0x00, 0x00,  // Root table: offset back to vtable
+        };
+
+        static_assert(sizeof(rgDefaultFlatbufferData) <= sc_cbFlatbufferData_Max, "Default configuration too large");
+
         // Commit data to RAM
         m_Data.Header.Signature = ConfigurationHeader::sc_Signature;
         m_Data.Header.Version = ConfigurationHeader::sc_CurrentVersion;
 
-        memcpy(m_Data.rgFlatbufferData, flatbufferBuilder.GetBufferPointer(), flatbufferBuilder.GetSize());
-        m_Data.cbFlatbufferData = static_cast<uint16_t>(flatbufferBuilder.GetSize());
+        memcpy(m_Data.rgFlatbufferData, rgDefaultFlatbufferData, sizeof(rgDefaultFlatbufferData));
+        m_Data.cbFlatbufferData = sizeof(rgDefaultFlatbufferData);
 
         // Don't bother committing default data to EEPROM
         // - we'll just overwrite it when we get an updated configuration or reload defaults on the next power cycle.
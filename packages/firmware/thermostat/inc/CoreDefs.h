@@ -28,3 +28,9 @@ constexpr T const& clamp(T const& value, T const& low, T const& high)
 {
     return (value < low) ? low : (high < value) ? high : value;
 }
+
+// Smallest power of two that's at least value
+constexpr std::size_t roundUpToPowerOfTwo(std::size_t const value, std::size_t const powerOfTwo = 1) noexcept
+{
+    return (powerOfTwo >= value) ? powerOfTwo : roundUpToPowerOfTwo(value, 2 * powerOfTwo);
+}
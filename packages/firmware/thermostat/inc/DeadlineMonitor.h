@@ -0,0 +1,323 @@
+#pragma once
+
+//
+// Bounds how long each stage of the main loop may take, and gates the hardware watchdog
+// (c.f. Main.cpp#serviceWatchdog()) on every stage having met its deadline:
+//
+// - Stages on the control thread are bracketed by Begin()/End() (c.f. Scope).
+// - Acquisitions run on the acquisition thread; the control thread times them from request to receipt and checks
+//   on them while they're outstanding (c.f. Check()), so a hung bus is caught without the acquisition thread's help.
+// - Once a stage has overrun, IsOnTime() stays false: the watchdog is no longer kicked and resets the device.
+//
+// The first overrun is kept in retained memory (c.f. RetainedRecord) so it survives that reset, and is picked up
+// at the next boot (c.f. Initialize()) to be published (c.f. StatusPublisher). A stage that hangs the control thread
+// outright never gets to report itself, so the record also notes which control thread stage is underway.
+//
+
+class DeadlineMonitor
+{
+public:
+    enum class Stage : uint8_t
+    {
+        Ingest,       // Accepting hold and configuration updates
+        Acquire,      // Sensor I/O (acquisition thread), from request to receipt
+        Process,      // Filtering and fusing readings
+        Control,      // Evaluating zones
+        Publish,      // Publishing status (including any backlog)
+        Maintenance,  // Flash erases and configuration writes
+    };
+
+    static size_t constexpr sc_cStages = 6;
+    static uint8_t constexpr sc_NoStage = 0xFF;
+
+    struct Overrun
+    {
+        uint8_t Stage;       // c.f. Stage
+        bool fIsIncomplete;  // Stage hadn't completed yet (Duration_msec is as of detection, or zero if it hung)
+        uint32_t Duration_msec;
+        uint32_t Deadline_msec;
+        uint32_t DetectionTime;  // UTC, zero if it hung
+    };
+
+    //
+    // Kept in retained memory across the watchdog's reset (c.f. FEATURE_RETAINED_MEMORY).
+    // Like RetainedState, it isn't initialized by the runtime: contents are only trusted once IsValid().
+    //
+    struct RetainedRecord
+    {
+        static uint32_t constexpr sc_Signature = 0x4F464157;  // "WAFO"
+        static uint16_t constexpr sc_CurrentVersion = 1;
+
+        uint32_t Signature;
+        uint16_t Version;
+
+        uint8_t ActiveStage;   // Control thread stage underway, sc_NoStage if none
+        Overrun FirstOverrun;  // FirstOverrun.Stage is sc_NoStage if none
+
+        uint32_t Checksum;
+
+        bool IsValid() const
+        {
+            return (Signature == sc_Signature) && (Version == sc_CurrentVersion) && (Checksum == ComputeChecksum());
+        }
+
+        void Reset()
+        {
+            memset(this, 0, sizeof(*this));
+
+            Signature = sc_Signature;
+            Version = sc_CurrentVersion;
+            ActiveStage = sc_NoStage;
+            FirstOverrun.Stage = sc_NoStage;
+
+            Checksum = ComputeChecksum();
+        }
+
+        void Update()
+        {
+            Checksum = ComputeChecksum();
+        }
+
+    private:
+        uint32_t ComputeChecksum() const
+        {
+            return Configuration::ComputeHash(reinterpret_cast<uint8_t const*>(this),
+                                              offsetof(RetainedRecord, Checksum));
+        }
+    };
+
+    // Brackets a control thread stage (like Activity)
+    class Scope
+    {
+    public:
+        Scope(DeadlineMonitor& deadlineMonitor, Stage const stage)
+            : m_DeadlineMonitor(deadlineMonitor)
+            , m_Stage(stage)
+        {
+            m_DeadlineMonitor.Begin(m_Stage, millis());
+        }
+
+        ~Scope()
+        {
+            m_DeadlineMonitor.End(m_Stage, millis());
+        }
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+    private:
+        DeadlineMonitor& m_DeadlineMonitor;
+        Stage const m_Stage;
+    };
+
+public:
+    DeadlineMonitor()
+        : m_rgDeadlines_msec()
+        , m_rgStartTimes_msec()
+        , m_InProgressMask()
+        , m_fIsOnTime(true)
+        , m_pRecord()
+        , m_fHasPreviousOverrun()
+        , m_PreviousOverrun()
+    {
+    }
+
+    DeadlineMonitor(DeadlineMonitor const&) = delete;
+    DeadlineMonitor& operator=(DeadlineMonitor const&) = delete;
+
+public:
+    //
+    // Setup
+    //
+
+    // Picks up the previous boot's overrun, if any, and records overruns from here on
+    // (Call once deadlines have been set)
+    void Initialize(RetainedRecord* const pRecord)
+    {
+        m_pRecord = pRecord;
+
+        if (m_pRecord->IsValid())
+        {
+            if (m_pRecord->FirstOverrun.Stage != sc_NoStage)
+            {
+                m_PreviousOverrun = m_pRecord->FirstOverrun;
+                m_fHasPreviousOverrun = true;
+            }
+            else if (m_pRecord->ActiveStage < sc_cStages)
+            {
+                // Hung until the watchdog reset us
+                m_PreviousOverrun = Overrun();
+                m_PreviousOverrun.Stage = m_pRecord->ActiveStage;
+                m_PreviousOverrun.fIsIncomplete = true;
+                m_PreviousOverrun.Deadline_msec = m_rgDeadlines_msec[m_pRecord->ActiveStage];
+                m_fHasPreviousOverrun = true;
+            }
+        }
+
+        m_pRecord->Reset();
+    }
+
+    // A deadline of zero leaves the stage unbounded
+    void SetDeadline(Stage const stage, unsigned long const deadline_msec)
+    {
+        m_rgDeadlines_msec[static_cast<size_t>(stage)] = deadline_msec;
+    }
+
+    //
+    // Operations
+    //
+
+    void Begin(Stage const stage, unsigned long const currentTime_msec)
+    {
+        size_t const idxStage = static_cast<size_t>(stage);
+
+        m_rgStartTimes_msec[idxStage] = currentTime_msec;
+        m_InProgressMask |= (1U << idxStage);
+
+        // (Acquisitions don't block the control thread, c.f. Check())
+        if (m_pRecord && (stage != Stage::Acquire))
+        {
+            m_pRecord->ActiveStage = static_cast<uint8_t>(stage);
+            m_pRecord->Update();
+        }
+    }
+
+    // @returns whether the stage met its deadline
+    bool End(Stage const stage, unsigned long const currentTime_msec)
+    {
+        size_t const idxStage = static_cast<size_t>(stage);
+
+        if (!IsInProgress(stage))
+        {
+            return true;
+        }
+
+        m_InProgressMask &= ~(1U << idxStage);
+
+        if (m_pRecord && (stage != Stage::Acquire))
+        {
+            m_pRecord->ActiveStage = sc_NoStage;
+            m_pRecord->Update();
+        }
+
+        // (Carefully phrased to deal with rollovers)
+        unsigned long const duration_msec = currentTime_msec - m_rgStartTimes_msec[idxStage];
+
+        if (hasOverrun(idxStage, duration_msec))
+        {
+            recordOverrun(idxStage, duration_msec, false /* complete */);
+            return false;
+        }
+
+        return true;
+    }
+
+    // Checks on stages that are still underway (i.e. outstanding acquisitions)
+    // @returns IsOnTime()
+    bool Check(unsigned long const currentTime_msec)
+    {
+        for (size_t idxStage = 0; idxStage < sc_cStages; ++idxStage)
+        {
+            if (!(m_InProgressMask & (1U << idxStage)))
+            {
+                continue;
+            }
+
+            unsigned long const duration_msec = currentTime_msec - m_rgStartTimes_msec[idxStage];
+
+            if (hasOverrun(idxStage, duration_msec))
+            {
+                recordOverrun(idxStage, duration_msec, true /* incomplete */);
+            }
+        }
+
+        return m_fIsOnTime;
+    }
+
+    //
+    // Accessors
+    //
+
+    // Whether all stages have met their deadlines so far (i.e. whether to keep kicking the watchdog)
+    bool IsOnTime() const
+    {
+        return m_fIsOnTime;
+    }
+
+    bool IsInProgress(Stage const stage) const
+    {
+        return !!(m_InProgressMask & (1U << static_cast<size_t>(stage)));
+    }
+
+    unsigned long GetDeadline_msec(Stage const stage) const
+    {
+        return m_rgDeadlines_msec[static_cast<size_t>(stage)];
+    }
+
+    // Overrun that led to the previous reset (nullptr if none or once cleared)
+    Overrun const* PreviousOverrun() const
+    {
+        return m_fHasPreviousOverrun ? &m_PreviousOverrun : nullptr;
+    }
+
+    // Call once the previous overrun has been published
+    void ClearPreviousOverrun()
+    {
+        m_fHasPreviousOverrun = false;
+    }
+
+    static char const* GetStageName(uint8_t const stage)
+    {
+        static char const* const rgszStageNames[sc_cStages] = {
+            "Ingest", "Acquire", "Process", "Control", "Publish", "Maintenance"};
+
+        return (stage < sc_cStages) ? rgszStageNames[stage] : "?";
+    }
+
+private:
+    unsigned long m_rgDeadlines_msec[sc_cStages];
+    unsigned long m_rgStartTimes_msec[sc_cStages];
+    uint32_t m_InProgressMask;
+
+    bool m_fIsOnTime;
+    RetainedRecord* m_pRecord;
+
+    bool m_fHasPreviousOverrun;
+    Overrun m_PreviousOverrun;
+
+private:
+    bool hasOverrun(size_t const idxStage, unsigned long const duration_msec) const
+    {
+        return m_rgDeadlines_msec[idxStage] && (duration_msec > m_rgDeadlines_msec[idxStage]);
+    }
+
+    void recordOverrun(size_t const idxStage, unsigned long const duration_msec, bool const fIsIncomplete)
+    {
+        if (!m_fIsOnTime)
+        {
+            // Only the first overrun is recorded (later ones tend to be its consequences)
+            return;
+        }
+
+        m_fIsOnTime = false;
+
+        WAF_LOG_WARNING("!! %s overran its deadline: %lu msec%s (deadline: %lu msec), stopping watchdog.",
+                        GetStageName(static_cast<uint8_t>(idxStage)),
+                        duration_msec,
+                        fIsIncomplete ? " and counting" : "",
+                        m_rgDeadlines_msec[idxStage]);
+
+        if (m_pRecord)
+        {
+            Overrun& overrun = m_pRecord->FirstOverrun;
+
+            overrun.Stage = static_cast<uint8_t>(idxStage);
+            overrun.fIsIncomplete = fIsIncomplete;
+            overrun.Duration_msec = duration_msec;
+            overrun.Deadline_msec = m_rgDeadlines_msec[idxStage];
+            overrun.DetectionTime = Time.now();
+
+            m_pRecord->Update();
+        }
+    }
+};
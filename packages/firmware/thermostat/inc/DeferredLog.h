@@ -0,0 +1,503 @@
+#pragma once
+
+//
+// Deferred, level-filtered logging
+//
+// - Log statements below WAF_LOG_LEVEL are compiled out entirely (including evaluation of their arguments).
+// - Enabled log statements don't format anything: they append a binary record (level, format string address as
+//   the format's id, raw argument values) to a fixed-size ring buffer.
+// - Drain() formats pending records and writes them to Serial; the main loop calls it while idling so that
+//   formatting and USB serial traffic stay off the control path.
+//
+// Format strings must be literals (their addresses are retained until drained). String arguments are copied
+// (truncated to sc_cchStringArgument_Max). Records that don't fit into the ring buffer are dropped and counted.
+//
+// Supported conversions: d, i, u, x, X, o, c, f, F, e, E, g, G, s, and %%, with flags, width, and precision;
+// length modifiers are accepted and ignored (integers are recorded at 64 bits).
+//
+
+#define WAF_LOG_LEVEL_TRACE 0
+#define WAF_LOG_LEVEL_INFO 1
+#define WAF_LOG_LEVEL_WARNING 2
+#define WAF_LOG_LEVEL_ERROR 3
+#define WAF_LOG_LEVEL_NONE 4
+
+#ifndef WAF_LOG_LEVEL
+#define WAF_LOG_LEVEL WAF_LOG_LEVEL_INFO
+#endif
+
+#define WAF_LOG_DISABLED(...) \
+    do                        \
+    {                         \
+    } while (0)
+
+#if WAF_LOG_LEVEL <= WAF_LOG_LEVEL_TRACE
+#define WAF_LOG_TRACE(...) DeferredLog::Instance().Append(DeferredLog::Level::Trace, __VA_ARGS__)
+#else
+#define WAF_LOG_TRACE(...) WAF_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if WAF_LOG_LEVEL <= WAF_LOG_LEVEL_INFO
+#define WAF_LOG_INFO(...) DeferredLog::Instance().Append(DeferredLog::Level::Info, __VA_ARGS__)
+#else
+#define WAF_LOG_INFO(...) WAF_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if WAF_LOG_LEVEL <= WAF_LOG_LEVEL_WARNING
+#define WAF_LOG_WARNING(...) DeferredLog::Instance().Append(DeferredLog::Level::Warning, __VA_ARGS__)
+#else
+#define WAF_LOG_WARNING(...) WAF_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if WAF_LOG_LEVEL <= WAF_LOG_LEVEL_ERROR
+#define WAF_LOG_ERROR(...) DeferredLog::Instance().Append(DeferredLog::Level::Error, __VA_ARGS__)
+#else
+#define WAF_LOG_ERROR(...) WAF_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+class DeferredLog
+{
+public:
+    enum class Level : uint8_t
+    {
+        Trace = WAF_LOG_LEVEL_TRACE,
+        Info = WAF_LOG_LEVEL_INFO,
+        Warning = WAF_LOG_LEVEL_WARNING,
+        Error = WAF_LOG_LEVEL_ERROR,
+    };
+
+    static uint16_t constexpr sc_cbBuffer = 1024;
+    static uint16_t constexpr sc_cbRecord_Max = 192;
+    static uint8_t constexpr sc_cchStringArgument_Max = 96;
+    static uint16_t constexpr sc_cchLine_Max = 256;
+
+public:
+    DeferredLog()
+        : m_rgBuffer()
+        , m_idxRead()
+        , m_cbUsed()
+        , m_cDroppedRecords()
+        , m_Mutex()
+    {
+    }
+
+    DeferredLog(DeferredLog const&) = delete;
+    DeferredLog& operator=(DeferredLog const&) = delete;
+
+    static DeferredLog& Instance()
+    {
+        static DeferredLog s_DeferredLog;
+        return s_DeferredLog;
+    }
+
+public:
+    //
+    // Producers (any thread)
+    //
+
+    template <typename... TArguments>
+    void Append(Level const level, char const* const szFormat, TArguments const... arguments)
+    {
+        Record record;
+        record.Header.Severity = level;
+        record.Header.cArguments = sizeof...(arguments);
+        record.Header.szFormat = szFormat;
+
+        uint16_t cbRecord = sizeof(record.Header);
+        bool const fFits = appendArguments(record.rgData, cbRecord, arguments...);
+
+        if (!fFits)
+        {
+            // Argument data too large for a record; keep the format so the omission is at least visible
+            record.Header.cArguments = 0;
+            cbRecord = sizeof(record.Header);
+        }
+
+        record.Header.cbRecord = cbRecord;
+
+        LockGuard autoLock(m_Mutex);
+
+        if (cbRecord > (sc_cbBuffer - m_cbUsed))
+        {
+            ++m_cDroppedRecords;
+            return;
+        }
+
+        writeBytes(reinterpret_cast<uint8_t const*>(&record), cbRecord);
+    }
+
+    //
+    // Consumer (single thread)
+    //
+
+    // Formats and writes out up to cRecords_Max pending records; @returns count of records written
+    size_t Drain(size_t const cRecords_Max = SIZE_MAX)
+    {
+        size_t cRecords = 0;
+
+        while (cRecords < cRecords_Max)
+        {
+            Record record;
+            bool fHasRecord = false;
+            uint32_t cDroppedRecords;
+
+            {
+                LockGuard autoLock(m_Mutex);
+
+                cDroppedRecords = m_cDroppedRecords;
+                m_cDroppedRecords = 0;
+
+                if (m_cbUsed)
+                {
+                    readBytes(reinterpret_cast<uint8_t*>(&record.Header), sizeof(record.Header));
+                    readBytes(record.rgData + sizeof(record.Header), record.Header.cbRecord - sizeof(record.Header));
+
+                    fHasRecord = true;
+                }
+            }
+
+            // Format outside of the lock so producers aren't held up
+            char szLine[sc_cchLine_Max];
+
+            if (fHasRecord)
+            {
+                FormatRecord(szLine, sizeof(szLine), record);
+            }
+
+            WITH_LOCK(Serial)
+            {
+                if (cDroppedRecords)
+                {
+                    Serial.printlnf("!! %u log records dropped", cDroppedRecords);
+                }
+
+                if (fHasRecord)
+                {
+                    Serial.println(szLine);
+                }
+            }
+
+            if (!fHasRecord)
+            {
+                break;
+            }
+
+            ++cRecords;
+        }
+
+        return cRecords;
+    }
+
+    bool IsEmpty() const
+    {
+        LockGuard autoLock(m_Mutex);
+        return !m_cbUsed;
+    }
+
+private:
+    typedef std::mutex Mutex;
+    typedef std::lock_guard<Mutex> LockGuard;
+
+    enum class ArgumentType : uint8_t
+    {
+        Signed,
+        Unsigned,
+        Double,
+        String,
+    };
+
+    struct RecordHeader
+    {
+        uint16_t cbRecord;
+        Level Severity;
+        uint8_t cArguments;
+        char const* szFormat;
+    };
+
+    // (Deliberately left uninitialized; only the first Header.cbRecord bytes are ever used)
+    union Record
+    {
+        RecordHeader Header;
+        uint8_t rgData[sc_cbRecord_Max];
+    };
+
+    // Ring buffer
+    uint8_t m_rgBuffer[sc_cbBuffer];
+    uint16_t m_idxRead;
+    uint16_t m_cbUsed;
+    uint32_t m_cDroppedRecords;
+
+    mutable Mutex m_Mutex;
+
+private:
+    //
+    // Argument encoding: [ArgumentType][value] with values stored as int64_t, uint64_t, double,
+    // or [length][characters] for strings
+    //
+
+    static bool appendArguments(uint8_t* const /* rgRecord */, uint16_t& /* cbRecord */)
+    {
+        return true;
+    }
+
+    template <typename TArgument, typename... TArguments>
+    static bool appendArguments(uint8_t* const rgRecord,
+                                uint16_t& cbRecord,
+                                TArgument const argument,
+                                TArguments const... arguments)
+    {
+        return appendArgument(rgRecord, cbRecord, argument) && appendArguments(rgRecord, cbRecord, arguments...);
+    }
+
+    template <typename TValue>
+    static bool appendValue(uint8_t* const rgRecord,
+                            uint16_t& cbRecord,
+                            ArgumentType const argumentType,
+                            TValue const value)
+    {
+        if (cbRecord + 1 + sizeof(value) > sc_cbRecord_Max)
+        {
+            return false;
+        }
+
+        rgRecord[cbRecord] = static_cast<uint8_t>(argumentType);
+        memcpy(rgRecord + cbRecord + 1, &value, sizeof(value));
+        cbRecord += 1 + sizeof(value);
+
+        return true;
+    }
+
+    template <typename TArgument>
+    static typename std::enable_if<std::is_integral<TArgument>::value && std::is_signed<TArgument>::value, bool>::type
+    appendArgument(uint8_t* const rgRecord, uint16_t& cbRecord, TArgument const argument)
+    {
+        return appendValue(rgRecord, cbRecord, ArgumentType::Signed, static_cast<int64_t>(argument));
+    }
+
+    template <typename TArgument>
+    static typename std::enable_if<std::is_integral<TArgument>::value && !std::is_signed<TArgument>::value, bool>::type
+    appendArgument(uint8_t* const rgRecord, uint16_t& cbRecord, TArgument const argument)
+    {
+        return appendValue(rgRecord, cbRecord, ArgumentType::Unsigned, static_cast<uint64_t>(argument));
+    }
+
+    template <typename TArgument>
+    static typename std::enable_if<std::is_enum<TArgument>::value, bool>::type appendArgument(
+        uint8_t* const rgRecord, uint16_t& cbRecord, TArgument const argument)
+    {
+        return appendValue(rgRecord, cbRecord, ArgumentType::Unsigned, static_cast<uint64_t>(argument));
+    }
+
+    template <typename TArgument>
+    static typename std::enable_if<std::is_floating_point<TArgument>::value, bool>::type appendArgument(
+        uint8_t* const rgRecord, uint16_t& cbRecord, TArgument const argument)
+    {
+        return appendValue(rgRecord, cbRecord, ArgumentType::Double, static_cast<double>(argument));
+    }
+
+    static bool appendArgument(uint8_t* const rgRecord, uint16_t& cbRecord, char const* const szArgument)
+    {
+        size_t const cchArgument = szArgument ? strnlen(szArgument, sc_cchStringArgument_Max) : 0;
+
+        if (cbRecord + 2 + cchArgument > sc_cbRecord_Max)
+        {
+            return false;
+        }
+
+        rgRecord[cbRecord] = static_cast<uint8_t>(ArgumentType::String);
+        rgRecord[cbRecord + 1] = static_cast<uint8_t>(cchArgument);
+        memcpy(rgRecord + cbRecord + 2, szArgument, cchArgument);
+        cbRecord += 2 + cchArgument;
+
+        return true;
+    }
+
+    //
+    // Ring buffer (callers hold m_Mutex)
+    //
+
+    void writeBytes(uint8_t const* const rgData, uint16_t const cbData)
+    {
+        uint16_t idxWrite = (m_idxRead + m_cbUsed) % sc_cbBuffer;
+
+        for (uint16_t idxData = 0; idxData < cbData; ++idxData)
+        {
+            m_rgBuffer[idxWrite] = rgData[idxData];
+            idxWrite = (idxWrite + 1) % sc_cbBuffer;
+        }
+
+        m_cbUsed += cbData;
+    }
+
+    void readBytes(uint8_t* const rgData, uint16_t const cbData)
+    {
+        for (uint16_t idxData = 0; idxData < cbData; ++idxData)
+        {
+            rgData[idxData] = m_rgBuffer[m_idxRead];
+            m_idxRead = (m_idxRead + 1) % sc_cbBuffer;
+        }
+
+        m_cbUsed -= cbData;
+    }
+
+    //
+    // Formatting
+    //
+
+    static void FormatRecord(char* const szLine, size_t const cchLine, Record const& record)
+    {
+        char const* pFormat = record.Header.szFormat;
+        uint8_t const* pArgument = record.rgData + sizeof(record.Header);
+        uint8_t cArgumentsRemaining = record.Header.cArguments;
+
+        size_t idxLine = 0;
+
+        auto const append = [&](int const cchAppended) {
+            if (cchAppended > 0)
+            {
+                idxLine = std::min(idxLine + cchAppended, cchLine - 1);
+            }
+        };
+
+        while (*pFormat && idxLine < cchLine - 1)
+        {
+            if (*pFormat != '%')
+            {
+                szLine[idxLine++] = *pFormat++;
+                continue;
+            }
+
+            if (pFormat[1] == '%')
+            {
+                szLine[idxLine++] = '%';
+                pFormat += 2;
+                continue;
+            }
+
+            // Collect conversion specification: %[flags][width][.precision][length]conversion
+            char szSpecification[16] = "%";
+            size_t cchSpecification = 1;
+
+            ++pFormat;
+
+            while (*pFormat && strchr("-+ #0123456789.", *pFormat) &&
+                   cchSpecification < sizeof(szSpecification) - 4 /* length, conversion, terminator */)
+            {
+                szSpecification[cchSpecification++] = *pFormat++;
+            }
+
+            while (*pFormat && strchr("hlLqjzt", *pFormat))
+            {
+                ++pFormat;  // Length modifiers are superseded by our recorded types
+            }
+
+            char const conversion = *pFormat;
+
+            if (!conversion)
+            {
+                break;
+            }
+
+            ++pFormat;
+
+            // Retrieve argument
+            if (!cArgumentsRemaining)
+            {
+                append(snprintf(szLine + idxLine, cchLine - idxLine, "<?>"));
+                continue;
+            }
+
+            --cArgumentsRemaining;
+
+            ArgumentType const argumentType = static_cast<ArgumentType>(*pArgument++);
+
+            int64_t signedValue = 0;
+            uint64_t unsignedValue = 0;
+            double doubleValue = 0;
+            char szString[sc_cchStringArgument_Max + 1] = "";
+
+            switch (argumentType)
+            {
+                case ArgumentType::Signed:
+                    memcpy(&signedValue, pArgument, sizeof(signedValue));
+                    pArgument += sizeof(signedValue);
+                    unsignedValue = static_cast<uint64_t>(signedValue);
+                    doubleValue = static_cast<double>(signedValue);
+                    break;
+
+                case ArgumentType::Unsigned:
+                    memcpy(&unsignedValue, pArgument, sizeof(unsignedValue));
+                    pArgument += sizeof(unsignedValue);
+                    signedValue = static_cast<int64_t>(unsignedValue);
+                    doubleValue = static_cast<double>(unsignedValue);
+                    break;
+
+                case ArgumentType::Double:
+                    memcpy(&doubleValue, pArgument, sizeof(doubleValue));
+                    pArgument += sizeof(doubleValue);
+                    signedValue = static_cast<int64_t>(doubleValue);
+                    unsignedValue = static_cast<uint64_t>(signedValue);
+                    break;
+
+                case ArgumentType::String: {
+                    uint8_t const cchString = *pArgument++;
+                    memcpy(szString, pArgument, cchString);
+                    szString[cchString] = 0;
+                    pArgument += cchString;
+                    break;
+                }
+            }
+
+            // Format argument
+            char const* const szIntegerLength = "ll";
+            bool const fIsInteger = !!strchr("diuxXo", conversion);
+
+            if (fIsInteger)
+            {
+                strcpy(szSpecification + cchSpecification, szIntegerLength);
+                cchSpecification += strlen(szIntegerLength);
+            }
+
+            szSpecification[cchSpecification++] = conversion;
+            szSpecification[cchSpecification] = 0;
+
+            if (argumentType == ArgumentType::String && conversion != 's')
+            {
+                append(snprintf(szLine + idxLine, cchLine - idxLine, "<?>"));
+            }
+            else if (conversion == 's')
+            {
+                append(snprintf(szLine + idxLine,
+                                cchLine - idxLine,
+                                szSpecification,
+                                argumentType == ArgumentType::String ? szString : "<?>"));
+            }
+            else if (conversion == 'd' || conversion == 'i')
+            {
+                append(snprintf(
+                    szLine + idxLine, cchLine - idxLine, szSpecification, static_cast<long long>(signedValue)));
+            }
+            else if (fIsInteger)
+            {
+                append(snprintf(szLine + idxLine,
+                                cchLine - idxLine,
+                                szSpecification,
+                                static_cast<unsigned long long>(unsignedValue)));
+            }
+            else if (conversion == 'c')
+            {
+                append(snprintf(szLine + idxLine, cchLine - idxLine, szSpecification, static_cast<int>(signedValue)));
+            }
+            else if (strchr("fFeEgG", conversion))
+            {
+                append(snprintf(szLine + idxLine, cchLine - idxLine, szSpecification, doubleValue));
+            }
+            else
+            {
+                append(snprintf(szLine + idxLine, cchLine - idxLine, "<?>"));
+            }
+        }
+
+        szLine[idxLine] = 0;
+    }
+};
@@ -15,6 +15,21 @@ public:
         return m_rgBuffer;
     }
 
+    uint16_t Length() const
+    {
+        return m_cchUsed;
+    }
+
+    // Drops anything appended past cchLength (e.g. to back out of a partially appended item)
+    void Truncate(uint16_t const cchLength)
+    {
+        if (cchLength < m_cchUsed)
+        {
+            m_cchUsed = cchLength;
+            m_rgBuffer[m_cchUsed] = '\0';
+        }
+    }
+
     bool Append(char const* const rgText)
     {
         uint16_t const cchToAppend_WithTerminator = static_cast<uint16_t>(strlen(rgText)) + 1;
@@ -42,6 +57,8 @@ public:
             return true;
         }
 
+        // (Drop whatever part of the text did fit)
+        m_rgBuffer[m_cchUsed] = '\0';
         return false;
     }
 
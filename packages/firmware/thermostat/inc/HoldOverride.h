@@ -0,0 +1,207 @@
+#pragma once
+
+//
+// In-RAM hold that takes precedence over the configuration's settings (c.f. ThermostatSetpointScheduler),
+// submitted through the `hold` Particle function so that a hold takes effect without waiting for the full
+// configuration to be built, encoded, pushed, decoded, verified, and persisted.
+//
+// Holds are submitted as short text (c.f. //packages/api/src/shared/firmware/thermostatSettingAdapter.ts):
+//
+//   H1,<allowedActions>,<setPointHeat_x100>,<setPointCool_x100>,<setPointCirculateAbove_x100>,
+//      <setPointCirculateBelow_x100>,<holdUntil>
+//
+// with allowedActions as ThermostatAction bits and holdUntil in seconds since the UTC epoch, just like
+// a Hold ThermostatSetting. An empty string clears the hold.
+//
+// The cloud follows up with the full configuration carrying the same hold as a regular Hold setting, so the
+// overlay is dropped whenever an updated configuration is accepted (c.f. Clear()); it isn't persisted.
+// It applies to all zones.
+//
+// A note on threading: like Configuration, holds are submitted on the system thread and only accepted
+// (i.e. made visible to readers) on the main thread.
+//
+
+class HoldOverride
+{
+public:
+    HoldOverride()
+        : m_fIsActive()
+        , m_Setpoint()
+        , m_HoldUntil()
+        , m_fHasPendingUpdate()
+        , m_fPendingIsActive()
+        , m_PendingSetpoint()
+        , m_PendingHoldUntil()
+        , m_UpdateMutex()
+    {
+    }
+
+    HoldOverride(HoldOverride const&) = delete;
+    HoldOverride& operator=(HoldOverride const&) = delete;
+
+public:
+    //
+    // Accessors (main thread)
+    //
+
+    bool IsActive(uint32_t const timeNow) const
+    {
+        // (Same semantics as ThermostatSetting::holdUntil)
+        return m_fIsActive && (timeNow <= m_HoldUntil);
+    }
+
+    ThermostatSetpoint const& Setpoint() const
+    {
+        return m_Setpoint;
+    }
+
+    uint32_t HoldUntil() const
+    {
+        return m_HoldUntil;
+    }
+
+    //
+    // Operations
+    //
+
+    enum class HoldUpdateResult
+    {
+        Cleared,
+        Accepted,
+        Invalid,
+    };
+
+    HoldUpdateResult SubmitUpdate(char const* const szHold)
+    {
+        bool fIsActive = false;
+        ThermostatSetpoint setpoint;
+        uint32_t holdUntil = 0;
+
+        if (*szHold)
+        {
+            if (!tryParse(szHold, setpoint, holdUntil))
+            {
+                return HoldUpdateResult::Invalid;
+            }
+
+            fIsActive = true;
+        }
+
+        LockGuard autoLock(m_UpdateMutex);
+
+        m_fPendingIsActive = fIsActive;
+        m_PendingSetpoint = setpoint;
+        m_PendingHoldUntil = holdUntil;
+        m_fHasPendingUpdate = true;
+
+        return fIsActive ? HoldUpdateResult::Accepted : HoldUpdateResult::Cleared;
+    }
+
+    bool HasPendingUpdates() const
+    {
+        LockGuard autoLock(m_UpdateMutex);
+
+        return m_fHasPendingUpdate;
+    }
+
+    // @returns whether there was an update to accept
+    bool AcceptPendingUpdates()
+    {
+        LockGuard autoLock(m_UpdateMutex);
+
+        if (!m_fHasPendingUpdate)
+        {
+            return false;
+        }
+
+        m_fIsActive = m_fPendingIsActive;
+        m_Setpoint = m_PendingSetpoint;
+        m_HoldUntil = m_PendingHoldUntil;
+
+        m_fHasPendingUpdate = false;
+
+        return true;
+    }
+
+    // Call after accepting an updated configuration (it supersedes the overlay)
+    void Clear()
+    {
+        m_fIsActive = false;
+    }
+
+private:
+    typedef std::recursive_mutex Mutex;
+    typedef std::lock_guard<Mutex> LockGuard;
+
+    // Readable state
+    bool m_fIsActive;
+    ThermostatSetpoint m_Setpoint;
+    uint32_t m_HoldUntil;
+
+    // Pending (to be accepted) state
+    bool m_fHasPendingUpdate;
+    bool m_fPendingIsActive;
+    ThermostatSetpoint m_PendingSetpoint;
+    uint32_t m_PendingHoldUntil;
+
+    // Protects pending state
+    mutable Mutex m_UpdateMutex;
+
+private:
+    static bool tryParse(char const* const szHold, ThermostatSetpoint& setpoint, uint32_t& holdUntil)
+    {
+        static char constexpr rgMagic[] = "H1";
+        size_t const cchMagic = strlen(rgMagic);
+
+        if (strncmp(szHold, rgMagic, cchMagic) != 0)
+        {
+            return false;
+        }
+
+        long long rgFields[6];
+        char const* pch = szHold + cchMagic;
+
+        for (size_t idxField = 0; idxField < countof(rgFields); ++idxField)
+        {
+            if (*pch != ',')
+            {
+                return false;
+            }
+
+            char* pchEnd = nullptr;
+            rgFields[idxField] = strtoll(pch + 1, &pchEnd, 10);
+
+            if (pchEnd == pch + 1)
+            {
+                // No digits
+                return false;
+            }
+
+            pch = pchEnd;
+        }
+
+        if (*pch)
+        {
+            // Trailing characters
+            return false;
+        }
+
+        long long const allowedActions = rgFields[0];
+        long long const holdUntilField = rgFields[5];
+
+        if ((allowedActions < 0) || (allowedActions > static_cast<long long>(ThermostatAction::ANY)) ||
+            (holdUntilField <= 0) || (holdUntilField > UINT32_MAX))
+        {
+            return false;
+        }
+
+        setpoint = ThermostatSetpoint(static_cast<ThermostatAction>(allowedActions),
+                                      rgFields[1] / 100.0f,
+                                      rgFields[2] / 100.0f,
+                                      rgFields[3] / 100.0f,
+                                      rgFields[4] / 100.0f);
+        holdUntil = static_cast<uint32_t>(holdUntilField);
+
+        return true;
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+//
+// Maps UTC time (i.e. Time.now()) to local time with plain integer arithmetic rather than Time.zone() and
+// Time.{weekday,hour,minute}() (each of which goes through a struct tm conversion).
+//
+// The configuration carries the current UTC offset and a table of upcoming transitions (timezoneTransitions),
+// so schedules keep following local time across DST changes even if the device stays offline for months.
+// Configurations without a table fall back on the single nextTimezone{UTCOffset,Change}.
+//
+// UTC offsets follow the IANA sign convention (minutes *behind* UTC, e.g. PST = 480).
+//
+
+class LocalTime
+{
+public:
+    static uint16_t constexpr sc_MinutesPerDay = 24 * 60;
+    static uint16_t constexpr sc_MinutesPerWeek = 7 * sc_MinutesPerDay;
+
+public:
+    // @returns the UTC offset applicable at utcTime
+    static int16_t GetUTCOffset(Configuration const& configuration, uint32_t const utcTime)
+    {
+        auto const& rootConfiguration = configuration.rootConfiguration();
+        auto const pvTimezoneTransitions = rootConfiguration.timezoneTransitions();
+
+        if (!pvTimezoneTransitions || pvTimezoneTransitions->size() == 0)
+        {
+            return (rootConfiguration.nextTimezoneChange() <= utcTime) ? rootConfiguration.nextTimezoneUTCOffset()
+                                                                       : rootConfiguration.currentTimezoneUTCOffset();
+        }
+
+        // Latest transition that has taken place, if any
+        int16_t utcOffset = rootConfiguration.currentTimezoneUTCOffset();
+        uint32_t latestTransitionTime = 0;
+
+        for (auto const pTimezoneTransition : *pvTimezoneTransitions)
+        {
+            if (pTimezoneTransition->at() <= utcTime && pTimezoneTransition->at() >= latestTransitionTime)
+            {
+                utcOffset = pTimezoneTransition->utcOffset();
+                latestTransitionTime = pTimezoneTransition->at();
+            }
+        }
+
+        return utcOffset;
+    }
+
+    // @returns minutes since local midnight at the start of Sunday
+    // (c.f. ThermostatSetting::atMinutesSinceMidnight, DaysOfWeek)
+    static uint16_t GetMinutesSinceStartOfWeek(Configuration const& configuration, uint32_t const utcTime)
+    {
+        int32_t const localTime_minutes = static_cast<int32_t>(utcTime / 60) - GetUTCOffset(configuration, utcTime);
+
+        // The UTC epoch (Jan 1 1970) was a Thursday, i.e. four days into its week
+        int32_t const minutesSinceStartOfWeek = (localTime_minutes + 4 * sc_MinutesPerDay) % sc_MinutesPerWeek;
+
+        // (Local times before the epoch come out negative)
+        return static_cast<uint16_t>((minutesSinceStartOfWeek < 0) ? minutesSinceStartOfWeek + sc_MinutesPerWeek
+                                                                   : minutesSinceStartOfWeek);
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+//
+// Decides which of the main loop's tasks are due on each pass:
+//
+// - Acquisition (requesting readings from the acquisition thread, c.f. AcquisitionChannel) runs every `cadence`;
+//   readings are aggregated and published as they come in.
+// - Control (zones re-evaluating their setpoints and relays) runs off the latest acquired readings
+//   right as readings come in, right after configuration changes, and every sc_ControlInterval_msec
+//   in between, so that schedule boundaries, holds, and new setpoints take effect within seconds
+//   rather than up to a full `cadence` later.
+//
+
+class LoopScheduler
+{
+public:
+    static unsigned long constexpr sc_ControlInterval_msec = 10 * 1000;
+
+    struct DueTasks
+    {
+        bool fAcquire;
+        bool fControl;
+    };
+
+public:
+    LoopScheduler()
+        : m_fHasAcquired()
+        , m_LastAcquisitionTime_msec()
+        , m_LastControlTime_msec()
+    {
+    }
+
+public:
+    // Determines and records the tasks due at currentTime_msec
+    DueTasks GetDueTasks(unsigned long const currentTime_msec,
+                         unsigned long const acquisitionInterval_msec,
+                         bool const fHasUpdatedConfiguration)
+    {
+        DueTasks dueTasks;
+
+        // (Carefully phrased to deal with rollovers)
+        dueTasks.fAcquire =
+            !m_fHasAcquired || ((currentTime_msec - m_LastAcquisitionTime_msec) >= acquisitionInterval_msec);
+
+        dueTasks.fControl = dueTasks.fAcquire || fHasUpdatedConfiguration ||
+                            ((currentTime_msec - m_LastControlTime_msec) >= sc_ControlInterval_msec);
+
+        if (dueTasks.fAcquire)
+        {
+            m_fHasAcquired = true;
+            m_LastAcquisitionTime_msec = currentTime_msec;
+        }
+
+        if (dueTasks.fControl)
+        {
+            m_LastControlTime_msec = currentTime_msec;
+        }
+
+        return dueTasks;
+    }
+
+    // @returns time until the next task is due, zero if one is due now
+    unsigned long TimeUntilNextTask_msec(unsigned long const currentTime_msec,
+                                         unsigned long const acquisitionInterval_msec) const
+    {
+        if (!m_fHasAcquired)
+        {
+            return 0;
+        }
+
+        // (Carefully phrased to deal with rollovers)
+        unsigned long const timeSinceAcquisition_msec = currentTime_msec - m_LastAcquisitionTime_msec;
+        unsigned long const timeSinceControl_msec = currentTime_msec - m_LastControlTime_msec;
+
+        if ((timeSinceAcquisition_msec >= acquisitionInterval_msec) ||
+            (timeSinceControl_msec >= sc_ControlInterval_msec))
+        {
+            return 0;
+        }
+
+        unsigned long const timeUntilAcquisition_msec = acquisitionInterval_msec - timeSinceAcquisition_msec;
+        unsigned long const timeUntilControl_msec = sc_ControlInterval_msec - timeSinceControl_msec;
+
+        return std::min(timeUntilAcquisition_msec, timeUntilControl_msec);
+    }
+
+private:
+    bool m_fHasAcquired;
+    unsigned long m_LastAcquisitionTime_msec;
+    unsigned long m_LastControlTime_msec;
+};
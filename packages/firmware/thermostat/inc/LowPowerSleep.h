@@ -0,0 +1,152 @@
+#pragma once
+
+//
+// Sleeps through the main loop's waits in between tasks (c.f. LoopScheduler::TimeUntilNextTask_msec) on
+// battery-powered devices (opt-in, c.f. ThermostatConfiguration::lowPowerSleep), rather than idling in delay()
+// with the CPU and Wi-Fi on:
+//
+// - Device OS's stop mode halts the CPU with RAM retained and resumes execution right after System.sleep(),
+//   but only wakes in whole seconds, so sleep ends at least sc_WakeMargin_msec ahead of the next task
+//   and the rest of the wait is delayed out as before.
+// - The Wi-Fi module can be kept in standby, so that the cloud connection resumes right away on waking rather than
+//   with a full reconnect. That's only worth it while standby draws less over the sleep than reconnecting would
+//   (c.f. PowerModel), i.e. for short sleeps.
+// - The loop keeps track of time with millis(), which Device OS carries across stop mode. If it turns out not to,
+//   sleep is disabled rather than throwing off the schedule.
+//
+// Callers must not sleep while sensor I/O is underway (c.f. AcquisitionChannel::IsAcquiring()): stop mode halts
+// the acquisition thread and interrupts along with everything else.
+//
+
+class LowPowerSleep
+{
+public:
+    // Typical current draw in each power state (c.f. the Photon datasheet; network standby and reconnects
+    // are estimates), for weighing sleep options and estimating charge per cycle (c.f. tests/LowPowerSleep.cpp)
+    struct PowerModel
+    {
+        float Active_mA;          // CPU and Wi-Fi on
+        float NetworkStandby_mA;  // Stop mode, Wi-Fi module in standby
+        float Stop_mA;            // Stop mode, Wi-Fi module off
+        float Reconnect_mAs;      // Rejoining Wi-Fi and the cloud after waking with the Wi-Fi module off
+
+        static PowerModel Photon()
+        {
+            return PowerModel{80.0f, 15.0f, 1.0f, 300.0f};
+        }
+
+        float EstimateCharge_mAh(unsigned long const active_msec,
+                                 unsigned long const networkStandby_msec,
+                                 unsigned long const stop_msec,
+                                 unsigned long const cReconnects) const
+        {
+            float const charge_mAs = (Active_mA * active_msec + NetworkStandby_mA * networkStandby_msec +
+                                      Stop_mA * stop_msec) / 1000.0f +
+                                     Reconnect_mAs * cReconnects;
+
+            return charge_mAs / (60.0f * 60.0f);
+        }
+    };
+
+    struct Plan
+    {
+        uint32_t Duration_sec;  // Zero if not worth sleeping
+        bool fKeepNetwork;
+    };
+
+    // Woken this far ahead of the next task (at least) to get clocks back up
+    static unsigned long constexpr sc_WakeMargin_msec = 250;
+
+public:
+    LowPowerSleep(pin_t const wakeUpPin, PowerModel const& powerModel = PowerModel::Photon())
+        : m_WakeUpPin(wakeUpPin)
+        , m_PowerModel(powerModel)
+        , m_fIsDisabled()
+        , m_cSleeps()
+    {
+    }
+
+public:
+    //
+    // Operations
+    //
+
+    // Sleeps through as much of timeUntilNextTask_msec as is worth it, in one go of up to maximumSleep_msec
+    // (e.g. to stay clear of a watchdog, which keeps running in stop mode)
+    // @returns whether it slept
+    bool Sleep(unsigned long const timeUntilNextTask_msec,
+               unsigned long const maximumSleep_msec,
+               bool const fIsConnected)
+    {
+        Plan const plan = GetPlan(timeUntilNextTask_msec, maximumSleep_msec, fIsConnected);
+
+        if (!plan.Duration_sec)
+        {
+            return false;
+        }
+
+        unsigned long const startTime_msec = millis();
+
+        // (Woken by time alone, the wake-up pin is expected to stay low)
+        System.sleep(
+            m_WakeUpPin, RISING, plan.Duration_sec, plan.fKeepNetwork ? SLEEP_NETWORK_STANDBY : SLEEP_NETWORK_OFF);
+
+        ++m_cSleeps;
+
+        // (Carefully phrased to deal with rollovers)
+        unsigned long const sleepDuration_msec = millis() - startTime_msec;
+
+        if (sleepDuration_msec < plan.Duration_sec * 1000UL / 2)
+        {
+            WAF_LOG_WARNING("!! Clock didn't advance while sleeping (%lu msec for %lu sec), disabling sleep.",
+                            sleepDuration_msec,
+                            static_cast<unsigned long>(plan.Duration_sec));
+            m_fIsDisabled = true;
+        }
+
+        return true;
+    }
+
+    Plan GetPlan(unsigned long const timeUntilNextTask_msec,
+                 unsigned long const maximumSleep_msec,
+                 bool const fIsConnected) const
+    {
+        Plan plan = {0, false};
+
+        if (m_fIsDisabled || (timeUntilNextTask_msec <= sc_WakeMargin_msec))
+        {
+            return plan;
+        }
+
+        plan.Duration_sec = std::min(timeUntilNextTask_msec - sc_WakeMargin_msec, maximumSleep_msec) / 1000;
+
+        // Standby pays off as long as it draws less than turning the module off and reconnecting on waking
+        float const standbyCharge_mAs = m_PowerModel.NetworkStandby_mA * plan.Duration_sec;
+        float const reconnectCharge_mAs = m_PowerModel.Stop_mA * plan.Duration_sec + m_PowerModel.Reconnect_mAs;
+
+        plan.fKeepNetwork = fIsConnected && (standbyCharge_mAs <= reconnectCharge_mAs);
+
+        return plan;
+    }
+
+    //
+    // Accessors
+    //
+
+    bool IsDisabled() const
+    {
+        return m_fIsDisabled;
+    }
+
+    uint32_t SleepCount() const
+    {
+        return m_cSleeps;
+    }
+
+private:
+    pin_t const m_WakeUpPin;
+    PowerModel const m_PowerModel;
+
+    bool m_fIsDisabled;
+    uint32_t m_cSleeps;
+};
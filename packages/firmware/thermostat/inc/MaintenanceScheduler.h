@@ -0,0 +1,150 @@
+#pragma once
+
+//
+// Runs flash maintenance only in idle windows long enough for it:
+//
+// - Pending EEPROM emulation page erases (c.f. notes in Configuration.h), which stall the CPU for tens to hundreds
+//   of msec. Left to themselves, they'd otherwise happen as part of whichever write next needs the space.
+// - Writing out accepted configurations (c.f. Configuration::SaveData()) and zones' learned recovery rates
+//   (c.f. Zone::SaveData()), which may need an erase of their own and are thus budgeted like one.
+//
+// The window is the idle time until the main loop's next task (c.f. LoopScheduler::TimeUntilNextTask_msec):
+// acquisitions (and with them publishes) and control passes, the latter picking up schedule transitions.
+// The onboard sensor's interrupt-driven transmission is started and harvested within an acquisition,
+// which the main loop keeps clear of by not running idle tasks while one is outstanding (c.f. AcquisitionChannel).
+//
+// Erase durations are measured; the budget is the longest recent one, decaying as shorter ones come in.
+//
+
+class MaintenanceScheduler
+{
+public:
+    // Budgeted until erases have been measured
+    static unsigned long constexpr sc_EraseDuration_Initial_msec = 500;
+
+    // Slack left ahead of the next task
+    static unsigned long constexpr sc_Margin_msec = 100;
+
+public:
+    MaintenanceScheduler()
+        : m_EraseDurationBudget_msec(sc_EraseDuration_Initial_msec)
+        , m_LastEraseDuration_msec()
+        , m_MaxEraseDuration_msec()
+        , m_cErases()
+    {
+    }
+
+public:
+    // Performs whatever maintenance fits into timeUntilNextTask_msec
+    // @returns whether any maintenance was performed
+    bool RunIdleTasks(Configuration& configuration, unsigned long const timeUntilNextTask_msec)
+    {
+        return RunIdleTasks(configuration, nullptr, 0, timeUntilNextTask_msec);
+    }
+
+    bool RunIdleTasks(Configuration& configuration,
+                      Zone* const rgZones,
+                      size_t const cZones,
+                      unsigned long const timeUntilNextTask_msec)
+    {
+        unsigned long const startTime_msec = millis();
+        bool fPerformedMaintenance = false;
+
+        // Erase first so the configuration write won't have to
+        if (EEPROM.hasPendingErase() && fitsInto(timeUntilNextTask_msec))
+        {
+            EEPROM.performPendingErase();
+
+            // (Carefully phrased to deal with rollovers)
+            recordEraseDuration(millis() - startTime_msec);
+            fPerformedMaintenance = true;
+        }
+
+        if (configuration.HasUnsavedData())
+        {
+            unsigned long const elapsedTime_msec = millis() - startTime_msec;
+
+            if ((elapsedTime_msec < timeUntilNextTask_msec) && fitsInto(timeUntilNextTask_msec - elapsedTime_msec))
+            {
+                Activity saveConfigurationActivity("SaveConfiguration");
+
+                configuration.SaveData();
+                fPerformedMaintenance = true;
+            }
+        }
+
+        for (size_t idxZone = 0; idxZone < cZones; ++idxZone)
+        {
+            if (!rgZones[idxZone].HasUnsavedData())
+            {
+                continue;
+            }
+
+            unsigned long const elapsedTime_msec = millis() - startTime_msec;
+
+            if ((elapsedTime_msec >= timeUntilNextTask_msec) || !fitsInto(timeUntilNextTask_msec - elapsedTime_msec))
+            {
+                break;
+            }
+
+            Activity saveRecoveryRatesActivity("SaveRecoveryRates");
+
+            rgZones[idxZone].SaveData();
+            fPerformedMaintenance = true;
+        }
+
+        return fPerformedMaintenance;
+    }
+
+    //
+    // Diagnostics
+    //
+
+    unsigned long EraseDurationBudget_msec() const
+    {
+        return m_EraseDurationBudget_msec;
+    }
+
+    unsigned long LastEraseDuration_msec() const
+    {
+        return m_LastEraseDuration_msec;
+    }
+
+    unsigned long MaxEraseDuration_msec() const
+    {
+        return m_MaxEraseDuration_msec;
+    }
+
+    uint32_t EraseCount() const
+    {
+        return m_cErases;
+    }
+
+private:
+    bool fitsInto(unsigned long const timeAvailable_msec) const
+    {
+        return timeAvailable_msec >= m_EraseDurationBudget_msec + sc_Margin_msec;
+    }
+
+    void recordEraseDuration(unsigned long const eraseDuration_msec)
+    {
+        m_LastEraseDuration_msec = eraseDuration_msec;
+        m_MaxEraseDuration_msec = std::max(m_MaxEraseDuration_msec, eraseDuration_msec);
+        ++m_cErases;
+
+        // Decay by an eighth per erase (erases are rare, so this tracks the longest of the last dozen or so)
+        m_EraseDurationBudget_msec =
+            std::max(eraseDuration_msec, m_EraseDurationBudget_msec - m_EraseDurationBudget_msec / 8);
+
+        WAF_LOG_INFO("Flash page erase took %lu msec (longest: %lu msec, now budgeting %lu msec)",
+                     eraseDuration_msec,
+                     m_MaxEraseDuration_msec,
+                     m_EraseDurationBudget_msec);
+    }
+
+private:
+    unsigned long m_EraseDurationBudget_msec;
+    unsigned long m_LastEraseDuration_msec;
+    unsigned long m_MaxEraseDuration_msec;
+    uint32_t m_cErases;
+};
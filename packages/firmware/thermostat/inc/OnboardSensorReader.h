@@ -0,0 +1,168 @@
+#pragma once
+
+//
+// Reads the onboard DHT22 (c.f. PietteTech_DHT) without blocking the app thread:
+//
+// - Start() kicks off an interrupt-driven acquisition at the beginning of an acquisition cycle,
+// - the cycle goes on with other work (e.g. the 1-Wire temperature conversion) while the sensor transmits,
+// - Harvest() collects the result afterwards, giving up on (and aborting) acquisitions that haven't
+//   completed within sc_AcquisitionTimeout_msec of starting.
+//
+// The DHT22 mustn't be read more often than every sc_MinimumInterval_msec; Start() skips acquisitions that
+// would be too soon after the previous one. Nor should it be read within sc_PowerUpDelay_msec of powering up,
+// which is left to callers at boot (c.f. setup()).
+//
+// The last good reading is retained along with its timestamp so that callers can fall back on it
+// (within a maximum age of their choosing) when an acquisition fails.
+//
+
+template <typename TSensor>
+class OnboardSensorReader
+{
+public:
+    static unsigned long constexpr sc_MinimumInterval_msec = 2000;
+    static unsigned long constexpr sc_PowerUpDelay_msec = 1000;
+    static unsigned long constexpr sc_AcquisitionTimeout_msec = 100;  // A full transaction takes ~6 msec
+
+    struct Reading
+    {
+        float Temperature;
+        float Humidity;
+        unsigned long Age_msec;  // Time since the reading's acquisition was started
+    };
+
+public:
+    OnboardSensorReader(TSensor& sensor)
+        : m_Sensor(sensor)
+        , m_fIsAcquiring()
+        , m_fHasStarted()
+        , m_StartTime_msec()
+        , m_fHasGoodReading()
+        , m_LastGoodReading()
+        , m_LastGoodReadingTime_msec()
+        , m_LastStatus()
+    {
+    }
+
+    OnboardSensorReader(OnboardSensorReader const&) = delete;
+    OnboardSensorReader& operator=(OnboardSensorReader const&) = delete;
+
+public:
+    //
+    // Operations
+    //
+
+    // Starts an acquisition if the sensor is ready for one; @returns true if an acquisition was started
+    bool Start(unsigned long const currentTime_msec)
+    {
+        if (m_fIsAcquiring)
+        {
+            return false;
+        }
+
+        // (Carefully phrased to deal with rollovers)
+        if (m_fHasStarted && (currentTime_msec - m_StartTime_msec) < sc_MinimumInterval_msec)
+        {
+            return false;
+        }
+
+        int const result = m_Sensor.acquire();
+
+        m_fHasStarted = true;
+        m_StartTime_msec = currentTime_msec;
+        m_fIsAcquiring = (result == DHTLIB_ACQUIRING);
+
+        if (!m_fIsAcquiring)
+        {
+            m_LastStatus = result;
+        }
+
+        return m_fIsAcquiring;
+    }
+
+    // Collects the result of a started acquisition, waiting out the remainder of its timeout if need be;
+    // @returns true if a new good reading was harvested
+    bool Harvest()
+    {
+        if (!m_fIsAcquiring)
+        {
+            return false;
+        }
+
+        m_fIsAcquiring = false;
+
+        // (Carefully phrased to deal with rollovers)
+        while (m_Sensor.acquiring() && (millis() - m_StartTime_msec) < sc_AcquisitionTimeout_msec)
+        {
+            delay(1);
+        }
+
+        if (m_Sensor.acquiring())
+        {
+            // Sensor didn't respond (or stopped responding); release its interrupt so we can try again
+            m_Sensor.abort();
+        }
+
+        m_LastStatus = m_Sensor.getStatus();
+
+        if (m_LastStatus != DHTLIB_OK)
+        {
+            WAF_LOG_WARNING("Error '%d' acquiring DHT22 data.", m_LastStatus);
+            return false;
+        }
+
+        m_fHasGoodReading = true;
+        m_LastGoodReading.Temperature = m_Sensor.getCelsius();
+        m_LastGoodReading.Humidity = m_Sensor.getHumidity();
+        m_LastGoodReadingTime_msec = m_StartTime_msec;
+
+        return true;
+    }
+
+    //
+    // Accessors
+    //
+
+    // @returns the latest good reading if it's no older than maximumAge_msec, NaN values otherwise
+    Reading GetReading(unsigned long const currentTime_msec, unsigned long const maximumAge_msec) const
+    {
+        Reading reading = {NAN, NAN, 0};
+
+        if (!m_fHasGoodReading)
+        {
+            return reading;
+        }
+
+        // (Carefully phrased to deal with rollovers)
+        unsigned long const age_msec = currentTime_msec - m_LastGoodReadingTime_msec;
+
+        if (age_msec > maximumAge_msec)
+        {
+            return reading;
+        }
+
+        reading = m_LastGoodReading;
+        reading.Age_msec = age_msec;
+
+        return reading;
+    }
+
+    int LastStatus() const
+    {
+        return m_LastStatus;
+    }
+
+private:
+    TSensor& m_Sensor;
+
+    // Current acquisition
+    bool m_fIsAcquiring;
+    bool m_fHasStarted;
+    unsigned long m_StartTime_msec;
+
+    // Latest results
+    bool m_fHasGoodReading;
+    Reading m_LastGoodReading;
+    unsigned long m_LastGoodReadingTime_msec;
+    int m_LastStatus;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+//
+// Humidity-derived metrics in single precision for FPU-less targets (the Photon's Cortex-M3 emulates floating point,
+// so double precision log()/exp()/pow() as used by PietteTech_DHT::getDewPoint{Slow}() are comparatively expensive).
+//
+// Dew point uses the Magnus formula (Sonntag 1990 coefficients) with polynomial approximations of ln() and exp().
+// Over -20..50 C and 5..100 %RH, dew points are within 0.1 C of the NOAA formula
+// (c.f. PietteTech_DHT::dewPointSlow() and tests/Psychrometrics.cpp), nearly all of which is down to the
+// Magnus formula itself rather than the polynomial approximations.
+//
+
+namespace Psychrometrics
+{
+float constexpr c_MagnusB = 17.62f;
+float constexpr c_MagnusC_Celsius = 243.12f;
+float constexpr c_MagnusSaturationVaporPressure_hPa = 6.112f;
+
+float constexpr c_Ln2 = 0.69314718f;
+float constexpr c_Log2E = 1.44269504f;
+float constexpr c_Sqrt2 = 1.41421356f;
+
+float constexpr c_WaterVaporGasConstantFactor = 216.7f;  // g*K/(m^3*hPa), i.e. 100 / 461.5 J/(kg*K) * 1000
+float constexpr c_ZeroCelsius_Kelvin = 273.15f;
+
+// Natural logarithm of positive normal values (NaN otherwise), absolute error < 1e-6
+inline float FastLog(float const value)
+{
+    if (!(value > 0.0f))
+    {
+        return NAN;
+    }
+
+    // value = mantissa * 2^exponent with mantissa in [sqrt(1/2), sqrt(2))
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+
+    float mantissa;
+    memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    if (mantissa > c_Sqrt2)
+    {
+        mantissa *= 0.5f;
+        ++exponent;
+    }
+
+    // ln(mantissa) = 2 * atanh(s) with s = (mantissa - 1) / (mantissa + 1), |s| <= 0.172
+    float const s = (mantissa - 1.0f) / (mantissa + 1.0f);
+    float const s2 = s * s;
+
+    float const lnMantissa = 2.0f * s * (1.0f + s2 * (1.0f / 3.0f + s2 * (1.0f / 5.0f + s2 * (1.0f / 7.0f))));
+
+    return static_cast<float>(exponent) * c_Ln2 + lnMantissa;
+}
+
+// Exponential function, relative error < 5e-6
+inline float FastExp(float const value)
+{
+    if (std::isnan(value))
+    {
+        return NAN;
+    }
+
+    // e^value = 2^n * e^t with n integer and |t| <= ln(2) / 2
+    float const scaled = value * c_Log2E;
+
+    if (scaled < -126.0f)
+    {
+        return 0.0f;
+    }
+
+    if (scaled > 127.0f)
+    {
+        return INFINITY;
+    }
+
+    int const n = static_cast<int>(scaled + ((scaled >= 0.0f) ? 0.5f : -0.5f));
+    float const t = (scaled - static_cast<float>(n)) * c_Ln2;
+
+    float const expT =
+        1.0f + t * (1.0f + t * (1.0f / 2.0f + t * (1.0f / 6.0f + t * (1.0f / 24.0f + t * (1.0f / 120.0f)))));
+
+    uint32_t const scaleBits = static_cast<uint32_t>(n + 127) << 23;
+
+    float scale;
+    memcpy(&scale, &scaleBits, sizeof(scale));
+
+    return expT * scale;
+}
+
+// @returns NaN if either input is missing or humidity isn't positive
+inline float DewPoint(float const temperature, float const relativeHumidity)
+{
+    if (std::isnan(temperature) || !(relativeHumidity > 0.0f))
+    {
+        return NAN;
+    }
+
+    // gamma = ln(actual vapor pressure / c_MagnusSaturationVaporPressure_hPa)
+    float const gamma =
+        FastLog(relativeHumidity * 0.01f) + (c_MagnusB * temperature) / (c_MagnusC_Celsius + temperature);
+
+    return (c_MagnusC_Celsius * gamma) / (c_MagnusB - gamma);
+}
+
+// Absolute humidity [g/m^3]; @returns NaN if either input is missing or humidity isn't positive
+inline float AbsoluteHumidity(float const temperature, float const relativeHumidity)
+{
+    if (std::isnan(temperature) || !(relativeHumidity > 0.0f))
+    {
+        return NAN;
+    }
+
+    float const vaporPressure_hPa = c_MagnusSaturationVaporPressure_hPa * relativeHumidity * 0.01f *
+                                    FastExp((c_MagnusB * temperature) / (c_MagnusC_Celsius + temperature));
+
+    return (c_WaterVaporGasConstantFactor * vaporPressure_hPa) / (c_ZeroCelsius_Kelvin + temperature);
+}
+}  // namespace Psychrometrics
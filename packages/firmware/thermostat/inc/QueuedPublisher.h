@@ -70,7 +70,7 @@ private:
 
         if (fSucceeded)
         {
-            Serial.printlnf("Published %s: %s", m_szEventName, szEventData);
+            WAF_LOG_TRACE("Published %s: %s", m_szEventName, szEventData);
         }
 
         return fSucceeded;
@@ -0,0 +1,288 @@
+#pragma once
+
+//
+// Learns how quickly the house heats up (cools down) while heating (cooling)
+// so that ThermostatSetpointScheduler can start recovering towards an upcoming setpoint early enough
+// to reach it by its scheduled time.
+//
+// Every heat/cool period of at least sc_MinimumPeriod_msec yields a rate sample
+// (temperature change between the start and the end of the period over its duration)
+// which is folded into an exponentially weighted moving average.
+//
+// Note that on high-mass systems some of the heat delivered during a period only shows up after it ends,
+// so the learned rates err on the slow side, i.e. recovery errs on the early side.
+//
+// Learned rates are updated at the end of a heat/cool period and persisted to EEPROM (c.f. notes in Configuration.h)
+// by SaveData(), which callers defer to idle windows (c.f. MaintenanceScheduler) since writes can stall on flash page
+// erases. (Should we reset before then, we'll boot with the previously learned rates.)
+//
+
+class RecoveryRateEstimator
+{
+public:
+    RecoveryRateEstimator()
+        : m_EEPROMAddress(sc_EEPROMAddress)
+        , m_Data()
+        , m_fHasUnsavedData()
+        , m_PreviousActions(ThermostatAction::NONE)
+        , m_rgPeriods()
+    {
+    }
+
+public:
+    //
+    // Accessors
+    //
+
+    // @returns degrees C per hour; zero if not yet learned
+    float HeatingRate() const
+    {
+        return m_Data.HeatingRate;
+    }
+
+    // @returns degrees C per hour (positive); zero if not yet learned
+    float CoolingRate() const
+    {
+        return m_Data.CoolingRate;
+    }
+
+    // @returns minutes of heating/cooling required to reach thermostatSetpoint from currentTemperature;
+    //          zero if no recovery is required or rates haven't been learned yet
+    float RequiredRecoveryTime_minutes(ThermostatSetpoint const& thermostatSetpoint,
+                                       float const currentTemperature) const
+    {
+        float requiredRecoveryTime_minutes = 0.0f;
+
+        if (std::isnan(currentTemperature))
+        {
+            return requiredRecoveryTime_minutes;
+        }
+
+        if (!!(thermostatSetpoint.AllowedActions & ThermostatAction::Heat) && (m_Data.HeatingRate > 0.0f) &&
+            (currentTemperature < thermostatSetpoint.SetPointHeat))
+        {
+            requiredRecoveryTime_minutes = std::max(
+                requiredRecoveryTime_minutes,
+                (thermostatSetpoint.SetPointHeat - currentTemperature) / m_Data.HeatingRate * 60.0f);
+        }
+
+        if (!!(thermostatSetpoint.AllowedActions & ThermostatAction::Cool) && (m_Data.CoolingRate > 0.0f) &&
+            (currentTemperature > thermostatSetpoint.SetPointCool))
+        {
+            requiredRecoveryTime_minutes = std::max(
+                requiredRecoveryTime_minutes,
+                (currentTemperature - thermostatSetpoint.SetPointCool) / m_Data.CoolingRate * 60.0f);
+        }
+
+        return requiredRecoveryTime_minutes;
+    }
+
+    bool HasUnsavedData() const
+    {
+        return m_fHasUnsavedData;
+    }
+
+    //
+    // Operations
+    //
+
+    // @param idxInstance: selects where to persist data (e.g. per zone)
+    void Initialize(uint8_t const idxInstance)
+    {
+        int const eepromAddress = sc_EEPROMAddress + idxInstance * sizeof(PersistedData);
+
+        if (m_fHasUnsavedData && (eepromAddress == m_EEPROMAddress))
+        {
+            // (Rates learned since the last save are newer than what's persisted)
+            return;
+        }
+
+        m_EEPROMAddress = eepromAddress;
+        m_fHasUnsavedData = false;
+
+        EEPROM.get(m_EEPROMAddress, m_Data);
+
+        bool const fIsValid = (m_Data.Signature == PersistedData::sc_Signature) &&
+                              (m_Data.Version == PersistedData::sc_CurrentVersion) &&
+                              IsPlausibleRate(m_Data.HeatingRate) && IsPlausibleRate(m_Data.CoolingRate);
+
+        if (!fIsValid)
+        {
+            m_Data = PersistedData();
+        }
+
+        WAF_LOG_INFO("Recovery rates: heating %.2f C/h (%u samples), cooling %.2f C/h (%u samples)",
+                     m_Data.HeatingRate,
+                     m_Data.cHeatingSamples,
+                     m_Data.CoolingRate,
+                     m_Data.cCoolingSamples);
+    }
+
+    // Call after every Thermostat::Apply() with the resulting actions
+    void Observe(ThermostatAction const currentActions,
+                 float const currentTemperature,
+                 unsigned long const currentTime_msec)
+    {
+        bool fHasUpdated = false;
+
+        fHasUpdated |= ObservePeriod(m_rgPeriods[sc_idxHeat],
+                                     ThermostatAction::Heat,
+                                     currentActions,
+                                     currentTemperature,
+                                     currentTime_msec,
+                                     m_Data.HeatingRate,
+                                     m_Data.cHeatingSamples);
+
+        fHasUpdated |= ObservePeriod(m_rgPeriods[sc_idxCool],
+                                     ThermostatAction::Cool,
+                                     currentActions,
+                                     currentTemperature,
+                                     currentTime_msec,
+                                     m_Data.CoolingRate,
+                                     m_Data.cCoolingSamples);
+
+        m_PreviousActions = currentActions;
+
+        if (fHasUpdated)
+        {
+            WAF_LOG_INFO(
+                "Recovery rates updated: heating %.2f C/h, cooling %.2f C/h", m_Data.HeatingRate, m_Data.CoolingRate);
+
+            // Persist data later (c.f. SaveData())
+            m_fHasUnsavedData = true;
+        }
+    }
+
+    void SaveData()
+    {
+        EEPROM.put(m_EEPROMAddress, m_Data);
+        m_fHasUnsavedData = false;
+    }
+
+private:
+    struct PersistedData
+    {
+        uint16_t Signature;
+        uint16_t Version;
+
+        float HeatingRate;
+        float CoolingRate;
+
+        uint16_t cHeatingSamples;
+        uint16_t cCoolingSamples;
+
+        PersistedData()
+            : Signature(sc_Signature)
+            , Version(sc_CurrentVersion)
+            , HeatingRate()
+            , CoolingRate()
+            , cHeatingSamples()
+            , cCoolingSamples()
+        {
+        }
+
+        static constexpr uint16_t sc_Signature = 0x8234;
+        static constexpr uint16_t sc_CurrentVersion = 1;
+    };
+
+    struct Period
+    {
+        bool fIsValid;
+        float StartTemperature;
+        unsigned long StartTime_msec;
+    };
+
+    // Placed well past Configuration's data (c.f. Configuration::sc_EEPROMAddress)
+    static constexpr int sc_EEPROMAddress = 1024;
+
+    // Shorter periods are dominated by sensor resolution and noise
+    static constexpr unsigned long sc_MinimumPeriod_msec = 15 * 60 * 1000;
+
+    // Weight of each new sample (the first sample is adopted as-is)
+    static constexpr float sc_SmoothingFactor = 0.3f;
+
+    // Samples outside of this range [C/h] are discarded as implausible
+    static constexpr float sc_MinimumRate = 0.05f;
+    static constexpr float sc_MaximumRate = 20.0f;
+
+    static size_t constexpr sc_idxHeat = 0;
+    static size_t constexpr sc_idxCool = 1;
+
+    int m_EEPROMAddress;
+    PersistedData m_Data;
+    bool m_fHasUnsavedData;
+
+    ThermostatAction m_PreviousActions;
+    Period m_rgPeriods[2];
+
+private:
+    static bool IsPlausibleRate(float const rate)
+    {
+        return (rate == 0.0f) || ((rate >= sc_MinimumRate) && (rate <= sc_MaximumRate));
+    }
+
+    // @returns whether rate has been updated
+    bool ObservePeriod(Period& period,
+                       ThermostatAction const action,
+                       ThermostatAction const currentActions,
+                       float const currentTemperature,
+                       unsigned long const currentTime_msec,
+                       float& rate,
+                       uint16_t& cSamples)
+    {
+        bool const fWasActive = !!(m_PreviousActions & action);
+        bool const fIsActive = !!(currentActions & action);
+
+        if (!fWasActive && fIsActive)
+        {
+            // Period starts
+            period.fIsValid = !std::isnan(currentTemperature);
+            period.StartTemperature = currentTemperature;
+            period.StartTime_msec = currentTime_msec;
+
+            return false;
+        }
+
+        if (!(fWasActive && !fIsActive))
+        {
+            // No period ending
+            return false;
+        }
+
+        // Period ends
+        if (!period.fIsValid || std::isnan(currentTemperature))
+        {
+            return false;
+        }
+
+        period.fIsValid = false;
+
+        // (Carefully phrased to deal with rollovers)
+        unsigned long const duration_msec = currentTime_msec - period.StartTime_msec;
+
+        if (duration_msec < sc_MinimumPeriod_msec)
+        {
+            return false;
+        }
+
+        float const temperatureChange = (action == ThermostatAction::Heat)
+                                            ? (currentTemperature - period.StartTemperature)
+                                            : (period.StartTemperature - currentTemperature);
+
+        float const sampleRate = temperatureChange / (duration_msec / static_cast<float>(60 * 60 * 1000));
+
+        if (sampleRate < sc_MinimumRate || sampleRate > sc_MaximumRate)
+        {
+            return false;
+        }
+
+        rate = (cSamples == 0) ? sampleRate : (rate + sc_SmoothingFactor * (sampleRate - rate));
+
+        if (cSamples < static_cast<uint16_t>(-1))
+        {
+            ++cSamples;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+//
+// Control state kept in retained memory (the Photon's backup SRAM, c.f. FEATURE_RETAINED_MEMORY) across resets and
+// brownouts, so that zones can drive their relays the way they last did right at boot rather than leaving them off
+// until the first acquisition has completed (c.f. setup()).
+//
+// Retained memory isn't initialized by the runtime (hence no constructors here): contents are only trusted once
+// IsValid() has checked the signature, version, and checksum.
+//
+
+struct RetainedState
+{
+    static uint32_t constexpr sc_Signature = 0x52464157;  // "WAFR"
+    static uint16_t constexpr sc_CurrentVersion = 1;
+
+    uint32_t Signature;
+    uint16_t Version;
+    uint16_t cZones;
+
+    // Hash of the configuration in use (c.f. Configuration::Hash()), only ever recorded for configurations that have
+    // passed verification so that a matching stored configuration needn't be verified again at boot
+    uint32_t ConfigurationHash;
+
+    // Latest relay actions of each zone (c.f. ThermostatAction)
+    uint8_t rgZoneActions[Configuration::sc_cZones_Max];
+
+    uint32_t Checksum;
+
+    //
+    // Operations
+    //
+
+    bool IsValid() const
+    {
+        return (Signature == sc_Signature) && (Version == sc_CurrentVersion) &&
+               (cZones <= Configuration::sc_cZones_Max) && (Checksum == ComputeChecksum());
+    }
+
+    // Cheap enough to call on every control pass (retained memory is plain RAM)
+    void Update(uint32_t const configurationHash, ThermostatAction const* const rgActions, size_t const cActions)
+    {
+        Signature = sc_Signature;
+        Version = sc_CurrentVersion;
+        cZones = static_cast<uint16_t>(std::min(cActions, countof(rgZoneActions)));
+        ConfigurationHash = configurationHash;
+
+        for (size_t idxZone = 0; idxZone < countof(rgZoneActions); ++idxZone)
+        {
+            rgZoneActions[idxZone] = (idxZone < cZones) ? static_cast<uint8_t>(rgActions[idxZone]) : 0;
+        }
+
+        Checksum = ComputeChecksum();
+    }
+
+private:
+    uint32_t ComputeChecksum() const
+    {
+        return Configuration::ComputeHash(reinterpret_cast<uint8_t const*>(this), offsetof(RetainedState, Checksum));
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+//
+// Constant-space min/max/mean/last accumulator.
+// NaN values (i.e. failed measurements) are ignored.
+//
+
+class RunningStatistics
+{
+public:
+    RunningStatistics()
+        : m_Min(NAN)
+        , m_Max(NAN)
+        , m_Sum(0.0f)
+        , m_Last(NAN)
+        , m_Count(0)
+    {
+    }
+
+public:
+    void Add(float const value)
+    {
+        if (std::isnan(value))
+        {
+            return;
+        }
+
+        m_Min = (m_Count == 0) ? value : std::min(m_Min, value);
+        m_Max = (m_Count == 0) ? value : std::max(m_Max, value);
+        m_Sum += value;
+        m_Last = value;
+
+        ++m_Count;
+    }
+
+    void Reset()
+    {
+        *this = RunningStatistics();
+    }
+
+    uint16_t Count() const
+    {
+        return m_Count;
+    }
+
+    float Min() const
+    {
+        return m_Min;
+    }
+
+    float Max() const
+    {
+        return m_Max;
+    }
+
+    float Mean() const
+    {
+        return (m_Count > 0) ? (m_Sum / m_Count) : NAN;
+    }
+
+    float Last() const
+    {
+        return m_Last;
+    }
+
+private:
+    float m_Min;
+    float m_Max;
+    float m_Sum;
+    float m_Last;
+    uint16_t m_Count;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+//
+// Lock-free, fixed-capacity queue for exactly one producer thread and one consumer thread
+// (c.f. AcquisitionChannel).
+//
+// - The producer only ever writes m_idxWrite, the consumer only ever writes m_idxRead; each publishes its index
+//   with a release store that the other side picks up with an acquire load, so an item's contents are complete
+//   before it's visible to the consumer, and a slot is only reused once the consumer is done with it.
+// - Indices run freely (wrapping at 2^32) and are reduced modulo the capacity, which hence must be a power of two.
+// - Items can be filled and read in place (prepare_push()/commit_push(), front()/pop()) so that large items
+//   needn't be copied through the queue.
+//
+// Neither side ever waits on the other: pushing into a full queue fails, leaving it up to the producer
+// whether to retry or drop the item.
+//
+
+template <typename T, uint8_t nItems_Max>
+class SPSCQueue
+{
+    static_assert(nItems_Max > 0 && (nItems_Max & (nItems_Max - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    typedef uint32_t size_type;
+
+public:
+    SPSCQueue()
+        : m_rgItems()
+        , m_idxWrite(0)
+        , m_idxRead(0)
+    {
+    }
+
+    SPSCQueue(SPSCQueue const&) = delete;
+    SPSCQueue& operator=(SPSCQueue const&) = delete;
+
+public:
+    //
+    // Either thread
+    //
+
+    bool empty() const
+    {
+        return (size() == 0);
+    }
+
+    // (A snapshot that may be stale by the time it's returned unless called by the consumer [for non-emptiness]
+    //  or the producer [for non-fullness])
+    size_type size() const
+    {
+        // (Carefully phrased to deal with index wraparound)
+        return m_idxWrite.load(std::memory_order_acquire) - m_idxRead.load(std::memory_order_acquire);
+    }
+
+    size_type constexpr capacity() const
+    {
+        return nItems_Max;
+    }
+
+    //
+    // Producer
+    //
+
+    // @returns the slot to fill in place, or nullptr if the queue is full
+    T* prepare_push()
+    {
+        size_type const idxWrite = m_idxWrite.load(std::memory_order_relaxed);
+
+        if (idxWrite - m_idxRead.load(std::memory_order_acquire) >= nItems_Max)
+        {
+            return nullptr;
+        }
+
+        return &m_rgItems[idxWrite % nItems_Max];
+    }
+
+    // Makes the slot returned by prepare_push() visible to the consumer
+    void commit_push()
+    {
+        m_idxWrite.store(m_idxWrite.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // @returns false if the queue is full
+    bool push(T const& item)
+    {
+        T* const pItem = prepare_push();
+
+        if (!pItem)
+        {
+            return false;
+        }
+
+        *pItem = item;
+        commit_push();
+
+        return true;
+    }
+
+    //
+    // Consumer
+    //
+
+    // @returns the oldest item, or nullptr if the queue is empty
+    T const* front() const
+    {
+        size_type const idxRead = m_idxRead.load(std::memory_order_relaxed);
+
+        if (idxRead == m_idxWrite.load(std::memory_order_acquire))
+        {
+            return nullptr;
+        }
+
+        return &m_rgItems[idxRead % nItems_Max];
+    }
+
+    // Releases the item returned by front() back to the producer
+    void pop()
+    {
+        m_idxRead.store(m_idxRead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // @returns false if the queue is empty
+    bool pop(T& item)
+    {
+        T const* const pItem = front();
+
+        if (!pItem)
+        {
+            return false;
+        }
+
+        item = *pItem;
+        pop();
+
+        return true;
+    }
+
+private:
+    T m_rgItems[nItems_Max];
+
+    // (32 bits wide so loads and stores are plain, lock-free word accesses on the device)
+    std::atomic<size_type> m_idxWrite;
+    std::atomic<size_type> m_idxRead;
+};
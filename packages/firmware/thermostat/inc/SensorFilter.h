@@ -0,0 +1,189 @@
+#pragma once
+
+//
+// Per-sensor smoothing between acquisition and control (c.f. sensorFilterType).
+//
+// Control (sensor fusion, external sensor override, Thermostat) works off filtered values
+// so that sensor jitter doesn't cause relay chatter at tight thresholds;
+// published per-sensor values remain raw.
+//
+// Filter state persists across control cycles. Missing (NaN) readings pass through as NaN without
+// disturbing the filter's state, so it picks up where it left off once the sensor recovers.
+//
+
+class ScalarFilter
+{
+public:
+    ScalarFilter()
+        : m_fHasValue()
+        , m_Value()
+        , m_ErrorVariance()
+    {
+    }
+
+public:
+    void Reset()
+    {
+        *this = ScalarFilter();
+    }
+
+    // @param smoothingFactor: weight of the new reading in (0, 1]
+    float UpdateExponentialMovingAverage(float const value, float const smoothingFactor)
+    {
+        if (std::isnan(value))
+        {
+            return value;
+        }
+
+        if (!m_fHasValue)
+        {
+            m_fHasValue = true;
+            m_Value = value;
+        }
+        else
+        {
+            m_Value += smoothingFactor * (value - m_Value);
+        }
+
+        return m_Value;
+    }
+
+    // Scalar Kalman filter for a slowly drifting level observed through noisy readings
+    // @param processNoiseVariance: expected variance of the true temperature's change between readings [C^2]
+    // @param measurementNoiseVariance: variance of the sensor's noise [C^2]
+    float UpdateKalman(float const value, float const processNoiseVariance, float const measurementNoiseVariance)
+    {
+        if (std::isnan(value))
+        {
+            return value;
+        }
+
+        if (!m_fHasValue)
+        {
+            m_fHasValue = true;
+            m_Value = value;
+            m_ErrorVariance = measurementNoiseVariance;
+        }
+        else
+        {
+            // Predict
+            float const predictedErrorVariance = m_ErrorVariance + processNoiseVariance;
+
+            // Update
+            float const kalmanGain = predictedErrorVariance / (predictedErrorVariance + measurementNoiseVariance);
+
+            m_Value += kalmanGain * (value - m_Value);
+            m_ErrorVariance = (1.0f - kalmanGain) * predictedErrorVariance;
+        }
+
+        return m_Value;
+    }
+
+private:
+    bool m_fHasValue;
+    float m_Value;
+    float m_ErrorVariance;
+};
+
+template <uint8_t c_cOneWireDevices_Max>
+class SensorFilterBank
+{
+public:
+    SensorFilterBank()
+        : m_FilterType(SensorFilterType::None)
+        , m_OnboardFilter()
+        , m_rgAddresses()
+        , m_rgExternalFilters()
+        , m_cAddresses()
+    {
+    }
+
+public:
+    float FilterOnboard(Configuration const& configuration, float const value)
+    {
+        ApplyConfiguration(configuration);
+        return Filter(configuration, m_OnboardFilter, value);
+    }
+
+    float FilterExternal(Configuration const& configuration, OneWireAddress const& address, float const value)
+    {
+        ApplyConfiguration(configuration);
+
+        ScalarFilter* const pFilter = FindOrAddFilter(address);
+
+        if (!pFilter)
+        {
+            // Out of space, pass through unfiltered
+            return value;
+        }
+
+        return Filter(configuration, *pFilter, value);
+    }
+
+private:
+    SensorFilterType m_FilterType;
+
+    ScalarFilter m_OnboardFilter;
+
+    OneWireAddress m_rgAddresses[c_cOneWireDevices_Max];
+    ScalarFilter m_rgExternalFilters[c_cOneWireDevices_Max];
+    size_t m_cAddresses;
+
+private:
+    void ApplyConfiguration(Configuration const& configuration)
+    {
+        SensorFilterType const filterType = configuration.rootConfiguration().sensorFilterType();
+
+        if (filterType != m_FilterType)
+        {
+            // Filter state isn't transferable between filter types, start over
+            m_FilterType = filterType;
+            m_OnboardFilter.Reset();
+            m_cAddresses = 0;
+        }
+    }
+
+    static float Filter(Configuration const& configuration, ScalarFilter& filter, float const value)
+    {
+        auto const& rootConfiguration = configuration.rootConfiguration();
+
+        switch (rootConfiguration.sensorFilterType())
+        {
+            case SensorFilterType::ExponentialMovingAverage:
+                return filter.UpdateExponentialMovingAverage(
+                    value, clamp(rootConfiguration.sensorFilterSmoothing_x100() / 100.0f, 0.01f, 1.0f));
+
+            case SensorFilterType::Kalman:
+                return filter.UpdateKalman(value,
+                                           rootConfiguration.sensorFilterProcessNoise_x10000() / 10000.0f,
+                                           std::max(rootConfiguration.sensorFilterMeasurementNoise_x10000(),
+                                                    static_cast<uint16_t>(1)) /
+                                               10000.0f);
+
+            case SensorFilterType::None:
+            default:
+                return value;
+        }
+    }
+
+    ScalarFilter* FindOrAddFilter(OneWireAddress const& address)
+    {
+        for (size_t idxAddress = 0; idxAddress < m_cAddresses; ++idxAddress)
+        {
+            if (m_rgAddresses[idxAddress] == address)
+            {
+                return &m_rgExternalFilters[idxAddress];
+            }
+        }
+
+        if (m_cAddresses >= countof(m_rgAddresses))
+        {
+            return nullptr;
+        }
+
+        m_rgAddresses[m_cAddresses] = address;
+        m_rgExternalFilters[m_cAddresses].Reset();
+
+        return &m_rgExternalFilters[m_cAddresses++];
+    }
+};
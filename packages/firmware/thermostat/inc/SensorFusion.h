@@ -0,0 +1,253 @@
+#pragma once
+
+//
+// Fuses the operable temperature from the sensors listed in the configuration's sensorFusionInputs
+// so that a single misbehaving sensor can't drive the thermostat on its own.
+//
+// Each input's reading is checked against physical bounds; inputs without a fresh reading fall back to their
+// last good reading for up to sc_cMaximumAgeInCadences cadences before being considered stale.
+// Surviving readings are combined per sensorFusionMethod.
+//
+// Per-input status is retained for reporting (c.f. StatusPublisher).
+//
+
+template <uint8_t c_cOneWireDevices_Max>
+class SensorFusion
+{
+public:
+    enum class InputStatus : char
+    {
+        Fresh = 'F',        // reading from this cycle
+        Held = 'H',         // no reading this cycle, last good reading still recent enough
+        Stale = 'S',        // no reading recent enough
+        OutOfBounds = 'B',  // reading outside of physical bounds
+    };
+
+public:
+    SensorFusion()
+        : m_rgInputStates()
+        , m_cInputs()
+        , m_fUsedExternalSensor()
+    {
+    }
+
+public:
+    //
+    // Accessors
+    //
+
+    static bool IsConfigured(Configuration const& configuration)
+    {
+        auto const pvInputs = configuration.rootConfiguration().sensorFusionInputs();
+        return pvInputs && (pvInputs->size() > 0);
+    }
+
+    size_t InputCount() const
+    {
+        return m_cInputs;
+    }
+
+    InputStatus GetInputStatus(size_t const idxInput) const
+    {
+        return m_rgInputStates[idxInput].Status;
+    }
+
+    bool UsedExternalSensor() const
+    {
+        return m_fUsedExternalSensor;
+    }
+
+    //
+    // Operations
+    //
+
+    // @returns fused temperature, or NaN if no input had a usable reading
+    float Fuse(Configuration const& configuration,
+               float const onboardTemperature,
+               SensorRegistry<c_cOneWireDevices_Max> const& sensorRegistry,
+               unsigned long const currentTime_msec)
+    {
+        auto const& rootConfiguration = configuration.rootConfiguration();
+        auto const pvInputs = rootConfiguration.sensorFusionInputs();
+
+        m_cInputs = pvInputs ? std::min(static_cast<size_t>(pvInputs->size()), countof(m_rgInputStates)) : 0;
+        m_fUsedExternalSensor = false;
+
+        unsigned long const maximumAge_msec = sc_cMaximumAgeInCadences * rootConfiguration.cadence() * 1000UL;
+
+        Candidate rgCandidates[sc_cInputs_Max];
+        size_t cCandidates = 0;
+
+        for (size_t idxInput = 0; idxInput < m_cInputs; ++idxInput)
+        {
+            auto const& input = *pvInputs->Get(idxInput);
+            InputState& inputState = m_rgInputStates[idxInput];
+
+            if (inputState.SensorId != input.sensorId())
+            {
+                // Configuration has changed, forget what we knew about this slot
+                inputState = InputState();
+                inputState.SensorId = input.sensorId();
+            }
+
+            float const reading = (input.sensorId() == 0) ? onboardTemperature
+                                                          : sensorRegistry.GetCurrentTemperature(input.sensorId());
+
+            if (!std::isnan(reading))
+            {
+                if (reading < sc_MinimumPlausibleTemperature || reading > sc_MaximumPlausibleTemperature)
+                {
+                    inputState.Status = InputStatus::OutOfBounds;
+                    continue;
+                }
+
+                inputState.fHasReading = true;
+                inputState.LatestReading = reading;
+                inputState.LatestReadingTime_msec = currentTime_msec;
+                inputState.Status = InputStatus::Fresh;
+            }
+            else if (inputState.fHasReading &&
+                     ((currentTime_msec - inputState.LatestReadingTime_msec) <= maximumAge_msec))  // (rollover-safe)
+            {
+                inputState.Status = InputStatus::Held;
+            }
+            else
+            {
+                inputState.Status = InputStatus::Stale;
+                continue;
+            }
+
+            if (!input.weight())
+            {
+                // Monitored only
+                continue;
+            }
+
+            rgCandidates[cCandidates].Value = inputState.LatestReading;
+            rgCandidates[cCandidates].Weight = input.weight();
+            ++cCandidates;
+
+            if (input.sensorId() != 0)
+            {
+                m_fUsedExternalSensor = true;
+            }
+        }
+
+        if (!cCandidates)
+        {
+            return NAN;
+        }
+
+        // Sort by value (insertion sort; there's only a handful)
+        for (size_t idxCandidate = 1; idxCandidate < cCandidates; ++idxCandidate)
+        {
+            Candidate const candidate = rgCandidates[idxCandidate];
+            size_t idxInsert = idxCandidate;
+
+            for (; idxInsert > 0 && rgCandidates[idxInsert - 1].Value > candidate.Value; --idxInsert)
+            {
+                rgCandidates[idxInsert] = rgCandidates[idxInsert - 1];
+            }
+
+            rgCandidates[idxInsert] = candidate;
+        }
+
+        switch (rootConfiguration.sensorFusionMethod())
+        {
+            case SensorFusionMethod::TrimmedMean:
+                return getTrimmedMean(rgCandidates, cCandidates);
+
+            case SensorFusionMethod::WeightedMedian:
+            default:
+                return getWeightedMedian(rgCandidates, cCandidates);
+        }
+    }
+
+private:
+    struct InputState
+    {
+        uint64_t SensorId;
+
+        bool fHasReading;
+        float LatestReading;
+        unsigned long LatestReadingTime_msec;
+
+        InputStatus Status;
+
+        InputState()
+            : SensorId()
+            , fHasReading()
+            , LatestReading()
+            , LatestReadingTime_msec()
+            , Status(InputStatus::Stale)
+        {
+        }
+    };
+
+    struct Candidate
+    {
+        float Value;
+        uint8_t Weight;
+    };
+
+    // Every external sensor plus the onboard sensor
+    static size_t constexpr sc_cInputs_Max = c_cOneWireDevices_Max + 1;
+
+    static unsigned long constexpr sc_cMaximumAgeInCadences = 3;
+
+    static constexpr float sc_MinimumPlausibleTemperature = -20.0f;
+    static constexpr float sc_MaximumPlausibleTemperature = 60.0f;
+
+    InputState m_rgInputStates[sc_cInputs_Max];
+    size_t m_cInputs;
+    bool m_fUsedExternalSensor;
+
+private:
+    // @param rgCandidates: sorted by value
+    static float getWeightedMedian(Candidate const* const rgCandidates, size_t const cCandidates)
+    {
+        uint32_t totalWeight = 0;
+
+        for (size_t idxCandidate = 0; idxCandidate < cCandidates; ++idxCandidate)
+        {
+            totalWeight += rgCandidates[idxCandidate].Weight;
+        }
+
+        uint32_t cumulativeWeight = 0;
+
+        for (size_t idxCandidate = 0; idxCandidate < cCandidates; ++idxCandidate)
+        {
+            cumulativeWeight += rgCandidates[idxCandidate].Weight;
+
+            if (2 * cumulativeWeight == totalWeight)
+            {
+                // Exactly half the weight on either side: split the difference
+                return (rgCandidates[idxCandidate].Value + rgCandidates[idxCandidate + 1].Value) / 2.0f;
+            }
+
+            if (2 * cumulativeWeight > totalWeight)
+            {
+                return rgCandidates[idxCandidate].Value;
+            }
+        }
+
+        return rgCandidates[cCandidates - 1].Value;
+    }
+
+    // @param rgCandidates: sorted by value
+    static float getTrimmedMean(Candidate const* const rgCandidates, size_t const cCandidates)
+    {
+        size_t const cTrimmed = (cCandidates >= 3) ? 1 : 0;
+
+        float weightedSum = 0.0f;
+        uint32_t totalWeight = 0;
+
+        for (size_t idxCandidate = cTrimmed; idxCandidate < cCandidates - cTrimmed; ++idxCandidate)
+        {
+            weightedSum += rgCandidates[idxCandidate].Value * rgCandidates[idxCandidate].Weight;
+            totalWeight += rgCandidates[idxCandidate].Weight;
+        }
+
+        return weightedSum / totalWeight;
+    }
+};
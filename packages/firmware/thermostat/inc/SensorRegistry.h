@@ -0,0 +1,276 @@
+#pragma once
+
+//
+// External sensors known to the control thread, keyed by their 64-bit address (c.f. OneWireAddress::Value())
+// in an open-addressed hash table sized at compile time, so control, sensor fusion, and aggregation can look up
+// a configured sensor id in constant time rather than scanning the latest acquisition.
+//
+// Sensors are registered as acquisitions come in (c.f. Update()) and keep their index for as long as they're around,
+// along with per-sensor metadata: roles, hex id (rendered once at registration), latest readings, failure counts,
+// and the resolution the sensor is configured for.
+//
+// There's no removal: if a new sensor shows up while the registry is full, it starts over with the latest acquisition.
+//
+
+template <uint8_t c_cSensors_Max>
+class SensorRegistry
+{
+    static_assert(c_cSensors_Max <= 32, "Presence masks are 32 bits wide");
+
+public:
+    static size_t constexpr sc_idxNotFound = static_cast<size_t>(-1);
+
+    // Roles
+    static uint8_t constexpr sc_RoleOperable = 0x01;  // Sole source of the operable temperature (c.f. externalSensorId)
+
+    struct SensorInfo
+    {
+        OneWireAddress Id;
+        char szId[OneWireAddress::sc_cchAsHexString_WithTerminator];
+
+        uint8_t Roles;           // c.f. sc_Role*
+        uint8_t ResolutionBits;  // As configured on the sensor (zero if unknown)
+
+        // Latest successful reading
+        float Value;          // Raw, for publishing
+        float FilteredValue;  // Filtered, for control
+        unsigned long ReadingTime_msec;
+
+        // Failed or missed readings
+        uint16_t cConsecutiveFailures;
+        uint32_t cFailures;
+
+        bool HasRole(uint8_t const role) const
+        {
+            return !!(Roles & role);
+        }
+    };
+
+public:
+    SensorRegistry()
+        : m_rgSensors()
+        , m_cSensors()
+        , m_rgidxBuckets()
+        , m_CurrentMask()
+    {
+    }
+
+public:
+    //
+    // Operations
+    //
+
+    // Registers the acquisition's sensors and records their readings (including failures of sensors that are missing)
+    // Roles are reassigned every acquisition (c.f. SetRoles()).
+    void Update(SensorSnapshot<c_cSensors_Max> const& snapshot)
+    {
+        uint32_t presentMask = 0;
+        uint32_t currentMask = 0;
+
+        for (size_t idxSlot = 0; idxSlot < snapshot.cSensors; ++idxSlot)
+        {
+            size_t idxSensor = findOrAdd(snapshot.rgIds[idxSlot]);
+
+            if (idxSensor == sc_idxNotFound)
+            {
+                // Full: start over with the sensors that are actually around (dropping those seen so far)
+                Clear();
+                presentMask = 0;
+                currentMask = 0;
+
+                for (size_t idxPreviousSlot = 0; idxPreviousSlot < idxSlot; ++idxPreviousSlot)
+                {
+                    size_t const idxPreviousSensor = findOrAdd(snapshot.rgIds[idxPreviousSlot]);
+
+                    presentMask |= (1UL << idxPreviousSensor);
+                    recordReading(idxPreviousSensor, snapshot, idxPreviousSlot, currentMask);
+                }
+
+                idxSensor = findOrAdd(snapshot.rgIds[idxSlot]);
+            }
+
+            presentMask |= (1UL << idxSensor);
+            recordReading(idxSensor, snapshot, idxSlot, currentMask);
+        }
+
+        for (size_t idxSensor = 0; idxSensor < m_cSensors; ++idxSensor)
+        {
+            SensorInfo& sensor = m_rgSensors[idxSensor];
+
+            sensor.Roles = 0;
+
+            if (!(presentMask & (1UL << idxSensor)))
+            {
+                // Gone missing from the bus
+                recordFailure(sensor);
+            }
+        }
+
+        m_CurrentMask = currentMask;
+    }
+
+    // @returns false if the sensor isn't registered
+    bool SetRoles(uint64_t const id, uint8_t const roles)
+    {
+        size_t const idxSensor = Find(id);
+
+        if (idxSensor == sc_idxNotFound)
+        {
+            return false;
+        }
+
+        m_rgSensors[idxSensor].Roles = roles;
+        return true;
+    }
+
+    void Clear()
+    {
+        m_cSensors = 0;
+        m_CurrentMask = 0;
+
+        memset(m_rgidxBuckets, 0, sizeof(m_rgidxBuckets));
+    }
+
+    //
+    // Accessors
+    //
+
+    size_t Count() const
+    {
+        return m_cSensors;
+    }
+
+    SensorInfo const& operator[](size_t const idxSensor) const
+    {
+        return m_rgSensors[idxSensor];
+    }
+
+    // @returns the sensor's index, or sc_idxNotFound if it isn't registered
+    size_t Find(uint64_t const id) const
+    {
+        if (!id)
+        {
+            // (Zero isn't a sensor address: configurations use it to refer to the onboard sensor)
+            return sc_idxNotFound;
+        }
+
+        for (size_t idxBucket = getBucket(id);; idxBucket = (idxBucket + 1) % sc_cBuckets)
+        {
+            uint8_t const idxSensorPlusOne = m_rgidxBuckets[idxBucket];
+
+            if (!idxSensorPlusOne)
+            {
+                return sc_idxNotFound;
+            }
+
+            if (m_rgSensors[idxSensorPlusOne - 1].Id.Value() == id)
+            {
+                return idxSensorPlusOne - 1;
+            }
+        }
+    }
+
+    // Whether the sensor was read successfully in the latest acquisition
+    bool IsCurrent(size_t const idxSensor) const
+    {
+        return !!(m_CurrentMask & (1UL << idxSensor));
+    }
+
+    // @returns the sensor's filtered reading from the latest acquisition, or NaN if there's none
+    float GetCurrentTemperature(uint64_t const id) const
+    {
+        size_t const idxSensor = Find(id);
+
+        return ((idxSensor != sc_idxNotFound) && IsCurrent(idxSensor)) ? m_rgSensors[idxSensor].FilteredValue : NAN;
+    }
+
+private:
+    // At most half full so probe sequences stay short
+    static size_t constexpr sc_cBuckets = roundUpToPowerOfTwo(2 * c_cSensors_Max);
+
+    SensorInfo m_rgSensors[c_cSensors_Max];
+    size_t m_cSensors;
+
+    uint8_t m_rgidxBuckets[sc_cBuckets];  // Index into m_rgSensors plus one, zero if empty
+    uint32_t m_CurrentMask;               // Sensors read successfully in the latest acquisition
+
+private:
+    static size_t getBucket(uint64_t const id)
+    {
+        // Fold, then multiplicative (Fibonacci) hash, sticking to 32-bit arithmetic for the device's sake
+        uint32_t const foldedId = static_cast<uint32_t>(id) ^ static_cast<uint32_t>(id >> 32);
+
+        return static_cast<size_t>(static_cast<uint32_t>(foldedId * 2654435761U) >> 16) % sc_cBuckets;
+    }
+
+    size_t findOrAdd(OneWireAddress const& address)
+    {
+        uint64_t const id = address.Value();
+        size_t idxBucket = getBucket(id);
+
+        for (;; idxBucket = (idxBucket + 1) % sc_cBuckets)
+        {
+            uint8_t const idxSensorPlusOne = m_rgidxBuckets[idxBucket];
+
+            if (!idxSensorPlusOne)
+            {
+                break;
+            }
+
+            if (m_rgSensors[idxSensorPlusOne - 1].Id.Value() == id)
+            {
+                return idxSensorPlusOne - 1;
+            }
+        }
+
+        if (m_cSensors >= c_cSensors_Max)
+        {
+            return sc_idxNotFound;
+        }
+
+        SensorInfo& sensor = m_rgSensors[m_cSensors];
+
+        sensor = SensorInfo();
+        sensor.Id = address;
+        address.ToString(sensor.szId);
+        sensor.Value = NAN;
+        sensor.FilteredValue = NAN;
+
+        m_rgidxBuckets[idxBucket] = static_cast<uint8_t>(m_cSensors + 1);
+
+        return m_cSensors++;
+    }
+
+    static void recordFailure(SensorInfo& sensor)
+    {
+        if (sensor.cConsecutiveFailures < UINT16_MAX)
+        {
+            ++sensor.cConsecutiveFailures;
+        }
+
+        ++sensor.cFailures;
+    }
+
+    void recordReading(size_t const idxSensor,
+                       SensorSnapshot<c_cSensors_Max> const& snapshot,
+                       size_t const idxSlot,
+                       uint32_t& currentMask)
+    {
+        SensorInfo& sensor = m_rgSensors[idxSensor];
+
+        sensor.ResolutionBits = snapshot.rgResolutionBits[idxSlot];
+
+        if (!snapshot.IsValid(idxSlot))
+        {
+            recordFailure(sensor);
+            return;
+        }
+
+        sensor.Value = snapshot.rgValues[idxSlot];
+        sensor.FilteredValue = snapshot.rgFilteredValues[idxSlot];
+        sensor.ReadingTime_msec = snapshot.rgTimestamps_msec[idxSlot];
+        sensor.cConsecutiveFailures = 0;
+
+        currentMask |= (1UL << idxSensor);
+    }
+};
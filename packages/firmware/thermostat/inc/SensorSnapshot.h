@@ -0,0 +1,119 @@
+#pragma once
+
+//
+// Readings from one acquisition, laid out as a structure of arrays: the acquisition thread fills it in place
+// (c.f. AcquisitionChannel), the control thread filters its readings and then registers them with the SensorRegistry,
+// through which zones, sensor fusion, and aggregation look up individual sensors.
+//
+// External sensors are added in bus enumeration order.
+//
+
+template <uint8_t c_cExternalSensors_Max>
+struct SensorSnapshot
+{
+    static_assert(c_cExternalSensors_Max <= 32, "Sensor masks are 32 bits wide");
+
+    // Time the acquisition started (c.f. AcquisitionChannel)
+    unsigned long AcquisitionTime_msec;
+
+    // Onboard sensor
+    float OnboardTemperature;
+    float OnboardHumidity;
+    float OnboardDewPoint;
+    float FilteredOnboardTemperature;
+
+    // External sensors
+    size_t cSensors;
+    OneWireAddress rgIds[c_cExternalSensors_Max];
+    float rgValues[c_cExternalSensors_Max];                   // Raw, for publishing
+    float rgFilteredValues[c_cExternalSensors_Max];           // Filtered, for control
+    unsigned long rgTimestamps_msec[c_cExternalSensors_Max];  // Time of each reading
+    uint8_t rgResolutionBits[c_cExternalSensors_Max];         // As configured on each sensor (zero if unknown)
+    uint32_t ValidMask;                                       // Sensors with a reading this acquisition
+
+    // Control input
+    float OperableTemperature;
+    bool fUsedExternalSensor;
+
+    SensorSnapshot()
+        : AcquisitionTime_msec()
+        , OnboardTemperature(NAN)
+        , OnboardHumidity(NAN)
+        , OnboardDewPoint(NAN)
+        , FilteredOnboardTemperature(NAN)
+        , cSensors()
+        , rgIds()
+        , rgValues()
+        , rgFilteredValues()
+        , rgTimestamps_msec()
+        , rgResolutionBits()
+        , ValidMask()
+        , OperableTemperature(NAN)
+        , fUsedExternalSensor()
+    {
+    }
+
+    //
+    // Operations
+    //
+
+    // Starts over for a new acquisition (slots are cleared as sensors are added again)
+    void Reset()
+    {
+        AcquisitionTime_msec = 0;
+
+        OnboardTemperature = NAN;
+        OnboardHumidity = NAN;
+        OnboardDewPoint = NAN;
+        FilteredOnboardTemperature = NAN;
+
+        cSensors = 0;
+        ValidMask = 0;
+
+        OperableTemperature = NAN;
+        fUsedExternalSensor = false;
+    }
+
+    // @returns false if there's no more room
+    bool AddSensor(OneWireAddress const& id)
+    {
+        if (cSensors >= c_cExternalSensors_Max)
+        {
+            return false;
+        }
+
+        rgIds[cSensors] = id;
+        rgValues[cSensors] = NAN;
+        rgFilteredValues[cSensors] = NAN;
+        rgTimestamps_msec[cSensors] = 0;
+        rgResolutionBits[cSensors] = 0;
+
+        ++cSensors;
+        return true;
+    }
+
+    // value may be NaN if the reading failed
+    void SetReading(size_t const idxSensor,
+                    float const value,
+                    unsigned long const readingTime_msec,
+                    uint8_t const resolutionBits = 0)
+    {
+        rgValues[idxSensor] = value;
+        rgTimestamps_msec[idxSensor] = readingTime_msec;
+        rgResolutionBits[idxSensor] = resolutionBits;
+
+        if (!std::isnan(value))
+        {
+            ValidMask |= (1UL << idxSensor);
+        }
+    }
+
+    //
+    // Accessors
+    //
+
+    bool IsValid(size_t const idxSensor) const
+    {
+        return !!(ValidMask & (1UL << idxSensor));
+    }
+};
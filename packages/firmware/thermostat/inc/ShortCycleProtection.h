@@ -0,0 +1,195 @@
+#pragma once
+
+//
+// Short-cycle protection for heat pump compressors.
+//
+// Heat and Cool both run the compressor (see Thermostat::ApplyActions()); Cool additionally engages the reversing
+// valve. Given the currently applied and the proposed actions, this state machine holds back transitions that would:
+//
+// - stop heat/cool before it has run for at least MinimumRunTime,
+// - (re)start the compressor before it has been off for at least MinimumOffTime,
+// - start heat after cool (or vice versa) before ChangeoverDeadTime has passed since the other one stopped.
+//
+// Circulation isn't affected. Timestamps are millis()-based and rollover-safe.
+// Since we don't know what happened before boot, actions without any recorded history are unrestricted,
+// except for ones known to have been running before a reset (c.f. RecordReset()).
+//
+
+class ShortCycleProtection
+{
+public:
+    struct Timings
+    {
+        unsigned long MinimumRunTime_msec;
+        unsigned long MinimumOffTime_msec;
+        unsigned long ChangeoverDeadTime_msec;
+    };
+
+public:
+    ShortCycleProtection()
+        : m_rgActionStates()
+    {
+    }
+
+public:
+    // @returns the actions that may be applied; assumes the caller commits them
+    ThermostatAction Apply(ThermostatAction const currentActions,
+                           ThermostatAction const proposedActions,
+                           Timings const& timings,
+                           unsigned long const currentTime_msec)
+    {
+        ThermostatAction permittedActions = proposedActions;
+
+        ActionState& heatState = m_rgActionStates[sc_idxHeat];
+        ActionState& coolState = m_rgActionStates[sc_idxCool];
+
+        // Stopping: enforce minimum run time
+        for (size_t idxAction = 0; idxAction < sc_cActions; ++idxAction)
+        {
+            ThermostatAction const action = GetAction(idxAction);
+            ActionState const& actionState = m_rgActionStates[idxAction];
+
+            bool const fIsStopping = !!(currentActions & action) && !(proposedActions & action);
+
+            if (fIsStopping && !HasElapsed(actionState.fHasStarted,
+                                           actionState.LatestStartTime_msec,
+                                           timings.MinimumRunTime_msec,
+                                           currentTime_msec))
+            {
+                permittedActions |= action;
+            }
+        }
+
+        // Record stops (including the ones we just decided on, so starts below are checked against them)
+        RecordStop(heatState, ThermostatAction::Heat, currentActions, permittedActions, currentTime_msec);
+        RecordStop(coolState, ThermostatAction::Cool, currentActions, permittedActions, currentTime_msec);
+
+        // Starting: enforce minimum off time and changeover dead time
+        for (size_t idxAction = 0; idxAction < sc_cActions; ++idxAction)
+        {
+            ThermostatAction const action = GetAction(idxAction);
+            ThermostatAction const otherAction = GetAction(1 - idxAction);
+
+            ActionState const& actionState = m_rgActionStates[idxAction];
+            ActionState const& otherActionState = m_rgActionStates[1 - idxAction];
+
+            bool const fIsStarting = !(currentActions & action) && !!(proposedActions & action);
+
+            if (!fIsStarting)
+            {
+                continue;
+            }
+
+            bool const fIsPermitted =
+                // The compressor isn't otherwise occupied...
+                !(permittedActions & otherAction)
+                // ...and has rested long enough after either action
+                && HasElapsed(actionState.fHasStopped,
+                              actionState.LatestStopTime_msec,
+                              timings.MinimumOffTime_msec,
+                              currentTime_msec) &&
+                HasElapsed(otherActionState.fHasStopped,
+                           otherActionState.LatestStopTime_msec,
+                           std::max(timings.MinimumOffTime_msec, timings.ChangeoverDeadTime_msec),
+                           currentTime_msec);
+
+            if (!fIsPermitted)
+            {
+                permittedActions &= ~action;
+            }
+        }
+
+        // Record starts
+        RecordStart(heatState, ThermostatAction::Heat, currentActions, permittedActions, currentTime_msec);
+        RecordStart(coolState, ThermostatAction::Cool, currentActions, permittedActions, currentTime_msec);
+
+        return permittedActions;
+    }
+
+    // Records actions applied without consulting Apply() (e.g. when shutting down)
+    void Override(ThermostatAction const currentActions,
+                  ThermostatAction const appliedActions,
+                  unsigned long const currentTime_msec)
+    {
+        for (size_t idxAction = 0; idxAction < sc_cActions; ++idxAction)
+        {
+            ActionState& actionState = m_rgActionStates[idxAction];
+            ThermostatAction const action = GetAction(idxAction);
+
+            RecordStop(actionState, action, currentActions, appliedActions, currentTime_msec);
+            RecordStart(actionState, action, currentActions, appliedActions, currentTime_msec);
+        }
+    }
+
+    // Records heat/cool among actions as stopped by a reset (relays are off while we're down), so that they only
+    // start again once the compressor has been off for MinimumOffTime (e.g. after a brownout mid-cycle)
+    void RecordReset(ThermostatAction const actions, unsigned long const currentTime_msec)
+    {
+        for (size_t idxAction = 0; idxAction < sc_cActions; ++idxAction)
+        {
+            ActionState& actionState = m_rgActionStates[idxAction];
+
+            if (!!(actions & GetAction(idxAction)))
+            {
+                actionState.fHasStopped = true;
+                actionState.LatestStopTime_msec = currentTime_msec;
+            }
+        }
+    }
+
+private:
+    struct ActionState
+    {
+        bool fHasStarted;
+        bool fHasStopped;
+        unsigned long LatestStartTime_msec;
+        unsigned long LatestStopTime_msec;
+    };
+
+    static size_t constexpr sc_idxHeat = 0;
+    static size_t constexpr sc_idxCool = 1;
+    static size_t constexpr sc_cActions = 2;
+
+    ActionState m_rgActionStates[sc_cActions];
+
+private:
+    static ThermostatAction GetAction(size_t const idxAction)
+    {
+        return (idxAction == sc_idxHeat) ? ThermostatAction::Heat : ThermostatAction::Cool;
+    }
+
+    static bool HasElapsed(bool const fHasHistory,
+                           unsigned long const since_msec,
+                           unsigned long const duration_msec,
+                           unsigned long const currentTime_msec)
+    {
+        // (Carefully phrased to deal with rollovers)
+        return !fHasHistory || ((currentTime_msec - since_msec) >= duration_msec);
+    }
+
+    static void RecordStart(ActionState& actionState,
+                            ThermostatAction const action,
+                            ThermostatAction const currentActions,
+                            ThermostatAction const permittedActions,
+                            unsigned long const currentTime_msec)
+    {
+        if (!(currentActions & action) && !!(permittedActions & action))
+        {
+            actionState.fHasStarted = true;
+            actionState.LatestStartTime_msec = currentTime_msec;
+        }
+    }
+
+    static void RecordStop(ActionState& actionState,
+                           ThermostatAction const action,
+                           ThermostatAction const currentActions,
+                           ThermostatAction const permittedActions,
+                           unsigned long const currentTime_msec)
+    {
+        if (!!(currentActions & action) && !(permittedActions & action))
+        {
+            actionState.fHasStopped = true;
+            actionState.LatestStopTime_msec = currentTime_msec;
+        }
+    }
+};
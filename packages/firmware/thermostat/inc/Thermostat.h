@@ -6,26 +6,85 @@ public:
     Thermostat();
     ~Thermostat();
 
+public:
+    // See ApplyActions() for explanation
+    struct RelayPins
+    {
+        pin_t Heat;
+        pin_t SwitchOver;
+        pin_t Circulate;
+    };
+
+    // For relays that aren't connected
+    static pin_t constexpr sc_RelayPin_None = static_cast<pin_t>(-1);
+
+    static RelayPins DefaultRelayPins()
+    {
+        return RelayPins{A0, A1, A2};
+    }
+
+    // Heat/cool control as configured for a zone, or the configuration's where the zone doesn't say
+    // (c.f. ZoneConfiguration::controlMode)
+    struct ControlSettings
+    {
+        ControlMode Mode;
+        float ProportionalGain;
+        float IntegralGain_PerHour;
+        unsigned long Window_msec;
+    };
+
+    static ControlSettings GetControlSettings(Configuration const& Configuration, uint8_t const idxZone);
+
 public:
     void Initialize();
+    // idxZone: the zone (c.f. ZoneConfiguration) whose control settings to use, if configured
+    void Initialize(RelayPins const& relayPins, uint8_t const idxZone = 0);
 
+    // Turns off all relays (e.g. before re-initializing with different pins)
+    void Shutdown(unsigned long const CurrentTime_msec);
+
+    // Drives relays per actions retained from before a reset (c.f. RetainedState) until the next Apply(),
+    // holding back heat/cool as if they'd stopped at the reset (c.f. ShortCycleProtection::RecordReset())
+    void Resume(Configuration const& Configuration,
+                ThermostatAction const Actions,
+                unsigned long const CurrentTime_msec);
+
+    // CurrentTime_msec is the caller's millis()-based time (time-proportioning windows, short-cycle protection);
+    // CurrentDewPoint is only needed for dehumidification (c.f. dehumidifyAboveDewPoint_x100)
     void Apply(Configuration const& Configuration,
                ThermostatSetpoint const& ThermostatSetpoint,
-               float CurrentTemperature);
+               float CurrentTemperature,
+               unsigned long CurrentTime_msec,
+               float CurrentDewPoint = NAN);
 
     ThermostatAction CurrentActions() const
     {
         return m_CurrentActions;
     }
 
+    bool IsDehumidifying() const
+    {
+        return m_fIsDehumidifying;
+    }
+
 private:
-    // See ApplyActions() for explanation
-    static pin_t constexpr sc_RelayPin_Heat = A0;
-    static pin_t constexpr sc_RelayPin_SwitchOver = A1;
-    static pin_t constexpr sc_RelayPin_Circulate = A2;
+    RelayPins m_RelayPins;
+    uint8_t m_idxZone;
 
     ThermostatAction m_CurrentActions;
 
+    // For ControlMode::TimeProportional
+    TimeProportionalController m_HeatController;
+    TimeProportionalController m_CoolController;
+
+    ShortCycleProtection m_ShortCycleProtection;
+
+    bool m_fIsDehumidifying;
+
 private:
     void ApplyActions(ThermostatAction const& Actions);
+
+    static ShortCycleProtection::Timings GetShortCycleProtectionTimings(Configuration const& Configuration);
+
+    static void WriteRelay(pin_t const pin, bool const fIsOn);
 };
@@ -7,8 +7,56 @@ public:
     ~ThermostatSetpointScheduler();
 
 public:
+    // Restricts the scheduler to thermostatSettings selected by mask (bit N = setting N); zero selects all
+    void setThermostatSettingsMask(uint32_t const thermostatSettingsMask)
+    {
+        m_ThermostatSettingsMask = thermostatSettingsMask;
+
+        // (Settings are re-selected on configuration changes, after which indices may no longer line up)
+        m_idxEarlyStartSetting = sc_idxNotSet;
+    }
+
+    // Has the scheduler consult holdOverride ahead of the configuration's settings; nullptr for none
+    void setHoldOverride(HoldOverride const* const pHoldOverride)
+    {
+        m_pHoldOverride = pHoldOverride;
+    }
+
     ThermostatSetpoint getCurrentThermostatSetpoint(Configuration const& Configuration) const;
 
+    // Same as above, but adopts the next scheduled setpoint early
+    // if it'd otherwise not be reached by its scheduled time (c.f. maximumEarlyStart).
+    // Once adopted, it's kept until its scheduled time so that the thermostat doesn't flip back and forth
+    // between setpoints as the zone heats up faster than estimated.
+    ThermostatSetpoint getCurrentThermostatSetpoint(Configuration const& Configuration,
+                                                    RecoveryRateEstimator const& RecoveryRateEstimator,
+                                                    float CurrentTemperature);
+
+    // For when the time of day isn't known (e.g. after a power loss, until synchronized with the cloud)
+    // so that neither schedules nor holds can be evaluated: heat only, to the lowest heat setpoint among the
+    // selected settings (i.e. never warmer than any of them would ask for); inactive if none of them heat
+    ThermostatSetpoint getTimeIndependentThermostatSetpoint(Configuration const& Configuration) const;
+
 private:
+    uint32_t m_ThermostatSettingsMask;
+    HoldOverride const* m_pHoldOverride;
+
+    // Early start in progress, if any
+    uint32_t m_idxEarlyStartSetting;
+    uint32_t m_EarlyStartScheduledTime;  // seconds since UTC epoch
+
+private:
+    static uint32_t constexpr sc_idxNotSet = static_cast<uint32_t>(-1);
+
+    uint32_t getActiveHoldIndex(Configuration const& Configuration, uint32_t const timeNow) const;
+
+    uint32_t getNextScheduledIndex(Configuration const& Configuration,
+                                   uint32_t const timeNow,
+                                   uint16_t& minutesUntilNextScheduled) const;
+
+    bool isHoldOverrideActive(uint32_t const timeNow) const;
+
+    bool isSettingSelected(uint32_t const idxSetting) const;
+
     uint8_t getScalarDayOfWeek(DaysOfWeek const dayOfWeek) const;
 };
\ No newline at end of file
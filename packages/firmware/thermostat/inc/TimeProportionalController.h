@@ -0,0 +1,117 @@
+#pragma once
+
+//
+// PI controller driving a relay by time-proportioning:
+// at the start of every control cycle window, the controller's output is latched as the duty fraction
+// and the relay is kept on for that fraction of the window (on first, then off).
+//
+// Anti-windup is by conditional integration: the integral term is clamped to [0, 1] and is not integrated further
+// while the output is saturated in the direction of the error.
+//
+// Note that the relay can only change state when Update() is called, so the effective on-time resolution
+// is the caller's control cadence; keep the window a good multiple of that.
+//
+
+class TimeProportionalController
+{
+public:
+    TimeProportionalController()
+        : m_IntegralTerm()
+        , m_Duty()
+        , m_fIsRunning()
+        , m_LatestUpdateTime_msec()
+        , m_WindowStartTime_msec()
+    {
+    }
+
+public:
+    void Reset()
+    {
+        *this = TimeProportionalController();
+    }
+
+    // @param error: positive values call for more output (e.g. setpoint - temperature when heating)
+    // @returns whether the relay should be on
+    bool Update(float const error,
+                float const proportionalGain,
+                float const integralGain_PerHour,
+                unsigned long const window_msec,
+                unsigned long const currentTime_msec)
+    {
+        if (!m_fIsRunning)
+        {
+            m_fIsRunning = true;
+            m_LatestUpdateTime_msec = currentTime_msec;
+            m_WindowStartTime_msec = currentTime_msec;
+
+            m_Duty = ComputeOutput(error, proportionalGain);
+        }
+
+        // Integrate (carefully phrased to deal with rollovers)
+        {
+            float const timeSinceLatestUpdate_hours =
+                (currentTime_msec - m_LatestUpdateTime_msec) / static_cast<float>(60 * 60 * 1000);
+
+            float const candidateIntegralTerm =
+                m_IntegralTerm + integralGain_PerHour * error * timeSinceLatestUpdate_hours;
+
+            float const unclampedOutput = proportionalGain * error + candidateIntegralTerm;
+
+            bool const fIsWindingUp =
+                ((unclampedOutput > 1.0f) && (error > 0)) || ((unclampedOutput < 0.0f) && (error < 0));
+
+            if (!fIsWindingUp)
+            {
+                m_IntegralTerm = clamp(candidateIntegralTerm, 0.0f, 1.0f);
+            }
+
+            m_LatestUpdateTime_msec = currentTime_msec;
+        }
+
+        // Start a new window and latch its duty if the current one has elapsed
+        if ((currentTime_msec - m_WindowStartTime_msec) >= window_msec)
+        {
+            m_WindowStartTime_msec = currentTime_msec;
+            m_Duty = ComputeOutput(error, proportionalGain);
+        }
+
+        unsigned long const onTime_msec = static_cast<unsigned long>(m_Duty * window_msec);
+
+        return (currentTime_msec - m_WindowStartTime_msec) < onTime_msec;
+    }
+
+    float Duty() const
+    {
+        return m_Duty;
+    }
+
+private:
+    // Duty fractions below this are dropped (and above 1 - this are rounded up)
+    // to avoid pointlessly short relay pulses
+    static constexpr float sc_MinimumDuty = 0.05f;
+
+    float m_IntegralTerm;
+    float m_Duty;
+
+    bool m_fIsRunning;
+    unsigned long m_LatestUpdateTime_msec;
+    unsigned long m_WindowStartTime_msec;
+
+private:
+    float ComputeOutput(float const error, float const proportionalGain) const
+    {
+        float const output = clamp(proportionalGain * error + m_IntegralTerm, 0.0f, 1.0f);
+
+        if (output < sc_MinimumDuty)
+        {
+            return 0.0f;
+        }
+
+        if (output > 1.0f - sc_MinimumDuty)
+        {
+            return 1.0f;
+        }
+
+        return output;
+    }
+};
@@ -47,7 +47,7 @@ inline uint16_t DecodeBytes(uint8_t* const rgDestination,
         return 0;
     }
 
-    uint32_t* pDestination = reinterpret_cast<uint32_t*>(rgDestination);
+    uint8_t* pDestination = rgDestination;
     uint32_t accumulator = 0;
 
     for (size_t idxSource = 0; idxSource < cchSource; ++idxSource)
@@ -55,7 +55,7 @@ inline uint16_t DecodeBytes(uint8_t* const rgDestination,
         // Accumulate value in base 85
         uint8_t sourceValueMinusBase = static_cast<uint8_t>(rgSource[idxSource]) - sc_decoderRingBaseValue;
 
-        if (sourceValueMinusBase > countof(sc_rgDecoderRing))
+        if (sourceValueMinusBase >= countof(sc_rgDecoderRing))
         {
             // Invalid input
             return 0;
@@ -66,8 +66,10 @@ inline uint16_t DecodeBytes(uint8_t* const rgDestination,
         if ((idxSource + 1) % 5 == 0)
         {
             // Emit completed value
-            *pDestination = __builtin_bswap32(accumulator);
-            ++pDestination;
+            // (Destination isn't necessarily aligned for uint32_t)
+            uint32_t const value = __builtin_bswap32(accumulator);
+            memcpy(pDestination, &value, sizeof(value));
+            pDestination += sizeof(value);
 
             accumulator = 0;
         }
@@ -119,7 +121,7 @@ inline uint16_t EncodeBytes(char* const rgDestination,
         }
     };
 
-    for (uint16_t idxSource; idxSource < cbSource; ++idxSource)
+    for (uint16_t idxSource = 0; idxSource < cbSource; ++idxSource)
     {
         accumulateByte(rgSource[idxSource]);
     }
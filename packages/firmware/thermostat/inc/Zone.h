@@ -0,0 +1,217 @@
+#pragma once
+
+//
+// A zone is a set of relays (c.f. Thermostat) driven by one temperature and a subset of the thermostat settings.
+//
+// Zones are described by the configuration's zones. Without any, there's a single zone on Thermostat's default
+// relay pins that follows the device's operable temperature and uses all thermostat settings.
+//
+// All zones are evaluated off the same acquisition pass so adding a zone doesn't add any sensor bus traffic.
+//
+
+class Zone
+{
+public:
+    static size_t constexpr sc_cZones_Max = Configuration::sc_cZones_Max;
+
+public:
+    Zone()
+        : m_fIsInitialized()
+        , m_RelayPins(Thermostat::DefaultRelayPins())
+        , m_SensorId()
+        , m_ThermostatSetpointScheduler()
+        , m_Thermostat()
+        , m_RecoveryRateEstimator()
+        , m_ThermostatSetpoint()
+        , m_OperableTemperature(NAN)
+    {
+    }
+
+    Zone(Zone const&) = delete;
+    Zone& operator=(Zone const&) = delete;
+
+public:
+    //
+    // Accessors
+    //
+
+    static size_t GetZoneCount(Configuration const& configuration)
+    {
+        auto const pvZones = configuration.rootConfiguration().zones();
+
+        if (!pvZones || pvZones->size() == 0)
+        {
+            // Single default zone
+            return 1;
+        }
+
+        size_t const cZones_Max = sc_cZones_Max;
+        return std::min(static_cast<size_t>(pvZones->size()), cZones_Max);
+    }
+
+    float OperableTemperature() const
+    {
+        return m_OperableTemperature;
+    }
+
+    ThermostatSetpoint const& CurrentSetpoint() const
+    {
+        return m_ThermostatSetpoint;
+    }
+
+    ThermostatAction CurrentActions() const
+    {
+        return m_Thermostat.CurrentActions();
+    }
+
+    // Learned recovery rates are written out by SaveData() in idle windows (c.f. RecoveryRateEstimator)
+    bool HasUnsavedData() const
+    {
+        return m_RecoveryRateEstimator.HasUnsavedData();
+    }
+
+    //
+    // Operations
+    //
+
+    // (Re-)applies the zone's configuration; call at startup and whenever the configuration changes
+    // @param pHoldOverride: local hold to consult ahead of the configuration's settings (c.f. HoldOverride), if any
+    void Initialize(Configuration const& configuration,
+                    uint8_t const idxZone,
+                    unsigned long const currentTime_msec,
+                    HoldOverride const* const pHoldOverride = nullptr)
+    {
+        Thermostat::RelayPins relayPins = Thermostat::DefaultRelayPins();
+        uint64_t sensorId = 0;
+        uint32_t thermostatSettingsMask = 0;
+
+        auto const pvZones = configuration.rootConfiguration().zones();
+
+        if (pvZones && idxZone < pvZones->size())
+        {
+            auto const& zoneConfiguration = *pvZones->Get(idxZone);
+
+            relayPins.Heat = getRelayPin(zoneConfiguration.relayPinHeat());
+            relayPins.SwitchOver = getRelayPin(zoneConfiguration.relayPinSwitchOver());
+            relayPins.Circulate = getRelayPin(zoneConfiguration.relayPinCirculate());
+
+            sensorId = zoneConfiguration.sensorId();
+            thermostatSettingsMask = zoneConfiguration.thermostatSettingsMask();
+        }
+
+        m_SensorId = sensorId;
+        m_ThermostatSetpointScheduler.setThermostatSettingsMask(thermostatSettingsMask);
+        m_ThermostatSetpointScheduler.setHoldOverride(pHoldOverride);
+
+        if (!m_fIsInitialized)
+        {
+            m_Thermostat.Initialize(relayPins, idxZone);
+            m_RecoveryRateEstimator.Initialize(idxZone);
+
+            m_fIsInitialized = true;
+        }
+        else if (relayPins.Heat != m_RelayPins.Heat || relayPins.SwitchOver != m_RelayPins.SwitchOver ||
+                 relayPins.Circulate != m_RelayPins.Circulate)
+        {
+            // Release the previous pins before taking on the new ones
+            m_Thermostat.Shutdown(currentTime_msec);
+            m_Thermostat.Initialize(relayPins, idxZone);
+        }
+
+        m_RelayPins = relayPins;
+    }
+
+    // Picks up where the zone left off before a reset (c.f. RetainedState) without waiting for a reading
+    void Resume(Configuration const& configuration,
+                ThermostatAction const actions,
+                unsigned long const currentTime_msec)
+    {
+        if (!m_fIsInitialized)
+        {
+            return;
+        }
+
+        m_Thermostat.Resume(configuration, actions, currentTime_msec);
+    }
+
+    void SaveData()
+    {
+        m_RecoveryRateEstimator.SaveData();
+    }
+
+    // Turns off the zone's relays (e.g. when the zone is no longer configured)
+    void Shutdown(unsigned long const currentTime_msec)
+    {
+        if (!m_fIsInitialized)
+        {
+            return;
+        }
+
+        m_Thermostat.Shutdown(currentTime_msec);
+        m_fIsInitialized = false;
+    }
+
+    // @param operableTemperature: the device's operable temperature (c.f. sensorFusionInputs, externalSensorId)
+    // @param sensorRegistry: external sensors with their (filtered) readings
+    template <typename TSensorRegistry>
+    float SelectTemperature(float const operableTemperature, TSensorRegistry const& sensorRegistry) const
+    {
+        if (!m_SensorId)
+        {
+            return operableTemperature;
+        }
+
+        return sensorRegistry.GetCurrentTemperature(m_SensorId);
+    }
+
+    // dewPoint is only needed for dehumidification (c.f. Thermostat::Apply())
+    void Apply(Configuration const& configuration,
+               float const operableTemperature,
+               unsigned long const currentTime_msec,
+               float const dewPoint = NAN)
+    {
+        m_OperableTemperature = operableTemperature;
+
+        m_ThermostatSetpoint = m_ThermostatSetpointScheduler.getCurrentThermostatSetpoint(
+            configuration, m_RecoveryRateEstimator, operableTemperature);
+
+        m_Thermostat.Apply(configuration, m_ThermostatSetpoint, operableTemperature, currentTime_msec, dewPoint);
+
+        m_RecoveryRateEstimator.Observe(m_Thermostat.CurrentActions(), operableTemperature, currentTime_msec);
+    }
+
+    // Same as Apply() for when the time of day isn't known, which leaves schedules and holds out of reach
+    // (c.f. ThermostatSetpointScheduler::getTimeIndependentThermostatSetpoint())
+    void ApplyWithoutTime(Configuration const& configuration,
+                          float const operableTemperature,
+                          unsigned long const currentTime_msec)
+    {
+        m_OperableTemperature = operableTemperature;
+
+        m_ThermostatSetpoint = m_ThermostatSetpointScheduler.getTimeIndependentThermostatSetpoint(configuration);
+
+        m_Thermostat.Apply(configuration, m_ThermostatSetpoint, operableTemperature, currentTime_msec);
+    }
+
+private:
+    static uint8_t constexpr sc_RelayPin_NotConnected = Configuration::sc_RelayPin_NotConnected;
+
+    bool m_fIsInitialized;
+    Thermostat::RelayPins m_RelayPins;
+    uint64_t m_SensorId;
+
+    ThermostatSetpointScheduler m_ThermostatSetpointScheduler;
+    Thermostat m_Thermostat;
+    RecoveryRateEstimator m_RecoveryRateEstimator;
+
+    // Latest results
+    ThermostatSetpoint m_ThermostatSetpoint;
+    float m_OperableTemperature;
+
+private:
+    static pin_t getRelayPin(uint8_t const configuredPin)
+    {
+        return (configuredPin == sc_RelayPin_NotConnected) ? Thermostat::sc_RelayPin_None
+                                                           : static_cast<pin_t>(configuredPin);
+    }
+};
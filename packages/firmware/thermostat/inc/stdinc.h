@@ -1,22 +1,30 @@
 #pragma once
 
+#include <atomic>
 #include <math.h>
 #include <mutex>
 
 // Generated files
 #include "../generated/firmware_generated.h"
 
+typedef Flatbuffers::Firmware::ControlMode ControlMode;
 typedef Flatbuffers::Firmware::DaysOfWeek DaysOfWeek;
+typedef Flatbuffers::Firmware::SensorFilterType SensorFilterType;
+typedef Flatbuffers::Firmware::SensorFusionMethod SensorFusionMethod;
 typedef Flatbuffers::Firmware::ThermostatAction ThermostatAction;
 typedef Flatbuffers::Firmware::ThermostatSettingType ThermostatSettingType;
+typedef Flatbuffers::Firmware::ZoneControlMode ZoneControlMode;
 
 // Core definitions
 #include "inc/CoreDefs.h"
+#include "inc/DeferredLog.h"
 #include "inc/Activity.h"
 
 #include "inc/FixedStringBuffer.h"
 #include "inc/FixedQueue.h"
+#include "inc/SPSCQueue.h"
 #include "inc/QueuedPublisher.h"
+#include "inc/RunningStatistics.h"
 
 // OneWire stack
 #include "onewire/OneWireCRC.h"
@@ -25,16 +33,38 @@ typedef Flatbuffers::Firmware::ThermostatSettingType ThermostatSettingType;
 #include "onewire/OneWireGateway2484.h"
 #include "onewire/OneWireTemperatureSensor.h"
 
+// Onboard sensor
+#include "PietteTech_DHT.h"
+#include "inc/OnboardSensorReader.h"
+
 // Helpers
+#include "inc/Psychrometrics.h"
 #include "inc/Z85.h"
 
 // Configuration
 #include "inc/Configuration.h"
+#include "inc/RetainedState.h"
+#include "inc/LocalTime.h"
 
 // Components
+#include "inc/SensorSnapshot.h"
+#include "inc/SensorRegistry.h"
+#include "inc/AcquisitionChannel.h"
+#include "inc/SensorFilter.h"
+#include "inc/SensorFusion.h"
+#include "inc/ShortCycleProtection.h"
+#include "inc/TimeProportionalController.h"
 #include "inc/ThermostatSetpoint.h"
+#include "inc/HoldOverride.h"
 #include "inc/Thermostat.h"
+#include "inc/RecoveryRateEstimator.h"
 #include "inc/ThermostatSetpointScheduler.h"
+#include "inc/Zone.h"
+#include "inc/LoopScheduler.h"
+#include "inc/MaintenanceScheduler.h"
+#include "inc/DeadlineMonitor.h"
+#include "inc/LowPowerSleep.h"
 
 // Publishers
+#include "publishers/StatusAggregator.h"
 #include "publishers/StatusPublisher.h"
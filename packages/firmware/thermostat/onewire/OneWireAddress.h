@@ -1,5 +1,13 @@
 #pragma once
 
+//
+// Addresses are kept as a native 64-bit value (bytes LSB...MSB as they come off the bus, i.e. family code first)
+// so they can be compared and hashed (c.f. SensorRegistry) as integers. Both the device and the host are
+// little-endian, so the value's in-memory representation is the bus byte order as well.
+//
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "OneWireAddress::Get() assumes a little-endian target");
+
 class OneWireAddress
 {
 private:
@@ -12,74 +20,69 @@ public:
     }
 
     OneWireAddress(uint64_t const address)
+        : m_Address(address)
     {
-        static_assert(sizeof(address) == sizeof(m_Address), "Type mismatch");
-        memcpy(m_Address, &address, sizeof(address));
     }
 
     void SetBit(size_t idxBit, bool IsSet)
     {
-        if (idxBit >= 8 * countof(m_Address))
+        if (idxBit >= 8 * sc_cAddressBytes)
         {
             return;
         }
 
-        size_t const idxByte = idxBit / 8;
-        size_t const idxBitInByte = idxBit % 8;
-
-        uint8_t const existingValue = m_Address[idxByte];
-        uint8_t const existingValue_BitCleared = existingValue & static_cast<uint8_t>(~(1 << idxBitInByte));
-
-        m_Address[idxByte] = existingValue_BitCleared | (static_cast<uint8_t>(!!IsSet) << idxBitInByte);
+        m_Address = (m_Address & ~(1ULL << idxBit)) | (static_cast<uint64_t>(!!IsSet) << idxBit);
     }
 
     bool GetBit(size_t idxBit) const
     {
-        if (idxBit >= 8 * countof(m_Address))
+        if (idxBit >= 8 * sc_cAddressBytes)
         {
             return false;
         }
 
-        size_t const idxByte = idxBit / 8;
-        size_t const idxBitInByte = idxBit % 8;
-
-        return ((m_Address[idxByte] >> idxBitInByte) & 0x1);
+        return ((m_Address >> idxBit) & 0x1);
     }
 
     uint8_t GetByte(size_t idxByte) const
     {
-        if (idxByte >= countof(m_Address))
+        if (idxByte >= sc_cAddressBytes)
         {
             return 0;
         }
 
-        return m_Address[idxByte];
+        return static_cast<uint8_t>(m_Address >> (8 * idxByte));
     }
 
+    // Bytes in bus order
     uint8_t const* Get() const
+    {
+        return reinterpret_cast<uint8_t const*>(&m_Address);
+    }
+
+    uint64_t Value() const
     {
         return m_Address;
     }
 
     uint8_t GetDeviceFamily() const
     {
-        return m_Address[0];
+        return GetByte(0);
     }
 
     bool IsEqual(OneWireAddress const& rhs) const
     {
-        return memcmp(m_Address, rhs.m_Address, sizeof(m_Address)) == 0;
+        return m_Address == rhs.m_Address;
     }
 
     bool IsEmpty() const
     {
-        OneWireAddress emptyAddress;
-        return IsEqual(emptyAddress);
+        return m_Address == 0;
     }
 
     bool IsValid() const
     {
-        return IsValid(m_Address);
+        return IsValid(Get());
     }
 
 
@@ -90,10 +93,10 @@ public:
         auto toHexChar = [](uint8_t const v) -> char { return (v < 0xA) ? (v + '0') : ((v - 0xA) + 'A'); };
 
         // LSB...MSB
-        for (size_t idxByte = 0; idxByte < countof(m_Address); ++idxByte)
+        for (size_t idxByte = 0; idxByte < sc_cAddressBytes; ++idxByte)
         {
-            uint8_t const lowerNibble = m_Address[idxByte] & 0xF;
-            uint8_t const upperNibble = m_Address[idxByte] >> 4;
+            uint8_t const lowerNibble = GetByte(idxByte) & 0xF;
+            uint8_t const upperNibble = GetByte(idxByte) >> 4;
 
             rgBuffer[2 * idxByte + 0] = toHexChar(upperNibble);
             rgBuffer[2 * idxByte + 1] = toHexChar(lowerNibble);
@@ -133,7 +136,7 @@ public:
         // LSB...MSB
         uint8_t rgAddress[sc_cAddressBytes];
 
-        for (size_t idxByte = 0; idxByte < countof(m_Address); ++idxByte)
+        for (size_t idxByte = 0; idxByte < sc_cAddressBytes; ++idxByte)
         {
             uint8_t const upperNibble = fromHexChar(rgBuffer[2 * idxByte + 0]);
             uint8_t const lowerNibble = fromHexChar(rgBuffer[2 * idxByte + 1]);
@@ -152,12 +155,12 @@ public:
         }
 
         // Commit
-        memcpy(m_Address, rgAddress, sizeof(m_Address));
+        memcpy(&m_Address, rgAddress, sizeof(m_Address));
         return true;
     }
 
 private:
-    uint8_t m_Address[sc_cAddressBytes];
+    uint64_t m_Address;
 
     static bool IsValid(uint8_t const rgAddress[sc_cAddressBytes])
     {
@@ -34,9 +34,11 @@ public:
         return true;
     }
 
+    // @param pResolutionBits: receives the resolution the sensor is configured for, if desired
     static bool RetrieveMeasurement(__out float& Celsius,
                                     OneWireAddress const& Address,
-                                    IOneWireGateway const& OneWireGateway)
+                                    IOneWireGateway const& OneWireGateway,
+                                    __out_opt uint8_t* const pResolutionBits = nullptr)
     {
         // Reset bus and select device by address
         RETURN_IF_FALSE(OneWireGateway.Reset());
@@ -61,15 +63,18 @@ public:
 
         // Convert data to actual temperature
         int16_t rawValue = (rgScratchpad[1] << 8) | rgScratchpad[0];
+        uint8_t resolutionBits = 12;
 
         if (Address.GetDeviceFamily() == 0x10)  // DS1820 (no 'B')
         {
             rawValue = rawValue << 3;  // 9 bit resolution default
+            resolutionBits = 9;
 
             if (rgScratchpad[7] == 0x10)
             {
                 // "count remain" gives full 12 bit resolution
                 rawValue = (rawValue & 0xFFF0) + 12 - rgScratchpad[6];
+                resolutionBits = 12;
             }
         }
         else
@@ -81,14 +86,17 @@ public:
             {
                 case 0x00:
                     rawValue = rawValue & ~7;  // 9 bit resolution, 93.75ms conversion time
+                    resolutionBits = 9;
                     break;
 
                 case 0x20:
                     rawValue = rawValue & ~3;  // 10 bit resolution, 187.5ms conversion time
+                    resolutionBits = 10;
                     break;
 
                 case 0x40:
                     rawValue = rawValue & ~1;  // 11 bit resolution, 375ms conversion time
+                    resolutionBits = 11;
                     break;
 
                 case 0x60:  // 12 bit resolution, 750ms conversion time, no fix-ups needed
@@ -102,6 +110,11 @@ public:
         // Commit converted value
         Celsius = static_cast<float>(rawValue) / 16.0f;
 
+        if (pResolutionBits)
+        {
+            *pResolutionBits = resolutionBits;
+        }
+
         return true;
     }
 
@@ -0,0 +1,231 @@
+#pragma once
+
+//
+// Aggregates measurements taken every acquisition (`cadence`) and actions taken every control cycle
+// (c.f. LoopScheduler) over a publish window (`publishCadence`) so we can control at a fast cadence
+// without publishing an event for every cycle.
+//
+// Windows are contiguous: the time between the last sample of one window and the first sample of the next
+// is attributed to the next window.
+//
+
+template <uint8_t c_cOneWireDevices_Max>
+class StatusAggregator
+{
+public:
+    StatusAggregator()
+        : m_OperableTemperature()
+        , m_OnboardTemperature()
+        , m_OnboardHumidity()
+        , m_rgAddresses()
+        , m_rgszAddresses()
+        , m_rgExternalTemperatures()
+        , m_cAddresses()
+        , m_fUsedExternalSensor()
+        , m_cSamples()
+        , m_fHasPreviousSample()
+        , m_WindowStartTime_msec()
+        , m_LatestSampleTime_msec()
+        , m_LatestActions(ThermostatAction::NONE)
+        , m_HeatOnTime_msec()
+        , m_CoolOnTime_msec()
+        , m_CirculateOnTime_msec()
+    {
+    }
+
+    ~StatusAggregator()
+    {
+    }
+
+public:
+    // Records actions (e.g. after re-evaluating control in between acquisitions) without adding a measurement sample
+    void AddActions(unsigned long const actionTime_msec, ThermostatAction const& currentActions)
+    {
+        // Account for time spent with the previous actions (carefully phrased to deal with rollovers)
+        if (m_fHasPreviousSample)
+        {
+            unsigned long const timeSincePreviousActions_msec = actionTime_msec - m_LatestSampleTime_msec;
+
+            if (!!(m_LatestActions & ThermostatAction::Heat))
+            {
+                m_HeatOnTime_msec += timeSincePreviousActions_msec;
+            }
+
+            if (!!(m_LatestActions & ThermostatAction::Cool))
+            {
+                m_CoolOnTime_msec += timeSincePreviousActions_msec;
+            }
+
+            if (!!(m_LatestActions & ThermostatAction::Circulate))
+            {
+                m_CirculateOnTime_msec += timeSincePreviousActions_msec;
+            }
+        }
+        else
+        {
+            m_WindowStartTime_msec = actionTime_msec;
+            m_fHasPreviousSample = true;
+        }
+
+        m_LatestSampleTime_msec = actionTime_msec;
+        m_LatestActions = currentActions;
+    }
+
+    // External sensors are tracked by their index in sensorRegistry
+    void AddSample(unsigned long const sampleTime_msec,
+                   ThermostatAction const& currentActions,
+                   SensorSnapshot<c_cOneWireDevices_Max> const& snapshot,
+                   SensorRegistry<c_cOneWireDevices_Max> const& sensorRegistry)
+    {
+        AddActions(sampleTime_msec, currentActions);
+
+        // Accumulate measurements
+        m_fUsedExternalSensor = snapshot.fUsedExternalSensor;
+
+        m_OperableTemperature.Add(snapshot.OperableTemperature);
+        m_OnboardTemperature.Add(snapshot.OnboardTemperature);
+        m_OnboardHumidity.Add(snapshot.OnboardHumidity);
+
+        for (size_t idxSensor = 0; idxSensor < sensorRegistry.Count(); ++idxSensor)
+        {
+            auto const& sensor = sensorRegistry[idxSensor];
+
+            // Sensors standing in for the operable temperature are already reported as such
+            if (!sensorRegistry.IsCurrent(idxSensor) || sensor.HasRole(sensorRegistry.sc_RoleOperable))
+            {
+                continue;
+            }
+
+            RunningStatistics& statistics = m_rgExternalTemperatures[idxSensor];
+
+            if ((statistics.Count() == 0) || (m_rgAddresses[idxSensor] != sensor.Id))
+            {
+                // First sample of the sensor in this window (or the registry has started over)
+                statistics.Reset();
+                m_rgAddresses[idxSensor] = sensor.Id;
+                memcpy(m_rgszAddresses[idxSensor], sensor.szId, sizeof(m_rgszAddresses[idxSensor]));
+            }
+
+            statistics.Add(sensor.Value);
+        }
+
+        m_cAddresses = std::max(m_cAddresses, sensorRegistry.Count());
+
+        ++m_cSamples;
+    }
+
+    // Starts a new window at the latest sample
+    void Reset()
+    {
+        m_OperableTemperature.Reset();
+        m_OnboardTemperature.Reset();
+        m_OnboardHumidity.Reset();
+
+        for (size_t idxSensor = 0; idxSensor < m_cAddresses; ++idxSensor)
+        {
+            m_rgExternalTemperatures[idxSensor].Reset();
+        }
+
+        m_cAddresses = 0;
+        m_cSamples = 0;
+
+        m_WindowStartTime_msec = m_LatestSampleTime_msec;
+
+        m_HeatOnTime_msec = 0;
+        m_CoolOnTime_msec = 0;
+        m_CirculateOnTime_msec = 0;
+    }
+
+    //
+    // Accessors
+    //
+
+    uint16_t SampleCount() const
+    {
+        return m_cSamples;
+    }
+
+    unsigned long WindowDuration_msec() const
+    {
+        return m_LatestSampleTime_msec - m_WindowStartTime_msec;
+    }
+
+    unsigned long HeatOnTime_msec() const
+    {
+        return m_HeatOnTime_msec;
+    }
+
+    unsigned long CoolOnTime_msec() const
+    {
+        return m_CoolOnTime_msec;
+    }
+
+    unsigned long CirculateOnTime_msec() const
+    {
+        return m_CirculateOnTime_msec;
+    }
+
+    bool UsedExternalSensor() const
+    {
+        return m_fUsedExternalSensor;
+    }
+
+    RunningStatistics const& OperableTemperature() const
+    {
+        return m_OperableTemperature;
+    }
+
+    RunningStatistics const& OnboardTemperature() const
+    {
+        return m_OnboardTemperature;
+    }
+
+    RunningStatistics const& OnboardHumidity() const
+    {
+        return m_OnboardHumidity;
+    }
+
+    // (Sensors without samples in this window have no SensorTemperature().Count())
+    size_t SensorCount() const
+    {
+        return m_cAddresses;
+    }
+
+    OneWireAddress const& SensorAddress(size_t const idxSensor) const
+    {
+        return m_rgAddresses[idxSensor];
+    }
+
+    // SensorAddress() rendered to hex
+    char const* SensorId(size_t const idxSensor) const
+    {
+        return m_rgszAddresses[idxSensor];
+    }
+
+    RunningStatistics const& SensorTemperature(size_t const idxSensor) const
+    {
+        return m_rgExternalTemperatures[idxSensor];
+    }
+
+private:
+    RunningStatistics m_OperableTemperature;
+    RunningStatistics m_OnboardTemperature;
+    RunningStatistics m_OnboardHumidity;
+
+    OneWireAddress m_rgAddresses[c_cOneWireDevices_Max];
+    char m_rgszAddresses[c_cOneWireDevices_Max][OneWireAddress::sc_cchAsHexString_WithTerminator];
+    RunningStatistics m_rgExternalTemperatures[c_cOneWireDevices_Max];
+    size_t m_cAddresses;
+
+    bool m_fUsedExternalSensor;
+    uint16_t m_cSamples;
+
+    bool m_fHasPreviousSample;
+    unsigned long m_WindowStartTime_msec;
+    unsigned long m_LatestSampleTime_msec;
+    ThermostatAction m_LatestActions;
+
+    unsigned long m_HeatOnTime_msec;
+    unsigned long m_CoolOnTime_msec;
+    unsigned long m_CirculateOnTime_msec;
+};
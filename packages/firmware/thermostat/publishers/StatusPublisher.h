@@ -18,13 +18,11 @@ public:
     void Publish(Configuration const& configuration,
                  ThermostatSetpoint const& thermostatSetpoint,
                  ThermostatAction const& currentActions,
-                 bool const fUsedExternalSensor,
-                 float const operableTemperature,
-                 float const onboardTemperature,
-                 float const onboardHumidity,
-                 OneWireAddress const* const rgAddresses,
-                 size_t const cAddressesFound,
-                 float const* const rgExternalTemperatures)
+                 StatusAggregator<c_cOneWireDevices_Max> const& aggregator,
+                 SensorFusion<c_cOneWireDevices_Max> const& sensorFusion,
+                 Zone const* const rgZones,
+                 size_t const cZones,
+                 DeadlineMonitor::Overrun const* const pPreviousOverrun = nullptr)
     {
         FixedStringBuffer<cchEventData> sb;
 
@@ -33,27 +31,85 @@ public:
         ++m_SerialNumber;
 
         // Status
-        sb.AppendFormat(",\"t\":%.1f", !std::isnan(operableTemperature) ? operableTemperature : 0.0f);
-
-        if (fUsedExternalSensor)
         {
-            sb.AppendFormat(",\"t2\":%.1f", !std::isnan(onboardTemperature) ? onboardTemperature : 0.0f);
+            RunningStatistics const& operableTemperature = aggregator.OperableTemperature();
+            RunningStatistics const& onboardTemperature = aggregator.OnboardTemperature();
+            RunningStatistics const& onboardHumidity = aggregator.OnboardHumidity();
+
+            sb.AppendFormat(",\"t\":%.1f", valueOrZero(operableTemperature.Last()));
+            appendStatisticsToStringBuilder(sb, "t", operableTemperature);
+
+            if (aggregator.UsedExternalSensor())
+            {
+                sb.AppendFormat(",\"t2\":%.1f", valueOrZero(onboardTemperature.Last()));
+            }
+
+            sb.AppendFormat(",\"h\":%.1f", valueOrZero(onboardHumidity.Last()));
+            appendStatisticsToStringBuilder(sb, "h", onboardHumidity);
+
+            // Derived from the latest onboard reading
+            float const dewPoint = Psychrometrics::DewPoint(onboardTemperature.Last(), onboardHumidity.Last());
+
+            if (!std::isnan(dewPoint))
+            {
+                sb.AppendFormat(",\"dp\":%.1f,\"ah\":%.1f",
+                                dewPoint,
+                                Psychrometrics::AbsoluteHumidity(onboardTemperature.Last(), onboardHumidity.Last()));
+            }
         }
 
-        sb.AppendFormat(",\"h\":%.1f", !std::isnan(onboardHumidity) ? onboardHumidity : 0.0f);
+        // Sensor fusion input status (one character per configured input, c.f. SensorFusion::InputStatus)
+        if (SensorFusion<c_cOneWireDevices_Max>::IsConfigured(configuration))
+        {
+            sb.Append(",\"fq\":\"");
+
+            for (size_t idxInput = 0; idxInput < sensorFusion.InputCount(); ++idxInput)
+            {
+                sb.AppendFormat("%c", static_cast<char>(sensorFusion.GetInputStatus(idxInput)));
+            }
+
+            sb.Append("\"");
+        }
 
         sb.Append(",\"ca\":\"");
         appendActionsToStringBuilder(sb, currentActions);
         sb.Append("\"");
 
+        // Aggregation window: sample count, window duration [sec], and time spent in each action [sec]
+        sb.AppendFormat(",\"n\":%u,\"w\":%lu,\"ao\":[%lu,%lu,%lu]",
+                        aggregator.SampleCount(),
+                        toSeconds(aggregator.WindowDuration_msec()),
+                        toSeconds(aggregator.HeatOnTime_msec()),
+                        toSeconds(aggregator.CoolOnTime_msec()),
+                        toSeconds(aggregator.CirculateOnTime_msec()));
+
+        // Zones (only worth reporting separately if there's more than one)
+        if (cZones > 1)
+        {
+            sb.Append(",\"z\":[");
+
+            for (size_t idxZone = 0; idxZone < cZones; ++idxZone)
+            {
+                Zone const& zone = rgZones[idxZone];
+
+                sb.AppendFormat("%s{\"t\":%.1f,\"sh\":%.1f,\"sc\":%.1f,\"ca\":\"",
+                                (idxZone > 0) ? "," : "",
+                                valueOrZero(zone.OperableTemperature()),
+                                zone.CurrentSetpoint().SetPointHeat,
+                                zone.CurrentSetpoint().SetPointCool);
+                appendActionsToStringBuilder(sb, zone.CurrentActions());
+                sb.Append("\"}");
+            }
+
+            sb.Append("]");
+        }
+
         // Configuration
         {
-            // See main.cpp#applyTimezoneConfiguration()
-            bool const inNextTimezone = configuration.rootConfiguration().nextTimezoneChange() <= Time.now();
+            int16_t const timezoneUTCOffset = LocalTime::GetUTCOffset(configuration, Time.now());
 
-            int16_t const timezoneUTCOffset = inNextTimezone
-                                                  ? configuration.rootConfiguration().nextTimezoneUTCOffset()
-                                                  : configuration.rootConfiguration().currentTimezoneUTCOffset();
+            // Active configuration's hash (the status response is abbreviated if the cloud's configuration matches)
+            sb.AppendFormat(",\"ch\":\"%08lx\"", static_cast<unsigned long>(configuration.Hash()));
 
             sb.AppendFormat(",\"cc\":{\"sh\":%.1f,\"sc\":%.1f,\"sa\":%.1f,\"sb\":%.1f,\"th\":%.2f,\"tz\":%d",
                             thermostatSetpoint.SetPointHeat,
@@ -68,52 +124,141 @@ public:
             sb.Append("\"}");
         }
 
-        // Measurements
+        // Everything up to here fits (c.f. cchRequired_Max); the rest is only appended while it does
+
+        // Deadline overrun that led to the previous reset (c.f. DeadlineMonitor)
+        if (pPreviousOverrun)
+        {
+            uint16_t const cchBefore = sb.Length();
+
+            bool const fFits =
+                sb.AppendFormat(",\"ov\":{\"s\":\"%s\",\"d\":%lu,\"dl\":%lu,\"i\":%u,\"ts\":%lu}",
+                                DeadlineMonitor::GetStageName(pPreviousOverrun->Stage),
+                                static_cast<unsigned long>(pPreviousOverrun->Duration_msec),
+                                static_cast<unsigned long>(pPreviousOverrun->Deadline_msec),
+                                pPreviousOverrun->fIsIncomplete ? 1 : 0,
+                                static_cast<unsigned long>(pPreviousOverrun->DetectionTime));
+
+            if (!fFits || !hasRoomForTail(sb))
+            {
+                sb.Truncate(cchBefore);
+                WAF_LOG_WARNING("!! Deadline overrun doesn't fit into status event, omitted.");
+            }
+        }
+
+        // Measurements (sensors that don't fit are omitted and counted)
         sb.Append(",\"v\":[");
         {
             bool isCommaNeeded = false;
+            unsigned int cOmittedSensors = 0;
 
-            for (size_t idxAddress = 0; idxAddress < cAddressesFound; ++idxAddress)
+            for (size_t idxSensor = 0; idxSensor < aggregator.SensorCount(); ++idxSensor)
             {
-                if (std::isnan(rgExternalTemperatures[idxAddress]))
+                RunningStatistics const& sensorTemperature = aggregator.SensorTemperature(idxSensor);
+
+                if (sensorTemperature.Count() == 0)
                 {
                     continue;
                 }
 
-                if (isCommaNeeded)
+                uint16_t const cchBefore = sb.Length();
+
+                bool fFits = !isCommaNeeded || sb.Append(",");
+
+                fFits = fFits && sb.AppendFormat("{\"id\":\"%s\",\"t\":%.1f",
+                                                 aggregator.SensorId(idxSensor),
+                                                 sensorTemperature.Last());
+                fFits = fFits && appendStatisticsToStringBuilder(sb, "t", sensorTemperature);
+                fFits = fFits && sb.Append("}");
+
+                if (!fFits || !hasRoomForTail(sb))
                 {
-                    sb.Append(",");
+                    sb.Truncate(cchBefore);
+                    ++cOmittedSensors;
+                    continue;
                 }
 
-                char rgAddress[OneWireAddress::sc_cchAsHexString_WithTerminator];
-                rgAddresses[idxAddress].ToString(rgAddress);
+                isCommaNeeded = true;
+            }
 
-                sb.AppendFormat("{\"id\":\"%s\",\"t\":%.1f}", rgAddress, rgExternalTemperatures[idxAddress]);
+            sb.Append("]");
 
-                isCommaNeeded = true;
+            if (cOmittedSensors)
+            {
+                sb.AppendFormat(",\"vx\":%u", cOmittedSensors);
+                WAF_LOG_WARNING("!! %u measurement(s) don't fit into status event, omitted.", cOmittedSensors);
             }
         }
-        sb.AppendFormat("]}");
+        sb.Append("}");
 
         m_QueuedPublisher.Publish(sb.ToString());
     }
 
 private:
-    static size_t constexpr cchEventData =
-        static_strlen("{'ts':4294967295,'ser':4294967295")   // Header
-        + static_strlen(",'t':-100.0,'t2':-100.0,'h':100.0,'ca':'HCR'")  // Status
-        + static_strlen(
-              ",cc:{'sh':10.0,'sc':10.0,'sa':10.0,'sb':10.0,'th':10.00,'tz':-999,'aa':'HCR','tz'}")  // Configuration
-        + static_strlen(",'v':[]}")                                                                  // Measurements
-        + c_cOneWireDevices_Max *
-              static_strlen("{'id':'001122334455667788','t':-100.0,'h':100.0},")  // Values from external sensors
-        + 4;                                                                      // Safety margin
+    // Particle's limit on event data (c.f. Particle.publish()), plus the terminator
+    static size_t constexpr cchEventData = 622 + 1;
+
+    // Worst case for everything ahead of the overrun and measurements, which thus always fits
+    static size_t constexpr cchRequired_Max =
+        static_strlen("{'ts':4294967295,'ser':4294967295")                        // Header
+        + static_strlen(",'t':-100.0,'t2':-100.0,'h':100.0,'ca':'HCR'")           // Status
+        + static_strlen(",'dp':-100.0,'ah':100.0")                                // Derived humidity metrics
+        + 2 * static_strlen(",'tn':-100.0,'tx':-100.0,'ta':-100.00")              // Status aggregates
+        + static_strlen(",'fq':''") + (c_cOneWireDevices_Max + 1)                 // Sensor fusion status
+        + static_strlen(",'n':65535,'w':4294967,'ao':[4294967,4294967,4294967]")  // Aggregation window
+        + static_strlen(",'z':[]")                                                // Zones
+        + Zone::sc_cZones_Max * static_strlen("{'t':-100.0,'sh':-100.0,'sc':-100.0,'ca':'HCR'},")
+        + static_strlen(",'ch':'0123abcd'")                                       // Configuration hash
+        + static_strlen(",'cc':{'sh':-100.0,'sc':-100.0,'sa':-100.0,'sb':-100.0,'th':10.00,'tz':-999,'aa':'HCR'}")
+        + static_strlen(",'v':[");                                                // Measurements
+
+    // Closing out the measurements (with the count of omitted ones) and the event
+    static size_t constexpr cchTail_Max = static_strlen("],'vx':255}");
+
+    static_assert(cchRequired_Max + cchTail_Max < cchEventData, "Status event exceeds Particle's limit");
 
 private:
     QueuedPublisher<cchEventData, 8> m_QueuedPublisher;
     uint32_t m_SerialNumber;
 
 private:
+    static float valueOrZero(float const value)
+    {
+        return !std::isnan(value) ? value : 0.0f;
+    }
+
+    static unsigned long toSeconds(unsigned long const value_msec)
+    {
+        return (value_msec + 500) / 1000;
+    }
+
+    template <typename T>
+    static bool hasRoomForTail(T const& stringBuilder)
+    {
+        return stringBuilder.Length() + cchTail_Max < cchEventData;
+    }
+
+    // @returns whether it fit
+    template <typename T>
+    bool appendStatisticsToStringBuilder(T& stringBuilder,
+                                         char const* const szKey,
+                                         RunningStatistics const& statistics) const
+    {
+        // Only worth reporting if there was more than one sample (otherwise it's all the same value)
+        if (statistics.Count() <= 1)
+        {
+            return true;
+        }
+
+        return stringBuilder.AppendFormat(",\"%sn\":%.1f,\"%sx\":%.1f,\"%sa\":%.2f",
+                                          szKey,
+                                          statistics.Min(),
+                                          szKey,
+                                          statistics.Max(),
+                                          szKey,
+                                          statistics.Mean());
+    }
+
     template <typename T>
     void appendActionsToStringBuilder(T& stringBuilder, ThermostatAction const& actions) const
     {
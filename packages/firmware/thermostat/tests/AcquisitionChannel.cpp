@@ -0,0 +1,186 @@
+#include <thread>  // (Ahead of base.h, whose CoreDefs.h defines __out)
+
+#include "base.h"
+
+namespace
+{
+typedef SensorSnapshot<8> TestReadings;
+
+struct TestRequest
+{
+    uint32_t Sequence;
+};
+
+// Stands in for sensor I/O: derives everything from the request so the control thread can check it
+void acquireTestReadings(TestRequest const& request, TestReadings& readings)
+{
+    readings.Reset();
+    readings.AcquisitionTime_msec = request.Sequence;
+    readings.OnboardTemperature = static_cast<float>(request.Sequence % 1000);
+
+    size_t const cSensors = request.Sequence % 9;
+
+    for (size_t idxSensor = 0; idxSensor < cSensors; ++idxSensor)
+    {
+        readings.AddSensor(OneWireAddress(0x28 + idxSensor));
+        readings.SetReading(idxSensor, readings.OnboardTemperature + idxSensor, request.Sequence);
+    }
+}
+
+bool areTestReadingsConsistent(TestReadings const& readings)
+{
+    uint32_t const sequence = readings.AcquisitionTime_msec;
+
+    if ((readings.OnboardTemperature != static_cast<float>(sequence % 1000)) || (readings.cSensors != sequence % 9))
+    {
+        return false;
+    }
+
+    for (size_t idxSensor = 0; idxSensor < readings.cSensors; ++idxSensor)
+    {
+        if (!readings.IsValid(idxSensor) || (readings.rgIds[idxSensor] != OneWireAddress(0x28 + idxSensor)) ||
+            (readings.rgValues[idxSensor] != readings.OnboardTemperature + idxSensor) ||
+            (readings.rgTimestamps_msec[idxSensor] != sequence))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+}  // namespace
+
+SCENARIO("AcquisitionChannel hands requests and readings off", "[AcquisitionChannel]")
+{
+    GIVEN("A channel")
+    {
+        AcquisitionChannel<TestRequest, TestReadings> channel;
+        TestReadings readings;
+
+        REQUIRE(!channel.IsAcquiring());
+        REQUIRE(!channel.HasReadings());
+        REQUIRE(!channel.Service(acquireTestReadings));
+        REQUIRE(!channel.Receive(readings));
+
+        WHEN("An acquisition is requested")
+        {
+            REQUIRE(channel.Request(TestRequest{3}));
+
+            THEN("It's outstanding until it has been serviced")
+            {
+                REQUIRE(channel.IsAcquiring());
+                REQUIRE(!channel.HasReadings());
+
+                REQUIRE(channel.Service(acquireTestReadings));
+
+                REQUIRE(!channel.IsAcquiring());
+                REQUIRE(channel.HasReadings());
+
+                REQUIRE(channel.Receive(readings));
+                REQUIRE(readings.AcquisitionTime_msec == 3);
+                REQUIRE(areTestReadingsConsistent(readings));
+
+                REQUIRE(!channel.HasReadings());
+                REQUIRE(!channel.Receive(readings));
+            }
+        }
+
+        WHEN("The control thread doesn't keep up with readings")
+        {
+            // (Room for fewer readings than requests)
+            AcquisitionChannel<TestRequest, TestReadings, 1> narrowChannel;
+
+            uint32_t sequence = 0;
+
+            while (narrowChannel.Request(TestRequest{sequence}))
+            {
+                ++sequence;
+            }
+
+            uint8_t const cRequests_Max = narrowChannel.sc_cRequests_Max;
+            REQUIRE(sequence == cRequests_Max);
+
+            while (narrowChannel.Service(acquireTestReadings))
+            {
+            }
+
+            THEN("Requests stay outstanding rather than readings getting dropped")
+            {
+                REQUIRE(narrowChannel.IsAcquiring());
+
+                for (uint32_t idxExpected = 0; idxExpected < sequence; ++idxExpected)
+                {
+                    if (!narrowChannel.Receive(readings))
+                    {
+                        REQUIRE(narrowChannel.Service(acquireTestReadings));
+                        REQUIRE(narrowChannel.Receive(readings));
+                    }
+
+                    REQUIRE(readings.AcquisitionTime_msec == idxExpected);
+                }
+
+                REQUIRE(!narrowChannel.IsAcquiring());
+            }
+        }
+    }
+}
+
+SCENARIO("AcquisitionChannel works across threads", "[AcquisitionChannel]")
+{
+    uint32_t constexpr c_cAcquisitions = 50 * 1000;
+
+    GIVEN("An acquisition thread servicing requests")
+    {
+        AcquisitionChannel<TestRequest, TestReadings> channel;
+        std::atomic<bool> fStop(false);
+
+        std::thread acquisitionThread([&]() {
+            while (!fStop.load())
+            {
+                if (!channel.Service(acquireTestReadings))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        WHEN("The control thread requests and receives acquisitions without ever waiting")
+        {
+            TestReadings readings;
+
+            uint32_t cRequested = 0;
+            uint32_t cReceived = 0;
+            uint32_t cOutOfOrder = 0;
+            uint32_t cInconsistent = 0;
+
+            while (cReceived < c_cAcquisitions)
+            {
+                if (cRequested < c_cAcquisitions && channel.Request(TestRequest{cRequested}))
+                {
+                    ++cRequested;
+                }
+
+                if (channel.Receive(readings))
+                {
+                    cOutOfOrder += (readings.AcquisitionTime_msec != cReceived) ? 1 : 0;
+                    cInconsistent += areTestReadingsConsistent(readings) ? 0 : 1;
+
+                    ++cReceived;
+                }
+            }
+
+            fStop = true;
+            acquisitionThread.join();
+
+            THEN("Every acquisition arrives once, in order, and intact")
+            {
+                REQUIRE(cRequested == c_cAcquisitions);
+                REQUIRE(cOutOfOrder == 0);
+                REQUIRE(cInconsistent == 0);
+
+                REQUIRE(!channel.IsAcquiring());
+                REQUIRE(!channel.HasReadings());
+            }
+        }
+    }
+}
@@ -0,0 +1,304 @@
+#include "base.h"
+
+SCENARIO("Configuration ingestion is bounded by explicit limits", "[Configuration]")
+{
+    EEPROM.testErase();
+
+    GIVEN("As many zones as the firmware supports")
+    {
+        SyntheticConfiguration configuration;
+
+        for (uint8_t idxZone = 0; idxZone < Configuration::sc_cZones_Max; ++idxZone)
+        {
+            configuration.AddZone(0, 0);
+        }
+
+        THEN("The configuration is accepted")
+        {
+            REQUIRE(configuration.TryBuild());
+        }
+    }
+
+    GIVEN("More zones than the firmware supports")
+    {
+        SyntheticConfiguration configuration;
+
+        for (uint8_t idxZone = 0; idxZone <= Configuration::sc_cZones_Max; ++idxZone)
+        {
+            configuration.AddZone(0, 0);
+        }
+
+        THEN("The configuration is rejected")
+        {
+            REQUIRE(!configuration.TryBuild());
+        }
+    }
+
+    GIVEN("Configuration text with characters outside of the Z85 alphabet")
+    {
+        Configuration configuration;
+        configuration.Initialize();
+
+        THEN("It's rejected, including characters past the end of the decoder's table")
+        {
+            REQUIRE(configuration.SubmitUpdate("\x80\x80\x80\x80\x80", 5) ==
+                    Configuration::ConfigUpdateResult::Invalid);
+            REQUIRE(configuration.SubmitUpdate("\xff\xff\xff\xff\xff", 5) ==
+                    Configuration::ConfigUpdateResult::Invalid);
+        }
+    }
+
+    GIVEN("Configuration text longer than the configuration buffer")
+    {
+        Configuration configuration;
+        configuration.Initialize();
+
+        // (One Z85 frame past the buffer's size)
+        std::string const text((Configuration::sc_cbFlatbufferData_Max / 4 + 1) * 5, '0');
+
+        THEN("It's rejected before decoding")
+        {
+            REQUIRE(configuration.SubmitUpdate(text.c_str(), text.size()) ==
+                    Configuration::ConfigUpdateResult::Invalid);
+        }
+    }
+}
+
+SCENARIO("Configuration rejects unusable relay pins", "[Configuration]")
+{
+    EEPROM.testErase();
+
+    uint8_t constexpr c_RelayPin_NotConnected = Configuration::sc_RelayPin_NotConnected;
+
+    GIVEN("Zones on relay pins of their own")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddZone(0, 0x1, D3, D4, D5);
+        configuration.AddZone(0, 0x2, A0, c_RelayPin_NotConnected, c_RelayPin_NotConnected);
+        configuration.AddZone(0, 0x4, A1, c_RelayPin_NotConnected, c_RelayPin_NotConnected);
+
+        THEN("The configuration is accepted, with unconnected relays not counting as shared")
+        {
+            REQUIRE(configuration.TryBuild());
+        }
+    }
+
+    GIVEN("A zone with a relay on a pin the device uses itself")
+    {
+        THEN("The configuration is rejected")
+        {
+            for (uint8_t const reservedPin : {D0, D1, D2, D6, D7})
+            {
+                CAPTURE(reservedPin);
+
+                SyntheticConfiguration heatConfiguration;
+                heatConfiguration.AddZone(0, 0, reservedPin, D4, D5);
+                REQUIRE(!heatConfiguration.TryBuild());
+
+                SyntheticConfiguration circulateConfiguration;
+                circulateConfiguration.AddZone(0, 0, D3, D4, reservedPin);
+                REQUIRE(!circulateConfiguration.TryBuild());
+            }
+        }
+    }
+
+    GIVEN("A zone using the same pin for two relays")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddZone(0, 0, D3, D4, D3);
+
+        THEN("The configuration is rejected")
+        {
+            REQUIRE(!configuration.TryBuild());
+        }
+    }
+
+    GIVEN("Two zones sharing a relay pin")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddZone(0, 0x1, D3, D4, D5);
+        configuration.AddZone(0, 0x2, A0, A1, D5);
+
+        THEN("The configuration is rejected")
+        {
+            REQUIRE(!configuration.TryBuild());
+        }
+    }
+}
+
+SCENARIO("Configurations are identified by their hash", "[Configuration]")
+{
+    EEPROM.testErase();
+
+    GIVEN("Known data")
+    {
+        THEN("The hash matches the API's FNV-1a implementation")
+        {
+            uint8_t rgData[256];
+
+            for (size_t idxData = 0; idxData < countof(rgData); ++idxData)
+            {
+                rgData[idxData] = static_cast<uint8_t>(idxData * 37 + 11);
+            }
+
+            REQUIRE(Configuration::ComputeHash(reinterpret_cast<uint8_t const*>("a"), 1) == 0xE40C292C);
+            REQUIRE(Configuration::ComputeHash(rgData, countof(rgData)) == 0x7FABA7C5);
+        }
+    }
+
+    GIVEN("An accepted configuration")
+    {
+        ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+        SyntheticConfiguration configuration;
+        configuration.AddHoldSetting(0, setpoint);
+        configuration.Build();
+
+        uint32_t const hash = static_cast<Configuration const&>(configuration).Hash();
+
+        THEN("Its hash differs from the defaults'")
+        {
+            EEPROM.testErase();
+
+            Configuration defaultConfiguration;
+            defaultConfiguration.Initialize();
+
+            REQUIRE(hash != defaultConfiguration.Hash());
+        }
+
+        THEN("Its hash survives a reload")
+        {
+            std::string const& encodedConfiguration = configuration.EncodedConfiguration();
+
+            Configuration persistedConfiguration;
+            persistedConfiguration.Initialize();
+
+            REQUIRE(persistedConfiguration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+                    Configuration::ConfigUpdateResult::Accepted);
+            REQUIRE(persistedConfiguration.AcceptPendingUpdates());
+            persistedConfiguration.SaveData();
+            REQUIRE(persistedConfiguration.Hash() == hash);
+
+            Configuration reloadedConfiguration;
+            reloadedConfiguration.Initialize();
+
+            REQUIRE(reloadedConfiguration.Hash() == hash);
+        }
+    }
+}
+
+SCENARIO("Configurations load quickly at boot", "[Configuration]")
+{
+    EEPROM.testErase();
+
+    GIVEN("Nothing stored")
+    {
+        Configuration configuration;
+        configuration.Initialize();
+
+        THEN("The prebuilt defaults read as the schema's defaults")
+        {
+            REQUIRE(configuration.rootConfiguration().cadence() == 600);
+            REQUIRE(configuration.rootConfiguration().threshold_x100() == 50);
+            REQUIRE(configuration.rootConfiguration().controlMode() == ControlMode::Hysteresis);
+            REQUIRE(configuration.rootConfiguration().thermostatSettings() == nullptr);
+            REQUIRE(configuration.rootConfiguration().zones() == nullptr);
+        }
+    }
+
+    GIVEN("A stored configuration")
+    {
+        ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+        SyntheticConfiguration syntheticConfiguration;
+        syntheticConfiguration.AddHoldSetting(0, setpoint);
+        syntheticConfiguration.Build();
+
+        std::string const& encodedConfiguration = syntheticConfiguration.EncodedConfiguration();
+
+        Configuration persistedConfiguration;
+        persistedConfiguration.Initialize();
+
+        REQUIRE(persistedConfiguration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+                Configuration::ConfigUpdateResult::Accepted);
+        REQUIRE(persistedConfiguration.AcceptPendingUpdates());
+        persistedConfiguration.SaveData();
+
+        uint32_t const verifiedHash = persistedConfiguration.Hash();
+
+        WHEN("It's loaded along with the hash it was verified under")
+        {
+            Configuration configuration;
+            configuration.Initialize(verifiedHash);
+
+            THEN("It's used as is")
+            {
+                REQUIRE(configuration.Hash() == verifiedHash);
+                REQUIRE(configuration.rootConfiguration().thermostatSettings()->size() == 1);
+            }
+        }
+
+        WHEN("It's loaded along with some other hash")
+        {
+            Configuration configuration;
+            configuration.Initialize(verifiedHash + 1);
+
+            THEN("It's verified and used")
+            {
+                REQUIRE(configuration.Hash() == verifiedHash);
+                REQUIRE(configuration.rootConfiguration().thermostatSettings()->size() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Configuration dumps make it through the deferred log", "[Configuration]")
+{
+    EEPROM.testErase();
+
+    GIVEN("A configuration with as many settings as fit")
+    {
+        ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+        std::unique_ptr<SyntheticConfiguration> pConfiguration;
+        size_t cThermostatSettings = Configuration::sc_cThermostatSettings_Max + 1;
+
+        do
+        {
+            REQUIRE(cThermostatSettings > 1);
+            --cThermostatSettings;
+
+            pConfiguration.reset(new SyntheticConfiguration());
+
+            for (size_t idxSetting = 0; idxSetting < cThermostatSettings; ++idxSetting)
+            {
+                pConfiguration->AddScheduledSetting(DaysOfWeek::ANY, static_cast<uint16_t>(idxSetting * 60), setpoint);
+            }
+        } while (!pConfiguration->TryBuild());
+
+        Configuration const& configuration = *pConfiguration;
+
+        // (Discard anything logged while building)
+        DeferredLog::Instance().Drain();
+
+        WHEN("It's printed and the log drained")
+        {
+            Serial.testCaptureLines(true);
+            configuration.PrintConfiguration();
+            DeferredLog::Instance().Drain();
+            std::vector<std::string> const lines = Serial.testGetCapturedLines();
+            Serial.testCaptureLines(false);
+
+            THEN("No records are dropped")
+            {
+                REQUIRE(lines.size() > cThermostatSettings);
+
+                for (std::string const& line : lines)
+                {
+                    CAPTURE(line);
+                    REQUIRE(line.find("log records dropped") == std::string::npos);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+//
+// Accounts for costs incurred against the mocks (I2C traffic, serial output, delays, publishes, flash writes, sleep)
+// from the time it's constructed, so scenarios can assert performance budgets alongside functional results.
+//
+
+struct Costs
+{
+    uint64_t I2CTransactions;
+    uint64_t I2CBytes;
+    uint64_t SerialBytes;
+    uint64_t Delay_usec;
+    uint64_t Publishes;
+    uint64_t PublishedBytes;
+    uint64_t EEPROMWrites;
+    uint64_t EEPROMBytesWritten;
+    uint64_t Sleeps;
+    uint64_t Sleep_msec;
+    uint64_t NetworkStandbySleep_msec;
+    uint64_t NetworkOffSleeps;
+
+    uint64_t Delay_msec() const
+    {
+        return Delay_usec / 1000;
+    }
+};
+
+class CostAccounting
+{
+public:
+    CostAccounting()
+        : m_Baseline(Snapshot())
+    {
+    }
+
+public:
+    Costs Elapsed() const
+    {
+        Costs const current = Snapshot();
+
+        return Costs{current.I2CTransactions - m_Baseline.I2CTransactions,
+                     current.I2CBytes - m_Baseline.I2CBytes,
+                     current.SerialBytes - m_Baseline.SerialBytes,
+                     current.Delay_usec - m_Baseline.Delay_usec,
+                     current.Publishes - m_Baseline.Publishes,
+                     current.PublishedBytes - m_Baseline.PublishedBytes,
+                     current.EEPROMWrites - m_Baseline.EEPROMWrites,
+                     current.EEPROMBytesWritten - m_Baseline.EEPROMBytesWritten,
+                     current.Sleeps - m_Baseline.Sleeps,
+                     current.Sleep_msec - m_Baseline.Sleep_msec,
+                     current.NetworkStandbySleep_msec - m_Baseline.NetworkStandbySleep_msec,
+                     current.NetworkOffSleeps - m_Baseline.NetworkOffSleeps};
+    }
+
+    void Print(char const* const szScenario) const
+    {
+        Costs const costs = Elapsed();
+
+        printf("\n[Costs] %s: %llu I2C transactions (%llu bytes), %llu serial bytes, %.1f ms delay, "
+               "%llu publishes (%llu bytes), %llu EEPROM writes (%llu bytes), %llu sleeps (%.1f s)\n",
+               szScenario,
+               static_cast<unsigned long long>(costs.I2CTransactions),
+               static_cast<unsigned long long>(costs.I2CBytes),
+               static_cast<unsigned long long>(costs.SerialBytes),
+               costs.Delay_usec / 1000.0,
+               static_cast<unsigned long long>(costs.Publishes),
+               static_cast<unsigned long long>(costs.PublishedBytes),
+               static_cast<unsigned long long>(costs.EEPROMWrites),
+               static_cast<unsigned long long>(costs.EEPROMBytesWritten),
+               static_cast<unsigned long long>(costs.Sleeps),
+               costs.Sleep_msec / 1000.0);
+    }
+
+private:
+    Costs m_Baseline;
+
+    static Costs Snapshot()
+    {
+        return Costs{Wire.testGetTransactionCount(),
+                     Wire.testGetByteCount(),
+                     Serial.testGetByteCount(),
+                     Time.testGetTotalDelay_usec(),
+                     Particle.testGetPublishCount(),
+                     Particle.testGetPublishedByteCount(),
+                     EEPROM.testGetWriteCount(),
+                     EEPROM.testGetBytesWritten(),
+                     System.testGetSleepCount(),
+                     System.testGetSleep_msec(),
+                     System.testGetNetworkStandbySleep_msec(),
+                     System.testGetNetworkOffSleepCount()};
+    }
+};
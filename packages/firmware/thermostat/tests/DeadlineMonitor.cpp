@@ -0,0 +1,162 @@
+#include "base.h"
+
+namespace
+{
+typedef DeadlineMonitor::Stage Stage;
+
+void setDeadlines(DeadlineMonitor& deadlineMonitor)
+{
+    deadlineMonitor.SetDeadline(Stage::Acquire, 5000);
+    deadlineMonitor.SetDeadline(Stage::Control, 1000);
+    deadlineMonitor.SetDeadline(Stage::Publish, 20000);
+}
+}  // namespace
+
+SCENARIO("Deadline monitor gates the watchdog on stage deadlines", "[DeadlineMonitor]")
+{
+    uint8_t const noStage = DeadlineMonitor::sc_NoStage;
+
+    DeadlineMonitor::RetainedRecord record;
+    memset(&record, 0xA5, sizeof(record));  // Retained memory isn't initialized at boot
+
+    Time.testSetUTCTime(1600000000);
+
+    DeadlineMonitor deadlineMonitor;
+    setDeadlines(deadlineMonitor);
+    deadlineMonitor.Initialize(&record);
+
+    GIVEN("A freshly booted device")
+    {
+        THEN("There's no previous overrun to report and the record is reset")
+        {
+            REQUIRE(deadlineMonitor.PreviousOverrun() == nullptr);
+            REQUIRE(deadlineMonitor.IsOnTime());
+
+            REQUIRE(record.IsValid());
+            REQUIRE(record.ActiveStage == noStage);
+            REQUIRE(record.FirstOverrun.Stage == noStage);
+        }
+    }
+
+    GIVEN("Stages that meet their deadlines")
+    {
+        deadlineMonitor.Begin(Stage::Control, 1000);
+        REQUIRE(record.ActiveStage == static_cast<uint8_t>(Stage::Control));
+        REQUIRE(deadlineMonitor.End(Stage::Control, 1900));
+
+        deadlineMonitor.Begin(Stage::Process, 2000);  // (No deadline)
+        REQUIRE(deadlineMonitor.End(Stage::Process, 60000));
+
+        THEN("The watchdog keeps being kicked")
+        {
+            REQUIRE(deadlineMonitor.Check(70000));
+            REQUIRE(record.IsValid());
+            REQUIRE(record.ActiveStage == noStage);
+            REQUIRE(record.FirstOverrun.Stage == noStage);
+        }
+    }
+
+    GIVEN("A stage that overruns")
+    {
+        deadlineMonitor.Begin(Stage::Publish, 1000);
+        REQUIRE(!deadlineMonitor.End(Stage::Publish, 23000));
+
+        deadlineMonitor.Begin(Stage::Control, 30000);
+        REQUIRE(!deadlineMonitor.End(Stage::Control, 32000));
+
+        THEN("The watchdog is no longer kicked")
+        {
+            REQUIRE(!deadlineMonitor.IsOnTime());
+            REQUIRE(!deadlineMonitor.Check(40000));
+        }
+
+        THEN("Only the first overrun is recorded")
+        {
+            REQUIRE(record.IsValid());
+            REQUIRE(record.FirstOverrun.Stage == static_cast<uint8_t>(Stage::Publish));
+            REQUIRE(record.FirstOverrun.Duration_msec == 22000);
+            REQUIRE(record.FirstOverrun.Deadline_msec == 20000);
+            REQUIRE(!record.FirstOverrun.fIsIncomplete);
+            REQUIRE(record.FirstOverrun.DetectionTime == 1600000000);
+        }
+
+        WHEN("The device comes back up after the watchdog's reset")
+        {
+            DeadlineMonitor nextDeadlineMonitor;
+            setDeadlines(nextDeadlineMonitor);
+            nextDeadlineMonitor.Initialize(&record);
+
+            THEN("The overrun is reported until cleared")
+            {
+                DeadlineMonitor::Overrun const* const pPreviousOverrun = nextDeadlineMonitor.PreviousOverrun();
+
+                REQUIRE(pPreviousOverrun != nullptr);
+                REQUIRE(pPreviousOverrun->Stage == static_cast<uint8_t>(Stage::Publish));
+                REQUIRE(pPreviousOverrun->Duration_msec == 22000);
+                REQUIRE(strcmp(DeadlineMonitor::GetStageName(pPreviousOverrun->Stage), "Publish") == 0);
+
+                REQUIRE(nextDeadlineMonitor.IsOnTime());
+                REQUIRE(record.FirstOverrun.Stage == noStage);
+
+                nextDeadlineMonitor.ClearPreviousOverrun();
+                REQUIRE(nextDeadlineMonitor.PreviousOverrun() == nullptr);
+            }
+        }
+    }
+
+    GIVEN("An acquisition that doesn't complete")
+    {
+        deadlineMonitor.Begin(Stage::Acquire, 1000);
+
+        THEN("It's caught while still outstanding")
+        {
+            REQUIRE(deadlineMonitor.Check(6000));
+            REQUIRE(record.ActiveStage == noStage);  // (Doesn't hold up the control thread)
+
+            REQUIRE(!deadlineMonitor.Check(6001));
+            REQUIRE(record.FirstOverrun.Stage == static_cast<uint8_t>(Stage::Acquire));
+            REQUIRE(record.FirstOverrun.Duration_msec == 5001);
+            REQUIRE(record.FirstOverrun.fIsIncomplete);
+        }
+    }
+
+    GIVEN("A stage that hangs the control thread until the watchdog resets the device")
+    {
+        deadlineMonitor.Begin(Stage::Control, 1000);
+
+        DeadlineMonitor nextDeadlineMonitor;
+        setDeadlines(nextDeadlineMonitor);
+        nextDeadlineMonitor.Initialize(&record);
+
+        THEN("It's reported as the overrun")
+        {
+            DeadlineMonitor::Overrun const* const pPreviousOverrun = nextDeadlineMonitor.PreviousOverrun();
+
+            REQUIRE(pPreviousOverrun != nullptr);
+            REQUIRE(pPreviousOverrun->Stage == static_cast<uint8_t>(Stage::Control));
+            REQUIRE(pPreviousOverrun->fIsIncomplete);
+            REQUIRE(pPreviousOverrun->Duration_msec == 0);
+            REQUIRE(pPreviousOverrun->Deadline_msec == 1000);
+
+            REQUIRE(record.ActiveStage == noStage);
+        }
+    }
+
+    GIVEN("A corrupted record")
+    {
+        deadlineMonitor.Begin(Stage::Publish, 1000);
+        deadlineMonitor.End(Stage::Publish, 30000);
+
+        record.FirstOverrun.Duration_msec ^= 0x01;
+
+        DeadlineMonitor nextDeadlineMonitor;
+        setDeadlines(nextDeadlineMonitor);
+        nextDeadlineMonitor.Initialize(&record);
+
+        THEN("It's not trusted")
+        {
+            REQUIRE(nextDeadlineMonitor.PreviousOverrun() == nullptr);
+            REQUIRE(record.IsValid());
+        }
+    }
+}
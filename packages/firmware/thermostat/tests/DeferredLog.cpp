@@ -0,0 +1,159 @@
+#include "base.h"
+
+namespace
+{
+std::string DrainOneLine(DeferredLog& deferredLog)
+{
+    Serial.testCaptureLines(true);
+    deferredLog.Drain();
+
+    std::vector<std::string> const lines = Serial.testGetCapturedLines();
+    Serial.testCaptureLines(false);
+
+    REQUIRE(lines.size() == 1);
+    return lines.front();
+}
+
+int s_cEvaluations = 0;
+
+int CountEvaluation()
+{
+    return ++s_cEvaluations;
+}
+}  // namespace
+
+SCENARIO("Deferred logging", "[DeferredLog]")
+{
+    DeferredLog deferredLog;
+
+    GIVEN("A logged line")
+    {
+        CostAccounting costAccounting;
+
+        deferredLog.Append(DeferredLog::Level::Info, "Early start: up to %u min", 90u);
+
+        THEN("Nothing is written out until it's drained")
+        {
+            REQUIRE(costAccounting.Elapsed().SerialBytes == 0);
+            REQUIRE(!deferredLog.IsEmpty());
+
+            REQUIRE(DrainOneLine(deferredLog) == "Early start: up to 90 min");
+            REQUIRE(deferredLog.IsEmpty());
+        }
+    }
+
+    GIVEN("The conversions used by the firmware")
+    {
+        THEN("Records are formatted as printf() would")
+        {
+            deferredLog.Append(DeferredLog::Level::Info,
+                               "-- It is currently %02d:%02d on a %sday (%u Unix time)",
+                               7,
+                               5,
+                               "Mon",
+                               static_cast<uint32_t>(1577836800));
+            REQUIRE(DrainOneLine(deferredLog) == "-- It is currently 07:05 on a Monday (1577836800 Unix time)");
+
+            deferredLog.Append(
+                DeferredLog::Level::Info, "heating %.2f C/h (%u samples), %.0f minutes", 1.5f, uint16_t(3), 42.4);
+            REQUIRE(DrainOneLine(deferredLog) == "heating 1.50 C/h (3 samples), 42 minutes");
+
+            deferredLog.Append(DeferredLog::Level::Trace,
+                               "<< %s (%lu msec), [%c%c%c], %d, 100%%",
+                               "LoopDelay",
+                               4294967295UL,
+                               'H',
+                               '_',
+                               'R',
+                               -12);
+            REQUIRE(DrainOneLine(deferredLog) == "<< LoopDelay (4294967295 msec), [H_R], -12, 100%");
+        }
+
+        THEN("Missing and mismatched arguments are marked rather than misread")
+        {
+            deferredLog.Append(DeferredLog::Level::Info, "%d and %s", "text");
+            REQUIRE(DrainOneLine(deferredLog) == "<?> and <?>");
+        }
+    }
+
+    GIVEN("A logged string that changes before it's drained")
+    {
+        char szData[] = "before";
+        deferredLog.Append(DeferredLog::Level::Info, "Published %s", szData);
+
+        strcpy(szData, "after!");
+
+        THEN("The logged value is retained")
+        {
+            REQUIRE(DrainOneLine(deferredLog) == "Published before");
+        }
+    }
+
+    GIVEN("More records than fit into the ring buffer")
+    {
+        size_t cAppended = 0;
+
+        for (; cAppended < DeferredLog::sc_cbBuffer; ++cAppended)
+        {
+            deferredLog.Append(DeferredLog::Level::Info, "Record %u", static_cast<unsigned int>(cAppended));
+        }
+
+        THEN("Excess records are dropped and reported")
+        {
+            Serial.testCaptureLines(true);
+            size_t const cDrained = deferredLog.Drain();
+            std::vector<std::string> const lines = Serial.testGetCapturedLines();
+            Serial.testCaptureLines(false);
+
+            REQUIRE(cDrained > 0);
+            REQUIRE(cDrained < cAppended);
+
+            char szDropped[64];
+            snprintf(szDropped, sizeof(szDropped), "!! %zu log records dropped", cAppended - cDrained);
+
+            REQUIRE(lines.size() == cDrained + 1);
+            REQUIRE(lines[0] == szDropped);
+            REQUIRE(lines[1] == "Record 0");
+        }
+    }
+
+    GIVEN("Records drained a few at a time")
+    {
+        for (unsigned int idxRecord = 0; idxRecord < 5; ++idxRecord)
+        {
+            deferredLog.Append(DeferredLog::Level::Info, "Record %u", idxRecord);
+        }
+
+        THEN("Draining is bounded and in order")
+        {
+            Serial.testCaptureLines(true);
+
+            REQUIRE(deferredLog.Drain(2) == 2);
+            REQUIRE(deferredLog.Drain() == 3);
+
+            std::vector<std::string> const lines = Serial.testGetCapturedLines();
+            Serial.testCaptureLines(false);
+
+            REQUIRE(lines.size() == 5);
+            REQUIRE(lines[2] == "Record 2");
+        }
+    }
+}
+
+SCENARIO("Log levels are filtered at compile time", "[DeferredLog]")
+{
+    DeferredLog::Instance().Drain();
+    s_cEvaluations = 0;
+
+    GIVEN("The default log level (info)")
+    {
+        WAF_LOG_TRACE("Trace %d", CountEvaluation());
+        WAF_LOG_INFO("Info %d", CountEvaluation());
+
+        THEN("Disabled statements don't evaluate their arguments")
+        {
+            REQUIRE(s_cEvaluations == 1);
+            REQUIRE(DrainOneLine(DeferredLog::Instance()) == "Info 1");
+        }
+    }
+}
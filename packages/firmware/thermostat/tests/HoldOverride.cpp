@@ -0,0 +1,164 @@
+#include "base.h"
+
+SCENARIO("Local holds take effect without a configuration update", "[HoldOverride]")
+{
+    EEPROM.testErase();
+
+    uint32_t constexpr c_Now = 1600000000;
+
+    GIVEN("A local hold")
+    {
+        HoldOverride holdOverride;
+
+        REQUIRE(!holdOverride.IsActive(c_Now));
+        REQUIRE(!holdOverride.HasPendingUpdates());
+
+        THEN("Well-formed holds are accepted once the main thread gets to them")
+        {
+            REQUIRE(holdOverride.SubmitUpdate("H1,1,2150,2600,10000,-1000,1600007200") ==
+                    HoldOverride::HoldUpdateResult::Accepted);
+
+            REQUIRE(holdOverride.HasPendingUpdates());
+            REQUIRE(!holdOverride.IsActive(c_Now));
+
+            REQUIRE(holdOverride.AcceptPendingUpdates());
+            REQUIRE(!holdOverride.HasPendingUpdates());
+            REQUIRE(!holdOverride.AcceptPendingUpdates());
+
+            REQUIRE(holdOverride.IsActive(c_Now));
+            REQUIRE(holdOverride.IsActive(c_Now + 7200));
+            REQUIRE(!holdOverride.IsActive(c_Now + 7201));
+
+            REQUIRE(holdOverride.HoldUntil() == c_Now + 7200);
+            REQUIRE(holdOverride.Setpoint() ==
+                    ThermostatSetpoint(ThermostatAction::Heat, 21.5f, 26.0f, 100.0f, -10.0f));
+        }
+
+        THEN("Empty holds clear the hold")
+        {
+            REQUIRE(holdOverride.SubmitUpdate("H1,1,2150,2600,10000,-1000,1600007200") ==
+                    HoldOverride::HoldUpdateResult::Accepted);
+            REQUIRE(holdOverride.AcceptPendingUpdates());
+
+            REQUIRE(holdOverride.SubmitUpdate("") == HoldOverride::HoldUpdateResult::Cleared);
+            REQUIRE(holdOverride.AcceptPendingUpdates());
+
+            REQUIRE(!holdOverride.IsActive(c_Now));
+        }
+
+        THEN("Malformed holds are rejected")
+        {
+            char const* const rgszMalformedHolds[] = {
+                "H2,1,2150,2600,10000,-1000,1600007200",     // Unknown version
+                "H1,1,2150,2600,10000,-1000",                // Missing field
+                "H1,1,2150,2600,10000,-1000,1600007200,1",   // Extra field
+                "H1,1,2150,2600,10000,-1000,1600007200x",    // Trailing characters
+                "H1,1,2150,,10000,-1000,1600007200",         // Empty field
+                "H1,8,2150,2600,10000,-1000,1600007200",     // Unknown actions
+                "H1,1,2150,2600,10000,-1000,0",              // No expiry
+                "H1,1,2150,2600,10000,-1000,99999999999",    // Expiry out of range
+                "1,2150,2600,10000,-1000,1600007200",        // No magic
+            };
+
+            for (char const* const szMalformedHold : rgszMalformedHolds)
+            {
+                REQUIRE(holdOverride.SubmitUpdate(szMalformedHold) == HoldOverride::HoldUpdateResult::Invalid);
+            }
+
+            REQUIRE(!holdOverride.HasPendingUpdates());
+        }
+    }
+
+    GIVEN("A configuration with a hold and a schedule")
+    {
+        ThermostatSetpoint const setpointConfiguredHold(ThermostatAction::Heat, 18.0f, 25.0f, 100.0f, 0.0f);
+        ThermostatSetpoint const setpointScheduled(ThermostatAction::Heat, 19.0f, 25.0f, 100.0f, 0.0f);
+        ThermostatSetpoint const setpointLocalHold(ThermostatAction::Heat, 22.0f, 26.0f, 100.0f, 0.0f);
+
+        SyntheticConfiguration configuration;
+        configuration.AddHoldSetting(c_Now + 3600, setpointConfiguredHold);
+        configuration.AddScheduledSetting(DaysOfWeek::ANY, 0, setpointScheduled);
+        configuration.SetMaximumEarlyStart(60);
+        configuration.Build();
+
+        HoldOverride holdOverride;
+        REQUIRE(holdOverride.SubmitUpdate("H1,1,2200,2600,10000,0,1600007200") ==
+                HoldOverride::HoldUpdateResult::Accepted);
+        REQUIRE(holdOverride.AcceptPendingUpdates());
+
+        ThermostatSetpointScheduler scheduler;
+        scheduler.setHoldOverride(&holdOverride);
+
+        WHEN("The local hold is in effect")
+        {
+            Time.testSetUTCTime(c_Now);
+
+            THEN("It takes precedence over the configuration's settings")
+            {
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration) == setpointLocalHold);
+
+                RecoveryRateEstimator recoveryRateEstimator;
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration, recoveryRateEstimator, 10.0f) ==
+                        setpointLocalHold);
+            }
+
+            THEN("Schedulers without it are unaffected")
+            {
+                ThermostatSetpointScheduler otherScheduler;
+                REQUIRE(otherScheduler.getCurrentThermostatSetpoint(configuration) == setpointConfiguredHold);
+            }
+
+            AND_WHEN("An updated configuration supersedes it")
+            {
+                holdOverride.Clear();
+
+                THEN("The configuration's settings apply again")
+                {
+                    REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration) == setpointConfiguredHold);
+                }
+            }
+        }
+
+        WHEN("The local hold has expired")
+        {
+            Time.testSetUTCTime(c_Now + 7201);
+
+            THEN("The configuration's settings apply again")
+            {
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration) == setpointScheduled);
+            }
+        }
+    }
+
+    GIVEN("A zone")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetThreshold(0.5f);
+        configuration.Build();
+
+        Time.testSetUTCTime(c_Now);
+
+        HoldOverride holdOverride;
+
+        Zone zone;
+        zone.Initialize(configuration, 0, 0, &holdOverride);
+
+        zone.Apply(configuration, 20.0f, 0);
+        REQUIRE(zone.CurrentActions() == ThermostatAction::NONE);
+
+        WHEN("A local hold calls for heat")
+        {
+            REQUIRE(holdOverride.SubmitUpdate("H1,1,2200,2600,10000,0,1600007200") ==
+                    HoldOverride::HoldUpdateResult::Accepted);
+            REQUIRE(holdOverride.AcceptPendingUpdates());
+
+            zone.Apply(configuration, 20.0f, 1000);
+
+            THEN("The zone heats on its very next evaluation")
+            {
+                REQUIRE(zone.CurrentSetpoint().SetPointHeat == 22.0f);
+                REQUIRE(zone.CurrentActions() == ThermostatAction::Heat);
+            }
+        }
+    }
+}
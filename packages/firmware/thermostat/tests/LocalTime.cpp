@@ -0,0 +1,152 @@
+#include "base.h"
+
+namespace
+{
+// US Pacific time in 2020/2021
+uint32_t constexpr c_PDTStart2020 = 1583661600;  // Mar 8 2020 10:00 UTC
+uint32_t constexpr c_PSTStart2020 = 1604221200;  // Nov 1 2020 09:00 UTC
+uint32_t constexpr c_PDTStart2021 = 1615716000;  // Mar 14 2021 10:00 UTC
+
+int16_t constexpr c_PST = 480;
+int16_t constexpr c_PDT = 420;
+
+uint32_t constexpr c_Hour = 60 * 60;
+uint32_t constexpr c_Day = 24 * c_Hour;
+
+// Minutes since the start of the week by way of the C runtime
+uint16_t referenceMinutesSinceStartOfWeek(uint32_t const utcTime, int16_t const utcOffset)
+{
+    std::time_t const localTime = static_cast<std::time_t>(utcTime) - utcOffset * 60;
+    std::tm const* const pCalendarTime = std::gmtime(&localTime);
+
+    return (pCalendarTime->tm_wday * 24 + pCalendarTime->tm_hour) * 60 + pCalendarTime->tm_min;
+}
+}  // namespace
+
+SCENARIO("Local time is computed arithmetically", "[LocalTime]")
+{
+    EEPROM.testErase();
+
+    GIVEN("Fixed UTC offsets")
+    {
+        THEN("Minutes since the start of the week match the C runtime's")
+        {
+            int16_t const rgUTCOffsets[] = {0, c_PST, c_PDT, -60, -330, 720, -840};
+
+            for (int16_t const utcOffset : rgUTCOffsets)
+            {
+                SyntheticConfiguration configuration;
+                configuration.SetTimezone(utcOffset, utcOffset, 0);
+                configuration.Build();
+
+                for (uint32_t utcTime = 3 * c_Day; utcTime < 2000000000; utcTime += 7919 * 60 + 13)
+                {
+                    REQUIRE(LocalTime::GetMinutesSinceStartOfWeek(configuration, utcTime) ==
+                            referenceMinutesSinceStartOfWeek(utcTime, utcOffset));
+                }
+            }
+        }
+
+        THEN("Local times before the epoch wrap into the previous week")
+        {
+            SyntheticConfiguration configuration;
+            configuration.SetTimezone(c_PST, c_PST, 0);
+            configuration.Build();
+
+            // Wednesday Dec 31 1969, 16:00
+            REQUIRE(LocalTime::GetMinutesSinceStartOfWeek(configuration, 0) == (3 * 24 + 16) * 60);
+        }
+    }
+
+    GIVEN("A configuration with a single upcoming offset change")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetTimezone(c_PST, c_PDT, c_PDTStart2020);
+        configuration.Build();
+
+        THEN("The change is applied")
+        {
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PDTStart2020 - 1) == c_PST);
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PDTStart2020) == c_PDT);
+        }
+
+        THEN("Later changes are missed while offline")
+        {
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PSTStart2020 + c_Day) == c_PDT);
+        }
+    }
+
+    GIVEN("A configuration with a table of upcoming offset changes")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetTimezone(c_PST, c_PDT, c_PDTStart2020);
+        configuration.AddTimezoneTransition(c_PDTStart2020, c_PDT);
+        configuration.AddTimezoneTransition(c_PSTStart2020, c_PST);
+        configuration.AddTimezoneTransition(c_PDTStart2021, c_PDT);
+        configuration.Build();
+
+        THEN("Each change is applied in turn")
+        {
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PDTStart2020 - 1) == c_PST);
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PDTStart2020) == c_PDT);
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PSTStart2020 - 1) == c_PDT);
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PSTStart2020) == c_PST);
+            REQUIRE(LocalTime::GetUTCOffset(configuration, c_PDTStart2021 + 30 * c_Day) == c_PDT);
+        }
+
+        WHEN("A schedule is evaluated after going offline in the summer")
+        {
+            ThermostatSetpoint const setpointNight(ThermostatAction::Heat, 16.0f, 30.0f, 100, 0);
+            ThermostatSetpoint const setpointMorning(ThermostatAction::Heat, 21.0f, 30.0f, 100, 0);
+
+            SyntheticConfiguration scheduledConfiguration;
+            scheduledConfiguration.SetTimezone(c_PDT, c_PST, c_PSTStart2020);
+            scheduledConfiguration.AddTimezoneTransition(c_PSTStart2020, c_PST);
+            scheduledConfiguration.AddTimezoneTransition(c_PDTStart2021, c_PDT);
+            scheduledConfiguration.AddScheduledSetting(DaysOfWeek::Sunday, 0, setpointNight);
+            scheduledConfiguration.AddScheduledSetting(DaysOfWeek::Monday, 7 * 60, setpointMorning);
+            scheduledConfiguration.Build();
+
+            ThermostatSetpointScheduler scheduler;
+
+            // Monday Nov 2 2020, 07:00 PST
+            uint32_t const mondayMorning = c_PSTStart2020 + c_Day + 6 * c_Hour;
+
+            THEN("Settings follow local time through the fall change")
+            {
+                Time.testSetUTCTime(mondayMorning - 60);
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(scheduledConfiguration) == setpointNight);
+
+                Time.testSetUTCTime(mondayMorning);
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(scheduledConfiguration) == setpointMorning);
+            }
+
+            THEN("Settings follow local time through the spring change")
+            {
+                // Monday Mar 15 2021, 07:00 PDT
+                uint32_t const springMondayMorning = c_PDTStart2021 + c_Day + 4 * c_Hour;
+
+                Time.testSetUTCTime(springMondayMorning - 60);
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(scheduledConfiguration) == setpointNight);
+
+                Time.testSetUTCTime(springMondayMorning);
+                REQUIRE(scheduler.getCurrentThermostatSetpoint(scheduledConfiguration) == setpointMorning);
+            }
+        }
+    }
+
+    GIVEN("More offset changes than the firmware supports")
+    {
+        SyntheticConfiguration configuration;
+
+        for (uint32_t idxTransition = 0; idxTransition <= Configuration::sc_cTimezoneTransitions_Max; ++idxTransition)
+        {
+            configuration.AddTimezoneTransition(c_PDTStart2020 + idxTransition * c_Day, c_PDT);
+        }
+
+        THEN("The configuration is rejected")
+        {
+            REQUIRE(!configuration.TryBuild());
+        }
+    }
+}
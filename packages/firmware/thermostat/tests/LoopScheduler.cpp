@@ -0,0 +1,109 @@
+#include "base.h"
+
+SCENARIO("Loop scheduler decouples control from acquisition", "[LoopScheduler]")
+{
+    unsigned long constexpr acquisitionInterval_msec = 600 * 1000;
+    unsigned long constexpr controlInterval_msec = LoopScheduler::sc_ControlInterval_msec;
+
+    GIVEN("A fresh loop scheduler")
+    {
+        LoopScheduler loopScheduler;
+
+        REQUIRE(loopScheduler.TimeUntilNextTask_msec(5000, acquisitionInterval_msec) == 0);
+
+        WHEN("It's first consulted")
+        {
+            LoopScheduler::DueTasks const dueTasks = loopScheduler.GetDueTasks(5000, acquisitionInterval_msec, false);
+
+            THEN("Acquisition and control are both due")
+            {
+                REQUIRE(dueTasks.fAcquire);
+                REQUIRE(dueTasks.fControl);
+
+                REQUIRE(loopScheduler.TimeUntilNextTask_msec(5000, acquisitionInterval_msec) == controlInterval_msec);
+            }
+
+            AND_WHEN("The control interval elapses")
+            {
+                LoopScheduler::DueTasks const nextDueTasks =
+                    loopScheduler.GetDueTasks(5000 + controlInterval_msec, acquisitionInterval_msec, false);
+
+                THEN("Only control is due")
+                {
+                    REQUIRE(!nextDueTasks.fAcquire);
+                    REQUIRE(nextDueTasks.fControl);
+                }
+            }
+
+            AND_WHEN("The configuration changes before the control interval elapses")
+            {
+                LoopScheduler::DueTasks const nextDueTasks =
+                    loopScheduler.GetDueTasks(6000, acquisitionInterval_msec, true);
+
+                THEN("Control is due right away")
+                {
+                    REQUIRE(!nextDueTasks.fAcquire);
+                    REQUIRE(nextDueTasks.fControl);
+
+                    // ...and the control interval restarts
+                    REQUIRE(loopScheduler.TimeUntilNextTask_msec(6000, acquisitionInterval_msec) ==
+                            controlInterval_msec);
+                }
+            }
+
+            AND_WHEN("Nothing has changed before the control interval elapses")
+            {
+                LoopScheduler::DueTasks const nextDueTasks =
+                    loopScheduler.GetDueTasks(6000, acquisitionInterval_msec, false);
+
+                THEN("Nothing is due")
+                {
+                    REQUIRE(!nextDueTasks.fAcquire);
+                    REQUIRE(!nextDueTasks.fControl);
+                }
+            }
+
+            AND_WHEN("Control is run every interval until acquisition is due")
+            {
+                unsigned long currentTime_msec = 5000;
+                uint32_t cAcquisitions = 0;
+                uint32_t cControls = 0;
+
+                while (currentTime_msec < 5000 + acquisitionInterval_msec)
+                {
+                    currentTime_msec +=
+                        loopScheduler.TimeUntilNextTask_msec(currentTime_msec, acquisitionInterval_msec);
+
+                    LoopScheduler::DueTasks const nextDueTasks =
+                        loopScheduler.GetDueTasks(currentTime_msec, acquisitionInterval_msec, false);
+
+                    cAcquisitions += nextDueTasks.fAcquire ? 1 : 0;
+                    cControls += nextDueTasks.fControl ? 1 : 0;
+                }
+
+                THEN("Control ran at its own interval and acquisition ran at the cadence")
+                {
+                    REQUIRE(cControls == acquisitionInterval_msec / controlInterval_msec);
+                    REQUIRE(cAcquisitions == 1);
+                }
+            }
+        }
+    }
+
+    GIVEN("A loop scheduler consulted just before millis() rolls over")
+    {
+        LoopScheduler loopScheduler;
+
+        unsigned long const startTime_msec = static_cast<unsigned long>(-1000);
+        loopScheduler.GetDueTasks(startTime_msec, acquisitionInterval_msec, false);
+
+        THEN("Intervals are measured across the rollover")
+        {
+            REQUIRE(loopScheduler.TimeUntilNextTask_msec(startTime_msec + 5000, acquisitionInterval_msec) ==
+                    controlInterval_msec - 5000);
+
+            REQUIRE(loopScheduler.GetDueTasks(startTime_msec + controlInterval_msec, acquisitionInterval_msec, false)
+                        .fControl);
+        }
+    }
+}
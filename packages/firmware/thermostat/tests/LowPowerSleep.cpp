@@ -0,0 +1,231 @@
+#include "base.h"
+
+namespace
+{
+struct SimulationResults
+{
+    uint32_t cAcquisitions;
+    uint32_t cControlPasses;
+    unsigned long MaximumLateness_msec;  // Of any task past its due time
+    Costs Incurred;
+    unsigned long Elapsed_msec;
+
+    float EstimateCharge_mAh(LowPowerSleep::PowerModel const& powerModel) const
+    {
+        unsigned long const sleep_msec = static_cast<unsigned long>(Incurred.Sleep_msec);
+        unsigned long const networkStandby_msec = static_cast<unsigned long>(Incurred.NetworkStandbySleep_msec);
+
+        return powerModel.EstimateCharge_mAh(Elapsed_msec - sleep_msec,
+                                             networkStandby_msec,
+                                             sleep_msec - networkStandby_msec,
+                                             static_cast<unsigned long>(Incurred.NetworkOffSleeps));
+    }
+};
+
+// Runs the main loop's schedule (c.f. Main.cpp#loop()) on the virtual clock, with each pass keeping the device busy
+// for a while, and idling in between tasks either like Main.cpp does by default or in low-power sleep
+SimulationResults simulate(unsigned long const acquisitionInterval_msec,
+                           unsigned long const duration_msec,
+                           bool const fLowPowerSleep,
+                           bool const fIsConnected)
+{
+    unsigned long constexpr c_AcquisitionPass_msec = 1500;  // Acquisition handoff, processing, control, and publish
+    unsigned long constexpr c_ControlPass_msec = 50;
+    unsigned long constexpr c_MaximumPollingDelay_msec = 250;
+    unsigned long constexpr c_MaximumSleep_msec = 25 * 1000;
+
+    Time.testSetMillis(1000);
+
+    LoopScheduler loopScheduler;
+    LowPowerSleep lowPowerSleep(D6);
+    CostAccounting costAccounting;
+
+    SimulationResults results = SimulationResults();
+    unsigned long const startTime_msec = millis();
+
+    while ((millis() - startTime_msec) < duration_msec)
+    {
+        LoopScheduler::DueTasks const dueTasks = loopScheduler.GetDueTasks(millis(), acquisitionInterval_msec, false);
+
+        if (dueTasks.fAcquire)
+        {
+            ++results.cAcquisitions;
+            delay(c_AcquisitionPass_msec);
+        }
+        else if (dueTasks.fControl)
+        {
+            ++results.cControlPasses;
+            delay(c_ControlPass_msec);
+        }
+
+        unsigned long const dueTime_msec =
+            millis() + loopScheduler.TimeUntilNextTask_msec(millis(), acquisitionInterval_msec);
+
+        while (true)
+        {
+            unsigned long const remainingTotalDelay_msec =
+                loopScheduler.TimeUntilNextTask_msec(millis(), acquisitionInterval_msec);
+
+            if (remainingTotalDelay_msec == 0)
+            {
+                break;
+            }
+
+            if (fLowPowerSleep && lowPowerSleep.Sleep(remainingTotalDelay_msec, c_MaximumSleep_msec, fIsConnected))
+            {
+                continue;
+            }
+
+            delay(std::min(remainingTotalDelay_msec, c_MaximumPollingDelay_msec));
+        }
+
+        results.MaximumLateness_msec = std::max(results.MaximumLateness_msec, millis() - dueTime_msec);
+    }
+
+    results.Incurred = costAccounting.Elapsed();
+    results.Elapsed_msec = millis() - startTime_msec;
+
+    return results;
+}
+}  // namespace
+
+SCENARIO("Low-power sleep plans sleeps around the next task", "[LowPowerSleep]")
+{
+    unsigned long const wakeMargin_msec = LowPowerSleep::sc_WakeMargin_msec;
+    unsigned long const maximumSleep_msec = 25 * 1000;
+
+    LowPowerSleep lowPowerSleep(D6);
+
+    GIVEN("Waits too short to be worth sleeping through")
+    {
+        THEN("It doesn't sleep")
+        {
+            REQUIRE(lowPowerSleep.GetPlan(0, maximumSleep_msec, true).Duration_sec == 0);
+            REQUIRE(lowPowerSleep.GetPlan(wakeMargin_msec, maximumSleep_msec, true).Duration_sec == 0);
+            REQUIRE(lowPowerSleep.GetPlan(wakeMargin_msec + 999, maximumSleep_msec, true).Duration_sec == 0);
+
+            REQUIRE(!lowPowerSleep.Sleep(wakeMargin_msec + 999, maximumSleep_msec, true));
+            REQUIRE(lowPowerSleep.SleepCount() == 0);
+        }
+    }
+
+    GIVEN("Longer waits")
+    {
+        THEN("It sleeps in whole seconds, waking ahead of the next task")
+        {
+            REQUIRE(lowPowerSleep.GetPlan(wakeMargin_msec + 1000, maximumSleep_msec, true).Duration_sec == 1);
+            REQUIRE(lowPowerSleep.GetPlan(5400, maximumSleep_msec, true).Duration_sec == 5);
+            REQUIRE(lowPowerSleep.GetPlan(6000, maximumSleep_msec, true).Duration_sec == 5);
+        }
+
+        THEN("It sleeps no longer than the maximum")
+        {
+            REQUIRE(lowPowerSleep.GetPlan(10 * 60 * 1000, maximumSleep_msec, true).Duration_sec == 25);
+        }
+
+        THEN("It keeps the network in standby for short sleeps only")
+        {
+            // (Standby at 15 mA breaks even with stop at 1 mA plus a 300 mAs reconnect after 21.4 sec)
+            unsigned long const noMaximum_msec = 60 * 1000;
+
+            LowPowerSleep::Plan const shortPlan =
+                lowPowerSleep.GetPlan(21 * 1000 + wakeMargin_msec, noMaximum_msec, true);
+            REQUIRE(shortPlan.Duration_sec == 21);
+            REQUIRE(shortPlan.fKeepNetwork);
+
+            LowPowerSleep::Plan const longPlan =
+                lowPowerSleep.GetPlan(22 * 1000 + wakeMargin_msec, noMaximum_msec, true);
+            REQUIRE(longPlan.Duration_sec == 22);
+            REQUIRE(!longPlan.fKeepNetwork);
+        }
+
+        THEN("It turns the network off while not connected")
+        {
+            REQUIRE(!lowPowerSleep.GetPlan(5000, maximumSleep_msec, false).fKeepNetwork);
+        }
+
+        THEN("Sleeping advances the clock by the planned duration")
+        {
+            Time.testSetMillis(1000);
+
+            REQUIRE(lowPowerSleep.Sleep(5400, maximumSleep_msec, true));
+            REQUIRE(Time.testGetMillis() == 6000);
+            REQUIRE(lowPowerSleep.SleepCount() == 1);
+            REQUIRE(!lowPowerSleep.IsDisabled());
+        }
+    }
+
+    GIVEN("A clock that doesn't advance while sleeping")
+    {
+        System.testSetSleepAdvancesClock(false);
+
+        REQUIRE(lowPowerSleep.Sleep(5400, maximumSleep_msec, true));
+
+        System.testSetSleepAdvancesClock(true);
+
+        THEN("Sleep is disabled")
+        {
+            REQUIRE(lowPowerSleep.IsDisabled());
+            REQUIRE(lowPowerSleep.GetPlan(5400, maximumSleep_msec, true).Duration_sec == 0);
+            REQUIRE(!lowPowerSleep.Sleep(5400, maximumSleep_msec, true));
+        }
+    }
+}
+
+SCENARIO("Low-power sleep meets deadlines at a fraction of the charge", "[LowPowerSleep]")
+{
+    unsigned long const controlInterval_msec = LoopScheduler::sc_ControlInterval_msec;
+    unsigned long const duration_msec = 6 * 60 * 60 * 1000;
+
+    LowPowerSleep::PowerModel const powerModel = LowPowerSleep::PowerModel::Photon();
+
+    GIVEN("Typical cadences on a connected device")
+    {
+        uint16_t const rgCadences_sec[] = {60, 300, 600};
+
+        THEN("Tasks run on the same schedule, none of them late, at well under half the charge")
+        {
+            for (uint16_t const cadence_sec : rgCadences_sec)
+            {
+                unsigned long const acquisitionInterval_msec = cadence_sec * 1000UL;
+                unsigned long const cControlPassesPerCycle = acquisitionInterval_msec / controlInterval_msec - 1;
+
+                SimulationResults const alwaysOn = simulate(acquisitionInterval_msec, duration_msec, false, true);
+                SimulationResults const lowPower = simulate(acquisitionInterval_msec, duration_msec, true, true);
+
+                float const alwaysOnCharge_mAh = alwaysOn.EstimateCharge_mAh(powerModel) / alwaysOn.cAcquisitions;
+                float const lowPowerCharge_mAh = lowPower.EstimateCharge_mAh(powerModel) / lowPower.cAcquisitions;
+
+                CAPTURE(cadence_sec, alwaysOnCharge_mAh, lowPowerCharge_mAh, lowPower.Incurred.Sleeps);
+
+                REQUIRE(lowPower.cAcquisitions == alwaysOn.cAcquisitions);
+                REQUIRE(lowPower.cControlPasses == alwaysOn.cControlPasses);
+                REQUIRE(lowPower.cAcquisitions >= duration_msec / acquisitionInterval_msec);
+                REQUIRE(lowPower.cControlPasses >= lowPower.cAcquisitions * cControlPassesPerCycle);
+
+                REQUIRE(alwaysOn.MaximumLateness_msec == 0);
+                REQUIRE(lowPower.MaximumLateness_msec == 0);
+
+                // (Waiting on control passes, sleeps are always short enough to keep the network in standby)
+                REQUIRE(alwaysOn.Incurred.Sleeps == 0);
+                REQUIRE(lowPower.Incurred.Sleeps > 0);
+                REQUIRE(lowPower.Incurred.NetworkOffSleeps == 0);
+
+                REQUIRE(lowPowerCharge_mAh < alwaysOnCharge_mAh / 2);
+            }
+        }
+    }
+
+    GIVEN("A device that isn't connected")
+    {
+        SimulationResults const lowPower = simulate(300 * 1000UL, duration_msec, true, false);
+
+        THEN("Sleeps turn the network off, still meeting deadlines")
+        {
+            REQUIRE(lowPower.Incurred.Sleeps > 0);
+            REQUIRE(lowPower.Incurred.NetworkOffSleeps == lowPower.Incurred.Sleeps);
+            REQUIRE(lowPower.Incurred.NetworkStandbySleep_msec == 0);
+            REQUIRE(lowPower.MaximumLateness_msec == 0);
+        }
+    }
+}
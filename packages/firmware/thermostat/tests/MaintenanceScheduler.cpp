@@ -0,0 +1,222 @@
+#include "base.h"
+
+SCENARIO("Flash maintenance runs in idle windows", "[MaintenanceScheduler]")
+{
+    EEPROM.testErase();
+    Time.testSetMillis(0);
+
+    unsigned long const initialBudget_msec = MaintenanceScheduler::sc_EraseDuration_Initial_msec;
+    unsigned long const margin_msec = MaintenanceScheduler::sc_Margin_msec;
+
+    Configuration configuration;
+    configuration.Initialize();
+
+    MaintenanceScheduler maintenanceScheduler;
+
+    GIVEN("A pending erase")
+    {
+        EEPROM.testSetPendingErase(120);
+
+        WHEN("The next task is due too soon")
+        {
+            bool const fPerformedMaintenance =
+                maintenanceScheduler.RunIdleTasks(configuration, initialBudget_msec + margin_msec - 1);
+
+            THEN("The erase is deferred")
+            {
+                REQUIRE(!fPerformedMaintenance);
+                REQUIRE(EEPROM.hasPendingErase());
+                REQUIRE(millis() == 0);
+            }
+        }
+
+        WHEN("There's enough time")
+        {
+            bool const fPerformedMaintenance = maintenanceScheduler.RunIdleTasks(configuration, 2000);
+
+            THEN("The erase is performed and measured")
+            {
+                REQUIRE(fPerformedMaintenance);
+                REQUIRE(!EEPROM.hasPendingErase());
+
+                REQUIRE(maintenanceScheduler.EraseCount() == 1);
+                REQUIRE(maintenanceScheduler.LastEraseDuration_msec() == 120);
+                REQUIRE(maintenanceScheduler.MaxEraseDuration_msec() == 120);
+            }
+
+            THEN("Later erases are budgeted off the measured duration")
+            {
+                unsigned long const budget_msec = maintenanceScheduler.EraseDurationBudget_msec();
+
+                REQUIRE(budget_msec < initialBudget_msec);
+                REQUIRE(budget_msec >= 120);
+
+                // Repeated short erases bring the budget down to their duration
+                for (int idxErase = 0; idxErase < 50; ++idxErase)
+                {
+                    EEPROM.testSetPendingErase(120);
+                    REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 2000));
+                }
+
+                REQUIRE(maintenanceScheduler.EraseDurationBudget_msec() == 120);
+
+                EEPROM.testSetPendingErase(120);
+                REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 120 + margin_msec));
+            }
+
+            AND_WHEN("An erase takes longer")
+            {
+                EEPROM.testSetPendingErase(700);
+                REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 2000));
+
+                THEN("It's budgeted for")
+                {
+                    REQUIRE(maintenanceScheduler.EraseDurationBudget_msec() == 700);
+                    REQUIRE(maintenanceScheduler.MaxEraseDuration_msec() == 700);
+
+                    EEPROM.testSetPendingErase(120);
+                    REQUIRE(!maintenanceScheduler.RunIdleTasks(configuration, 700));
+                }
+            }
+        }
+    }
+
+    GIVEN("An accepted configuration")
+    {
+        SyntheticConfiguration syntheticConfiguration;
+        syntheticConfiguration.SetThreshold(0.75f);
+        syntheticConfiguration.Build();
+
+        std::string const& encodedConfiguration = syntheticConfiguration.EncodedConfiguration();
+
+        REQUIRE(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+                Configuration::ConfigUpdateResult::Accepted);
+        REQUIRE(configuration.AcceptPendingUpdates());
+
+        THEN("It takes effect before it's written out")
+        {
+            REQUIRE(configuration.rootConfiguration().threshold_x100() == 75);
+            REQUIRE(configuration.HasUnsavedData());
+
+            Configuration reloadedConfiguration;
+            reloadedConfiguration.Initialize();
+
+            REQUIRE(reloadedConfiguration.Hash() != configuration.Hash());
+        }
+
+        WHEN("The next task is due too soon")
+        {
+            bool const fPerformedMaintenance =
+                maintenanceScheduler.RunIdleTasks(configuration, initialBudget_msec + margin_msec - 1);
+
+            THEN("It isn't written out yet")
+            {
+                REQUIRE(!fPerformedMaintenance);
+                REQUIRE(configuration.HasUnsavedData());
+            }
+        }
+
+        WHEN("There's enough time")
+        {
+            REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 2000));
+
+            THEN("It's written out")
+            {
+                REQUIRE(!configuration.HasUnsavedData());
+
+                Configuration reloadedConfiguration;
+                reloadedConfiguration.Initialize();
+
+                REQUIRE(reloadedConfiguration.Hash() == configuration.Hash());
+            }
+
+            THEN("There's nothing left to do")
+            {
+                REQUIRE(!maintenanceScheduler.RunIdleTasks(configuration, 2000));
+            }
+        }
+
+        WHEN("An erase is pending too")
+        {
+            EEPROM.testSetPendingErase(400);
+
+            AND_WHEN("There's only enough time for one of them")
+            {
+                REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 800));
+
+                THEN("The erase goes first")
+                {
+                    REQUIRE(!EEPROM.hasPendingErase());
+                    REQUIRE(configuration.HasUnsavedData());
+                }
+            }
+
+            AND_WHEN("There's enough time for both")
+            {
+                REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, 2000));
+
+                THEN("Both are done")
+                {
+                    REQUIRE(!EEPROM.hasPendingErase());
+                    REQUIRE(!configuration.HasUnsavedData());
+                }
+            }
+        }
+    }
+
+    GIVEN("A zone that has learned a recovery rate")
+    {
+        Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+
+        SyntheticConfiguration zoneConfiguration;
+        zoneConfiguration.AddScheduledSetting(
+            DaysOfWeek::ANY, 0, ThermostatSetpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0));
+        zoneConfiguration.Build();
+
+        Zone rgZones[1];
+        rgZones[0].Initialize(zoneConfiguration, 0, 0);
+
+        // Heat for an hour
+        rgZones[0].Apply(zoneConfiguration, 16.0f, 0);
+        rgZones[0].Apply(zoneConfiguration, 22.0f, 60 * 60 * 1000);
+
+        REQUIRE(rgZones[0].CurrentActions() == ThermostatAction::NONE);
+
+        THEN("The rate isn't written out on the control path")
+        {
+            REQUIRE(rgZones[0].HasUnsavedData());
+
+            RecoveryRateEstimator reloadedEstimator;
+            reloadedEstimator.Initialize(0);
+
+            REQUIRE(reloadedEstimator.HeatingRate() == 0.0f);
+        }
+
+        WHEN("The next task is due too soon")
+        {
+            bool const fPerformedMaintenance = maintenanceScheduler.RunIdleTasks(
+                configuration, rgZones, countof(rgZones), initialBudget_msec + margin_msec - 1);
+
+            THEN("It isn't written out yet")
+            {
+                REQUIRE(!fPerformedMaintenance);
+                REQUIRE(rgZones[0].HasUnsavedData());
+            }
+        }
+
+        WHEN("There's enough time")
+        {
+            REQUIRE(maintenanceScheduler.RunIdleTasks(configuration, rgZones, countof(rgZones), 2000));
+
+            THEN("It's written out")
+            {
+                REQUIRE(!rgZones[0].HasUnsavedData());
+
+                RecoveryRateEstimator reloadedEstimator;
+                reloadedEstimator.Initialize(0);
+
+                REQUIRE(reloadedEstimator.HeatingRate() == Approx(6.0f));
+            }
+        }
+    }
+}
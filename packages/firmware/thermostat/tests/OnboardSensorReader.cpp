@@ -0,0 +1,190 @@
+#include "base.h"
+
+namespace
+{
+// Stands in for PietteTech_DHT: acquisitions complete (or fail) a set time after being started
+class FakeDHT
+{
+public:
+    FakeDHT()
+        : Response_msec(6)
+        , fResponds(true)
+        , Temperature(21.5f)
+        , Humidity(40.0f)
+        , cAcquisitions(0)
+        , cAborts(0)
+        , m_fIsAcquiring(false)
+        , m_StartTime_msec(0)
+        , m_Status(DHTLIB_ERROR_NOTSTARTED)
+    {
+    }
+
+    int acquire()
+    {
+        if (acquiring())
+        {
+            return DHTLIB_ERROR_ACQUIRING;
+        }
+
+        ++cAcquisitions;
+        m_fIsAcquiring = true;
+        m_StartTime_msec = millis();
+
+        return DHTLIB_ACQUIRING;
+    }
+
+    bool acquiring()
+    {
+        if (m_fIsAcquiring && fResponds && (millis() - m_StartTime_msec) >= Response_msec)
+        {
+            m_fIsAcquiring = false;
+            m_Status = DHTLIB_OK;
+        }
+
+        return m_fIsAcquiring;
+    }
+
+    void abort()
+    {
+        ++cAborts;
+        m_fIsAcquiring = false;
+        m_Status = DHTLIB_ERROR_RESPONSE_TIMEOUT;
+    }
+
+    int getStatus()
+    {
+        acquiring();
+        return m_Status;
+    }
+
+    float getCelsius()
+    {
+        return Temperature;
+    }
+
+    float getHumidity()
+    {
+        return Humidity;
+    }
+
+public:
+    unsigned long Response_msec;
+    bool fResponds;
+    float Temperature;
+    float Humidity;
+
+    int cAcquisitions;
+    int cAborts;
+
+private:
+    bool m_fIsAcquiring;
+    unsigned long m_StartTime_msec;
+    int m_Status;
+};
+
+unsigned long constexpr c_MaximumAge_msec = 3 * 10 * 1000;
+unsigned long constexpr c_Conversion_msec = 1000;  // Stand-in for the 1-Wire temperature conversion
+}  // namespace
+
+SCENARIO("Onboard sensor acquisition overlaps other work", "[OnboardSensorReader]")
+{
+    FakeDHT sensor;
+    OnboardSensorReader<FakeDHT> reader(sensor);
+
+    GIVEN("A responsive sensor")
+    {
+        REQUIRE(reader.Start(millis()));
+
+        THEN("Work in between start and harvest hides the acquisition time")
+        {
+            delay(c_Conversion_msec);
+
+            CostAccounting costAccounting;
+            REQUIRE(reader.Harvest());
+            REQUIRE(costAccounting.Elapsed().Delay_msec() == 0);
+
+            OnboardSensorReader<FakeDHT>::Reading const reading = reader.GetReading(millis(), c_MaximumAge_msec);
+            REQUIRE(reading.Temperature == 21.5f);
+            REQUIRE(reading.Humidity == 40.0f);
+        }
+
+        THEN("Harvesting right away waits for the acquisition to complete")
+        {
+            CostAccounting costAccounting;
+            REQUIRE(reader.Harvest());
+            REQUIRE(costAccounting.Elapsed().Delay_msec() <= sensor.Response_msec);
+        }
+
+        THEN("Another acquisition isn't started within the sensor's minimum interval")
+        {
+            reader.Harvest();
+
+            delay(OnboardSensorReader<FakeDHT>::sc_MinimumInterval_msec / 2);
+            REQUIRE(!reader.Start(millis()));
+            REQUIRE(!reader.Harvest());
+            REQUIRE(sensor.cAcquisitions == 1);
+
+            delay(OnboardSensorReader<FakeDHT>::sc_MinimumInterval_msec / 2);
+            REQUIRE(reader.Start(millis()));
+            REQUIRE(sensor.cAcquisitions == 2);
+        }
+    }
+
+    GIVEN("A sensor that stops responding after a good reading")
+    {
+        REQUIRE(reader.Start(millis()));
+        REQUIRE(reader.Harvest());
+
+        unsigned long const goodReadingTime_msec = millis();
+
+        sensor.fResponds = false;
+        sensor.Temperature = NAN;
+
+        delay(10 * 1000);
+        REQUIRE(reader.Start(millis()));
+
+        THEN("The acquisition is aborted after a bounded wait")
+        {
+            unsigned long const acquisitionTimeout_msec = OnboardSensorReader<FakeDHT>::sc_AcquisitionTimeout_msec;
+
+            CostAccounting costAccounting;
+            REQUIRE(!reader.Harvest());
+            REQUIRE(costAccounting.Elapsed().Delay_msec() <= acquisitionTimeout_msec);
+
+            REQUIRE(sensor.cAborts == 1);
+            REQUIRE(reader.LastStatus() == DHTLIB_ERROR_RESPONSE_TIMEOUT);
+        }
+
+        THEN("The last good reading is used along with its age")
+        {
+            reader.Harvest();
+
+            OnboardSensorReader<FakeDHT>::Reading const reading = reader.GetReading(millis(), c_MaximumAge_msec);
+            REQUIRE(reading.Temperature == 21.5f);
+            REQUIRE(reading.Age_msec >= millis() - goodReadingTime_msec);
+        }
+
+        THEN("The last good reading expires")
+        {
+            reader.Harvest();
+            delay(c_MaximumAge_msec);
+
+            OnboardSensorReader<FakeDHT>::Reading const reading = reader.GetReading(millis(), c_MaximumAge_msec);
+            REQUIRE(std::isnan(reading.Temperature));
+            REQUIRE(std::isnan(reading.Humidity));
+        }
+    }
+
+    GIVEN("A sensor that has never responded")
+    {
+        sensor.fResponds = false;
+
+        REQUIRE(reader.Start(millis()));
+        REQUIRE(!reader.Harvest());
+
+        THEN("No reading is reported")
+        {
+            REQUIRE(std::isnan(reader.GetReading(millis(), c_MaximumAge_msec).Temperature));
+        }
+    }
+}
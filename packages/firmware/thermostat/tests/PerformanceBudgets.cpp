@@ -0,0 +1,281 @@
+#include "base.h"
+
+//
+// Performance budgets for hot paths, asserted against the mocks' cost accounting (c.f. CostAccounting.h).
+// Budgets are set a little above current costs so regressions fail here rather than show up in the field;
+// tighten them as the code gets faster.
+//
+
+SCENARIO("1-Wire acquisition stays within its I2C and delay budget", "[PerformanceBudgets]")
+{
+    GIVEN("Eight DS18B20 sensors behind the DS2484 gateway")
+    {
+        SimulatedOneWireBus bus;
+        Wire.testAttachDevice(SimulatedOneWireBus::sc_GatewayAddress, &bus);
+
+        OneWireAddress rgExpectedAddresses[8];
+        float rgExpectedTemperatures[countof(rgExpectedAddresses)];
+
+        for (size_t idxSensor = 0; idxSensor < countof(rgExpectedAddresses); ++idxSensor)
+        {
+            rgExpectedTemperatures[idxSensor] = 18.0f + idxSensor * 0.5f;
+            rgExpectedAddresses[idxSensor] =
+                bus.AddSensor(0x123456789A00ull + idxSensor * 0x010203ull, rgExpectedTemperatures[idxSensor]);
+        }
+
+        OneWireGateway2484 gateway;
+        REQUIRE(gateway.Initialize());
+
+        WHEN("A full acquisition is performed")
+        {
+            CostAccounting costAccounting;
+
+            OneWireAddress rgAddresses[16];
+            float rgTemperatures[countof(rgAddresses)];
+            size_t cAddresses = 0;
+
+            REQUIRE(gateway.EnumerateDevices([&](OneWireAddress const& address) {
+                if (cAddresses < countof(rgAddresses))
+                {
+                    rgAddresses[cAddresses++] = address;
+                }
+            }));
+
+            Costs const enumerationCosts = costAccounting.Elapsed();
+
+            REQUIRE(OneWireTemperatureSensor::RequestMeasurement(gateway));
+
+            for (size_t idxAddress = 0; idxAddress < cAddresses; ++idxAddress)
+            {
+                rgTemperatures[idxAddress] = NAN;
+                REQUIRE(OneWireTemperatureSensor::RetrieveMeasurement(
+                    rgTemperatures[idxAddress], rgAddresses[idxAddress], gateway));
+            }
+
+            Costs const acquisitionCosts = costAccounting.Elapsed();
+            costAccounting.Print("1-Wire acquisition of 8 sensors");
+
+            THEN("All sensors are found and read")
+            {
+                REQUIRE(cAddresses == countof(rgExpectedAddresses));
+
+                for (size_t idxSensor = 0; idxSensor < countof(rgExpectedAddresses); ++idxSensor)
+                {
+                    size_t idxAddress = 0;
+
+                    while (idxAddress < cAddresses && rgAddresses[idxAddress] != rgExpectedAddresses[idxSensor])
+                    {
+                        ++idxAddress;
+                    }
+
+                    REQUIRE(idxAddress < cAddresses);
+                    REQUIRE(rgTemperatures[idxAddress] == rgExpectedTemperatures[idxSensor]);
+                }
+            }
+
+            THEN("It stays within budget")
+            {
+                // Currently ~200 transactions per sensor to enumerate, ~290 in total
+                REQUIRE(enumerationCosts.I2CTransactions <= 220 * cAddresses);
+                REQUIRE(acquisitionCosts.I2CTransactions <= 320 * cAddresses);
+                REQUIRE(acquisitionCosts.Delay_msec() <= 1000);  // one bus-wide conversion
+                REQUIRE(acquisitionCosts.SerialBytes == 0);
+            }
+        }
+
+        Wire.testAttachDevice(SimulatedOneWireBus::sc_GatewayAddress, nullptr);
+    }
+}
+
+SCENARIO("Publishing stays within its budget", "[PerformanceBudgets]")
+{
+    uint8_t constexpr cOneWireDevices_Max = 16;
+
+    SyntheticConfiguration configuration;
+    configuration.Build();
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+    StatusAggregator<cOneWireDevices_Max> aggregator;
+    SensorSnapshot<cOneWireDevices_Max> snapshot;
+    snapshot.OnboardTemperature = 20.5f;
+    snapshot.OnboardHumidity = 40.0f;
+    snapshot.OperableTemperature = 20.5f;
+
+    SensorRegistry<cOneWireDevices_Max> sensorRegistry;
+    sensorRegistry.Update(snapshot);
+
+    aggregator.AddSample(0, ThermostatAction::Heat, snapshot, sensorRegistry);
+
+    SensorFusion<cOneWireDevices_Max> sensorFusion;
+    Zone rgZones[1];
+
+    StatusPublisher<cOneWireDevices_Max> statusPublisher;
+
+    GIVEN("A connected device")
+    {
+        CostAccounting costAccounting;
+
+        statusPublisher.Publish(configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1);
+
+        Costs const costs = costAccounting.Elapsed();
+        costAccounting.Print("Publish while connected");
+
+        THEN("A status update costs one publish, no delay, and no serial output")
+        {
+            REQUIRE(costs.Publishes == 1);
+            REQUIRE(costs.PublishedBytes <= 200);
+            REQUIRE(costs.Delay_usec == 0);
+            REQUIRE(costs.SerialBytes == 0);  // Logging is deferred (c.f. DeferredLog)
+            REQUIRE(costs.EEPROMWrites == 0);
+        }
+    }
+
+    GIVEN("A device reporting the deadline overrun that led to its previous reset")
+    {
+        DeadlineMonitor::Overrun overrun = DeadlineMonitor::Overrun();
+        overrun.Stage = static_cast<uint8_t>(DeadlineMonitor::Stage::Maintenance);
+        overrun.Duration_msec = 4000000000UL;
+        overrun.Deadline_msec = 3000;
+        overrun.DetectionTime = 4000000000UL;
+
+        CostAccounting costAccounting;
+
+        statusPublisher.Publish(
+            configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1, &overrun);
+
+        Costs const costs = costAccounting.Elapsed();
+
+        THEN("The overrun rides along in a regular status update")
+        {
+            REQUIRE(costs.Publishes == 1);
+            REQUIRE(costs.PublishedBytes <= 200 + 100);
+        }
+    }
+
+    GIVEN("A device that was offline for three publish cycles")
+    {
+        Particle.testSetConnected(false);
+
+        for (int idxPublish = 0; idxPublish < 3; ++idxPublish)
+        {
+            statusPublisher.Publish(
+                configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1);
+        }
+
+        Particle.testSetConnected(true);
+
+        WHEN("It reconnects and publishes again")
+        {
+            CostAccounting costAccounting;
+
+            statusPublisher.Publish(
+                configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1);
+
+            Costs const costs = costAccounting.Elapsed();
+            costAccounting.Print("Publish after reconnecting with a backlog of three");
+
+            THEN("The backlog drains with one second of delay per queued event")
+            {
+                REQUIRE(costs.Publishes == 4);
+                REQUIRE(costs.Delay_msec() <= 3 * 1000);
+            }
+        }
+    }
+}
+
+SCENARIO("Flash writes stay within their budget", "[PerformanceBudgets]")
+{
+    EEPROM.testErase();
+    Time.testSetMillis(0);
+
+    GIVEN("A configuration")
+    {
+        SyntheticConfiguration syntheticConfiguration;
+        syntheticConfiguration.SetThreshold(0.5f);
+        syntheticConfiguration.Build();
+
+        std::string const& encodedConfiguration = syntheticConfiguration.EncodedConfiguration();
+
+        WHEN("It's accepted and then resubmitted unchanged (e.g. by every status response)")
+        {
+            Configuration configuration;
+            CostAccounting costAccounting;
+
+            REQUIRE(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+                    Configuration::ConfigUpdateResult::Accepted);
+            REQUIRE(configuration.AcceptPendingUpdates());
+
+            Costs const acceptCosts = costAccounting.Elapsed();
+
+            configuration.SaveData();
+
+            for (int idxResubmission = 0; idxResubmission < 10; ++idxResubmission)
+            {
+                REQUIRE(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+                        Configuration::ConfigUpdateResult::Retained);
+                REQUIRE(!configuration.AcceptPendingUpdates());
+            }
+
+            Costs const totalCosts = costAccounting.Elapsed();
+            costAccounting.Print("Accept and resubmit configuration");
+
+            THEN("Only the accepted configuration is written, and only once saved")
+            {
+                REQUIRE(acceptCosts.EEPROMWrites == 0);
+                REQUIRE(totalCosts.EEPROMWrites == 1);
+            }
+        }
+    }
+
+    GIVEN("A zone cycling its heat with recovery rate learning")
+    {
+        ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpoint);
+        configuration.SetThreshold(1.0f);
+        configuration.Build();
+
+        Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+
+        Zone zone;
+        zone.Initialize(configuration, 0, 0);
+
+        WHEN("It runs for a day at the control interval")
+        {
+            CostAccounting costAccounting;
+
+            float temperature = 18.0f;
+            uint32_t cHeatCycles = 0;
+            bool fWasHeating = false;
+
+            for (uint32_t time_msec = 0; time_msec < 24 * 60 * 60 * 1000; time_msec += 10 * 1000)
+            {
+                Time.testSetMillis(time_msec);
+                zone.Apply(configuration, temperature, time_msec);
+
+                bool const fIsHeating = !!(zone.CurrentActions() & ThermostatAction::Heat);
+
+                if (fIsHeating && !fWasHeating)
+                {
+                    ++cHeatCycles;
+                }
+
+                fWasHeating = fIsHeating;
+
+                // Heat at 2 C/h, lose heat at 1 C/h
+                temperature += (fIsHeating ? 2.0f : -1.0f) * 10 / (60.0f * 60.0f);
+            }
+
+            Costs const costs = costAccounting.Elapsed();
+            costAccounting.Print("A day of zone control");
+
+            THEN("Learned rates are persisted at most once per heat cycle")
+            {
+                REQUIRE(cHeatCycles > 0);
+                REQUIRE(costs.EEPROMWrites <= cHeatCycles);
+            }
+        }
+    }
+}
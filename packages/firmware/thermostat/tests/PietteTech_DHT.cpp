@@ -0,0 +1,145 @@
+#include "base.h"
+
+namespace
+{
+// Synthesizes the falling edge timestamps the ISR would capture for a DHT22 transmission
+class SyntheticTransmission
+{
+public:
+    SyntheticTransmission(uint8_t const* const rgBytes)
+        : Start_usec(1000)
+        , Initial_usec(30)
+        , Response_usec(160)
+        , Zero_usec(78)
+        , One_usec(122)
+        , Jitter_usec(0)
+        , fIncludeInitialEdge(true)
+    {
+        memcpy(m_rgBytes, rgBytes, sizeof(m_rgBytes));
+    }
+
+    int Decode(uint8_t* const rgBits)
+    {
+        uint32_t rgEdges[DHT_EDGES_MAX];
+        uint8_t cEdges = 0;
+
+        uint32_t edge_usec = Start_usec + Initial_usec;
+
+        if (fIncludeInitialEdge)
+        {
+            rgEdges[cEdges++] = edge_usec;
+        }
+
+        edge_usec += Response_usec - Initial_usec;
+        rgEdges[cEdges++] = edge_usec;
+
+        for (uint8_t idxBit = 0; idxBit < DHT_DATA_BITS; ++idxBit)
+        {
+            bool const fIsOne = (m_rgBytes[idxBit / 8] >> (7 - idxBit % 8)) & 1;
+            int const jitter_usec = (idxBit % 2) ? Jitter_usec : -Jitter_usec;
+
+            edge_usec += (fIsOne ? One_usec : Zero_usec) + jitter_usec;
+            rgEdges[cEdges++] = edge_usec;
+        }
+
+        return PietteTech_DHT::decodeEdges(rgEdges, cEdges, Start_usec, rgBits);
+    }
+
+public:
+    uint32_t Start_usec;
+    uint32_t Initial_usec;
+    uint32_t Response_usec;
+    uint32_t Zero_usec;
+    uint32_t One_usec;
+    int Jitter_usec;
+    bool fIncludeInitialEdge;
+
+private:
+    uint8_t m_rgBytes[5];
+};
+
+// 65.2 %RH, 21.5 C, checksum
+uint8_t const c_rgBytes[] = {0x02, 0x8C, 0x00, 0xD7, 0x65};
+}  // namespace
+
+SCENARIO("DHT edge timestamps are decoded off the ISR", "[PietteTech_DHT]")
+{
+    SyntheticTransmission transmission(c_rgBytes);
+    uint8_t rgBits[5] = {};
+
+    GIVEN("A transmission with nominal timings")
+    {
+        THEN("It decodes")
+        {
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_OK);
+            REQUIRE(memcmp(rgBits, c_rgBytes, sizeof(rgBits)) == 0);
+        }
+
+        THEN("It decodes when the sensor's initial edge preceded the ISR being attached")
+        {
+            transmission.fIncludeInitialEdge = false;
+
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_OK);
+            REQUIRE(memcmp(rgBits, c_rgBytes, sizeof(rgBits)) == 0);
+        }
+
+        THEN("It decodes across a micros() rollover")
+        {
+            transmission.Start_usec = UINT32_MAX - 500;
+
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_OK);
+            REQUIRE(memcmp(rgBits, c_rgBytes, sizeof(rgBits)) == 0);
+        }
+    }
+
+    GIVEN("A transmission with timings skewed past the fixed threshold")
+    {
+        // '0' bits would be classified as '1' against the fixed 110 usec threshold
+        transmission.Zero_usec = 112;
+        transmission.One_usec = 158;
+        transmission.Jitter_usec = 4;
+
+        THEN("Adaptive thresholds still decode it")
+        {
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_OK);
+            REQUIRE(memcmp(rgBits, c_rgBytes, sizeof(rgBits)) == 0);
+        }
+    }
+
+    GIVEN("A corrupted transmission")
+    {
+        uint8_t rgCorruptBytes[5];
+        memcpy(rgCorruptBytes, c_rgBytes, sizeof(rgCorruptBytes));
+        rgCorruptBytes[3] ^= 0x01;
+
+        SyntheticTransmission corruptTransmission(rgCorruptBytes);
+
+        THEN("The checksum catches it")
+        {
+            REQUIRE(corruptTransmission.Decode(rgBits) == DHTLIB_ERROR_CHECKSUM);
+        }
+    }
+
+    GIVEN("Transmissions with invalid timings")
+    {
+        THEN("A missing response is reported")
+        {
+            REQUIRE(PietteTech_DHT::decodeEdges(nullptr, 0, 0, rgBits) == DHTLIB_ERROR_RESPONSE_TIMEOUT);
+
+            transmission.Response_usec = 400;
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_ERROR_RESPONSE_TIMEOUT);
+        }
+
+        THEN("Glitches are reported")
+        {
+            transmission.Zero_usec = 5;
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_ERROR_DELTA);
+        }
+
+        THEN("Overlong bits are reported")
+        {
+            transmission.One_usec = 300;
+            REQUIRE(transmission.Decode(rgBits) == DHTLIB_ERROR_DATA_TIMEOUT);
+        }
+    }
+}
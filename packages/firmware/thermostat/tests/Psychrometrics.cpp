@@ -0,0 +1,187 @@
+#include "base.h"
+
+namespace
+{
+// Absolute humidity [g/m^3] from the NOAA vapor pressure underlying PietteTech_DHT::dewPointSlow()
+double referenceAbsoluteHumidity(double const celsius, double const humidity)
+{
+    double const dewPoint = PietteTech_DHT::dewPointSlow(celsius, humidity);
+    double const T = (17.558 * dewPoint) / (241.88 + dewPoint);
+    double const vaporPressure_kPa = 0.61078 * exp(T);
+
+    return (2167.0 * vaporPressure_kPa) / (273.15 + celsius);
+}
+}  // namespace
+
+SCENARIO("Humidity-derived metrics are computed in single precision", "[Psychrometrics]")
+{
+    GIVEN("The polynomial approximations")
+    {
+        THEN("They track the C runtime's")
+        {
+            double maxLogError = 0;
+            double maxExpError = 0;
+
+            for (float value = 0.01f; value < 10.0f; value *= 1.01f)
+            {
+                double const error = Psychrometrics::FastLog(value) - log(static_cast<double>(value));
+                maxLogError = std::max(maxLogError, fabs(error));
+            }
+
+            for (float value = -10.0f; value < 10.0f; value += 0.01f)
+            {
+                double const error = Psychrometrics::FastExp(value) / exp(static_cast<double>(value)) - 1.0;
+                maxExpError = std::max(maxExpError, fabs(error));
+            }
+
+            REQUIRE(maxLogError < 1e-6);
+            REQUIRE(maxExpError < 5e-6);
+
+            REQUIRE(std::isnan(Psychrometrics::FastLog(0.0f)));
+            REQUIRE(std::isnan(Psychrometrics::FastLog(-1.0f)));
+            REQUIRE(Psychrometrics::FastExp(-1000.0f) == 0.0f);
+        }
+    }
+
+    GIVEN("Indoor and outdoor conditions")
+    {
+        double maxDewPointError = 0;
+        double maxAbsoluteHumidityError = 0;
+
+        for (float temperature = -20.0f; temperature <= 50.0f; temperature += 0.5f)
+        {
+            for (float humidity = 5.0f; humidity <= 100.0f; humidity += 0.5f)
+            {
+                maxDewPointError =
+                    std::max(maxDewPointError,
+                             fabs(Psychrometrics::DewPoint(temperature, humidity) -
+                                  PietteTech_DHT::dewPointSlow(temperature, humidity)));
+
+                maxAbsoluteHumidityError =
+                    std::max(maxAbsoluteHumidityError,
+                             fabs(Psychrometrics::AbsoluteHumidity(temperature, humidity) /
+                                      referenceAbsoluteHumidity(temperature, humidity) -
+                                  1.0));
+            }
+        }
+
+        THEN("Dew points are within the stated bound of the NOAA formula")
+        {
+            REQUIRE(maxDewPointError < 0.1);
+        }
+
+        THEN("Absolute humidity is within 1% of the NOAA vapor pressure's")
+        {
+            REQUIRE(maxAbsoluteHumidityError < 0.01);
+        }
+
+        THEN("Typical values are as expected")
+        {
+            REQUIRE(Psychrometrics::DewPoint(20.0f, 50.0f) == Approx(9.3f).margin(0.1f));
+            REQUIRE(Psychrometrics::AbsoluteHumidity(20.0f, 50.0f) == Approx(8.6f).margin(0.1f));
+        }
+    }
+
+    GIVEN("Missing readings")
+    {
+        THEN("Derived metrics are missing too")
+        {
+            REQUIRE(std::isnan(Psychrometrics::DewPoint(NAN, 50.0f)));
+            REQUIRE(std::isnan(Psychrometrics::DewPoint(20.0f, NAN)));
+            REQUIRE(std::isnan(Psychrometrics::DewPoint(20.0f, 0.0f)));
+            REQUIRE(std::isnan(Psychrometrics::AbsoluteHumidity(NAN, 50.0f)));
+            REQUIRE(std::isnan(Psychrometrics::AbsoluteHumidity(20.0f, NAN)));
+        }
+    }
+}
+
+SCENARIO("Thermostat dehumidifies by cooling", "[Psychrometrics]")
+{
+    GIVEN("A thermostat configured to dehumidify above a dew point of 15 C")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetDehumidifyAboveDewPoint(15.0f);
+        configuration.Build();
+
+        ThermostatSetpoint const thermostatSetpoint(
+            ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+        Thermostat thermostat;
+        thermostat.Initialize();
+
+        WHEN("It's comfortable but humid")
+        {
+            float const humidDewPoint = Psychrometrics::DewPoint(23.0f, 80.0f);
+            REQUIRE(humidDewPoint > 16.0f);
+
+            thermostat.Apply(configuration, thermostatSetpoint, 23.0f, Time.testGetMillis(), humidDewPoint);
+
+            THEN("Cooling is called for")
+            {
+                REQUIRE(thermostat.IsDehumidifying());
+                REQUIRE(thermostat.CurrentActions() == ThermostatAction::Cool);
+            }
+
+            AND_WHEN("The dew point drops into the threshold band")
+            {
+                thermostat.Apply(configuration, thermostatSetpoint, 23.0f, Time.testGetMillis(), 14.8f);
+
+                THEN("Dehumidifying continues (hysteresis)")
+                {
+                    REQUIRE(thermostat.IsDehumidifying());
+                }
+            }
+
+            AND_WHEN("The dew point drops below the threshold band")
+            {
+                thermostat.Apply(configuration, thermostatSetpoint, 23.0f, Time.testGetMillis(), 14.0f);
+
+                THEN("Dehumidifying stops")
+                {
+                    REQUIRE(!thermostat.IsDehumidifying());
+                    REQUIRE(!(thermostat.CurrentActions() & ThermostatAction::Cool));
+                }
+            }
+
+            AND_WHEN("The temperature drops near the heat setpoint")
+            {
+                thermostat.Apply(configuration, thermostatSetpoint, 20.2f, Time.testGetMillis(), humidDewPoint);
+
+                THEN("Dehumidifying stops rather than overcool")
+                {
+                    REQUIRE(!thermostat.IsDehumidifying());
+                    REQUIRE(!(thermostat.CurrentActions() & ThermostatAction::Cool));
+                }
+            }
+        }
+
+        WHEN("The dew point is unknown")
+        {
+            thermostat.Apply(configuration, thermostatSetpoint, 23.0f, Time.testGetMillis());
+
+            THEN("Control is by temperature alone")
+            {
+                REQUIRE(!thermostat.IsDehumidifying());
+                REQUIRE(thermostat.CurrentActions() == ThermostatAction::NONE);
+            }
+        }
+    }
+
+    GIVEN("A thermostat without dehumidification configured")
+    {
+        SyntheticConfiguration configuration;
+        configuration.Build();
+
+        ThermostatSetpoint const thermostatSetpoint(
+            ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+        Thermostat thermostat;
+        thermostat.Initialize();
+
+        THEN("Humidity doesn't affect control")
+        {
+            thermostat.Apply(configuration, thermostatSetpoint, 23.0f, Time.testGetMillis(), 20.0f);
+            REQUIRE(thermostat.CurrentActions() == ThermostatAction::NONE);
+        }
+    }
+}
@@ -0,0 +1,297 @@
+#include "base.h"
+
+namespace
+{
+unsigned long constexpr step_msec = 5 * 60 * 1000;
+
+// Runs alternating periods of heating and idling on a house that heats up at heatingRate [C/h]
+// and drifts down at 0.5 C/h while idle, with deterministic pseudo-random sensor noise
+float RunHeatingCycles(RecoveryRateEstimator& estimator,
+                       float const heatingRate,
+                       unsigned int const cCycles,
+                       unsigned long const period_msec,
+                       float temperature)
+{
+    uint32_t noiseState = 12345;
+
+    auto measure = [&]() {
+        noiseState = noiseState * 1103515245 + 12345;
+        float const noise = ((noiseState >> 16) % 101) / 1000.0f - 0.05f;  // +/- 0.05 C
+        return temperature + noise;
+    };
+
+    for (unsigned int idxCycle = 0; idxCycle < cCycles; ++idxCycle)
+    {
+        for (unsigned long elapsed_msec = 0; elapsed_msec < period_msec; elapsed_msec += step_msec)
+        {
+            estimator.Observe(ThermostatAction::Heat, measure(), Time.testGetMillis());
+
+            temperature += heatingRate * step_msec / (60.0f * 60.0f * 1000.0f);
+            Time.testAdvanceMillis(step_msec);
+        }
+
+        for (unsigned long elapsed_msec = 0; elapsed_msec < period_msec; elapsed_msec += step_msec)
+        {
+            estimator.Observe(ThermostatAction::NONE, measure(), Time.testGetMillis());
+
+            temperature -= 0.5f * step_msec / (60.0f * 60.0f * 1000.0f);
+            Time.testAdvanceMillis(step_msec);
+        }
+    }
+
+    return temperature;
+}
+}  // namespace
+
+SCENARIO("Recovery rate estimator learns heating rates", "[RecoveryRateEstimator]")
+{
+    EEPROM.testErase();
+    Time.testSetMillis(0);
+
+    GIVEN("A fresh estimator")
+    {
+        RecoveryRateEstimator estimator;
+        estimator.Initialize(0);
+
+        REQUIRE(estimator.HeatingRate() == 0.0f);
+        REQUIRE(estimator.CoolingRate() == 0.0f);
+
+        THEN("No recovery time is estimated before rates are learned")
+        {
+            ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+            REQUIRE(estimator.RequiredRecoveryTime_minutes(setpoint, 16.0f) == 0.0f);
+        }
+
+        WHEN("Heating periods are too short")
+        {
+            RunHeatingCycles(estimator, 2.0f, 5, 10 * 60 * 1000, 16.0f);
+
+            THEN("They're ignored")
+            {
+                REQUIRE(estimator.HeatingRate() == 0.0f);
+            }
+        }
+
+        WHEN("Heating runs for several one-hour periods")
+        {
+            float const temperature = RunHeatingCycles(estimator, 2.0f, 10, 60 * 60 * 1000, 16.0f);
+
+            THEN("The estimate converges on the true heating rate")
+            {
+                REQUIRE(estimator.HeatingRate() == Approx(2.0f).epsilon(0.05));
+                REQUIRE(estimator.CoolingRate() == 0.0f);
+            }
+
+            THEN("The learned rates are only written out when saved")
+            {
+                REQUIRE(estimator.HasUnsavedData());
+
+                RecoveryRateEstimator restartedEstimator;
+                restartedEstimator.Initialize(0);
+
+                REQUIRE(restartedEstimator.HeatingRate() == 0.0f);
+            }
+
+            THEN("Saved rates persist across restarts")
+            {
+                estimator.SaveData();
+                REQUIRE(!estimator.HasUnsavedData());
+
+                RecoveryRateEstimator restartedEstimator;
+                restartedEstimator.Initialize(0);
+
+                REQUIRE(restartedEstimator.HeatingRate() == estimator.HeatingRate());
+            }
+
+            AND_WHEN("The house starts heating more slowly (e.g. colder weather)")
+            {
+                RunHeatingCycles(estimator, 1.0f, 10, 60 * 60 * 1000, temperature);
+
+                THEN("The estimate tracks the new rate")
+                {
+                    REQUIRE(estimator.HeatingRate() == Approx(1.0f).epsilon(0.1));
+                }
+            }
+        }
+    }
+}
+
+namespace
+{
+struct EarlyStartResults
+{
+    uint32_t cRelayTransitions;  // Heat turning on or off ahead of the scheduled time
+    uint32_t HeatingAhead_sec;   // Time spent heating ahead of the scheduled time
+    float ScheduledTimeTemperature;
+};
+
+// Runs the scheduler and thermostat in closed loop on 10 sec control passes (c.f. LoopScheduler) from Monday 00:00
+// until scheduledAt_minutes, on a house that heats up at heatingRate [C/h] and drifts down at 0.5 C/h while idle
+EarlyStartResults SimulateEarlyStart(SyntheticConfiguration const& configuration,
+                                     RecoveryRateEstimator const& estimator,
+                                     float const heatingRate,
+                                     uint16_t const scheduledAt_minutes,
+                                     float temperature)
+{
+    uint32_t constexpr c_Step_sec = 10;
+
+    ThermostatSetpointScheduler scheduler;
+
+    Thermostat thermostat;
+    thermostat.Initialize();
+
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 0, 0);
+    uint32_t const startTime = Time.now();
+
+    EarlyStartResults results = {0, 0, 0.0f};
+    bool fWasHeating = false;
+
+    for (uint32_t elapsed_sec = 0; elapsed_sec < scheduledAt_minutes * 60UL; elapsed_sec += c_Step_sec)
+    {
+        Time.testSetUTCTime(startTime + elapsed_sec);
+
+        ThermostatSetpoint const setpoint =
+            scheduler.getCurrentThermostatSetpoint(configuration, estimator, temperature);
+        thermostat.Apply(configuration, setpoint, temperature, elapsed_sec * 1000);
+
+        bool const fIsHeating = !!(thermostat.CurrentActions() & ThermostatAction::Heat);
+
+        if (fIsHeating != fWasHeating)
+        {
+            ++results.cRelayTransitions;
+        }
+
+        if (fIsHeating)
+        {
+            results.HeatingAhead_sec += c_Step_sec;
+        }
+
+        fWasHeating = fIsHeating;
+
+        temperature += (fIsHeating ? heatingRate : -0.5f) * c_Step_sec / (60.0f * 60.0f);
+    }
+
+    results.ScheduledTimeTemperature = temperature;
+
+    return results;
+}
+}  // namespace
+
+SCENARIO("Scheduler starts recovery early", "[RecoveryRateEstimator]")
+{
+    EEPROM.testErase();
+    Time.testSetMillis(0);
+
+    ThermostatSetpointScheduler scheduler;
+
+    // Learn a heating rate of 2 C/h
+    RecoveryRateEstimator estimator;
+    estimator.Initialize(0);
+
+    estimator.Observe(ThermostatAction::Heat, 16.0f, 0);
+    estimator.Observe(ThermostatAction::NONE, 18.0f, 60 * 60 * 1000);
+
+    REQUIRE(estimator.HeatingRate() == Approx(2.0f));
+
+    // (Low enough at night for the house to just drift down)
+    ThermostatSetpoint const setpointNight(ThermostatAction::Heat, 10.0f, 30.0f, 100, 0);
+    ThermostatSetpoint const setpointMorning(ThermostatAction::Heat, 20.0f, 30.0f, 100, 0);
+
+    uint16_t constexpr c_MorningAt_minutes = 6 * 60;
+
+    GIVEN("A schedule with a morning setpoint and early start enabled")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointNight);
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, c_MorningAt_minutes, setpointMorning);
+        configuration.SetMaximumEarlyStart(3 * 60);
+        configuration.Build();
+
+        WHEN("The house heats up at the learned rate")
+        {
+            EarlyStartResults const results =
+                SimulateEarlyStart(configuration, estimator, 2.0f, c_MorningAt_minutes, 16.0f);
+
+            THEN("Heat starts once, early enough to reach the morning setpoint on schedule")
+            {
+                // (Drifting down from 16 C to 14.4 C by 03:12, then heating for 2.8 hours)
+                REQUIRE(results.cRelayTransitions == 1);
+                REQUIRE(results.HeatingAhead_sec == Approx(2.8f * 60 * 60).margin(60));
+                REQUIRE(results.ScheduledTimeTemperature == Approx(20.0f).margin(0.1f));
+            }
+        }
+
+        WHEN("The house heats up faster than the learned rate")
+        {
+            EarlyStartResults const results =
+                SimulateEarlyStart(configuration, estimator, 4.0f, c_MorningAt_minutes, 16.0f);
+
+            THEN("The early start is held rather than falling back to the current setpoint on every pass")
+            {
+                // (On, then off once past the morning setpoint, where it then drifts down from)
+                REQUIRE(results.cRelayTransitions == 2);
+                REQUIRE(results.ScheduledTimeTemperature >= 20.0f - 0.5f);
+            }
+        }
+
+        WHEN("The house is already warm enough")
+        {
+            EarlyStartResults const results =
+                SimulateEarlyStart(configuration, estimator, 2.0f, c_MorningAt_minutes, 24.0f);
+
+            THEN("Heat never starts early")
+            {
+                REQUIRE(results.cRelayTransitions == 0);
+            }
+        }
+
+        WHEN("Recovery would need to start earlier than the maximum early start")
+        {
+            EarlyStartResults const results =
+                SimulateEarlyStart(configuration, estimator, 2.0f, c_MorningAt_minutes, 12.0f);
+
+            THEN("Heat starts no earlier than the maximum early start, and stays on")
+            {
+                REQUIRE(results.cRelayTransitions == 1);
+                REQUIRE(results.HeatingAhead_sec == 3 * 60 * 60);
+            }
+        }
+    }
+
+    GIVEN("The same schedule with early start disabled")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointNight);
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, c_MorningAt_minutes, setpointMorning);
+        configuration.Build();
+
+        EarlyStartResults const results =
+            SimulateEarlyStart(configuration, estimator, 2.0f, c_MorningAt_minutes, 16.0f);
+
+        THEN("Heat doesn't start ahead of the schedule")
+        {
+            REQUIRE(results.cRelayTransitions == 0);
+            REQUIRE(results.ScheduledTimeTemperature < 16.0f);
+        }
+    }
+
+    GIVEN("The same schedule with an active hold")
+    {
+        ThermostatSetpoint const setpointHold(ThermostatAction::Heat, 12.0f, 30.0f, 100, 0);
+
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointNight);
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, c_MorningAt_minutes, setpointMorning);
+        configuration.SetMaximumEarlyStart(3 * 60);
+
+        Time.testSetLocalTime(ParticleDayOfWeek::Monday, 5, 0);
+        configuration.AddHoldSetting(Time.now() + 60 * 60, setpointHold);
+
+        configuration.Build();
+
+        THEN("The hold is retained")
+        {
+            REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration, estimator, 16.0f) == setpointHold);
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include "base.h"
+
+SCENARIO("Control state is retained across resets", "[RetainedState]")
+{
+    ThermostatAction const rgActions[] = {ThermostatAction::Heat, ThermostatAction::Circulate};
+
+    RetainedState retainedState;
+    memset(&retainedState, 0xA5, sizeof(retainedState));  // Retained memory isn't initialized at boot
+
+    GIVEN("Uninitialized retained memory")
+    {
+        THEN("It's not trusted")
+        {
+            REQUIRE(!retainedState.IsValid());
+        }
+    }
+
+    GIVEN("Updated retained memory")
+    {
+        retainedState.Update(0x12345678, rgActions, countof(rgActions));
+
+        THEN("It's trusted and reads back")
+        {
+            REQUIRE(retainedState.IsValid());
+            REQUIRE(retainedState.ConfigurationHash == 0x12345678);
+            REQUIRE(retainedState.cZones == 2);
+            REQUIRE(retainedState.rgZoneActions[0] == static_cast<uint8_t>(ThermostatAction::Heat));
+            REQUIRE(retainedState.rgZoneActions[1] == static_cast<uint8_t>(ThermostatAction::Circulate));
+        }
+
+        THEN("Corruption is detected")
+        {
+            retainedState.rgZoneActions[1] ^= 0x01;
+            REQUIRE(!retainedState.IsValid());
+        }
+    }
+}
+
+SCENARIO("Zones resume retained control state", "[RetainedState]")
+{
+    EEPROM.testErase();
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 30.0f, 100, 0);
+
+    SyntheticConfiguration configuration;
+    configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpoint);
+    configuration.AddZone(0 /* operable temperature */, 0x1, D3, D4, D5);
+    configuration.Build();
+
+    Zone zone;
+    zone.Initialize(configuration, 0, 0);
+
+    REQUIRE(testGetPinValues()[D3] == 0);
+
+    GIVEN("A zone that was heating before a reset")
+    {
+        zone.Resume(configuration, ThermostatAction::Heat, Time.testGetMillis());
+
+        THEN("It heats right away")
+        {
+            REQUIRE(zone.CurrentActions() == ThermostatAction::Heat);
+            REQUIRE(testGetPinValues()[D3] == 1);
+            REQUIRE(testGetPinValues()[D5] == 1);
+        }
+
+        WHEN("No reading is available yet")
+        {
+            zone.Apply(configuration, NAN, Time.testGetMillis());
+
+            THEN("It keeps heating")
+            {
+                REQUIRE(zone.CurrentActions() == ThermostatAction::Heat);
+            }
+        }
+
+        WHEN("The first reading is above the setpoint")
+        {
+            zone.Apply(configuration, 22.0f, Time.testGetMillis());
+
+            THEN("It stops heating")
+            {
+                REQUIRE(zone.CurrentActions() == ThermostatAction::NONE);
+                REQUIRE(testGetPinValues()[D3] == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Zones resuming after a reset respect short-cycle protection", "[RetainedState]")
+{
+    EEPROM.testErase();
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+    Time.testSetMillis(0);
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 30.0f, 100, 0);
+
+    SyntheticConfiguration configuration;
+    configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpoint);
+    configuration.AddZone(0 /* operable temperature */, 0x1, D3, D4, D5);
+    configuration.SetShortCycleProtection(0 /* minimum run time */, 5 * 60 /* minimum off time */, 0);
+    configuration.Build();
+
+    Zone zone;
+    zone.Initialize(configuration, 0, Time.testGetMillis());
+
+    GIVEN("A zone that was heating when it was reset (e.g. by a brownout)")
+    {
+        zone.Resume(configuration, ThermostatAction::Heat, Time.testGetMillis());
+
+        THEN("Heat is held back")
+        {
+            REQUIRE(zone.CurrentActions() == ThermostatAction::NONE);
+            REQUIRE(testGetPinValues()[D3] == 0);
+        }
+
+        WHEN("It's still cold before the minimum off time has passed since the reset")
+        {
+            Time.testAdvanceMillis(5 * 60 * 1000 - 1);
+            zone.Apply(configuration, 18.0f, Time.testGetMillis());
+
+            THEN("It still doesn't heat")
+            {
+                REQUIRE(zone.CurrentActions() == ThermostatAction::NONE);
+                REQUIRE(testGetPinValues()[D3] == 0);
+            }
+        }
+
+        WHEN("It's still cold once the minimum off time has passed since the reset")
+        {
+            Time.testAdvanceMillis(5 * 60 * 1000);
+            zone.Apply(configuration, 18.0f, Time.testGetMillis());
+
+            THEN("It heats again")
+            {
+                REQUIRE(zone.CurrentActions() == ThermostatAction::Heat);
+                REQUIRE(testGetPinValues()[D3] == 1);
+            }
+        }
+    }
+
+    GIVEN("A zone that was only circulating when it was reset")
+    {
+        zone.Resume(configuration, ThermostatAction::Circulate, Time.testGetMillis());
+
+        THEN("Circulation resumes right away")
+        {
+            REQUIRE(zone.CurrentActions() == ThermostatAction::Circulate);
+        }
+
+        WHEN("It's cold")
+        {
+            zone.Apply(configuration, 18.0f, Time.testGetMillis());
+
+            THEN("It heats right away, since the compressor wasn't running")
+            {
+                REQUIRE(!!(zone.CurrentActions() & ThermostatAction::Heat));
+            }
+        }
+    }
+}
@@ -0,0 +1,193 @@
+#include <thread>  // (Ahead of base.h, whose CoreDefs.h defines __out)
+
+#include "base.h"
+
+namespace
+{
+struct TestItem
+{
+    uint32_t Sequence;
+    uint32_t rgPayload[15];
+
+    void Fill(uint32_t const sequence)
+    {
+        Sequence = sequence;
+
+        for (size_t idxPayload = 0; idxPayload < countof(rgPayload); ++idxPayload)
+        {
+            rgPayload[idxPayload] = sequence * 31 + idxPayload;
+        }
+    }
+
+    bool IsConsistent() const
+    {
+        for (size_t idxPayload = 0; idxPayload < countof(rgPayload); ++idxPayload)
+        {
+            if (rgPayload[idxPayload] != Sequence * 31 + idxPayload)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+}  // namespace
+
+SCENARIO("SPSCQueue works single-threaded", "[SPSCQueue]")
+{
+    GIVEN("An empty queue")
+    {
+        SPSCQueue<uint32_t, 4> testQueue;
+
+        REQUIRE(testQueue.empty());
+        REQUIRE(testQueue.size() == 0);
+        REQUIRE(testQueue.capacity() == 4);
+        REQUIRE(testQueue.front() == nullptr);
+
+        uint32_t item = 0;
+        REQUIRE(!testQueue.pop(item));
+
+        WHEN("Items are pushed")
+        {
+            REQUIRE(testQueue.push(1));
+            REQUIRE(testQueue.push(2));
+
+            THEN("They come out in order")
+            {
+                REQUIRE(testQueue.size() == 2);
+                REQUIRE(*testQueue.front() == 1);
+
+                REQUIRE(testQueue.pop(item));
+                REQUIRE(item == 1);
+
+                REQUIRE(testQueue.pop(item));
+                REQUIRE(item == 2);
+
+                REQUIRE(testQueue.empty());
+            }
+        }
+
+        WHEN("The queue is full")
+        {
+            for (uint32_t idxItem = 0; idxItem < testQueue.capacity(); ++idxItem)
+            {
+                REQUIRE(testQueue.push(idxItem));
+            }
+
+            THEN("Pushes fail without evicting anything")
+            {
+                REQUIRE(!testQueue.push(100));
+                REQUIRE(testQueue.prepare_push() == nullptr);
+
+                REQUIRE(testQueue.size() == testQueue.capacity());
+                REQUIRE(*testQueue.front() == 0);
+            }
+
+            AND_WHEN("An item is popped")
+            {
+                testQueue.pop();
+
+                THEN("Its slot can be filled in place")
+                {
+                    uint32_t* const pItem = testQueue.prepare_push();
+                    REQUIRE(pItem != nullptr);
+
+                    *pItem = 100;
+
+                    // (Not visible until committed)
+                    REQUIRE(testQueue.size() == testQueue.capacity() - 1);
+
+                    testQueue.commit_push();
+                    REQUIRE(testQueue.size() == testQueue.capacity());
+
+                    for (uint32_t idxItem = 1; idxItem < testQueue.capacity(); ++idxItem)
+                    {
+                        REQUIRE(testQueue.pop(item));
+                        REQUIRE(item == idxItem);
+                    }
+
+                    REQUIRE(testQueue.pop(item));
+                    REQUIRE(item == 100);
+                }
+            }
+        }
+
+        WHEN("Items are pushed and popped many times over")
+        {
+            bool fItemsMatched = true;
+
+            for (uint32_t idxItem = 0; idxItem < 1000; ++idxItem)
+            {
+                fItemsMatched &= testQueue.push(idxItem);
+                fItemsMatched &= testQueue.pop(item) && (item == idxItem);
+            }
+
+            THEN("Slots are reused in turn")
+            {
+                REQUIRE(fItemsMatched);
+                REQUIRE(testQueue.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("SPSCQueue hands items off between threads", "[SPSCQueue]")
+{
+    uint32_t constexpr c_cItems = 200 * 1000;
+
+    GIVEN("A producer thread filling items in place as fast as it can")
+    {
+        // (Small so the threads run into each other at both ends of the queue)
+        SPSCQueue<TestItem, 4> testQueue;
+
+        std::thread producerThread([&]() {
+            for (uint32_t sequence = 0; sequence < c_cItems;)
+            {
+                TestItem* const pItem = testQueue.prepare_push();
+
+                if (!pItem)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                pItem->Fill(sequence++);
+                testQueue.commit_push();
+            }
+        });
+
+        WHEN("A consumer thread drains it")
+        {
+            uint32_t cItemsReceived = 0;
+            uint32_t cItemsOutOfOrder = 0;
+            uint32_t cItemsTorn = 0;
+
+            while (cItemsReceived < c_cItems)
+            {
+                TestItem const* const pItem = testQueue.front();
+
+                if (!pItem)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                cItemsOutOfOrder += (pItem->Sequence != cItemsReceived) ? 1 : 0;
+                cItemsTorn += pItem->IsConsistent() ? 0 : 1;
+
+                testQueue.pop();
+                ++cItemsReceived;
+            }
+
+            producerThread.join();
+
+            THEN("Every item arrives once, in order, and intact")
+            {
+                REQUIRE(cItemsOutOfOrder == 0);
+                REQUIRE(cItemsTorn == 0);
+                REQUIRE(testQueue.empty());
+            }
+        }
+    }
+}
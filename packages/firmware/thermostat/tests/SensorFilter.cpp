@@ -0,0 +1,166 @@
+#include "base.h"
+
+namespace
+{
+// Deterministic approximately-normal noise (sum of uniforms)
+class NoiseSource
+{
+public:
+    NoiseSource(float const standardDeviation)
+        : m_State(12345)
+        , m_StandardDeviation(standardDeviation)
+    {
+    }
+
+    float Next()
+    {
+        float sum = 0.0f;
+
+        for (int idx = 0; idx < 12; ++idx)
+        {
+            m_State = m_State * 1103515245 + 12345;
+            sum += ((m_State >> 8) & 0xFFFF) / 65536.0f;
+        }
+
+        return (sum - 6.0f) * m_StandardDeviation;
+    }
+
+private:
+    uint32_t m_State;
+    float m_StandardDeviation;
+};
+
+// @returns number of heat relay transitions over a day of holding the setpoint with a noisy sensor
+uint32_t CountRelayTransitions(SyntheticConfiguration const& configuration)
+{
+    uint32_t constexpr step_msec = 60 * 1000;
+    uint32_t constexpr duration_msec = 24 * 60 * 60 * 1000;
+
+    float constexpr setPoint = 20.0f;
+
+    Thermostat thermostat;
+    thermostat.Initialize();
+
+    SensorFilterBank<1> sensorFilterBank;
+    NoiseSource noiseSource(0.2f);
+
+    ThermostatSetpoint const thermostatSetpoint(ThermostatAction::Heat, setPoint, 100, 100, 0);
+
+    float temperature = setPoint;
+    bool fWasHeating = false;
+    uint32_t cTransitions = 0;
+
+    for (uint32_t time_msec = 0; time_msec < duration_msec; time_msec += step_msec)
+    {
+        float const rawTemperature = temperature + noiseSource.Next();
+        float const filteredTemperature = sensorFilterBank.FilterOnboard(configuration, rawTemperature);
+
+        thermostat.Apply(configuration, thermostatSetpoint, filteredTemperature, time_msec);
+
+        bool const fIsHeating = !!(thermostat.CurrentActions() & ThermostatAction::Heat);
+
+        if (fIsHeating != fWasHeating)
+        {
+            ++cTransitions;
+        }
+
+        fWasHeating = fIsHeating;
+
+        // Heat at 1 C/h, lose heat at 0.5 C/h
+        temperature += (fIsHeating ? 1.0f : -0.5f) * step_msec / (60.0f * 60.0f * 1000.0f);
+    }
+
+    return cTransitions;
+}
+}  // namespace
+
+SCENARIO("Scalar filters smooth readings", "[SensorFilter]")
+{
+    GIVEN("A fresh filter")
+    {
+        ScalarFilter filter;
+
+        THEN("The first reading is adopted as-is")
+        {
+            REQUIRE(filter.UpdateExponentialMovingAverage(20.0f, 0.3f) == 20.0f);
+        }
+
+        WHEN("An EMA filter has seen a reading")
+        {
+            filter.UpdateExponentialMovingAverage(20.0f, 0.5f);
+
+            THEN("Subsequent readings move it by the smoothing factor")
+            {
+                REQUIRE(filter.UpdateExponentialMovingAverage(22.0f, 0.5f) == Approx(21.0f));
+            }
+
+            THEN("Missing readings pass through without disturbing its state")
+            {
+                REQUIRE(std::isnan(filter.UpdateExponentialMovingAverage(NAN, 0.5f)));
+                REQUIRE(filter.UpdateExponentialMovingAverage(22.0f, 0.5f) == Approx(21.0f));
+            }
+        }
+
+        WHEN("A Kalman filter sees noisy readings of a constant temperature")
+        {
+            NoiseSource noiseSource(0.2f);
+
+            float filteredValue = NAN;
+            float sumSquaredRawError = 0.0f;
+            float sumSquaredFilteredError = 0.0f;
+
+            for (int idx = 0; idx < 200; ++idx)
+            {
+                float const rawValue = 20.0f + noiseSource.Next();
+                filteredValue = filter.UpdateKalman(rawValue, 0.0001f, 0.04f);
+
+                if (idx >= 100)
+                {
+                    sumSquaredRawError += (rawValue - 20.0f) * (rawValue - 20.0f);
+                    sumSquaredFilteredError += (filteredValue - 20.0f) * (filteredValue - 20.0f);
+                }
+            }
+
+            THEN("It converges with much less noise than the raw readings")
+            {
+                REQUIRE(filteredValue == Approx(20.0f).margin(0.1f));
+                REQUIRE(sumSquaredFilteredError < sumSquaredRawError / 4);
+            }
+        }
+    }
+}
+
+SCENARIO("Filtering sensor noise reduces relay chatter", "[SensorFilter]")
+{
+    GIVEN("A tight threshold and a sensor with 0.2 C of noise")
+    {
+        SyntheticConfiguration rawConfiguration;
+        rawConfiguration.SetThreshold(0.1f);
+        rawConfiguration.Build();
+
+        SyntheticConfiguration emaConfiguration;
+        emaConfiguration.SetThreshold(0.1f);
+        emaConfiguration.SetSensorFilter(SensorFilterType::ExponentialMovingAverage, 10, 0, 0);
+        emaConfiguration.Build();
+
+        SyntheticConfiguration kalmanConfiguration;
+        kalmanConfiguration.SetThreshold(0.1f);
+        kalmanConfiguration.SetSensorFilter(SensorFilterType::Kalman, 0, 3 /* ~(1 C/h / 60)^2 */, 400);
+        kalmanConfiguration.Build();
+
+        WHEN("Each holds the setpoint for a day")
+        {
+            uint32_t const cRawTransitions = CountRelayTransitions(rawConfiguration);
+            uint32_t const cEMATransitions = CountRelayTransitions(emaConfiguration);
+            uint32_t const cKalmanTransitions = CountRelayTransitions(kalmanConfiguration);
+
+            CAPTURE(cRawTransitions, cEMATransitions, cKalmanTransitions);
+
+            THEN("Filtered readings chatter far less")
+            {
+                REQUIRE(cEMATransitions * 2 < cRawTransitions);
+                REQUIRE(cKalmanTransitions * 2 < cRawTransitions);
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include "base.h"
+
+namespace
+{
+uint64_t constexpr c_OnboardSensorId = 0;
+uint64_t constexpr c_SensorIdA = 0x1111111111111128ull;
+uint64_t constexpr c_SensorIdB = 0x2222222222222228ull;
+uint64_t constexpr c_SensorIdC = 0x3333333333333328ull;
+
+OneWireAddress const rgAddresses[] = {OneWireAddress(c_SensorIdA),
+                                      OneWireAddress(c_SensorIdB),
+                                      OneWireAddress(c_SensorIdC)};
+
+typedef SensorFusion<4> TestSensorFusion;
+}  // namespace
+
+SCENARIO("Sensor fusion combines sensors robustly", "[SensorFusion]")
+{
+    unsigned long const cadence_msec = 600 * 1000;
+
+    GIVEN("Three external sensors and the onboard sensor fused by weighted median")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddSensorFusionInput(c_OnboardSensorId, 1);
+        configuration.AddSensorFusionInput(c_SensorIdA, 1);
+        configuration.AddSensorFusionInput(c_SensorIdB, 1);
+        configuration.AddSensorFusionInput(c_SensorIdC, 1);
+        configuration.Build();
+
+        REQUIRE(TestSensorFusion::IsConfigured(configuration));
+
+        TestSensorFusion sensorFusion;
+
+        WHEN("One sensor reports a wildly different (but plausible) value")
+        {
+            float const rgTemperatures[] = {20.0f, 20.5f, 35.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses));
+            float const fusedTemperature = sensorFusion.Fuse(configuration, 21.0f, sensorRegistry, 0);
+
+            THEN("It doesn't move the fused temperature beyond the other readings")
+            {
+                REQUIRE(fusedTemperature == Approx(20.75f));
+                REQUIRE(sensorFusion.UsedExternalSensor());
+                REQUIRE(sensorFusion.InputCount() == 4);
+
+                for (size_t idxInput = 0; idxInput < sensorFusion.InputCount(); ++idxInput)
+                {
+                    REQUIRE(sensorFusion.GetInputStatus(idxInput) == TestSensorFusion::InputStatus::Fresh);
+                }
+            }
+        }
+
+        WHEN("One sensor reports a physically implausible value")
+        {
+            float const rgTemperatures[] = {20.0f, 85.0f, 21.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses));
+            float const fusedTemperature = sensorFusion.Fuse(configuration, 20.5f, sensorRegistry, 0);
+
+            THEN("It's rejected and flagged")
+            {
+                REQUIRE(fusedTemperature == Approx(20.5f));
+                REQUIRE(sensorFusion.GetInputStatus(2) == TestSensorFusion::InputStatus::OutOfBounds);
+            }
+        }
+
+        WHEN("A sensor drops out")
+        {
+            float const rgTemperatures[] = {20.0f, 21.0f, 22.0f};
+            sensorFusion.Fuse(
+                configuration, 23.0f, SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses)), 0);
+
+            float const rgTemperaturesWithDropout[] = {NAN, 21.0f, 22.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperaturesWithDropout, 3);
+
+            THEN("Its last reading is held for a few cadences")
+            {
+                float const fusedTemperature = sensorFusion.Fuse(configuration, 23.0f, sensorRegistry, cadence_msec);
+
+                REQUIRE(fusedTemperature == Approx(21.5f));
+                REQUIRE(sensorFusion.GetInputStatus(1) == TestSensorFusion::InputStatus::Held);
+            }
+
+            THEN("It's eventually considered stale and dropped")
+            {
+                float const fusedTemperature =
+                    sensorFusion.Fuse(configuration, 23.0f, sensorRegistry, 4 * cadence_msec);
+
+                REQUIRE(fusedTemperature == Approx(22.0f));
+                REQUIRE(sensorFusion.GetInputStatus(1) == TestSensorFusion::InputStatus::Stale);
+            }
+        }
+
+        WHEN("A sensor isn't on the bus")
+        {
+            float const rgTemperatures[] = {20.0f, 21.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, 2);
+            float const fusedTemperature = sensorFusion.Fuse(configuration, 22.0f, sensorRegistry, 0);
+
+            THEN("It's flagged as stale and the rest are fused")
+            {
+                REQUIRE(fusedTemperature == Approx(21.0f));
+                REQUIRE(sensorFusion.GetInputStatus(3) == TestSensorFusion::InputStatus::Stale);
+            }
+        }
+
+        WHEN("No sensor has a usable reading")
+        {
+            float const rgTemperatures[] = {NAN, NAN, NAN};
+            auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses));
+            float const fusedTemperature = sensorFusion.Fuse(configuration, NAN, sensorRegistry, 0);
+
+            THEN("The fused temperature is NaN")
+            {
+                REQUIRE(std::isnan(fusedTemperature));
+                REQUIRE(!sensorFusion.UsedExternalSensor());
+            }
+        }
+    }
+
+    GIVEN("Sensors fused by weighted median with uneven weights")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddSensorFusionInput(c_OnboardSensorId, 0);
+        configuration.AddSensorFusionInput(c_SensorIdA, 3);
+        configuration.AddSensorFusionInput(c_SensorIdB, 1);
+        configuration.AddSensorFusionInput(c_SensorIdC, 1);
+        configuration.Build();
+
+        TestSensorFusion sensorFusion;
+
+        float const rgTemperatures[] = {22.0f, 20.0f, 21.0f};
+        auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses));
+        float const fusedTemperature = sensorFusion.Fuse(configuration, 10.0f, sensorRegistry, 0);
+
+        THEN("The heavily weighted sensor dominates and zero-weight sensors are only monitored")
+        {
+            REQUIRE(fusedTemperature == Approx(22.0f));
+            REQUIRE(sensorFusion.GetInputStatus(0) == TestSensorFusion::InputStatus::Fresh);
+        }
+    }
+
+    GIVEN("Sensors fused by trimmed mean")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddSensorFusionInput(c_SensorIdA, 1);
+        configuration.AddSensorFusionInput(c_SensorIdB, 1);
+        configuration.AddSensorFusionInput(c_SensorIdC, 1);
+        configuration.AddSensorFusionInput(c_OnboardSensorId, 1);
+        configuration.SetSensorFusionMethod(SensorFusionMethod::TrimmedMean);
+        configuration.Build();
+
+        TestSensorFusion sensorFusion;
+
+        float const rgTemperatures[] = {10.0f, 20.0f, 21.0f};
+        auto const sensorRegistry = SyntheticSensorRegistry<4>(rgAddresses, rgTemperatures, countof(rgAddresses));
+        float const fusedTemperature = sensorFusion.Fuse(configuration, 40.0f, sensorRegistry, 0);
+
+        THEN("The extremes are dropped and the rest averaged")
+        {
+            REQUIRE(fusedTemperature == Approx(20.5f));
+        }
+    }
+
+    GIVEN("A configuration without sensor fusion inputs")
+    {
+        SyntheticConfiguration configuration;
+        configuration.Build();
+
+        THEN("Sensor fusion isn't configured")
+        {
+            REQUIRE(!TestSensorFusion::IsConfigured(configuration));
+        }
+    }
+}
@@ -0,0 +1,156 @@
+#include "base.h"
+
+namespace
+{
+typedef SensorSnapshot<4> TestSensorSnapshot;
+typedef SensorRegistry<4> TestSensorRegistry;
+
+TestSensorSnapshot buildSnapshot(OneWireAddress const* const rgAddresses,
+                                 float const* const rgTemperatures,
+                                 size_t const cSensors,
+                                 unsigned long const readingTime_msec)
+{
+    TestSensorSnapshot snapshot;
+
+    for (size_t idxSensor = 0; idxSensor < cSensors; ++idxSensor)
+    {
+        REQUIRE(snapshot.AddSensor(rgAddresses[idxSensor]));
+        snapshot.SetReading(idxSensor, rgTemperatures[idxSensor], readingTime_msec, 11);
+        snapshot.rgFilteredValues[idxSensor] = rgTemperatures[idxSensor] + 0.5f;
+    }
+
+    return snapshot;
+}
+}  // namespace
+
+SCENARIO("Sensor registry tracks sensors by address across acquisitions", "[SensorRegistry]")
+{
+    size_t const idxNotFound = TestSensorRegistry::sc_idxNotFound;
+    uint8_t const roleOperable = TestSensorRegistry::sc_RoleOperable;
+
+    OneWireAddress const rgAddresses[] = {
+        OneWireAddress(0x1100000000000028ull),
+        OneWireAddress(0x2200000000000028ull),
+        OneWireAddress(0x3300000000000028ull),
+        OneWireAddress(0x4400000000000028ull),
+    };
+
+    GIVEN("A registry updated with an acquisition of three sensors")
+    {
+        TestSensorRegistry sensorRegistry;
+
+        float const rgTemperatures[] = {20.0f, NAN, 22.0f};
+        sensorRegistry.Update(buildSnapshot(rgAddresses, rgTemperatures, 3, 1000));
+
+        THEN("Sensors are registered in acquisition order")
+        {
+            REQUIRE(sensorRegistry.Count() == 3);
+
+            for (size_t idxSensor = 0; idxSensor < 3; ++idxSensor)
+            {
+                REQUIRE(sensorRegistry.Find(rgAddresses[idxSensor].Value()) == idxSensor);
+                REQUIRE(sensorRegistry[idxSensor].Id == rgAddresses[idxSensor]);
+                REQUIRE(sensorRegistry[idxSensor].ResolutionBits == 11);
+            }
+
+            REQUIRE(strcmp(sensorRegistry[0].szId, "2800000000000011") == 0);
+        }
+
+        THEN("Unknown sensors and the onboard sensor aren't found")
+        {
+            REQUIRE(sensorRegistry.Find(rgAddresses[3].Value()) == idxNotFound);
+            REQUIRE(sensorRegistry.Find(0) == idxNotFound);
+            REQUIRE(std::isnan(sensorRegistry.GetCurrentTemperature(rgAddresses[3].Value())));
+        }
+
+        THEN("Readings are recorded, failures are counted")
+        {
+            REQUIRE(sensorRegistry.IsCurrent(0));
+            REQUIRE(sensorRegistry[0].Value == 20.0f);
+            REQUIRE(sensorRegistry[0].FilteredValue == 20.5f);
+            REQUIRE(sensorRegistry[0].ReadingTime_msec == 1000);
+            REQUIRE(sensorRegistry[0].cFailures == 0);
+            REQUIRE(sensorRegistry.GetCurrentTemperature(rgAddresses[0].Value()) == 20.5f);
+
+            REQUIRE(!sensorRegistry.IsCurrent(1));
+            REQUIRE(sensorRegistry[1].cConsecutiveFailures == 1);
+            REQUIRE(sensorRegistry[1].cFailures == 1);
+            REQUIRE(std::isnan(sensorRegistry.GetCurrentTemperature(rgAddresses[1].Value())));
+        }
+
+        WHEN("A role is assigned")
+        {
+            REQUIRE(sensorRegistry.SetRoles(rgAddresses[2].Value(), roleOperable));
+            REQUIRE(!sensorRegistry.SetRoles(rgAddresses[3].Value(), roleOperable));
+
+            THEN("It holds until the next acquisition")
+            {
+                REQUIRE(sensorRegistry[2].HasRole(roleOperable));
+
+                sensorRegistry.Update(buildSnapshot(rgAddresses, rgTemperatures, 3, 2000));
+                REQUIRE(!sensorRegistry[2].HasRole(roleOperable));
+            }
+        }
+
+        WHEN("The next acquisition misses a sensor and finds a new one")
+        {
+            OneWireAddress const rgNextAddresses[] = {rgAddresses[3], rgAddresses[0], rgAddresses[1]};
+            float const rgNextTemperatures[] = {23.0f, 20.25f, 21.0f};
+
+            sensorRegistry.Update(buildSnapshot(rgNextAddresses, rgNextTemperatures, 3, 2000));
+
+            THEN("Known sensors keep their index and the new one is appended")
+            {
+                REQUIRE(sensorRegistry.Count() == 4);
+                REQUIRE(sensorRegistry.Find(rgAddresses[0].Value()) == 0);
+                REQUIRE(sensorRegistry.Find(rgAddresses[3].Value()) == 3);
+                REQUIRE(sensorRegistry[0].Value == 20.25f);
+            }
+
+            THEN("The sensor that recovered resets its consecutive failures")
+            {
+                REQUIRE(sensorRegistry.IsCurrent(1));
+                REQUIRE(sensorRegistry[1].cConsecutiveFailures == 0);
+                REQUIRE(sensorRegistry[1].cFailures == 1);
+            }
+
+            THEN("The missing sensor keeps its last reading but counts a failure")
+            {
+                REQUIRE(!sensorRegistry.IsCurrent(2));
+                REQUIRE(sensorRegistry[2].Value == 22.0f);
+                REQUIRE(sensorRegistry[2].ReadingTime_msec == 1000);
+                REQUIRE(sensorRegistry[2].cConsecutiveFailures == 1);
+                REQUIRE(std::isnan(sensorRegistry.GetCurrentTemperature(rgAddresses[2].Value())));
+            }
+        }
+    }
+
+    GIVEN("A full registry")
+    {
+        TestSensorRegistry sensorRegistry;
+
+        float const rgTemperatures[] = {20.0f, 21.0f, 22.0f, 23.0f};
+        sensorRegistry.Update(buildSnapshot(rgAddresses, rgTemperatures, 4, 1000));
+
+        REQUIRE(sensorRegistry.Count() == 4);
+
+        WHEN("A new sensor shows up")
+        {
+            OneWireAddress const rgNextAddresses[] = {rgAddresses[1], OneWireAddress(0x5500000000000028ull)};
+            float const rgNextTemperatures[] = {21.5f, 24.0f};
+
+            sensorRegistry.Update(buildSnapshot(rgNextAddresses, rgNextTemperatures, 2, 2000));
+
+            THEN("The registry starts over with the sensors that are around")
+            {
+                REQUIRE(sensorRegistry.Count() == 2);
+                REQUIRE(sensorRegistry.Find(rgAddresses[1].Value()) == 0);
+                REQUIRE(sensorRegistry.Find(rgNextAddresses[1].Value()) == 1);
+                REQUIRE(sensorRegistry.Find(rgAddresses[0].Value()) == idxNotFound);
+
+                REQUIRE(sensorRegistry.GetCurrentTemperature(rgAddresses[1].Value()) == 22.0f);
+                REQUIRE(sensorRegistry.GetCurrentTemperature(rgNextAddresses[1].Value()) == 24.5f);
+            }
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include "base.h"
+
+SCENARIO("Sensor snapshots are filled in place every acquisition", "[SensorSnapshot]")
+{
+    typedef SensorSnapshot<2> TestSensorSnapshot;
+
+    OneWireAddress const addressA(0x1100000000000028ull);
+    OneWireAddress const addressB(0x2200000000000028ull);
+    OneWireAddress const addressC(0x3300000000000028ull);
+
+    GIVEN("A snapshot of two sensors")
+    {
+        TestSensorSnapshot snapshot;
+
+        REQUIRE(snapshot.AddSensor(addressA));
+        REQUIRE(snapshot.AddSensor(addressB));
+
+        snapshot.SetReading(0, 20.5f, 1000, 12);
+        snapshot.SetReading(1, NAN, 1100);
+
+        THEN("Readings are recorded along with their validity")
+        {
+            REQUIRE(snapshot.cSensors == 2);
+            REQUIRE(snapshot.rgValues[0] == 20.5f);
+            REQUIRE(snapshot.rgTimestamps_msec[0] == 1000);
+            REQUIRE(snapshot.IsValid(0));
+            REQUIRE(!snapshot.IsValid(1));
+            REQUIRE(snapshot.rgResolutionBits[0] == 12);
+            REQUIRE(snapshot.rgResolutionBits[1] == 0);
+        }
+
+        THEN("There's no room for more")
+        {
+            REQUIRE(!snapshot.AddSensor(addressC));
+        }
+
+        WHEN("The next acquisition finds a different second sensor")
+        {
+            snapshot.Reset();
+
+            REQUIRE(snapshot.AddSensor(addressA));
+            REQUIRE(snapshot.AddSensor(addressC));
+
+            THEN("Slots start over")
+            {
+                REQUIRE(snapshot.cSensors == 2);
+                REQUIRE(snapshot.ValidMask == 0);
+                REQUIRE(std::isnan(snapshot.rgValues[0]));
+                REQUIRE(snapshot.rgResolutionBits[0] == 0);
+                REQUIRE(std::isnan(snapshot.OperableTemperature));
+            }
+
+            THEN("Ids follow the sensors")
+            {
+                REQUIRE(snapshot.rgIds[0] == addressA);
+                REQUIRE(snapshot.rgIds[1] == addressC);
+            }
+        }
+    }
+}
@@ -0,0 +1,162 @@
+#include "base.h"
+
+namespace
+{
+unsigned long constexpr minimumRunTime_msec = 5 * 60 * 1000;
+unsigned long constexpr minimumOffTime_msec = 3 * 60 * 1000;
+unsigned long constexpr changeoverDeadTime_msec = 10 * 60 * 1000;
+
+ShortCycleProtection::Timings const timings = {minimumRunTime_msec, minimumOffTime_msec, changeoverDeadTime_msec};
+
+ThermostatAction const None = ThermostatAction::NONE;
+ThermostatAction const Heat = ThermostatAction::Heat;
+ThermostatAction const Cool = ThermostatAction::Cool;
+ThermostatAction const Circulate = ThermostatAction::Circulate;
+}  // namespace
+
+SCENARIO("Short-cycle protection enforces compressor timings", "[ShortCycleProtection]")
+{
+    GIVEN("A fresh protection state machine")
+    {
+        ShortCycleProtection protection;
+        ThermostatAction currentActions = None;
+
+        // Mimic Thermostat: commit whatever's permitted
+        auto apply = [&](ThermostatAction const proposedActions, unsigned long const currentTime_msec) {
+            currentActions = protection.Apply(currentActions, proposedActions, timings, currentTime_msec);
+            return currentActions;
+        };
+
+        THEN("Actions without history are unrestricted")
+        {
+            REQUIRE(apply(Cool, 0) == Cool);
+        }
+
+        WHEN("Heat is started")
+        {
+            REQUIRE(apply(Heat, 0) == Heat);
+
+            THEN("It can't be stopped before the minimum run time")
+            {
+                REQUIRE(apply(None, minimumRunTime_msec - 1) == Heat);
+                REQUIRE(apply(None, minimumRunTime_msec) == None);
+            }
+
+            THEN("Circulation is unaffected")
+            {
+                REQUIRE(apply(Heat | Circulate, 1) == (Heat | Circulate));
+                REQUIRE(apply(Heat, 2) == Heat);
+            }
+
+            AND_WHEN("Heat is stopped")
+            {
+                REQUIRE(apply(None, minimumRunTime_msec) == None);
+
+                THEN("It can't be restarted before the minimum off time")
+                {
+                    REQUIRE(apply(Heat, minimumRunTime_msec + minimumOffTime_msec - 1) == None);
+                    REQUIRE(apply(Heat, minimumRunTime_msec + minimumOffTime_msec) == Heat);
+                }
+
+                THEN("Cool can't be started before the changeover dead time")
+                {
+                    REQUIRE(apply(Cool, minimumRunTime_msec + minimumOffTime_msec) == None);
+                    REQUIRE(apply(Cool, minimumRunTime_msec + changeoverDeadTime_msec - 1) == None);
+                    REQUIRE(apply(Cool, minimumRunTime_msec + changeoverDeadTime_msec) == Cool);
+                }
+            }
+
+            AND_WHEN("Cool is proposed straight away")
+            {
+                THEN("Heat keeps running and cool is held back")
+                {
+                    REQUIRE(apply(Cool, 1) == Heat);
+                }
+            }
+        }
+
+        WHEN("The clock rolls over while heat is running")
+        {
+            unsigned long const startTime_msec = static_cast<unsigned long>(-1) - 1000;
+            REQUIRE(apply(Heat, startTime_msec) == Heat);
+
+            THEN("Elapsed time is computed correctly")
+            {
+                REQUIRE(apply(None, startTime_msec + minimumRunTime_msec - 1) == Heat);
+                REQUIRE(apply(None, startTime_msec + minimumRunTime_msec) == None);
+            }
+        }
+    }
+}
+
+SCENARIO("Thermostat applies short-cycle protection", "[ShortCycleProtection]")
+{
+    GIVEN("A thermostat with short-cycle protection configured")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetShortCycleProtection(5 * 60 /* run */, 3 * 60 /* off */, 10 * 60 /* changeover */);
+        configuration.Build();
+
+        ThermostatSetpoint const thermostatSetpoint(
+            ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+        Time.testSetMillis(1000);
+
+        Thermostat thermostat;
+        thermostat.Initialize();
+
+        WHEN("The temperature swings quickly across both setpoints")
+        {
+            thermostat.Apply(configuration, thermostatSetpoint, 18.0f, Time.testGetMillis());
+            REQUIRE(thermostat.CurrentActions() == ThermostatAction::Heat);
+
+            Time.testAdvanceMillis(60 * 1000);
+            thermostat.Apply(configuration, thermostatSetpoint, 27.0f, Time.testGetMillis());
+
+            THEN("Heat keeps running for its minimum run time")
+            {
+                REQUIRE(thermostat.CurrentActions() == ThermostatAction::Heat);
+            }
+
+            AND_WHEN("The minimum run time has elapsed")
+            {
+                Time.testAdvanceMillis(4 * 60 * 1000);
+                thermostat.Apply(configuration, thermostatSetpoint, 27.0f, Time.testGetMillis());
+
+                THEN("Heat stops but cooling waits for the changeover dead time")
+                {
+                    REQUIRE(thermostat.CurrentActions() == ThermostatAction::NONE);
+
+                    Time.testAdvanceMillis(10 * 60 * 1000 - 1);
+                    thermostat.Apply(configuration, thermostatSetpoint, 27.0f, Time.testGetMillis());
+                    REQUIRE(thermostat.CurrentActions() == ThermostatAction::NONE);
+
+                    Time.testAdvanceMillis(1);
+                    thermostat.Apply(configuration, thermostatSetpoint, 27.0f, Time.testGetMillis());
+                    REQUIRE(thermostat.CurrentActions() == ThermostatAction::Cool);
+                }
+            }
+        }
+    }
+
+    GIVEN("A thermostat without short-cycle protection configured")
+    {
+        SyntheticConfiguration configuration;
+        configuration.Build();
+
+        ThermostatSetpoint const thermostatSetpoint(
+            ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+        Thermostat thermostat;
+        thermostat.Initialize();
+
+        THEN("Transitions happen immediately")
+        {
+            thermostat.Apply(configuration, thermostatSetpoint, 18.0f, Time.testGetMillis());
+            REQUIRE(thermostat.CurrentActions() == ThermostatAction::Heat);
+
+            thermostat.Apply(configuration, thermostatSetpoint, 27.0f, Time.testGetMillis());
+            REQUIRE(thermostat.CurrentActions() == ThermostatAction::Cool);
+        }
+    }
+}
@@ -0,0 +1,374 @@
+#pragma once
+
+//
+// Simulates a DS2484 I2C-to-1-Wire bridge (c.f. OneWireGateway2484) with DS18B20 temperature sensors on its bus,
+// for attaching to the mock Wire:
+//
+//   SimulatedOneWireBus bus;
+//   bus.AddSensor(0x0000000000000128, 21.5f);
+//   Wire.testAttachDevice(SimulatedOneWireBus::sc_GatewayAddress, &bus);
+//
+// Only the subset of the DS2484 and DS18B20 command sets used by our firmware is supported.
+//
+
+class SimulatedOneWireBus : public MockI2CDevice
+{
+public:
+    static uint8_t constexpr sc_GatewayAddress = 0x18;
+
+public:
+    SimulatedOneWireBus()
+        : m_Sensors()
+        , m_ReadPointer(Register::Status)
+        , m_Status()
+        , m_DeviceConfiguration()
+        , m_ReadData()
+        , m_BusState(BusState::Idle)
+        , m_rgfParticipating()
+        , m_rgMatchAddress()
+        , m_cbMatchAddress()
+        , m_idxSearchBit()
+        , m_idxScratchpadByte()
+    {
+    }
+
+public:
+    // @param serialNumber: lower 48 bits become the sensor's serial number; family code and CRC are filled in
+    // @returns the sensor's 1-Wire address
+    OneWireAddress AddSensor(uint64_t const serialNumber, float const temperature)
+    {
+        uint8_t rgAddress[8];
+        rgAddress[0] = 0x28;  // DS18B20
+
+        for (size_t idxByte = 1; idxByte < 7; ++idxByte)
+        {
+            rgAddress[idxByte] = static_cast<uint8_t>(serialNumber >> (8 * (idxByte - 1)));
+        }
+
+        rgAddress[7] = OneWireCRC::Compute(rgAddress, 7);
+
+        uint64_t address;
+        memcpy(&address, rgAddress, sizeof(address));
+
+        m_Sensors.push_back(Sensor{OneWireAddress(address), temperature});
+
+        return m_Sensors.back().Address;
+    }
+
+    //
+    // MockI2CDevice
+    //
+
+    bool OnWrite(uint8_t const* const rgData, size_t const cbData) override
+    {
+        if (cbData == 0)
+        {
+            return true;
+        }
+
+        switch (rgData[0])
+        {
+            case 0xF0:  // Device reset
+                m_Status = sc_Status_DeviceHasBeenReset;
+                m_DeviceConfiguration = 0;
+                m_ReadPointer = Register::Status;
+                return true;
+
+            case 0xE1:  // Set read pointer
+                if (cbData < 2)
+                {
+                    return false;
+                }
+
+                m_ReadPointer = static_cast<Register>(rgData[1]);
+                return true;
+
+            case 0xD2:  // Write device configuration (upper nibble must be the inverse of the lower nibble)
+                if ((cbData < 2) || (((rgData[1] >> 4) ^ rgData[1]) & 0x0F) != 0x0F)
+                {
+                    return false;
+                }
+
+                m_DeviceConfiguration = rgData[1] & 0x0F;
+                m_ReadPointer = Register::DeviceConfiguration;
+                return true;
+
+            case 0xB4:  // 1-Wire reset
+                OneWireReset();
+                m_ReadPointer = Register::Status;
+                return true;
+
+            case 0xA5:  // 1-Wire write byte
+                if (cbData < 2)
+                {
+                    return false;
+                }
+
+                OneWireWriteByte(rgData[1]);
+                m_ReadPointer = Register::Status;
+                return true;
+
+            case 0x96:  // 1-Wire read byte
+                m_ReadData = OneWireReadByte();
+                m_ReadPointer = Register::Status;
+                return true;
+
+            case 0x78:  // 1-Wire triplet
+                if (cbData < 2)
+                {
+                    return false;
+                }
+
+                OneWireTriplet(!!(rgData[1] & 0x80));
+                m_ReadPointer = Register::Status;
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    size_t OnRead(uint8_t* const rgData, size_t const cbData) override
+    {
+        for (size_t idxByte = 0; idxByte < cbData; ++idxByte)
+        {
+            switch (m_ReadPointer)
+            {
+                case Register::Status:
+                    rgData[idxByte] = m_Status;
+                    break;
+
+                case Register::ReadData:
+                    rgData[idxByte] = m_ReadData;
+                    break;
+
+                case Register::DeviceConfiguration:
+                    rgData[idxByte] = m_DeviceConfiguration;
+                    break;
+
+                default:
+                    rgData[idxByte] = 0xFF;
+                    break;
+            }
+        }
+
+        return cbData;
+    }
+
+private:
+    struct Sensor
+    {
+        OneWireAddress Address;
+        float Temperature;
+    };
+
+    enum class Register : uint8_t
+    {
+        DeviceConfiguration = 0xC3,
+        Status = 0xF0,
+        ReadData = 0xE1,
+    };
+
+    enum class BusState
+    {
+        Idle,           // awaiting reset
+        RomCommand,     // awaiting ROM command
+        MatchRom,       // receiving address to match
+        Search,         // searching via triplets
+        Function,       // awaiting function command
+        ReadScratchpad  // returning scratchpad bytes
+    };
+
+    static uint8_t constexpr sc_Status_PresencePulseDetected = 0x02;
+    static uint8_t constexpr sc_Status_DeviceHasBeenReset = 0x10;
+    static uint8_t constexpr sc_Status_SingleBitResult = 0x20;
+    static uint8_t constexpr sc_Status_TripletSecondBit = 0x40;
+    static uint8_t constexpr sc_Status_BranchDirectionTaken = 0x80;
+
+    static size_t constexpr sc_cSensors_Max = 64;
+
+    std::vector<Sensor> m_Sensors;
+
+    // DS2484 state
+    Register m_ReadPointer;
+    uint8_t m_Status;
+    uint8_t m_DeviceConfiguration;
+    uint8_t m_ReadData;
+
+    // 1-Wire bus state
+    BusState m_BusState;
+    bool m_rgfParticipating[sc_cSensors_Max];
+    uint8_t m_rgMatchAddress[8];
+    size_t m_cbMatchAddress;
+    uint8_t m_idxSearchBit;
+    uint8_t m_idxScratchpadByte;
+
+private:
+    void OneWireReset()
+    {
+        m_Status = m_Sensors.empty() ? 0 : sc_Status_PresencePulseDetected;
+        m_BusState = m_Sensors.empty() ? BusState::Idle : BusState::RomCommand;
+
+        SetAllParticipating(true);
+    }
+
+    void OneWireWriteByte(uint8_t const value)
+    {
+        m_Status = 0;
+
+        switch (m_BusState)
+        {
+            case BusState::RomCommand:
+                switch (static_cast<IOneWireGateway::OneWireCommand>(value))
+                {
+                    case IOneWireGateway::OneWireCommand::SearchAll:
+                        m_BusState = BusState::Search;
+                        m_idxSearchBit = 0;
+                        break;
+
+                    case IOneWireGateway::OneWireCommand::MatchROM:
+                        m_BusState = BusState::MatchRom;
+                        m_cbMatchAddress = 0;
+                        break;
+
+                    case IOneWireGateway::OneWireCommand::SkipROM:
+                        m_BusState = BusState::Function;
+                        break;
+
+                    default:
+                        m_BusState = BusState::Idle;
+                        break;
+                }
+                break;
+
+            case BusState::MatchRom:
+                m_rgMatchAddress[m_cbMatchAddress++] = value;
+
+                if (m_cbMatchAddress == countof(m_rgMatchAddress))
+                {
+                    for (size_t idxSensor = 0; idxSensor < m_Sensors.size(); ++idxSensor)
+                    {
+                        m_rgfParticipating[idxSensor] =
+                            (memcmp(m_Sensors[idxSensor].Address.Get(), m_rgMatchAddress, countof(m_rgMatchAddress)) ==
+                             0);
+                    }
+
+                    m_BusState = BusState::Function;
+                }
+                break;
+
+            case BusState::Function:
+                switch (static_cast<IOneWireGateway::OneWireCommand>(value))
+                {
+                    case IOneWireGateway::OneWireCommand::ConvertT:
+                        // Conversions complete instantly (the firmware's own delay stands in for conversion time)
+                        m_BusState = BusState::Idle;
+                        break;
+
+                    case IOneWireGateway::OneWireCommand::ReadScratchpad:
+                        m_BusState = BusState::ReadScratchpad;
+                        m_idxScratchpadByte = 0;
+                        break;
+
+                    default:
+                        m_BusState = BusState::Idle;
+                        break;
+                }
+                break;
+
+            default:
+                m_BusState = BusState::Idle;
+                break;
+        }
+    }
+
+    uint8_t OneWireReadByte()
+    {
+        m_Status = 0;
+
+        if (m_BusState != BusState::ReadScratchpad)
+        {
+            return 0xFF;  // Nobody's driving the bus
+        }
+
+        // Wired-AND of all participating sensors' scratchpads
+        uint8_t value = 0xFF;
+
+        for (size_t idxSensor = 0; idxSensor < m_Sensors.size(); ++idxSensor)
+        {
+            if (m_rgfParticipating[idxSensor])
+            {
+                uint8_t rgScratchpad[9];
+                GetScratchpad(rgScratchpad, m_Sensors[idxSensor].Temperature);
+
+                value &= (m_idxScratchpadByte < countof(rgScratchpad)) ? rgScratchpad[m_idxScratchpadByte] : 0xFF;
+            }
+        }
+
+        ++m_idxScratchpadByte;
+
+        return value;
+    }
+
+    void OneWireTriplet(bool const directionRequested)
+    {
+        if ((m_BusState != BusState::Search) || (m_idxSearchBit >= 64))
+        {
+            m_Status = sc_Status_SingleBitResult | sc_Status_TripletSecondBit | sc_Status_BranchDirectionTaken;
+            return;
+        }
+
+        bool fAnyZero = false;
+        bool fAnyOne = false;
+
+        for (size_t idxSensor = 0; idxSensor < m_Sensors.size(); ++idxSensor)
+        {
+            if (m_rgfParticipating[idxSensor])
+            {
+                (m_Sensors[idxSensor].Address.GetBit(m_idxSearchBit) ? fAnyOne : fAnyZero) = true;
+            }
+        }
+
+        // Bit and complement bit as read off the wired-AND bus
+        bool const firstBit = !fAnyZero;
+        bool const secondBit = !fAnyOne;
+
+        bool const directionTaken = (fAnyZero && fAnyOne) ? directionRequested : firstBit;
+
+        for (size_t idxSensor = 0; idxSensor < m_Sensors.size(); ++idxSensor)
+        {
+            if (m_Sensors[idxSensor].Address.GetBit(m_idxSearchBit) != directionTaken)
+            {
+                m_rgfParticipating[idxSensor] = false;
+            }
+        }
+
+        ++m_idxSearchBit;
+
+        m_Status = (firstBit ? sc_Status_SingleBitResult : 0) | (secondBit ? sc_Status_TripletSecondBit : 0) |
+                   (directionTaken ? sc_Status_BranchDirectionTaken : 0);
+    }
+
+    void SetAllParticipating(bool const fIsParticipating)
+    {
+        for (size_t idxSensor = 0; idxSensor < countof(m_rgfParticipating); ++idxSensor)
+        {
+            m_rgfParticipating[idxSensor] = fIsParticipating && (idxSensor < m_Sensors.size());
+        }
+    }
+
+    static void GetScratchpad(uint8_t rgScratchpad[9], float const temperature)
+    {
+        int16_t const rawValue = static_cast<int16_t>(lroundf(temperature * 16.0f));
+
+        rgScratchpad[0] = static_cast<uint8_t>(rawValue & 0xFF);
+        rgScratchpad[1] = static_cast<uint8_t>(rawValue >> 8);
+        rgScratchpad[2] = 0x4B;  // T_H
+        rgScratchpad[3] = 0x46;  // T_L
+        rgScratchpad[4] = 0x7F;  // Configuration: 12-bit resolution
+        rgScratchpad[5] = 0xFF;
+        rgScratchpad[6] = 0x0C;
+        rgScratchpad[7] = 0x10;
+        rgScratchpad[8] = OneWireCRC::Compute(rgScratchpad, 8);
+    }
+};
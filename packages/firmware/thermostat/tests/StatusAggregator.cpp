@@ -0,0 +1,198 @@
+#include "base.h"
+
+namespace
+{
+uint8_t constexpr c_cSensors_Max = 4;
+
+typedef SensorSnapshot<c_cSensors_Max> TestSensorSnapshot;
+typedef SensorRegistry<c_cSensors_Max> TestSensorRegistry;
+
+TestSensorSnapshot buildSnapshot(bool const fUsedExternalSensor,
+                                 float const operableTemperature,
+                                 float const onboardTemperature,
+                                 float const onboardHumidity,
+                                 OneWireAddress const* const rgAddresses,
+                                 size_t const cAddresses,
+                                 float const* const rgExternalTemperatures)
+{
+    TestSensorSnapshot snapshot;
+
+    snapshot.OnboardTemperature = onboardTemperature;
+    snapshot.OnboardHumidity = onboardHumidity;
+    snapshot.OperableTemperature = operableTemperature;
+    snapshot.fUsedExternalSensor = fUsedExternalSensor;
+
+    for (size_t idxAddress = 0; idxAddress < cAddresses; ++idxAddress)
+    {
+        REQUIRE(snapshot.AddSensor(rgAddresses[idxAddress]));
+        snapshot.SetReading(idxAddress, rgExternalTemperatures[idxAddress], 0);
+    }
+
+    return snapshot;
+}
+
+// Registers the snapshot's sensors before adding it (as Main.cpp#processReadings() does)
+void addSample(StatusAggregator<c_cSensors_Max>& aggregator,
+               TestSensorRegistry& sensorRegistry,
+               unsigned long const sampleTime_msec,
+               ThermostatAction const& currentActions,
+               TestSensorSnapshot const& snapshot)
+{
+    sensorRegistry.Update(snapshot);
+    aggregator.AddSample(sampleTime_msec, currentActions, snapshot, sensorRegistry);
+}
+}  // namespace
+
+SCENARIO("Status aggregator accumulates measurements and actions over a window", "[StatusAggregator]")
+{
+    OneWireAddress const rgAddresses[] = {OneWireAddress(0x1100000000000028), OneWireAddress(0x2200000000000028)};
+
+    GIVEN("An empty aggregator")
+    {
+        StatusAggregator<c_cSensors_Max> aggregator;
+        TestSensorRegistry sensorRegistry;
+
+        REQUIRE(aggregator.SampleCount() == 0);
+        REQUIRE(aggregator.SensorCount() == 0);
+
+        WHEN("Three samples are added thirty seconds apart")
+        {
+            float const rgTemperatures1[] = {20.0f, 10.0f};
+            float const rgTemperatures2[] = {21.0f, NAN};
+            float const rgTemperatures3[] = {23.0f, 12.0f};
+
+            addSample(aggregator,
+                      sensorRegistry,
+                      1000,
+                      ThermostatAction::Heat,
+                      buildSnapshot(false, 18.0f, 18.0f, 40.0f, rgAddresses, 2, rgTemperatures1));
+            addSample(aggregator,
+                      sensorRegistry,
+                      31000,
+                      ThermostatAction::Heat | ThermostatAction::Circulate,
+                      buildSnapshot(false, 19.0f, 19.0f, NAN, rgAddresses, 2, rgTemperatures2));
+            addSample(aggregator,
+                      sensorRegistry,
+                      61000,
+                      ThermostatAction::NONE,
+                      buildSnapshot(false, 21.0f, 21.0f, 50.0f, rgAddresses, 2, rgTemperatures3));
+
+            THEN("Statistics reflect all valid samples")
+            {
+                REQUIRE(aggregator.SampleCount() == 3);
+                REQUIRE(aggregator.WindowDuration_msec() == 60000);
+
+                REQUIRE(aggregator.OperableTemperature().Count() == 3);
+                REQUIRE(aggregator.OperableTemperature().Min() == 18.0f);
+                REQUIRE(aggregator.OperableTemperature().Max() == 21.0f);
+                REQUIRE(aggregator.OperableTemperature().Mean() == Approx(19.333f).epsilon(0.001));
+                REQUIRE(aggregator.OperableTemperature().Last() == 21.0f);
+
+                REQUIRE(aggregator.OnboardHumidity().Count() == 2);
+                REQUIRE(aggregator.OnboardHumidity().Mean() == 45.0f);
+            }
+
+            THEN("Per-sensor statistics skip failed measurements")
+            {
+                REQUIRE(aggregator.SensorCount() == 2);
+
+                REQUIRE(aggregator.SensorAddress(0) == rgAddresses[0]);
+                REQUIRE(aggregator.SensorTemperature(0).Count() == 3);
+                REQUIRE(aggregator.SensorTemperature(0).Max() == 23.0f);
+
+                REQUIRE(aggregator.SensorAddress(1) == rgAddresses[1]);
+                REQUIRE(aggregator.SensorTemperature(1).Count() == 2);
+                REQUIRE(aggregator.SensorTemperature(1).Mean() == 11.0f);
+                REQUIRE(aggregator.SensorTemperature(1).Last() == 12.0f);
+            }
+
+            THEN("Action on-time is attributed to the actions in effect between samples")
+            {
+                REQUIRE(aggregator.HeatOnTime_msec() == 60000);
+                REQUIRE(aggregator.CirculateOnTime_msec() == 30000);
+                REQUIRE(aggregator.CoolOnTime_msec() == 0);
+            }
+
+            AND_WHEN("The window is reset and another sample is added")
+            {
+                aggregator.Reset();
+
+                float const rgTemperatures4[] = {24.0f};
+
+                addSample(aggregator,
+                          sensorRegistry,
+                          91000,
+                          ThermostatAction::Cool,
+                          buildSnapshot(true, 22.0f, 25.0f, 55.0f, rgAddresses, 1, rgTemperatures4));
+
+                THEN("The new window continues where the previous one left off")
+                {
+                    REQUIRE(aggregator.SampleCount() == 1);
+                    REQUIRE(aggregator.WindowDuration_msec() == 30000);
+                    REQUIRE(aggregator.UsedExternalSensor());
+
+                    REQUIRE(aggregator.OperableTemperature().Count() == 1);
+                    REQUIRE(aggregator.OperableTemperature().Min() == 22.0f);
+
+                    // (Sensors keep their registry index; the one that went missing has no samples this window)
+                    REQUIRE(aggregator.SensorCount() == 2);
+                    REQUIRE(aggregator.SensorTemperature(0).Last() == 24.0f);
+                    REQUIRE(aggregator.SensorTemperature(1).Count() == 0);
+
+                    // Previous sample had no actions
+                    REQUIRE(aggregator.HeatOnTime_msec() == 0);
+                    REQUIRE(aggregator.CoolOnTime_msec() == 0);
+                }
+            }
+        }
+
+        WHEN("Actions change in between samples")
+        {
+            float const rgTemperatures[] = {20.0f, 10.0f};
+
+            addSample(aggregator,
+                      sensorRegistry,
+                      0,
+                      ThermostatAction::NONE,
+                      buildSnapshot(false, 18.0f, 18.0f, 40.0f, rgAddresses, 2, rgTemperatures));
+            aggregator.AddActions(10000, ThermostatAction::Heat);
+            aggregator.AddActions(20000, ThermostatAction::Heat);
+            addSample(aggregator,
+                      sensorRegistry,
+                      60000,
+                      ThermostatAction::Heat,
+                      buildSnapshot(false, 19.0f, 19.0f, 40.0f, rgAddresses, 2, rgTemperatures));
+
+            THEN("On-time reflects the intermediate actions without adding measurement samples")
+            {
+                REQUIRE(aggregator.SampleCount() == 2);
+                REQUIRE(aggregator.OperableTemperature().Count() == 2);
+                REQUIRE(aggregator.WindowDuration_msec() == 60000);
+                REQUIRE(aggregator.HeatOnTime_msec() == 50000);
+            }
+        }
+
+        WHEN("A sensor stands in for the operable temperature")
+        {
+            float const rgTemperatures[] = {20.0f, 10.0f};
+
+            TestSensorSnapshot const snapshot =
+                buildSnapshot(true, 10.0f, 18.0f, 40.0f, rgAddresses, 2, rgTemperatures);
+
+            sensorRegistry.Update(snapshot);
+            REQUIRE(sensorRegistry.SetRoles(rgAddresses[1].Value(), TestSensorRegistry::sc_RoleOperable));
+
+            aggregator.AddSample(0, ThermostatAction::NONE, snapshot, sensorRegistry);
+
+            THEN("It's only reported as such")
+            {
+                REQUIRE(aggregator.OperableTemperature().Last() == 10.0f);
+
+                REQUIRE(aggregator.SensorAddress(0) == rgAddresses[0]);
+                REQUIRE(strcmp(aggregator.SensorId(0), sensorRegistry[0].szId) == 0);
+                REQUIRE(aggregator.SensorTemperature(0).Count() == 1);
+                REQUIRE(aggregator.SensorTemperature(1).Count() == 0);
+            }
+        }
+    }
+}
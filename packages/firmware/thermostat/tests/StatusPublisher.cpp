@@ -0,0 +1,94 @@
+#include "base.h"
+
+SCENARIO("Status events stay within Particle's limit", "[StatusPublisher]")
+{
+    uint8_t constexpr cOneWireDevices_Max = 16;
+    size_t constexpr cchEventData_Max = 622;
+
+    SyntheticConfiguration configuration;
+    configuration.Build();
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+    SensorSnapshot<cOneWireDevices_Max> snapshot;
+    snapshot.OnboardTemperature = 20.5f;
+    snapshot.OnboardHumidity = 40.0f;
+    snapshot.OperableTemperature = 20.5f;
+
+    SensorFusion<cOneWireDevices_Max> sensorFusion;
+    Zone rgZones[Zone::sc_cZones_Max];
+
+    StatusPublisher<cOneWireDevices_Max> statusPublisher;
+
+    GIVEN("As many sensors and zones as the firmware supports, and an overrun to report")
+    {
+        for (uint8_t idxSensor = 0; idxSensor < cOneWireDevices_Max; ++idxSensor)
+        {
+            REQUIRE(snapshot.AddSensor(OneWireAddress(0x1111111111111128ull + (idxSensor << 8))));
+            snapshot.SetReading(idxSensor, -10.5f, 0);
+        }
+
+        SensorRegistry<cOneWireDevices_Max> sensorRegistry;
+        sensorRegistry.Update(snapshot);
+
+        // (Two samples so that statistics are reported as well)
+        StatusAggregator<cOneWireDevices_Max> aggregator;
+        aggregator.AddSample(0, ThermostatAction::Heat, snapshot, sensorRegistry);
+        aggregator.AddSample(1000, ThermostatAction::Heat, snapshot, sensorRegistry);
+
+        DeadlineMonitor::Overrun overrun = DeadlineMonitor::Overrun();
+        overrun.Stage = static_cast<uint8_t>(DeadlineMonitor::Stage::Maintenance);
+        overrun.Duration_msec = 4000000000UL;
+        overrun.Deadline_msec = 3000;
+        overrun.DetectionTime = 4000000000UL;
+
+        statusPublisher.Publish(configuration,
+                                setpoint,
+                                ThermostatAction::Heat,
+                                aggregator,
+                                sensorFusion,
+                                rgZones,
+                                countof(rgZones),
+                                &overrun);
+
+        std::string const& eventData = Particle.testGetLastPublishedData();
+        CAPTURE(eventData);
+
+        THEN("Measurements that don't fit are omitted and counted")
+        {
+            REQUIRE(eventData.size() <= cchEventData_Max);
+            REQUIRE(eventData.back() == '}');
+
+            REQUIRE(eventData.find("\"z\":[") != std::string::npos);
+            REQUIRE(eventData.find("\"ov\":{") != std::string::npos);
+            REQUIRE(eventData.find("\"v\":[{\"id\":") != std::string::npos);
+            REQUIRE(eventData.find("}],\"vx\":") != std::string::npos);
+        }
+    }
+
+    GIVEN("A few sensors")
+    {
+        for (uint8_t idxSensor = 0; idxSensor < 2; ++idxSensor)
+        {
+            REQUIRE(snapshot.AddSensor(OneWireAddress(0x1111111111111128ull + (idxSensor << 8))));
+            snapshot.SetReading(idxSensor, -10.5f, 0);
+        }
+
+        SensorRegistry<cOneWireDevices_Max> sensorRegistry;
+        sensorRegistry.Update(snapshot);
+
+        StatusAggregator<cOneWireDevices_Max> aggregator;
+        aggregator.AddSample(0, ThermostatAction::Heat, snapshot, sensorRegistry);
+
+        statusPublisher.Publish(configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1);
+
+        std::string const& eventData = Particle.testGetLastPublishedData();
+        CAPTURE(eventData);
+
+        THEN("They're all reported")
+        {
+            REQUIRE(eventData.find("\"vx\":") == std::string::npos);
+            REQUIRE(eventData.substr(eventData.size() - 3) == "}]}");
+        }
+    }
+}
@@ -9,6 +9,28 @@ public:
         , m_fIsBuilt()
         , m_FlatbufferBuilder(1024)
         , m_ThermostatSettings()
+        , m_Threshold_x100(Configuration::buildTemperature(0.5f))
+        , m_ControlMode(ControlMode::Hysteresis)
+        , m_ProportionalGain_x100(20)
+        , m_IntegralGain_x100(5)
+        , m_ControlCycleWindow(900)
+        , m_MinimumRunTime()
+        , m_MinimumOffTime()
+        , m_ChangeoverDeadTime()
+        , m_MaximumEarlyStart()
+        , m_SensorFusionInputs()
+        , m_SensorFusionMethod(SensorFusionMethod::WeightedMedian)
+        , m_SensorFilterType(SensorFilterType::None)
+        , m_SensorFilterSmoothing_x100(30)
+        , m_SensorFilterProcessNoise_x10000(10)
+        , m_SensorFilterMeasurementNoise_x10000(400)
+        , m_Zones()
+        , m_DehumidifyAboveDewPoint_x100()
+        , m_CurrentTimezoneUTCOffset()
+        , m_NextTimezoneUTCOffset()
+        , m_NextTimezoneChange()
+        , m_TimezoneTransitions()
+        , m_EncodedConfiguration()
     {
     }
 
@@ -49,23 +71,174 @@ public:
                                           atMinutesSinceMidnight);
     }
 
+    void SetThreshold(float const threshold)
+    {
+        m_Threshold_x100 = Configuration::buildTemperature(threshold);
+    }
+
+    void SetControlMode(ControlMode const controlMode,
+                        uint16_t const proportionalGain_x100,
+                        uint16_t const integralGain_x100,
+                        uint16_t const controlCycleWindow)
+    {
+        m_ControlMode = controlMode;
+        m_ProportionalGain_x100 = proportionalGain_x100;
+        m_IntegralGain_x100 = integralGain_x100;
+        m_ControlCycleWindow = controlCycleWindow;
+    }
+
+    void SetShortCycleProtection(uint16_t const minimumRunTime,
+                                 uint16_t const minimumOffTime,
+                                 uint16_t const changeoverDeadTime)
+    {
+        m_MinimumRunTime = minimumRunTime;
+        m_MinimumOffTime = minimumOffTime;
+        m_ChangeoverDeadTime = changeoverDeadTime;
+    }
+
+    void SetMaximumEarlyStart(uint16_t const maximumEarlyStart)
+    {
+        m_MaximumEarlyStart = maximumEarlyStart;
+    }
+
+    void AddSensorFusionInput(uint64_t const sensorId, uint8_t const weight)
+    {
+        m_SensorFusionInputs.emplace_back(sensorId, weight, 0 /* padding */, 0 /* padding */, 0 /* padding */);
+    }
+
+    void SetSensorFusionMethod(SensorFusionMethod const sensorFusionMethod)
+    {
+        m_SensorFusionMethod = sensorFusionMethod;
+    }
+
+    void SetSensorFilter(SensorFilterType const sensorFilterType,
+                         uint8_t const sensorFilterSmoothing_x100,
+                         uint16_t const sensorFilterProcessNoise_x10000,
+                         uint16_t const sensorFilterMeasurementNoise_x10000)
+    {
+        m_SensorFilterType = sensorFilterType;
+        m_SensorFilterSmoothing_x100 = sensorFilterSmoothing_x100;
+        m_SensorFilterProcessNoise_x10000 = sensorFilterProcessNoise_x10000;
+        m_SensorFilterMeasurementNoise_x10000 = sensorFilterMeasurementNoise_x10000;
+    }
+
+    void AddZone(uint64_t const sensorId,
+                 uint32_t const thermostatSettingsMask,
+                 uint8_t const relayPinHeat,
+                 uint8_t const relayPinSwitchOver,
+                 uint8_t const relayPinCirculate)
+    {
+        m_Zones.emplace_back(sensorId,
+                             thermostatSettingsMask,
+                             relayPinHeat,
+                             relayPinSwitchOver,
+                             relayPinCirculate,
+                             ZoneControlMode::Default,
+                             0,
+                             0,
+                             0,
+                             0 /* padding */);
+    }
+
+    // Adds a zone on heat and switch-over relay pins of its own (c.f. Configuration::IsReservedPin())
+    void AddZone(uint64_t const sensorId, uint32_t const thermostatSettingsMask)
+    {
+        static uint8_t const rgSparePins[] = {D3, D4, D5, A0, A1, A2, A3, A4, A5, A6, A7, RX, TX};
+
+        size_t const idxPin = m_Zones.size() * 2;
+        REQUIRE(idxPin + 1 < countof(rgSparePins));
+
+        AddZone(sensorId,
+                thermostatSettingsMask,
+                rgSparePins[idxPin],
+                rgSparePins[idxPin + 1],
+                Configuration::sc_RelayPin_NotConnected);
+    }
+
+    // Overrides the configuration's control settings (c.f. SetControlMode()) for a previously added zone
+    void SetZoneControlMode(size_t const idxZone,
+                            ZoneControlMode const controlMode,
+                            uint16_t const proportionalGain_x100,
+                            uint16_t const integralGain_x100,
+                            uint16_t const controlCycleWindow)
+    {
+        REQUIRE(idxZone < m_Zones.size());
+        auto const& zone = m_Zones[idxZone];
+
+        m_Zones[idxZone] = Flatbuffers::Firmware::ZoneConfiguration(zone.sensorId(),
+                                                                    zone.thermostatSettingsMask(),
+                                                                    zone.relayPinHeat(),
+                                                                    zone.relayPinSwitchOver(),
+                                                                    zone.relayPinCirculate(),
+                                                                    controlMode,
+                                                                    proportionalGain_x100,
+                                                                    integralGain_x100,
+                                                                    controlCycleWindow,
+                                                                    0 /* padding */);
+    }
+
+    void SetDehumidifyAboveDewPoint(float const dewPoint)
+    {
+        m_DehumidifyAboveDewPoint_x100 = Configuration::buildTemperature(dewPoint);
+    }
+
+    void SetTimezone(int16_t const currentTimezoneUTCOffset,
+                     int16_t const nextTimezoneUTCOffset,
+                     uint32_t const nextTimezoneChange)
+    {
+        m_CurrentTimezoneUTCOffset = currentTimezoneUTCOffset;
+        m_NextTimezoneUTCOffset = nextTimezoneUTCOffset;
+        m_NextTimezoneChange = nextTimezoneChange;
+    }
+
+    void AddTimezoneTransition(uint32_t const at, int16_t const utcOffset)
+    {
+        m_TimezoneTransitions.emplace_back(at, utcOffset, 0 /* padding */);
+    }
+
     void Build()
+    {
+        REQUIRE(TryBuild());
+    }
+
+    // Builds the configuration and submits it; @returns false if it was rejected (e.g. exceeds limits).
+    // Either way, a configuration can only be built once.
+    bool TryBuild()
     {
         REQUIRE(!m_fIsBuilt);
 
         auto const configurationRoot = Flatbuffers::Firmware::CreateThermostatConfigurationDirect(
             m_FlatbufferBuilder,
             0 /* external sensor ID */,
-            Configuration::buildTemperature(0.5f) /* threshold */,
+            m_Threshold_x100,
             600 /* cadence */,
-            0 /* currentTimezoneUTCOffset */,
-            0 /* nextTimezoneUTCOffset */,
-            0 /* nextTimezoneChange */,
-            &m_ThermostatSettings);
+            m_CurrentTimezoneUTCOffset,
+            m_NextTimezoneUTCOffset,
+            m_NextTimezoneChange,
+            &m_ThermostatSettings,
+            0 /* publishCadence */,
+            m_ControlMode,
+            m_ProportionalGain_x100,
+            m_IntegralGain_x100,
+            m_ControlCycleWindow,
+            m_MinimumRunTime,
+            m_MinimumOffTime,
+            m_ChangeoverDeadTime,
+            m_MaximumEarlyStart,
+            m_SensorFusionInputs.empty() ? nullptr : &m_SensorFusionInputs,
+            m_SensorFusionMethod,
+            m_SensorFilterType,
+            m_SensorFilterSmoothing_x100,
+            m_SensorFilterProcessNoise_x10000,
+            m_SensorFilterMeasurementNoise_x10000,
+            m_Zones.empty() ? nullptr : &m_Zones,
+            m_DehumidifyAboveDewPoint_x100,
+            m_TimezoneTransitions.empty() ? nullptr : &m_TimezoneTransitions);
 
         Flatbuffers::Firmware::FinishThermostatConfigurationBuffer(m_FlatbufferBuilder, configurationRoot);
 
-        char rgEncodedConfiguration[1024];
+        // (Large enough for oversized configurations so they get rejected by Configuration rather than here)
+        char rgEncodedConfiguration[2048];
         uint16_t cchEncodedConfiguration = Z85::EncodeBytes(rgEncodedConfiguration,
                                                             countof(rgEncodedConfiguration),
                                                             m_FlatbufferBuilder.GetBufferPointer(),
@@ -73,12 +246,18 @@ public:
 
         REQUIRE(cchEncodedConfiguration != 0);
 
-        REQUIRE(m_Configuration.SubmitUpdate(rgEncodedConfiguration, cchEncodedConfiguration) ==
-                Configuration::ConfigUpdateResult::Accepted);
+        if (m_Configuration.SubmitUpdate(rgEncodedConfiguration, cchEncodedConfiguration) !=
+            Configuration::ConfigUpdateResult::Accepted)
+        {
+            return false;
+        }
 
         REQUIRE(m_Configuration.AcceptPendingUpdates());
 
+        m_EncodedConfiguration.assign(rgEncodedConfiguration, cchEncodedConfiguration);
         m_fIsBuilt = true;
+
+        return true;
     }
 
     //
@@ -97,10 +276,49 @@ public:
         return m_Configuration.rootConfiguration();
     }
 
+    // Z85-encoded configuration as submitted to Configuration::SubmitUpdate()
+    std::string const& EncodedConfiguration() const
+    {
+        REQUIRE(m_fIsBuilt);
+        return m_EncodedConfiguration;
+    }
+
 private:
     Configuration m_Configuration;
     bool m_fIsBuilt;
 
     flatbuffers::FlatBufferBuilder m_FlatbufferBuilder;
     std::vector<Flatbuffers::Firmware::ThermostatSetting> m_ThermostatSettings;
+
+    uint16_t m_Threshold_x100;
+
+    ControlMode m_ControlMode;
+    uint16_t m_ProportionalGain_x100;
+    uint16_t m_IntegralGain_x100;
+    uint16_t m_ControlCycleWindow;
+
+    uint16_t m_MinimumRunTime;
+    uint16_t m_MinimumOffTime;
+    uint16_t m_ChangeoverDeadTime;
+
+    uint16_t m_MaximumEarlyStart;
+
+    std::vector<Flatbuffers::Firmware::SensorFusionInput> m_SensorFusionInputs;
+    SensorFusionMethod m_SensorFusionMethod;
+
+    SensorFilterType m_SensorFilterType;
+    uint8_t m_SensorFilterSmoothing_x100;
+    uint16_t m_SensorFilterProcessNoise_x10000;
+    uint16_t m_SensorFilterMeasurementNoise_x10000;
+
+    std::vector<Flatbuffers::Firmware::ZoneConfiguration> m_Zones;
+
+    uint16_t m_DehumidifyAboveDewPoint_x100;
+
+    int16_t m_CurrentTimezoneUTCOffset;
+    int16_t m_NextTimezoneUTCOffset;
+    uint32_t m_NextTimezoneChange;
+    std::vector<Flatbuffers::Firmware::TimezoneTransition> m_TimezoneTransitions;
+
+    std::string m_EncodedConfiguration;
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+// @returns a registry whose latest acquisition had the given (filtered) readings
+template <uint8_t c_cSensors_Max>
+SensorRegistry<c_cSensors_Max> SyntheticSensorRegistry(OneWireAddress const* const rgAddresses,
+                                                       float const* const rgTemperatures,
+                                                       size_t const cSensors,
+                                                       unsigned long const readingTime_msec = 0)
+{
+    SensorSnapshot<c_cSensors_Max> snapshot;
+
+    for (size_t idxSensor = 0; idxSensor < cSensors; ++idxSensor)
+    {
+        snapshot.AddSensor(rgAddresses[idxSensor]);
+        snapshot.SetReading(idxSensor, rgTemperatures[idxSensor], readingTime_msec);
+        snapshot.rgFilteredValues[idxSensor] = rgTemperatures[idxSensor];
+    }
+
+    SensorRegistry<c_cSensors_Max> sensorRegistry;
+    sensorRegistry.Update(snapshot);
+
+    return sensorRegistry;
+}
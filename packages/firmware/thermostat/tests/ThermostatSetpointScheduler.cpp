@@ -311,4 +311,53 @@ SCENARIO("Thermostat setpoint scheduler basics", "[ThermostatSetpointScheduler]"
             fnVerifySettings(configuration, groupedSetPoints);
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Thermostat setpoint scheduler without the time of day", "[ThermostatSetpointScheduler]")
+{
+    ThermostatSetpointScheduler scheduler;
+
+    GIVEN("A configuration with heating and cooling settings")
+    {
+        SyntheticConfiguration configuration;
+
+        ThermostatSetpoint const setpointHold(ThermostatAction::Heat | ThermostatAction::Circulate, 21, 26, 18, 24);
+        configuration.AddHoldSetting(1000, setpointHold);
+
+        ThermostatSetpoint const setpointNight(ThermostatAction::Heat, 16, 28, 16, 28);
+        configuration.AddScheduledSetting(DaysOfWeek::ANY, 22 * 60, setpointNight);
+
+        ThermostatSetpoint const setpointCooling(ThermostatAction::Cool, 10, 24, 10, 24);
+        configuration.AddScheduledSetting(DaysOfWeek::ANY, 12 * 60, setpointCooling);
+
+        configuration.Build();
+
+        THEN("It heats only, to the lowest heat setpoint among settings that heat")
+        {
+            ThermostatSetpoint const setpoint = scheduler.getTimeIndependentThermostatSetpoint(configuration);
+
+            REQUIRE(setpoint.AllowedActions == ThermostatAction::Heat);
+            REQUIRE(setpoint.SetPointHeat == setpointNight.SetPointHeat);
+        }
+
+        WHEN("The zone selects only the cooling setting")
+        {
+            scheduler.setThermostatSettingsMask(1 << 2);
+
+            THEN("An inactive setpoint is returned")
+            {
+                REQUIRE(scheduler.getTimeIndependentThermostatSetpoint(configuration) == ThermostatSetpoint());
+            }
+        }
+
+        WHEN("The zone selects the hold setting")
+        {
+            scheduler.setThermostatSettingsMask(1 << 0);
+
+            THEN("Its heat setpoint is used")
+            {
+                REQUIRE(scheduler.getTimeIndependentThermostatSetpoint(configuration).SetPointHeat ==
+                        setpointHold.SetPointHeat);
+            }
+        }
+    }
+}
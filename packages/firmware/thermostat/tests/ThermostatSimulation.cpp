@@ -0,0 +1,188 @@
+#include "base.h"
+
+//
+// Closed-loop simulation of Thermostat against a first-order-plus-dead-time thermal model,
+// approximating a radiant slab: heat delivered to the slab only shows up in the room after a delay
+// and the room then relaxes towards its steady-state temperature with a long time constant.
+//
+
+namespace
+{
+struct ThermalModel
+{
+    float OutsideTemperature;
+    float HeatGain;           // steady-state temperature rise over outside at 100% duty [C]
+    float TimeConstant_hours;
+    uint32_t DeadTime_msec;
+
+    float RoomTemperature;
+};
+
+struct SimulationResult
+{
+    float Overshoot;          // maximum temperature above setpoint after first reaching it [C]
+    float MeanAbsoluteError;  // over the second half of the simulation [C]
+    uint32_t HeatCycles;      // off -> on relay transitions
+};
+
+SimulationResult Simulate(SyntheticConfiguration const& configuration,
+                          ThermalModel model,
+                          float const setPoint,
+                          uint32_t const duration_msec)
+{
+    uint32_t constexpr step_msec = 30 * 1000;  // control cadence
+
+    Thermostat thermostat;
+    thermostat.Initialize();
+
+    ThermostatSetpoint const thermostatSetpoint(ThermostatAction::Heat, setPoint, 100, 100, 0);
+
+    // Heat actions in flight (dead time delay line)
+    std::vector<bool> heatDelayLine(model.DeadTime_msec / step_msec + 1, false);
+    size_t idxDelayLine = 0;
+
+    SimulationResult result = {0.0f, 0.0f, 0};
+
+    bool fHasReachedSetPoint = false;
+    bool fWasHeating = false;
+
+    float sumAbsoluteError = 0.0f;
+    uint32_t cErrorSamples = 0;
+
+    for (uint32_t time_msec = 0; time_msec < duration_msec; time_msec += step_msec)
+    {
+        thermostat.Apply(configuration, thermostatSetpoint, model.RoomTemperature, time_msec);
+
+        bool const fIsHeating = !!(thermostat.CurrentActions() & ThermostatAction::Heat);
+
+        if (fIsHeating && !fWasHeating)
+        {
+            ++result.HeatCycles;
+        }
+
+        fWasHeating = fIsHeating;
+
+        // Advance model
+        heatDelayLine[idxDelayLine] = fIsHeating;
+        idxDelayLine = (idxDelayLine + 1) % heatDelayLine.size();
+
+        bool const fIsDeliveringHeat = heatDelayLine[idxDelayLine];
+
+        float const steadyStateTemperature = model.OutsideTemperature + (fIsDeliveringHeat ? model.HeatGain : 0.0f);
+        float const step_hours = step_msec / (60.0f * 60.0f * 1000.0f);
+
+        model.RoomTemperature +=
+            (steadyStateTemperature - model.RoomTemperature) * (step_hours / model.TimeConstant_hours);
+
+        // Collect metrics
+        if (model.RoomTemperature >= setPoint)
+        {
+            fHasReachedSetPoint = true;
+        }
+
+        if (fHasReachedSetPoint)
+        {
+            result.Overshoot = std::max(result.Overshoot, model.RoomTemperature - setPoint);
+        }
+
+        if (time_msec >= duration_msec / 2)
+        {
+            sumAbsoluteError += std::abs(model.RoomTemperature - setPoint);
+            ++cErrorSamples;
+        }
+    }
+
+    result.MeanAbsoluteError = sumAbsoluteError / cErrorSamples;
+
+    return result;
+}
+}  // namespace
+
+SCENARIO("Time-proportioning PI control outperforms hysteresis on a slow radiant system", "[ThermostatSimulation]")
+{
+    ThermalModel const radiantSlab = {
+        5.0f /* outside */, 25.0f /* gain */, 6.0f /* time constant */, 45 * 60 * 1000 /* dead time */, 16.0f};
+
+    float constexpr setPoint = 20.0f;
+    uint32_t constexpr duration_msec = 48 * 60 * 60 * 1000;
+
+    GIVEN("The same house controlled by hysteresis and by PI control")
+    {
+        SyntheticConfiguration hysteresisConfiguration;
+        hysteresisConfiguration.SetThreshold(0.5f);
+        hysteresisConfiguration.Build();
+
+        SyntheticConfiguration piConfiguration;
+        piConfiguration.SetThreshold(0.5f);
+        piConfiguration.SetControlMode(ControlMode::TimeProportional, 20, 5, 15 * 60);
+        piConfiguration.Build();
+
+        WHEN("Both recover from a setback and hold the setpoint for two days")
+        {
+            SimulationResult const hysteresis = Simulate(hysteresisConfiguration, radiantSlab, setPoint, duration_msec);
+            SimulationResult const pi = Simulate(piConfiguration, radiantSlab, setPoint, duration_msec);
+
+            CAPTURE(hysteresis.Overshoot, hysteresis.MeanAbsoluteError, hysteresis.HeatCycles);
+            CAPTURE(pi.Overshoot, pi.MeanAbsoluteError, pi.HeatCycles);
+
+            THEN("PI control overshoots less and tracks the setpoint more closely")
+            {
+                REQUIRE(pi.Overshoot < hysteresis.Overshoot);
+                REQUIRE(pi.MeanAbsoluteError < hysteresis.MeanAbsoluteError);
+            }
+        }
+    }
+}
+
+SCENARIO("Time-proportioning PI controller behaves", "[TimeProportionalController]")
+{
+    unsigned long constexpr window_msec = 10 * 60 * 1000;
+
+    GIVEN("A fresh controller")
+    {
+        TimeProportionalController controller;
+
+        WHEN("The error is large")
+        {
+            bool const fIsOn = controller.Update(10.0f, 0.5f, 0.25f, window_msec, 0);
+
+            THEN("The output saturates at full duty")
+            {
+                REQUIRE(fIsOn);
+                REQUIRE(controller.Duty() == 1.0f);
+            }
+        }
+
+        WHEN("The error is moderate")
+        {
+            controller.Update(1.0f, 0.5f, 0.0f, window_msec, 0);
+
+            THEN("The relay is on for the duty fraction of the window, then off")
+            {
+                REQUIRE(controller.Duty() == 0.5f);
+                REQUIRE(controller.Update(1.0f, 0.5f, 0.0f, window_msec, window_msec / 2 - 1));
+                REQUIRE(!controller.Update(1.0f, 0.5f, 0.0f, window_msec, window_msec / 2));
+                REQUIRE(!controller.Update(1.0f, 0.5f, 0.0f, window_msec, window_msec - 1));
+            }
+
+            THEN("The next window starts on again")
+            {
+                REQUIRE(controller.Update(1.0f, 0.5f, 0.0f, window_msec, window_msec));
+            }
+        }
+
+        WHEN("The output has been saturated for a long time")
+        {
+            for (unsigned long time_msec = 0; time_msec < 24 * window_msec; time_msec += 30 * 1000)
+            {
+                controller.Update(10.0f, 0.5f, 0.25f, window_msec, time_msec);
+            }
+
+            THEN("The integral term doesn't wind up past full output and recovers as soon as the error reverses")
+            {
+                controller.Update(-1.0f, 0.5f, 0.25f, window_msec, 24 * window_msec);
+                REQUIRE(controller.Duty() <= 0.5f);
+            }
+        }
+    }
+}
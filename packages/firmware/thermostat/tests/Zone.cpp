@@ -0,0 +1,196 @@
+#include "base.h"
+
+namespace
+{
+uint64_t constexpr c_SensorIdA = 0x1111111111111128ull;
+uint64_t constexpr c_SensorIdB = 0x2222222222222228ull;
+
+OneWireAddress const rgAddresses[] = {OneWireAddress(c_SensorIdA), OneWireAddress(c_SensorIdB)};
+
+uint8_t constexpr c_RelayPin_NotConnected = 255;
+}  // namespace
+
+SCENARIO("Zones drive their own relays off a shared acquisition", "[Zone]")
+{
+    EEPROM.testErase();
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+
+    ThermostatSetpoint const setpointLiving(ThermostatAction::Heat, 20.0f, 30.0f, 100, 0);
+    ThermostatSetpoint const setpointBedroom(ThermostatAction::Heat, 17.0f, 30.0f, 100, 0);
+
+    GIVEN("Two zones with their own sensors, settings, and relay pins")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointLiving);   // Setting 0
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointBedroom);  // Setting 1
+        configuration.AddZone(0 /* operable temperature */, 0x1, D3, D4, D5);
+        configuration.AddZone(c_SensorIdB, 0x2, A3, A4, c_RelayPin_NotConnected);
+        configuration.Build();
+
+        REQUIRE(Zone::GetZoneCount(configuration) == 2);
+
+        Zone rgZones[Zone::sc_cZones_Max];
+
+        for (uint8_t idxZone = 0; idxZone < Zone::GetZoneCount(configuration); ++idxZone)
+        {
+            rgZones[idxZone].Initialize(configuration, idxZone, 0);
+        }
+
+        WHEN("Both zones are evaluated off the same readings")
+        {
+            float const operableTemperature = 18.0f;
+            float const rgTemperatures[] = {25.0f, 15.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<2>(rgAddresses, rgTemperatures, countof(rgAddresses));
+
+            for (uint8_t idxZone = 0; idxZone < Zone::GetZoneCount(configuration); ++idxZone)
+            {
+                Zone& zone = rgZones[idxZone];
+                zone.Apply(configuration,
+                           zone.SelectTemperature(operableTemperature, sensorRegistry),
+                           Time.testGetMillis());
+            }
+
+            THEN("Each zone follows its own sensor and settings")
+            {
+                REQUIRE(rgZones[0].OperableTemperature() == 18.0f);
+                REQUIRE(rgZones[0].CurrentSetpoint() == setpointLiving);
+                REQUIRE(rgZones[0].CurrentActions() == ThermostatAction::Heat);
+
+                REQUIRE(rgZones[1].OperableTemperature() == 15.0f);
+                REQUIRE(rgZones[1].CurrentSetpoint() == setpointBedroom);
+                REQUIRE(rgZones[1].CurrentActions() == ThermostatAction::Heat);
+            }
+
+            THEN("Each zone drives its own relay pins")
+            {
+                REQUIRE(testGetPinValues()[D3] == 1);
+                REQUIRE(testGetPinValues()[D4] == 0);
+                REQUIRE(testGetPinValues()[D5] == 1);
+
+                REQUIRE(testGetPinValues()[A3] == 1);
+                REQUIRE(testGetPinValues()[A4] == 0);
+            }
+
+            AND_WHEN("The second zone is shut down")
+            {
+                rgZones[1].Shutdown(Time.testGetMillis());
+
+                THEN("Only its relays are released")
+                {
+                    REQUIRE(testGetPinValues()[D3] == 1);
+                    REQUIRE(testGetPinValues()[A3] == 0);
+                }
+            }
+        }
+
+        WHEN("A zone's sensor isn't on the bus")
+        {
+            float const rgTemperatures[] = {25.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<2>(rgAddresses, rgTemperatures, 1);
+
+            THEN("It has no temperature to go by")
+            {
+                REQUIRE(std::isnan(rgZones[1].SelectTemperature(20.0f, sensorRegistry)));
+            }
+        }
+    }
+
+    GIVEN("A configuration without zones")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointLiving);
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpointBedroom);
+        configuration.Build();
+
+        THEN("There's a single legacy zone on the default relay pins using all settings")
+        {
+            REQUIRE(Zone::GetZoneCount(configuration) == 1);
+
+            Zone zone;
+            zone.Initialize(configuration, 0, 0);
+
+            float const rgTemperatures[] = {10.0f, 10.0f};
+            auto const sensorRegistry = SyntheticSensorRegistry<2>(rgAddresses, rgTemperatures, countof(rgAddresses));
+            float const temperature = zone.SelectTemperature(21.0f, sensorRegistry);
+
+            REQUIRE(temperature == 21.0f);
+
+            zone.Apply(configuration, temperature, Time.testGetMillis());
+
+            REQUIRE(zone.CurrentSetpoint() == setpointLiving);  // First of equally recent settings wins, as before
+            REQUIRE(zone.CurrentActions() == ThermostatAction::NONE);
+            REQUIRE(testGetPinValues()[A0] == 0);
+        }
+    }
+}
+
+SCENARIO("Zones may override the configuration's control settings", "[Zone]")
+{
+    EEPROM.testErase();
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 12, 0);
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 30.0f, 100, 0);
+
+    GIVEN("A hysteresis configuration with a zone left on it and a zone on time-proportional control")
+    {
+        SyntheticConfiguration configuration;
+        configuration.AddScheduledSetting(DaysOfWeek::Monday, 0, setpoint);
+        configuration.AddZone(0 /* operable temperature */, 0);
+        configuration.AddZone(0 /* operable temperature */, 0);
+        configuration.SetZoneControlMode(1, ZoneControlMode::TimeProportional, 100, 10, 10 * 60);
+        configuration.Build();
+
+        THEN("Zones without their own control settings follow the configuration's")
+        {
+            Thermostat::ControlSettings const controlSettings = Thermostat::GetControlSettings(configuration, 0);
+
+            REQUIRE(controlSettings.Mode == ControlMode::Hysteresis);
+            REQUIRE(controlSettings.ProportionalGain == 0.2f);
+            REQUIRE(controlSettings.IntegralGain_PerHour == 0.05f);
+            REQUIRE(controlSettings.Window_msec == 900 * 1000UL);
+        }
+
+        THEN("Zones with their own control settings use them")
+        {
+            Thermostat::ControlSettings const controlSettings = Thermostat::GetControlSettings(configuration, 1);
+
+            REQUIRE(controlSettings.Mode == ControlMode::TimeProportional);
+            REQUIRE(controlSettings.ProportionalGain == 1.0f);
+            REQUIRE(controlSettings.IntegralGain_PerHour == 0.1f);
+            REQUIRE(controlSettings.Window_msec == 600 * 1000UL);
+        }
+
+        WHEN("Both zones are slightly below the heat setpoint (within the hysteresis threshold)")
+        {
+            Zone rgZones[Zone::sc_cZones_Max];
+
+            for (uint8_t idxZone = 0; idxZone < Zone::GetZoneCount(configuration); ++idxZone)
+            {
+                rgZones[idxZone].Initialize(configuration, idxZone, 0);
+                rgZones[idxZone].Apply(configuration, 19.8f, Time.testGetMillis());
+            }
+
+            THEN("Only the time-proportional zone heats, for its share of the window")
+            {
+                REQUIRE(rgZones[0].CurrentActions() == ThermostatAction::NONE);
+                REQUIRE(rgZones[1].CurrentActions() == ThermostatAction::Heat);
+            }
+        }
+    }
+
+    GIVEN("A time-proportional configuration with a zone on hysteresis control")
+    {
+        SyntheticConfiguration configuration;
+        configuration.SetControlMode(ControlMode::TimeProportional, 20, 5, 15 * 60);
+        configuration.AddZone(0 /* operable temperature */, 0);
+        configuration.AddZone(0 /* operable temperature */, 0);
+        configuration.SetZoneControlMode(0, ZoneControlMode::Hysteresis, 0, 0, 0);
+        configuration.Build();
+
+        THEN("Each zone uses its own control mode")
+        {
+            REQUIRE(Thermostat::GetControlSettings(configuration, 0).Mode == ControlMode::Hysteresis);
+            REQUIRE(Thermostat::GetControlSettings(configuration, 1).Mode == ControlMode::TimeProportional);
+        }
+    }
+}
@@ -20,8 +20,8 @@
 #include "mocks/locks.h"
 #include "mocks/particle.h"
 #include "mocks/serial.h"
-#include "mocks/system.h"
 #include "mocks/time.h"
+#include "mocks/system.h"  // (After time.h: sleep advances the virtual clock)
 #include "mocks/wifi.h"
 #include "mocks/wire.h"
 
@@ -32,4 +32,7 @@
 #include "test_streams.h"
 
 // Helpers
+#include "CostAccounting.h"
+#include "SimulatedOneWireBus.h"
 #include "SyntheticConfiguration.h"
+#include "SyntheticSensorRegistry.h"
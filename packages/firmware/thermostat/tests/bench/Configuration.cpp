@@ -0,0 +1,177 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("Configuration", "[bench]")
+{
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+    SyntheticConfiguration syntheticConfiguration;
+
+    for (uint16_t idxSetting = 0; idxSetting < 6; ++idxSetting)
+    {
+        syntheticConfiguration.AddScheduledSetting(DaysOfWeek::Monday, idxSetting * 60, setpoint);
+    }
+
+    syntheticConfiguration.Build();
+
+    std::string const& encodedConfiguration = syntheticConfiguration.EncodedConfiguration();
+
+    // Status responses usually carry the configuration we already have,
+    // so this exercises decoding, verification, and comparison
+    Configuration configuration;
+
+    REQUIRE(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Accepted);
+    REQUIRE(configuration.AcceptPendingUpdates());
+    REQUIRE(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Retained);
+
+    Bench::Run("Configuration::SubmitUpdate (retained, 6 settings)", [&]() {
+        Bench::DoNotOptimize(configuration.SubmitUpdate(encodedConfiguration.c_str(), encodedConfiguration.size()));
+    });
+}
+
+namespace
+{
+// Builds a configuration with zones (relays all connected) and timezone transitions at their limits,
+// and the given number of settings and sensor fusion inputs
+bool TryBuildConfiguration(uint32_t const cSettings, uint32_t const cSensorFusionInputs, std::string& encoded)
+{
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat | ThermostatAction::Cool, 20.0f, 25.0f, 100, 0);
+
+    uint8_t const rgRelayPins[][3] = {{D3, D4, D5}, {A0, A1, A2}, {A3, A4, A5}, {A6, A7, RX}};
+    static_assert(countof(rgRelayPins) == Configuration::sc_cZones_Max, "Relay pins needed for every zone");
+
+    SyntheticConfiguration syntheticConfiguration;
+
+    for (uint16_t idxSetting = 0; idxSetting < cSettings; ++idxSetting)
+    {
+        syntheticConfiguration.AddScheduledSetting(DaysOfWeek::Monday, idxSetting * 30, setpoint);
+    }
+
+    for (uint8_t idxZone = 0; idxZone < Configuration::sc_cZones_Max; ++idxZone)
+    {
+        syntheticConfiguration.AddZone(
+            0, 1 << idxZone, rgRelayPins[idxZone][0], rgRelayPins[idxZone][1], rgRelayPins[idxZone][2]);
+    }
+
+    for (uint32_t idxInput = 0; idxInput < cSensorFusionInputs; ++idxInput)
+    {
+        syntheticConfiguration.AddSensorFusionInput(idxInput ? 0x2800000000000000ull + idxInput : 0, 1);
+    }
+
+    for (uint32_t idxTransition = 0; idxTransition < Configuration::sc_cTimezoneTransitions_Max; ++idxTransition)
+    {
+        syntheticConfiguration.AddTimezoneTransition(1600000000 + idxTransition * 180 * 24 * 60 * 60,
+                                                     (idxTransition % 2) ? 480 : 420);
+    }
+
+    if (!syntheticConfiguration.TryBuild())
+    {
+        return false;
+    }
+
+    encoded = syntheticConfiguration.EncodedConfiguration();
+    return true;
+}
+
+// Builds the worst-case configuration that fits into the configuration buffer: zones and timezone transitions
+// at their limits, as many sensor fusion inputs as fit alongside them, and settings filling up the rest
+// (i.e. every vector populated, and as much data as there can be to decode and verify)
+std::string BuildLargestConfiguration()
+{
+    std::string encoded;
+
+    uint32_t cSensorFusionInputs = Configuration::sc_cSensorFusionInputs_Max;
+
+    while (cSensorFusionInputs > 0 && !TryBuildConfiguration(0, cSensorFusionInputs, encoded))
+    {
+        --cSensorFusionInputs;
+    }
+
+    for (uint32_t cSettings = 1; cSettings <= Configuration::sc_cThermostatSettings_Max; ++cSettings)
+    {
+        if (!TryBuildConfiguration(cSettings, cSensorFusionInputs, encoded))
+        {
+            break;
+        }
+    }
+
+    return encoded;
+}
+}  // namespace
+
+TEST_CASE("Configuration worst-case ingestion", "[bench]")
+{
+    std::string const largestConfiguration = BuildLargestConfiguration();
+    REQUIRE(!largestConfiguration.empty());
+
+    // (Within a settings' worth of filling the buffer)
+    size_t const cbLargestConfiguration = largestConfiguration.size() * 4 / 5;
+    size_t const cbFlatbufferData_Max = Configuration::sc_cbFlatbufferData_Max;
+    REQUIRE(cbLargestConfiguration + sizeof(Flatbuffers::Firmware::ThermostatSetting) > cbFlatbufferData_Max);
+
+    Configuration configuration;
+    configuration.Initialize();
+
+    // Largest valid configuration: decoded, verified end-to-end, compared, and accepted
+    REQUIRE(configuration.SubmitUpdate(largestConfiguration.c_str(), largestConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Accepted);
+
+    Bench::Run("Configuration::SubmitUpdate (accepted, largest configuration)", [&]() {
+        Bench::DoNotOptimize(configuration.SubmitUpdate(largestConfiguration.c_str(), largestConfiguration.size()));
+    });
+
+    // Invalid character at the very end: fully decoded before being rejected
+    std::string invalidTextConfiguration(largestConfiguration);
+    invalidTextConfiguration.back() = '\x80';
+
+    REQUIRE(configuration.SubmitUpdate(invalidTextConfiguration.c_str(), invalidTextConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Invalid);
+
+    Bench::Run("Configuration::SubmitUpdate (invalid, bad character at end of largest configuration)", [&]() {
+        Bench::DoNotOptimize(
+            configuration.SubmitUpdate(invalidTextConfiguration.c_str(), invalidTextConfiguration.size()));
+    });
+
+    // Truncated flatbuffer: flatbuffers are built back to front so the first-built vectors go missing,
+    // leaving the verifier to get through the root table and the remaining vectors before rejecting it
+    std::string const truncatedConfiguration = largestConfiguration.substr(0, largestConfiguration.size() - 5);
+
+    REQUIRE(configuration.SubmitUpdate(truncatedConfiguration.c_str(), truncatedConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Invalid);
+
+    Bench::Run("Configuration::SubmitUpdate (invalid, truncated largest configuration)", [&]() {
+        Bench::DoNotOptimize(configuration.SubmitUpdate(truncatedConfiguration.c_str(), truncatedConfiguration.size()));
+    });
+
+    // Oversized: rejected before decoding
+    std::string const oversizedConfiguration(2 * largestConfiguration.size(), '0');
+
+    REQUIRE(configuration.SubmitUpdate(oversizedConfiguration.c_str(), oversizedConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Invalid);
+
+    Bench::Run("Configuration::SubmitUpdate (invalid, oversized)", [&]() {
+        Bench::DoNotOptimize(configuration.SubmitUpdate(oversizedConfiguration.c_str(), oversizedConfiguration.size()));
+    });
+
+    // Boot: loading the largest configuration from EEPROM, with and without having verified it before the reset
+    REQUIRE(configuration.SubmitUpdate(largestConfiguration.c_str(), largestConfiguration.size()) ==
+            Configuration::ConfigUpdateResult::Accepted);
+    REQUIRE(configuration.AcceptPendingUpdates());
+    configuration.SaveData();
+
+    uint32_t const verifiedHash = configuration.Hash();
+
+    Bench::Run("Configuration::Initialize (largest configuration, verifying)", [&]() {
+        Configuration bootConfiguration;
+        bootConfiguration.Initialize();
+        Bench::DoNotOptimize(bootConfiguration.Hash());
+    });
+
+    Bench::Run("Configuration::Initialize (largest configuration, verified before reset)", [&]() {
+        Configuration bootConfiguration;
+        bootConfiguration.Initialize(verifiedHash);
+        Bench::DoNotOptimize(bootConfiguration.Hash());
+    });
+}
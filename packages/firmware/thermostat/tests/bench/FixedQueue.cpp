@@ -0,0 +1,30 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("FixedQueue", "[bench]")
+{
+    // Same shape as StatusPublisher's queue
+    FixedQueue<622, 8> queue;
+
+    char const szItem[] =
+        "{\"ts\":1577836800,\"ser\":1234,\"t\":21.5,\"h\":40.0,\"ca\":\"H\",\"cc\":{\"sh\":20.0,\"sc\":25.0}}";
+
+    Bench::Run("FixedQueue::push+pop (80 chars)", [&]() {
+        queue.push(szItem);
+        Bench::DoNotOptimize(queue.front());
+        queue.pop();
+    });
+
+    // Fill the queue so pushes have to evict
+    for (size_t idxItem = 0; idxItem < queue.capacity(); ++idxItem)
+    {
+        queue.push(szItem);
+    }
+
+    REQUIRE(queue.size() == queue.capacity());
+
+    Bench::Run("FixedQueue::push (full, evicting, 80 chars)", [&]() {
+        queue.push(szItem);
+        Bench::DoNotOptimize(queue.front());
+    });
+}
@@ -0,0 +1,15 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("OneWireCRC", "[bench]")
+{
+    // DS18B20 scratchpad (eight data bytes followed by their CRC)
+    uint8_t const rgScratchpad[] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10, 0x1C};
+
+    REQUIRE(OneWireCRC::Compute(rgScratchpad, countof(rgScratchpad)) == 0);
+
+    Bench::Run("OneWireCRC::Compute (9-byte scratchpad)", [&]() {
+        Bench::DoNotOptimize(rgScratchpad);
+        Bench::DoNotOptimize(OneWireCRC::Compute(rgScratchpad, countof(rgScratchpad)));
+    });
+}
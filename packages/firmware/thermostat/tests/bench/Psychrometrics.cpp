@@ -0,0 +1,41 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("Psychrometrics", "[bench]")
+{
+    // A spread of indoor readings so nothing gets folded into constants
+    float rgTemperatures[16];
+    float rgHumidities[countof(rgTemperatures)];
+
+    for (size_t idxSample = 0; idxSample < countof(rgTemperatures); ++idxSample)
+    {
+        rgTemperatures[idxSample] = 15.0f + idxSample * 0.7f;
+        rgHumidities[idxSample] = 30.0f + idxSample * 3.1f;
+    }
+
+    Bench::DoNotOptimize(rgTemperatures);
+    Bench::DoNotOptimize(rgHumidities);
+
+    Bench::Run("Psychrometrics::DewPoint (16 readings)", [&]() {
+        for (size_t idxSample = 0; idxSample < countof(rgTemperatures); ++idxSample)
+        {
+            Bench::DoNotOptimize(Psychrometrics::DewPoint(rgTemperatures[idxSample], rgHumidities[idxSample]));
+        }
+    });
+
+    Bench::Run("Psychrometrics::AbsoluteHumidity (16 readings)", [&]() {
+        for (size_t idxSample = 0; idxSample < countof(rgTemperatures); ++idxSample)
+        {
+            Bench::DoNotOptimize(
+                Psychrometrics::AbsoluteHumidity(rgTemperatures[idxSample], rgHumidities[idxSample]));
+        }
+    });
+
+    // Reference: double precision NOAA formula as used by PietteTech_DHT::getDewPointSlow()
+    Bench::Run("PietteTech_DHT::dewPointSlow (16 readings)", [&]() {
+        for (size_t idxSample = 0; idxSample < countof(rgTemperatures); ++idxSample)
+        {
+            Bench::DoNotOptimize(PietteTech_DHT::dewPointSlow(rgTemperatures[idxSample], rgHumidities[idxSample]));
+        }
+    });
+}
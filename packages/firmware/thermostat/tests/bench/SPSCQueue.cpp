@@ -0,0 +1,116 @@
+#include <thread>  // (Ahead of base.h, whose CoreDefs.h defines __out)
+
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("SPSCQueue", "[bench]")
+{
+    SPSCQueue<uint32_t, 16> queue;
+    uint32_t item = 0;
+
+    Bench::Run("SPSCQueue::push+pop (uint32_t, single thread)", [&]() {
+        queue.push(++item);
+        queue.pop(item);
+        Bench::DoNotOptimize(item);
+    });
+
+    REQUIRE(queue.empty());
+
+    // Throughput of handing items to a consumer thread that drains the queue as fast as it can
+    std::atomic<bool> fStop(false);
+    std::atomic<uint32_t> cItemsConsumed(0);
+
+    std::thread consumerThread([&]() {
+        uint32_t consumedItem = 0;
+
+        while (!fStop.load(std::memory_order_relaxed))
+        {
+            if (queue.pop(consumedItem))
+            {
+                cItemsConsumed.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t cItemsProduced = 0;
+
+    Bench::Run("SPSCQueue::push (uint32_t, to consumer thread)", [&]() {
+        while (!queue.push(cItemsProduced))
+        {
+            // (Yielding rather than spinning so this works out on single-core hosts, too)
+            std::this_thread::yield();
+        }
+
+        ++cItemsProduced;
+    });
+
+    while (!queue.empty())
+    {
+        std::this_thread::yield();
+    }
+
+    fStop = true;
+    consumerThread.join();
+
+    REQUIRE(cItemsConsumed.load() == cItemsProduced);
+}
+
+TEST_CASE("AcquisitionChannel", "[bench]")
+{
+    // Same shape as Main.cpp's
+    typedef SensorSnapshot<16> Readings;
+
+    struct Request
+    {
+        unsigned long MaximumOnboardAge_msec;
+    };
+
+    AcquisitionChannel<Request, Readings> channel;
+    Readings readings;
+
+    std::atomic<bool> fStop(false);
+
+    std::thread acquisitionThread([&]() {
+        auto const acquire = [](Request const& request, Readings& acquiredReadings) {
+            acquiredReadings.Reset();
+            acquiredReadings.AcquisitionTime_msec = request.MaximumOnboardAge_msec;
+
+            for (size_t idxSensor = 0; idxSensor < 8; ++idxSensor)
+            {
+                acquiredReadings.AddSensor(OneWireAddress(0x28 + idxSensor));
+                acquiredReadings.SetReading(idxSensor, 20.0f + idxSensor, request.MaximumOnboardAge_msec);
+            }
+        };
+
+        while (!fStop.load(std::memory_order_relaxed))
+        {
+            if (!channel.Service(acquire))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    unsigned long cRoundTrips = 0;
+
+    Bench::Run("AcquisitionChannel request+receive (8 sensors, round trip between threads)", [&]() {
+        channel.Request(Request{++cRoundTrips});
+
+        while (!channel.Receive(readings))
+        {
+            std::this_thread::yield();
+        }
+
+        Bench::DoNotOptimize(readings.AcquisitionTime_msec);
+    });
+
+    fStop = true;
+    acquisitionThread.join();
+
+    REQUIRE(readings.AcquisitionTime_msec == cRoundTrips);
+    REQUIRE(readings.cSensors == 8);
+}
@@ -0,0 +1,48 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("StatusPublisher", "[bench]")
+{
+    uint8_t constexpr cOneWireDevices_Max = 16;
+
+    SyntheticConfiguration configuration;
+    configuration.Build();
+
+    ThermostatSetpoint const setpoint(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+
+    // Aggregate a publish window's worth of samples from a fully populated bus
+    SensorSnapshot<cOneWireDevices_Max> snapshot;
+    snapshot.OnboardTemperature = 20.5f;
+    snapshot.OnboardHumidity = 40.0f;
+    snapshot.OperableTemperature = 20.5f;
+
+    for (size_t idxSensor = 0; idxSensor < cOneWireDevices_Max; ++idxSensor)
+    {
+        REQUIRE(snapshot.AddSensor(OneWireAddress(0x1000000000000028ull + (idxSensor << 8))));
+        snapshot.SetReading(idxSensor, 18.0f + idxSensor * 0.25f, 0);
+    }
+
+    SensorRegistry<cOneWireDevices_Max> sensorRegistry;
+    sensorRegistry.Update(snapshot);
+
+    StatusAggregator<cOneWireDevices_Max> aggregator;
+
+    for (unsigned long idxSample = 0; idxSample < 6; ++idxSample)
+    {
+        aggregator.AddSample(idxSample * 60 * 1000, ThermostatAction::Heat, snapshot, sensorRegistry);
+    }
+
+    SensorFusion<cOneWireDevices_Max> sensorFusion;
+    Zone rgZones[1];
+
+    StatusPublisher<cOneWireDevices_Max> statusPublisher;
+
+    // Measure formatting and queuing rather than the mock's console output
+    Particle.testSetConnected(false);
+
+    Bench::Run("StatusPublisher::Publish (16 sensors, offline)", [&]() {
+        statusPublisher.Publish(configuration, setpoint, ThermostatAction::Heat, aggregator, sensorFusion, rgZones, 1);
+    });
+
+    Particle.testSetConnected(true);
+}
@@ -0,0 +1,35 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("ThermostatSetpointScheduler", "[bench]")
+{
+    ThermostatSetpoint const setpointDay(ThermostatAction::Heat, 20.0f, 25.0f, 100, 0);
+    ThermostatSetpoint const setpointNight(ThermostatAction::Heat, 16.0f, 25.0f, 100, 0);
+
+    // Largest realistic schedule that fits the configuration buffer (c.f. Configuration::sc_cbFlatbufferData_Max)
+    SyntheticConfiguration configuration;
+    configuration.AddScheduledSetting(DaysOfWeek::Monday | DaysOfWeek::Tuesday | DaysOfWeek::Wednesday |
+                                          DaysOfWeek::Thursday | DaysOfWeek::Friday,
+                                      6 * 60,
+                                      setpointDay);
+    configuration.AddScheduledSetting(DaysOfWeek::Monday | DaysOfWeek::Tuesday | DaysOfWeek::Wednesday |
+                                          DaysOfWeek::Thursday | DaysOfWeek::Friday,
+                                      22 * 60,
+                                      setpointNight);
+    configuration.AddScheduledSetting(DaysOfWeek::Saturday | DaysOfWeek::Sunday, 8 * 60, setpointDay);
+    configuration.AddScheduledSetting(DaysOfWeek::Saturday | DaysOfWeek::Sunday, 23 * 60, setpointNight);
+    configuration.AddScheduledSetting(DaysOfWeek::Wednesday, 12 * 60, setpointNight);
+    configuration.AddHoldSetting(0 /* expired */, setpointNight);
+    configuration.Build();
+
+    ThermostatSetpointScheduler scheduler;
+
+    // Early Monday morning, so the scheduler has to look back into the previous week
+    Time.testSetLocalTime(ParticleDayOfWeek::Monday, 1, 0);
+
+    REQUIRE(scheduler.getCurrentThermostatSetpoint(configuration) == setpointNight);
+
+    Bench::Run("ThermostatSetpointScheduler::getCurrentThermostatSetpoint (6 settings)", [&]() {
+        Bench::DoNotOptimize(scheduler.getCurrentThermostatSetpoint(configuration));
+    });
+}
@@ -0,0 +1,33 @@
+#include "base.h"
+#include "bench.h"
+
+TEST_CASE("Z85", "[bench]")
+{
+    // Typical configuration size (c.f. Configuration::sc_cbFlatbufferData_Max)
+    uint8_t rgData[256];
+
+    for (size_t idxData = 0; idxData < countof(rgData); ++idxData)
+    {
+        rgData[idxData] = static_cast<uint8_t>(idxData * 7 + 3);
+    }
+
+    char rgEncoded[countof(rgData) * 5 / 4 + 1 /* terminator */];
+    uint16_t const cchEncoded = Z85::EncodeBytes(rgEncoded, countof(rgEncoded), rgData, countof(rgData));
+
+    REQUIRE(cchEncoded == countof(rgData) * 5 / 4);
+
+    Bench::Run("Z85::EncodeBytes (256 bytes)", [&]() {
+        Bench::DoNotOptimize(Z85::EncodeBytes(rgEncoded, countof(rgEncoded), rgData, countof(rgData)));
+        Bench::DoNotOptimize(rgEncoded);
+    });
+
+    uint8_t rgDecoded[countof(rgData)];
+
+    REQUIRE(Z85::DecodeBytes(rgDecoded, countof(rgDecoded), rgEncoded, cchEncoded) == countof(rgData));
+    REQUIRE(memcmp(rgDecoded, rgData, countof(rgData)) == 0);
+
+    Bench::Run("Z85::DecodeBytes (256 bytes)", [&]() {
+        Bench::DoNotOptimize(Z85::DecodeBytes(rgDecoded, countof(rgDecoded), rgEncoded, cchEncoded));
+        Bench::DoNotOptimize(rgDecoded);
+    });
+}
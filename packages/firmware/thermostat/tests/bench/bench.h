@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+//
+// Minimal microbenchmark harness for host-compilable firmware components (c.f. `npm run bench`).
+//
+// Benchmarks are Catch test cases (so they can REQUIRE their setup is sane) that call Bench::Run().
+// Each benchmark body is first run for a warmup period, then calibrated to an iteration count
+// that takes at least Settings::SampleTarget_nsec per sample, then timed for Settings::cSamples samples.
+//
+// Results are reported as nanoseconds per iteration and written out as JSON by bench/main.cpp;
+// medians are the figure to compare across commits (means are skewed by scheduling noise).
+//
+
+namespace Bench
+{
+struct Settings
+{
+    uint32_t cSamples = 25;
+    uint64_t Warmup_nsec = 100 * 1000 * 1000;
+    uint64_t SampleTarget_nsec = 10 * 1000 * 1000;
+};
+
+struct Result
+{
+    std::string Name;
+    uint64_t cIterationsPerSample;
+    std::vector<double> rgSamples_nsecPerIteration;
+
+    double Mean() const
+    {
+        double sum = 0;
+
+        for (double const sample : rgSamples_nsecPerIteration)
+        {
+            sum += sample;
+        }
+
+        return sum / rgSamples_nsecPerIteration.size();
+    }
+
+    double StandardDeviation() const
+    {
+        double const mean = Mean();
+        double sumSquaredDeviations = 0;
+
+        for (double const sample : rgSamples_nsecPerIteration)
+        {
+            sumSquaredDeviations += (sample - mean) * (sample - mean);
+        }
+
+        return (rgSamples_nsecPerIteration.size() > 1)
+                   ? std::sqrt(sumSquaredDeviations / (rgSamples_nsecPerIteration.size() - 1))
+                   : 0.0;
+    }
+
+    double Median() const
+    {
+        std::vector<double> sortedSamples(rgSamples_nsecPerIteration);
+        std::sort(sortedSamples.begin(), sortedSamples.end());
+
+        size_t const idxMiddle = sortedSamples.size() / 2;
+
+        return (sortedSamples.size() % 2) ? sortedSamples[idxMiddle]
+                                          : (sortedSamples[idxMiddle - 1] + sortedSamples[idxMiddle]) / 2;
+    }
+
+    double Min() const
+    {
+        return *std::min_element(rgSamples_nsecPerIteration.begin(), rgSamples_nsecPerIteration.end());
+    }
+
+    double Max() const
+    {
+        return *std::max_element(rgSamples_nsecPerIteration.begin(), rgSamples_nsecPerIteration.end());
+    }
+};
+
+inline Settings& GetSettings()
+{
+    static Settings s_Settings;
+    return s_Settings;
+}
+
+inline std::vector<Result>& GetResults()
+{
+    static std::vector<Result> s_Results;
+    return s_Results;
+}
+
+// Keeps the compiler from optimizing away computations whose results are otherwise unused
+template <typename T>
+inline void DoNotOptimize(T const& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename TBody>
+uint64_t TimeIterations_nsec(TBody& body, uint64_t const cIterations)
+{
+    auto const startTime = std::chrono::steady_clock::now();
+
+    for (uint64_t idxIteration = 0; idxIteration < cIterations; ++idxIteration)
+    {
+        body();
+    }
+
+    auto const endTime = std::chrono::steady_clock::now();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+}
+
+template <typename TBody>
+void Run(char const* const szName, TBody body)
+{
+    Settings const& settings = GetSettings();
+
+    // Warm up (caches, branch predictors, CPU clocks) while calibrating iterations per sample
+    uint64_t cIterationsPerSample = 1;
+    uint64_t elapsedWarmup_nsec = 0;
+
+    while (true)
+    {
+        uint64_t const elapsed_nsec = TimeIterations_nsec(body, cIterationsPerSample);
+        elapsedWarmup_nsec += elapsed_nsec;
+
+        if (elapsed_nsec < settings.SampleTarget_nsec)
+        {
+            cIterationsPerSample *= 2;
+        }
+        else if (elapsedWarmup_nsec >= settings.Warmup_nsec)
+        {
+            break;
+        }
+    }
+
+    // Measure
+    Result result;
+    result.Name = szName;
+    result.cIterationsPerSample = cIterationsPerSample;
+
+    for (uint32_t idxSample = 0; idxSample < settings.cSamples; ++idxSample)
+    {
+        uint64_t const elapsed_nsec = TimeIterations_nsec(body, cIterationsPerSample);
+        result.rgSamples_nsecPerIteration.push_back(static_cast<double>(elapsed_nsec) / cIterationsPerSample);
+    }
+
+    printf("%-72s %10.1f ns/iter (median, +/- %.1f%%, %llu iterations x %u samples)\n",
+           szName,
+           result.Median(),
+           100.0 * result.StandardDeviation() / result.Mean(),
+           static_cast<unsigned long long>(cIterationsPerSample),
+           settings.cSamples);
+
+    GetResults().push_back(result);
+}
+}  // namespace Bench
@@ -0,0 +1,113 @@
+#define CATCH_CONFIG_RUNNER  // We provide main() so we can emit results as JSON after Catch is done
+#include "base.h"
+#include "bench.h"
+
+// Include implementation source files
+#include "../../Thermostat.cpp"
+#include "../../ThermostatSetpointScheduler.cpp"
+
+// Instantiate mock globals
+MockEEPROM EEPROM;
+MockParticle Particle;
+MockSerial Serial;
+MockSystem System;
+MockTime Time;
+MockWiFi WiFi;
+MockWire Wire;
+
+namespace
+{
+bool WriteResults(char const* const szPath, char const* const szCommit)
+{
+    FILE* const pFile = fopen(szPath, "w");
+
+    if (!pFile)
+    {
+        fprintf(stderr, "!! Couldn't open %s for writing\n", szPath);
+        return false;
+    }
+
+    fprintf(pFile, "{\n  \"commit\": \"%s\",\n  \"compiler\": \"%s\",\n", szCommit, __VERSION__);
+    fprintf(pFile,
+            "  \"settings\": {\"samples\": %u, \"warmup_ns\": %llu, \"sampleTarget_ns\": %llu},\n",
+            Bench::GetSettings().cSamples,
+            static_cast<unsigned long long>(Bench::GetSettings().Warmup_nsec),
+            static_cast<unsigned long long>(Bench::GetSettings().SampleTarget_nsec));
+    fprintf(pFile, "  \"benchmarks\": [");
+
+    std::vector<Bench::Result> const& results = Bench::GetResults();
+
+    for (size_t idxResult = 0; idxResult < results.size(); ++idxResult)
+    {
+        Bench::Result const& result = results[idxResult];
+
+        fprintf(pFile,
+                "%s\n    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %zu, \"median_ns\": %.3f, "
+                "\"mean_ns\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f}",
+                (idxResult > 0) ? "," : "",
+                result.Name.c_str(),
+                static_cast<unsigned long long>(result.cIterationsPerSample),
+                result.rgSamples_nsecPerIteration.size(),
+                result.Median(),
+                result.Mean(),
+                result.StandardDeviation(),
+                result.Min(),
+                result.Max());
+    }
+
+    fprintf(pFile, "\n  ]\n}\n");
+    fclose(pFile);
+
+    return true;
+}
+}  // namespace
+
+//
+// Usage: bench [--json <path>] [--commit <id>] [--samples <n>] [Catch options, e.g. test case filters]
+//
+
+int main(int argc, char* argv[])
+{
+    char const* szJsonPath = nullptr;
+    char const* szCommit = "unknown";
+
+    // Strip our own options before handing the remainder to Catch
+    std::vector<char*> rgCatchArguments;
+    rgCatchArguments.push_back(argv[0]);
+
+    for (int idxArgument = 1; idxArgument < argc; ++idxArgument)
+    {
+        bool const fHasValue = (idxArgument + 1 < argc);
+
+        if (fHasValue && strcmp(argv[idxArgument], "--json") == 0)
+        {
+            szJsonPath = argv[++idxArgument];
+        }
+        else if (fHasValue && strcmp(argv[idxArgument], "--commit") == 0)
+        {
+            szCommit = argv[++idxArgument];
+        }
+        else if (fHasValue && strcmp(argv[idxArgument], "--samples") == 0)
+        {
+            Bench::GetSettings().cSamples = std::max(atoi(argv[++idxArgument]), 1);
+        }
+        else
+        {
+            rgCatchArguments.push_back(argv[idxArgument]);
+        }
+    }
+
+    int const result = Catch::Session().run(static_cast<int>(rgCatchArguments.size()), rgCatchArguments.data());
+
+    if (result == 0 && szJsonPath)
+    {
+        if (!WriteResults(szJsonPath, szCommit))
+        {
+            return 1;
+        }
+
+        printf("Wrote %zu results to %s\n", Bench::GetResults().size(), szJsonPath);
+    }
+
+    return result;
+}
@@ -0,0 +1,158 @@
+// There's no Catch test context while fuzzing, so have the mocks' REQUIRE()s turn into plain assertions
+#include <cassert>
+#define CATCH_CONFIG_PREFIX_ALL
+#define REQUIRE(expression) assert(expression)
+
+#include "base.h"
+
+//
+// libFuzzer harness for configuration ingestion (c.f. `npm run fuzz`).
+//
+// The first input byte selects what the rest of the input is:
+// - even: a (decoded) configuration flatbuffer, which is Z85-encoded before submission so that the verifier
+//         and everything reading accepted configurations gets exercised rather than just the Z85 decoder
+// - odd:  configuration text as received from the cloud, submitted as-is
+//
+// Accepted configurations are then persisted, reloaded, and read through the way the firmware reads them
+// so that any verifier gap shows up as an out-of-bounds read under AddressSanitizer.
+//
+// Without libFuzzer (e.g. with g++), build with -DFUZZ_REPLAY_MAIN to replay inputs given as files.
+//
+
+// Include implementation source files
+#include "../../Thermostat.cpp"
+#include "../../ThermostatSetpointScheduler.cpp"
+
+// Instantiate mock globals
+MockEEPROM EEPROM;
+MockParticle Particle;
+MockSerial Serial;
+MockSystem System;
+MockTime Time;
+MockWiFi WiFi;
+MockWire Wire;
+
+namespace
+{
+void ReadConfiguration(Configuration const& configuration)
+{
+    // Walks all settings and sensor fusion inputs
+    configuration.PrintConfiguration();
+
+    for (uint8_t idxZone = 0; idxZone < Zone::GetZoneCount(configuration); ++idxZone)
+    {
+        Zone zone;
+        zone.Initialize(configuration, idxZone, 0);
+        zone.Shutdown(0);
+    }
+}
+}  // namespace
+
+extern "C" int LLVMFuzzerInitialize(int* /* pArgc */, char*** /* pArgv */)
+{
+    // Keep the mocks' console output from slowing fuzzing down (libFuzzer reports on stderr)
+    freopen("/dev/null", "w", stdout);
+
+    EEPROM.testErase();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const* const rgData, size_t const cbData)
+{
+    if (!cbData)
+    {
+        return 0;
+    }
+
+    bool const fIsText = !!(rgData[0] & 0x1);
+    uint8_t const* const rgPayload = rgData + 1;
+    size_t const cbPayload = cbData - 1;
+
+    Configuration configuration;
+    configuration.Initialize();
+
+    Configuration::ConfigUpdateResult configUpdateResult;
+
+    if (fIsText)
+    {
+        if (cbPayload > UINT16_MAX)
+        {
+            return 0;
+        }
+
+        configUpdateResult =
+            configuration.SubmitUpdate(reinterpret_cast<char const*>(rgPayload), static_cast<uint16_t>(cbPayload));
+    }
+    else
+    {
+        // Z85 encodes multiples of four bytes. Allow for inputs larger than the configuration buffer
+        // so that its size limit gets exercised too.
+        uint8_t rgFlatbuffer[512];
+        char rgText[(sizeof(rgFlatbuffer) / 4) * 5 + 1];
+
+        if (cbPayload > sizeof(rgFlatbuffer))
+        {
+            return 0;
+        }
+
+        memset(rgFlatbuffer, 0, sizeof(rgFlatbuffer));
+        memcpy(rgFlatbuffer, rgPayload, cbPayload);
+
+        uint16_t const cbPadded = static_cast<uint16_t>((cbPayload + 3) & ~3);
+        uint16_t const cchText = Z85::EncodeBytes(rgText, sizeof(rgText), rgFlatbuffer, cbPadded);
+
+        configUpdateResult = configuration.SubmitUpdate(rgText, cchText);
+    }
+
+    if (configUpdateResult == Configuration::ConfigUpdateResult::Accepted)
+    {
+        configuration.AcceptPendingUpdates();
+        configuration.SaveData();
+        ReadConfiguration(configuration);
+
+        // Reload from (mock) EEPROM, as after a restart
+        Configuration reloadedConfiguration;
+        reloadedConfiguration.Initialize();
+        ReadConfiguration(reloadedConfiguration);
+
+        EEPROM.testErase();
+    }
+
+    return 0;
+}
+
+#ifdef FUZZ_REPLAY_MAIN
+
+int main(int argc, char* argv[])
+{
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    for (int idxArgument = 1; idxArgument < argc; ++idxArgument)
+    {
+        FILE* const pFile = fopen(argv[idxArgument], "rb");
+
+        if (!pFile)
+        {
+            fprintf(stderr, "!! Couldn't open %s\n", argv[idxArgument]);
+            return 1;
+        }
+
+        std::vector<uint8_t> rgData;
+        uint8_t rgChunk[1024];
+        size_t cbChunk;
+
+        while ((cbChunk = fread(rgChunk, 1, sizeof(rgChunk), pFile)) > 0)
+        {
+            rgData.insert(rgData.end(), rgChunk, rgChunk + cbChunk);
+        }
+
+        fclose(pFile);
+
+        LLVMFuzzerTestOneInput(rgData.data(), rgData.size());
+        fprintf(stderr, "Replayed %s (%zu bytes)\n", argv[idxArgument], rgData.size());
+    }
+
+    return 0;
+}
+
+#endif
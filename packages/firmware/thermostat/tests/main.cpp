@@ -4,6 +4,7 @@
 // Include implementation source files
 #include "../Thermostat.cpp"
 #include "../ThermostatSetpointScheduler.cpp"
+#include "../onewire/OneWireGateway2484.cpp"
 
 // Instantiate mock globals
 MockEEPROM EEPROM;
@@ -62,3 +62,7 @@
 #define RGBR 21
 #define RGBG 22
 #define RGBB 23
+
+// I2C clock speeds (c.f. Particle's device-os/wiring/inc/spark_wiring_i2c.h)
+#define CLOCK_SPEED_100KHZ 100000
+#define CLOCK_SPEED_400KHZ 400000
@@ -1,23 +1,116 @@
 #pragma once
 
+inline void delay(uint32_t duration);  // c.f. mocks/time.h
+
 class MockEEPROM
 {
 public:
     MockEEPROM()
+        : m_rgData()
+        , m_cWrites()
+        , m_cBytesWritten()
+        , m_fHasPendingErase()
+        , m_EraseDuration_msec()
+        , m_cErases()
     {
+        testErase();
     }
 
 public:
     template <typename T>
-    void get(int const _address, T& data)
+    void get(int const address, T& data)
     {
-        memset(&data, 0xFF, sizeof(T));
+        REQUIRE(address + sizeof(T) <= sizeof(m_rgData));
+        memcpy(&data, m_rgData + address, sizeof(T));
     }
 
     template <typename T>
-    void put(int const _address, T const& _data)
+    void put(int const address, T const& data)
+    {
+        REQUIRE(address + sizeof(T) <= sizeof(m_rgData));
+
+        // Like Particle's implementation, only changed bytes are written
+        uint8_t const* const rgNewData = reinterpret_cast<uint8_t const*>(&data);
+        size_t cbChanged = 0;
+
+        for (size_t idxByte = 0; idxByte < sizeof(T); ++idxByte)
+        {
+            if (m_rgData[address + idxByte] != rgNewData[idxByte])
+            {
+                m_rgData[address + idxByte] = rgNewData[idxByte];
+                ++cbChanged;
+            }
+        }
+
+        if (cbChanged)
+        {
+            ++m_cWrites;
+            m_cBytesWritten += cbChanged;
+        }
+    }
+
+    bool hasPendingErase() const
+    {
+        return m_fHasPendingErase;
+    }
+
+    void performPendingErase()
+    {
+        if (m_fHasPendingErase)
+        {
+            // Erases stall the CPU
+            delay(m_EraseDuration_msec);
+
+            m_fHasPendingErase = false;
+            ++m_cErases;
+        }
+    }
+
+public:
+    //
+    // Test code API
+    //
+
+    void testErase()
     {
+        // Erased flash reads as 0xFF
+        memset(m_rgData, 0xFF, sizeof(m_rgData));
+        m_fHasPendingErase = false;
     }
+
+    // Simulates the Device OS running low on space in its active flash page
+    void testSetPendingErase(uint32_t const eraseDuration_msec)
+    {
+        m_fHasPendingErase = true;
+        m_EraseDuration_msec = eraseDuration_msec;
+    }
+
+    uint64_t testGetEraseCount() const
+    {
+        return m_cErases;
+    }
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    uint64_t testGetWriteCount() const
+    {
+        return m_cWrites;
+    }
+
+    uint64_t testGetBytesWritten() const
+    {
+        return m_cBytesWritten;
+    }
+
+private:
+    // c.f. https://docs.particle.io/reference/device-os/firmware/photon/#eeprom
+    uint8_t m_rgData[2047];
+
+    uint64_t m_cWrites;
+    uint64_t m_cBytesWritten;
+
+    bool m_fHasPendingErase;
+    uint32_t m_EraseDuration_msec;
+    uint64_t m_cErases;
 };
 
-extern MockEEPROM EEPROM;
\ No newline at end of file
+extern MockEEPROM EEPROM;
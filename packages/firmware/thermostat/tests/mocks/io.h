@@ -17,6 +17,14 @@ typedef enum PinMode
     PIN_MODE_NONE = 0xFF
 } PinMode;
 
+// c.f. Particle's device-os/hal/inc/interrupts_hal.h
+typedef enum InterruptMode
+{
+    CHANGE,
+    RISING,
+    FALLING
+} InterruptMode;
+
 // c.f. Particle's device-os/wiring_globals/src/spark_wiring_gpio.cpp
 inline void pinMode(pin_t _pin, PinMode _setMode)
 {
@@ -27,6 +35,17 @@ inline PinMode getPinMode(pin_t _pin)
     return OUTPUT;
 }
 
+// Test code API: last value written to each pin
+inline uint8_t* testGetPinValues()
+{
+    static uint8_t s_rgPinValues[32] = {};
+    return s_rgPinValues;
+}
+
 inline void digitalWrite(pin_t _pin, uint8_t _value)
 {
+    if (_pin < 32)
+    {
+        testGetPinValues()[_pin] = _value;
+    }
 }
@@ -12,13 +12,17 @@ class MockParticle
 {
 public:
     MockParticle()
+        : m_fIsConnected(true)
+        , m_cPublishes()
+        , m_cPublishedBytes()
+        , m_LastPublishedData()
     {
     }
 
 public:
     bool connected() const
     {
-        return true;
+        return m_fIsConnected;
     }
 
     bool publish(char const* const szEventName,
@@ -26,9 +30,53 @@ public:
                  int const _ttl,
                  int /*PublishFlag*/ const flags)
     {
+        if (!m_fIsConnected)
+        {
+            return false;
+        }
+
         printf("Particle.Publish: '%s' = '%s' (flags: 0x%02x)", szEventName, szData, flags);
+
+        ++m_cPublishes;
+        m_cPublishedBytes += strlen(szEventName) + strlen(szData);
+        m_LastPublishedData = szData;
+
         return true;
     }
+
+public:
+    //
+    // Test code API
+    //
+
+    void testSetConnected(bool const fIsConnected)
+    {
+        m_fIsConnected = fIsConnected;
+    }
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    uint64_t testGetPublishCount() const
+    {
+        return m_cPublishes;
+    }
+
+    uint64_t testGetPublishedByteCount() const
+    {
+        return m_cPublishedBytes;
+    }
+
+    std::string const& testGetLastPublishedData() const
+    {
+        return m_LastPublishedData;
+    }
+
+private:
+    bool m_fIsConnected;
+
+    uint64_t m_cPublishes;
+    uint64_t m_cPublishedBytes;
+
+    std::string m_LastPublishedData;
 };
 
 extern MockParticle Particle;
\ No newline at end of file
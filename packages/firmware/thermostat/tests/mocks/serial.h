@@ -4,6 +4,9 @@ class MockSerial
 {
 public:
     MockSerial()
+        : m_cBytes()
+        , m_fCaptureLines()
+        , m_CapturedLines()
     {
     }
 
@@ -11,12 +14,19 @@ public:
     void print(char const* const szData)
     {
         puts(szData);
+        m_cBytes += strlen(szData);
     }
 
     void println(char const* const szData)
     {
         puts(szData);
         puts("\n");
+        m_cBytes += strlen(szData) + 2 /* CR LF */;
+
+        if (m_fCaptureLines)
+        {
+            m_CapturedLines.push_back(szData);
+        }
     }
 
     void printf(char const* const szFormat, ...)
@@ -24,7 +34,7 @@ public:
         va_list args;
         va_start(args, szFormat);
 
-        vprintf(szFormat, args);
+        m_cBytes += std::max(vprintf(szFormat, args), 0);
 
         va_end(args);
     }
@@ -34,11 +44,42 @@ public:
         va_list args;
         va_start(args, szFormat);
 
-        vprintf(szFormat, args);
-        puts("\n");
+        char szLine[1024];
+        vsnprintf(szLine, sizeof(szLine), szFormat, args);
 
         va_end(args);
+
+        println(szLine);
+    }
+
+public:
+    //
+    // Test code API
+    //
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    uint64_t testGetByteCount() const
+    {
+        return m_cBytes;
     }
+
+    // Lines written with println()/printlnf() (while capturing)
+    void testCaptureLines(bool const fCaptureLines)
+    {
+        m_fCaptureLines = fCaptureLines;
+        m_CapturedLines.clear();
+    }
+
+    std::vector<std::string> const& testGetCapturedLines() const
+    {
+        return m_CapturedLines;
+    }
+
+private:
+    uint64_t m_cBytes;
+
+    bool m_fCaptureLines;
+    std::vector<std::string> m_CapturedLines;
 };
 
 extern MockSerial Serial;
\ No newline at end of file
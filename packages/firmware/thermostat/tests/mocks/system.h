@@ -1,17 +1,99 @@
 #pragma once
 
+// c.f. Particle's device-os/system/inc/system_sleep.h
+enum SleepNetworkFlag
+{
+    SLEEP_NETWORK_OFF,
+    SLEEP_NETWORK_STANDBY
+};
+
 class MockSystem
 {
 public:
     MockSystem()
+        : m_fSleepAdvancesClock(true)
+        , m_cSleeps()
+        , m_Sleep_msec()
+        , m_NetworkStandbySleep_msec()
+        , m_cNetworkOffSleeps()
     {
     }
 
 public:
+    //
+    // Product code API
+    //
+
     void reset()
     {
         printf(">>> System reset requested.");
     }
+
+    // Stop mode: woken by time alone (the virtual clock advances by the full duration)
+    void sleep(uint16_t const wakeUpPin,
+               uint16_t const edgeTriggerMode,
+               long const seconds,
+               SleepNetworkFlag const flag = SLEEP_NETWORK_OFF)
+    {
+        uint32_t const duration_msec = static_cast<uint32_t>(seconds) * 1000;
+
+        if (m_fSleepAdvancesClock)
+        {
+            Time.testAdvanceMillis(duration_msec);
+        }
+
+        ++m_cSleeps;
+        m_Sleep_msec += duration_msec;
+
+        if (flag == SLEEP_NETWORK_STANDBY)
+        {
+            m_NetworkStandbySleep_msec += duration_msec;
+        }
+        else
+        {
+            ++m_cNetworkOffSleeps;
+        }
+    }
+
+public:
+    //
+    // Test code API
+    //
+
+    void testSetSleepAdvancesClock(bool const fSleepAdvancesClock)
+    {
+        m_fSleepAdvancesClock = fSleepAdvancesClock;
+    }
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    uint64_t testGetSleepCount() const
+    {
+        return m_cSleeps;
+    }
+
+    uint64_t testGetSleep_msec() const
+    {
+        return m_Sleep_msec;
+    }
+
+    uint64_t testGetNetworkStandbySleep_msec() const
+    {
+        return m_NetworkStandbySleep_msec;
+    }
+
+    // i.e. sleeps that need a reconnect on waking
+    uint64_t testGetNetworkOffSleepCount() const
+    {
+        return m_cNetworkOffSleeps;
+    }
+
+private:
+    bool m_fSleepAdvancesClock;
+
+    uint64_t m_cSleeps;
+    uint64_t m_Sleep_msec;
+    uint64_t m_NetworkStandbySleep_msec;
+    uint64_t m_cNetworkOffSleeps;
 };
 
-extern MockSystem System;
\ No newline at end of file
+extern MockSystem System;
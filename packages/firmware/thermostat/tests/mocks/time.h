@@ -1,15 +1,5 @@
 #pragma once
 
-inline uint32_t millis()
-{
-    return 0;
-}
-
-inline void delay(uint32_t _duration)
-{
-    // Do nothing
-}
-
 // Test helper types
 enum class ParticleDayOfWeek : uint8_t
 {
@@ -28,6 +18,9 @@ class MockTime
 public:
     MockTime()
         : m_Now()
+        , m_Millis()
+        , m_Micros()
+        , m_TotalDelay_usec()
     {
     }
 
@@ -65,31 +58,85 @@ public:
         m_Now = now;
     }
 
+    // Local time is UTC for configurations with a zero UTC offset (i.e. by default, c.f. LocalTime)
     void testSetLocalTime(ParticleDayOfWeek dayOfWeek, int hour, int minute)
     {
-        // Use Sunday Jan 5 2020 as our arbitrary anchor
+        // Use Sunday Jan 5 2020 00:00 UTC as our arbitrary anchor
         // Also recall ParticleDayOfWeek::Sunday == 1
+        uint32_t constexpr c_AnchorTime = 1578182400;
 
-        std::tm time = {.tm_min = minute,
-                        .tm_hour = hour,
-                        .tm_mday = 4 + static_cast<int>(dayOfWeek),
-                        .tm_mon = 1 - 1,
-                        .tm_year = 2020 - 1900};
+        m_Now = c_AnchorTime + ((static_cast<int>(dayOfWeek) - 1) * 24 * 60 + hour * 60 + minute) * 60;
+    }
 
-        // std::mktime takes local time and returns UTC
-        time_t const now = std::mktime(&time);
+    //
+    // Virtual clock for millis() and delay()
+    //
 
-        m_Now = now;
+    uint32_t testGetMillis() const
+    {
+        return m_Millis;
+    }
+
+    void testSetMillis(uint32_t const millis)
+    {
+        m_Millis = millis;
+    }
+
+    void testAdvanceMillis(uint32_t const duration_msec)
+    {
+        m_Millis += duration_msec;
+    }
+
+    void testAdvanceMicros(uint32_t const duration_usec)
+    {
+        m_Micros += duration_usec;
+
+        m_Millis += m_Micros / 1000;
+        m_Micros %= 1000;
+    }
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    void testRecordDelay(uint64_t const duration_usec)
+    {
+        m_TotalDelay_usec += duration_usec;
+    }
+
+    uint64_t testGetTotalDelay_usec() const
+    {
+        return m_TotalDelay_usec;
     }
 
 private:
     uint32_t m_Now;
+    uint32_t m_Millis;
+    uint32_t m_Micros;  // sub-millisecond remainder
+
+    uint64_t m_TotalDelay_usec;
 
     std::tm const* getCalendarTime() const
     {
         std::time_t const now = m_Now;
-        return std::localtime(&now);
+        return std::gmtime(&now);
     }
 };
 
-extern MockTime Time;
\ No newline at end of file
+extern MockTime Time;
+
+inline uint32_t millis()
+{
+    return Time.testGetMillis();
+}
+
+inline void delay(uint32_t duration)
+{
+    // Advance virtual clock
+    Time.testAdvanceMillis(duration);
+    Time.testRecordDelay(duration * 1000ull);
+}
+
+inline void delayMicroseconds(uint32_t duration)
+{
+    // Advance virtual clock
+    Time.testAdvanceMicros(duration);
+    Time.testRecordDelay(duration);
+}
\ No newline at end of file
@@ -1,25 +1,132 @@
 #pragma once
 
+// Simulated device on the mock I2C bus (c.f. MockWire::testAttachDevice)
+class MockI2CDevice
+{
+public:
+    virtual ~MockI2CDevice()
+    {
+    }
+
+    // @returns false to NACK the transmission
+    virtual bool OnWrite(uint8_t const* const rgData, size_t const cbData) = 0;
+
+    // @returns count of bytes provided (up to cbData)
+    virtual size_t OnRead(uint8_t* const rgData, size_t const cbData) = 0;
+};
+
+// c.f. Particle's device-os/wiring/inc/spark_wiring_i2c.h
 class MockWire
 {
 public:
     MockWire()
+        : m_rgDevices()
+        , m_Address()
+        , m_rgTransmission()
+        , m_cbTransmission()
+        , m_rgReceived()
+        , m_cbReceived()
+        , m_idxReceived()
+        , m_cTransactions()
+        , m_cBytes()
     {
     }
 
 public:
-    void beginTransmission(uint8_t const _address)
+    //
+    // Product code API
+    //
+
+    void setSpeed(uint32_t const _clockSpeed)
     {
     }
 
+    void begin()
+    {
+    }
+
+    void beginTransmission(uint8_t const address)
+    {
+        m_Address = address;
+        m_cbTransmission = 0;
+    }
+
+    // @returns 0 on success, 2 if the address was NACKed (no such device)
     byte endTransmission()
     {
+        ++m_cTransactions;
+        m_cBytes += 1 /* address */ + m_cbTransmission;
+
+        MockI2CDevice* const pDevice = m_rgDevices[m_Address & 0x7F];
+
+        if (!pDevice || !pDevice->OnWrite(m_rgTransmission, m_cbTransmission))
+        {
+            return 2;
+        }
+
         return 0;
     }
 
-    void write(uint8_t const _data)
+    void write(uint8_t const data)
+    {
+        if (m_cbTransmission < sizeof(m_rgTransmission))
+        {
+            m_rgTransmission[m_cbTransmission++] = data;
+        }
+    }
+
+    uint8_t requestFrom(uint8_t const address, uint8_t const cbRequested)
     {
+        ++m_cTransactions;
+        m_cBytes += 1 /* address */ + cbRequested;
+
+        MockI2CDevice* const pDevice = m_rgDevices[address & 0x7F];
+
+        m_idxReceived = 0;
+        m_cbReceived = pDevice ? pDevice->OnRead(m_rgReceived, std::min<size_t>(cbRequested, sizeof(m_rgReceived))) : 0;
+
+        return static_cast<uint8_t>(m_cbReceived);
+    }
+
+    int read()
+    {
+        return (m_idxReceived < m_cbReceived) ? m_rgReceived[m_idxReceived++] : -1;
+    }
+
+public:
+    //
+    // Test code API
+    //
+
+    void testAttachDevice(uint8_t const address, MockI2CDevice* const pDevice)
+    {
+        m_rgDevices[address & 0x7F] = pDevice;
     }
+
+    // Costs (monotonically increasing, c.f. CostAccounting)
+    uint64_t testGetTransactionCount() const
+    {
+        return m_cTransactions;
+    }
+
+    uint64_t testGetByteCount() const
+    {
+        return m_cBytes;
+    }
+
+private:
+    MockI2CDevice* m_rgDevices[128];
+
+    uint8_t m_Address;
+    uint8_t m_rgTransmission[32];
+    size_t m_cbTransmission;
+
+    uint8_t m_rgReceived[32];
+    size_t m_cbReceived;
+    size_t m_idxReceived;
+
+    uint64_t m_cTransactions;
+    uint64_t m_cBytes;
 };
 
-extern MockWire Wire;
\ No newline at end of file
+extern MockWire Wire;
@@ -1,12 +1,51 @@
 import * as yup from "yup";
 
-import { ThermostatAction } from "../generated/graphqlTypes";
+import {
+  ControlMode,
+  SensorFilterType,
+  SensorFusionMethod,
+  ThermostatAction,
+} from "../generated/graphqlTypes";
 
 export namespace ThermostatConfigurationSchema {
   export const Actions = [ThermostatAction.Heat, ThermostatAction.Cool, ThermostatAction.Circulate];
 
   export const ThresholdRange = { min: 0.5, max: 5 };
   export const CadenceRange = { min: 30, max: 3600 };
+  export const PublishCadenceRange = { min: 0, max: 3600 }; // zero publishes on every cadence
+
+  export const ControlModes = [ControlMode.Hysteresis, ControlMode.TimeProportional];
+  export const ProportionalGainRange = { min: 0, max: 5 };
+  export const IntegralGainRange = { min: 0, max: 5 };
+  export const ControlCycleWindowRange = { min: 60, max: 3600 };
+
+  export const ShortCycleProtectionTimeRange = { min: 0, max: 3600 };
+
+  export const MaximumEarlyStartRange = { min: 0, max: 6 * 60 };
+
+  // c.f. firmware Configuration.h#sc_cSensorFusionInputs_Max
+  export const SensorFusionInputsMax = 17;
+  export const SensorFusionWeightRange = { min: 0, max: 255 };
+  export const SensorFusionMethods = [
+    SensorFusionMethod.WeightedMedian,
+    SensorFusionMethod.TrimmedMean,
+  ];
+
+  export const SensorFilterTypes = [
+    SensorFilterType.None,
+    SensorFilterType.ExponentialMovingAverage,
+    SensorFilterType.Kalman,
+  ];
+  export const SensorFilterSmoothingRange = { min: 0.01, max: 1 };
+  export const SensorFilterNoiseRange = { min: 0.0001, max: 6.5 }; // [C^2]
+
+  // c.f. firmware Configuration.h#sc_cZones_Max, #IsReservedPin()
+  export const ZonesMax = 4;
+  export const ZoneSettingIndexRange = { min: 0, max: 31 };
+  export const ZoneRelayPinRange = { min: 0, max: 254 };
+  export const ZoneRelayPinsReserved = [0, 1, 2, 6, 7]; // D0-D2, D6, D7
+
+  export const DehumidifyAboveDewPointRange = { min: 0, max: 30 }; // [Celsius]
 
   export const Schema = yup.object().shape({
     id: yup.string().required(),
@@ -34,5 +73,195 @@ export namespace ThermostatConfigurationSchema {
       .integer()
       .min(CadenceRange.min)
       .max(CadenceRange.max),
+    publishCadence: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(PublishCadenceRange.min)
+      .max(PublishCadenceRange.max),
+    controlMode: yup
+      .string()
+      .notRequired()
+      .nullable()
+      .oneOf([...ControlModes, null]),
+    proportionalGain: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(ProportionalGainRange.min)
+      .max(ProportionalGainRange.max),
+    integralGain: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(IntegralGainRange.min)
+      .max(IntegralGainRange.max),
+    controlCycleWindow: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(ControlCycleWindowRange.min)
+      .max(ControlCycleWindowRange.max),
+    minimumRunTime: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(ShortCycleProtectionTimeRange.min)
+      .max(ShortCycleProtectionTimeRange.max),
+    minimumOffTime: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(ShortCycleProtectionTimeRange.min)
+      .max(ShortCycleProtectionTimeRange.max),
+    changeoverDeadTime: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(ShortCycleProtectionTimeRange.min)
+      .max(ShortCycleProtectionTimeRange.max),
+    maximumEarlyStart: yup
+      .number()
+      .integer()
+      .notRequired()
+      .nullable()
+      .min(MaximumEarlyStartRange.min)
+      .max(MaximumEarlyStartRange.max),
+    sensorFusionInputs: yup
+      .array()
+      .notRequired()
+      .nullable()
+      .max(SensorFusionInputsMax)
+      .of(
+        yup.object().shape({
+          sensorId: yup
+            .string()
+            .notRequired()
+            .nullable()
+            .matches(/^$|^[a-f0-9]{16}$/),
+          weight: yup
+            .number()
+            .integer()
+            .required()
+            .min(SensorFusionWeightRange.min)
+            .max(SensorFusionWeightRange.max),
+        })
+      ),
+    sensorFusionMethod: yup
+      .string()
+      .notRequired()
+      .nullable()
+      .oneOf([...SensorFusionMethods, null]),
+    sensorFilterType: yup
+      .string()
+      .notRequired()
+      .nullable()
+      .oneOf([...SensorFilterTypes, null]),
+    sensorFilterSmoothing: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(SensorFilterSmoothingRange.min)
+      .max(SensorFilterSmoothingRange.max),
+    sensorFilterProcessNoise: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(SensorFilterNoiseRange.min)
+      .max(SensorFilterNoiseRange.max),
+    sensorFilterMeasurementNoise: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(SensorFilterNoiseRange.min)
+      .max(SensorFilterNoiseRange.max),
+    zones: yup
+      .array()
+      .notRequired()
+      .nullable()
+      .max(ZonesMax)
+      .of(
+        yup.object().shape({
+          sensorId: yup
+            .string()
+            .notRequired()
+            .nullable()
+            .matches(/^$|^[a-f0-9]{16}$/),
+          thermostatSettingIndexes: yup
+            .array()
+            .notRequired()
+            .nullable()
+            .of(
+              yup
+                .number()
+                .integer()
+                .min(ZoneSettingIndexRange.min)
+                .max(ZoneSettingIndexRange.max)
+            ),
+          relayPinHeat: yup
+            .number()
+            .integer()
+            .notRequired()
+            .nullable()
+            .min(ZoneRelayPinRange.min)
+            .max(ZoneRelayPinRange.max)
+            .notOneOf(ZoneRelayPinsReserved),
+          relayPinSwitchOver: yup
+            .number()
+            .integer()
+            .notRequired()
+            .nullable()
+            .min(ZoneRelayPinRange.min)
+            .max(ZoneRelayPinRange.max)
+            .notOneOf(ZoneRelayPinsReserved),
+          relayPinCirculate: yup
+            .number()
+            .integer()
+            .notRequired()
+            .nullable()
+            .min(ZoneRelayPinRange.min)
+            .max(ZoneRelayPinRange.max)
+            .notOneOf(ZoneRelayPinsReserved),
+          controlMode: yup
+            .string()
+            .notRequired()
+            .nullable()
+            .oneOf([...ControlModes, null]),
+          proportionalGain: yup
+            .number()
+            .notRequired()
+            .nullable()
+            .min(ProportionalGainRange.min)
+            .max(ProportionalGainRange.max),
+          integralGain: yup
+            .number()
+            .notRequired()
+            .nullable()
+            .min(IntegralGainRange.min)
+            .max(IntegralGainRange.max),
+          controlCycleWindow: yup
+            .number()
+            .integer()
+            .notRequired()
+            .nullable()
+            .min(ControlCycleWindowRange.min)
+            .max(ControlCycleWindowRange.max),
+        })
+      ),
+    dehumidifyAboveDewPoint: yup
+      .number()
+      .notRequired()
+      .nullable()
+      .min(DehumidifyAboveDewPointRange.min)
+      .max(DehumidifyAboveDewPointRange.max),
+    lowPowerSleep: yup
+      .boolean()
+      .notRequired()
+      .nullable(),
   });
 }